@@ -543,7 +543,40 @@ typedef struct {
 /* SURFACE */
 #define PYGAMEAPI_SURFACE_FIRSTSLOT                             \
     (PYGAMEAPI_DISPLAY_FIRSTSLOT + PYGAMEAPI_DISPLAY_NUMSLOTS)
-#define PYGAMEAPI_SURFACE_NUMSLOTS 3
+#define PYGAMEAPI_SURFACE_NUMSLOTS 8
+
+/* Most rects a dirty region keeps before merging them */
+#define PG_DIRTY_MAXRECTS 32
+struct DirtyRegion_Data
+{
+    int count;
+    SDL_Rect rects[PG_DIRTY_MAXRECTS];
+};
+
+/* One holder of locks on a surface, see surflock.c. A surface locking
+ * itself needs no weak reference; any other lock object is watched by
+ * one, so the locks of an object that died without unlocking are freed.
+ */
+struct SurfLock_Record
+{
+    PyObject *lockobj;              /* borrowed                          */
+    PyObject *ref;                  /* weakref to lockobj, or NULL       */
+    Py_ssize_t count;
+};
+
+/* Lock records kept in the surface object until there are too many */
+#define PG_SURFLOCK_INLINE 4
+
+/* A Surface.get_bounding_rect result kept until the surface changes */
+struct BoundingRect_Data
+{
+    int valid;
+    int min_alpha;
+    int has_colorkey;
+    Uint32 colorkey;
+    SDL_Rect rect;
+};
+
 typedef struct {
     PyObject_HEAD
     SDL_Surface* surf;
@@ -553,10 +586,23 @@ typedef struct {
     struct SubSurface_Data* subsurface;  /*ptr to subsurface data (if a
                                           * subsurface)*/
     PyObject *weakreflist;
-    PyObject *locklist;
+    PyObject *locklist;                  /*always NULL, the locks are in
+                                          * locks; kept for the layout*/
     PyObject *dependency;
+    struct DirtyRegion_Data* dirty;      /*ptr to changed areas (if
+                                          * tracked)*/
+    struct BoundingRect_Data* bounds;    /*ptr to cached bounding rect (if
+                                          * asked for)*/
+    struct SurfLock_Record* locks;       /*ptr to lock records, inlocks or
+                                          * the heap*/
+    int nlocks;
+    int maxlocks;
+    struct SurfLock_Record inlocks[PG_SURFLOCK_INLINE];
 } PySurfaceObject;
 #define PySurface_AsSurface(x) (((PySurfaceObject*)x)->surf)
+#define PySurface_ClearBounds(x)                                        \
+    if (((PySurfaceObject*)x)->bounds)                                  \
+        ((PySurfaceObject*)x)->bounds->valid = 0
 #ifndef PYGAMEAPI_SURFACE_INTERNAL
 #define PySurface_Check(x)                                              \
     ((x)->ob_type == (PyTypeObject*)                                    \
@@ -575,6 +621,22 @@ typedef struct {
 #define PySurface_Blit                                                  \
     (*(int(*)(PyObject*,PyObject*,SDL_Rect*,SDL_Rect*,int))             \
      PyGAME_C_API[PYGAMEAPI_SURFACE_FIRSTSLOT + 2])
+#define PySurface_AddDirty(x, r)                                        \
+    if(((PySurfaceObject*)x)->dirty || ((PySurfaceObject*)x)->subsurface) \
+        (*(*(void(*)(PyObject*,SDL_Rect*))                              \
+           PyGAME_C_API[PYGAMEAPI_SURFACE_FIRSTSLOT + 3]))(x, r)
+#define PySurface_CreatePooled                                          \
+    (*(SDL_Surface*(*)(Uint32,int,int,int,Uint32,Uint32,Uint32,Uint32)) \
+     PyGAME_C_API[PYGAMEAPI_SURFACE_FIRSTSLOT + 4])
+#define PySurface_FreePooled                                            \
+    (*(void(*)(SDL_Surface*))                                           \
+     PyGAME_C_API[PYGAMEAPI_SURFACE_FIRSTSLOT + 5])
+#define PySurface_WorkersBands                                          \
+    (*(int(*)(int,int))                                                 \
+     PyGAME_C_API[PYGAMEAPI_SURFACE_FIRSTSLOT + 6])
+#define PySurface_WorkersRun                                            \
+    (*(void(*)(void(*)(void*,int,int),void*,int,int))                   \
+     PyGAME_C_API[PYGAMEAPI_SURFACE_FIRSTSLOT + 7])
 
 #define import_pygame_surface() do {                                   \
     IMPORT_PYGAME_MODULE(surface, SURFACE);                            \
@@ -24,6 +24,8 @@
 
 #define NO_PYGAME_C_API
 #include "_surface.h"
+#include "simd_blitters.h"
+#include "pgworkers.h"
 
 /* The structure passed to the low level blit functions */
 typedef struct
@@ -65,6 +67,22 @@ static void blit_blend_rgba_max (SDL_BlitInfo * info);
 
 static void blit_blend_premultiplied (SDL_BlitInfo * info);
 
+static int alphablit_alpha_32_layout (SDL_BlitInfo * info,
+                                      AlphaBlitLayout32 * layout);
+
+static int blit_blend_packed (SDL_BlitInfo * info, PackedBlendOp op,
+                              int rgba);
+
+
+/* One blit split into row bands for the worker pool */
+typedef struct
+{
+    SDL_BlitInfo    *info;
+    void           (*blitfunc) (SDL_BlitInfo *);
+} SoftBlitJob;
+
+static void
+softblit_band (void *job, int first, int count);
 
 static int
 SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect,
@@ -72,6 +90,18 @@ SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect,
 extern int  SDL_RLESurface (SDL_Surface * surface);
 extern void SDL_UnRLESurface (SDL_Surface * surface, int recode);
 
+static void
+softblit_band (void *job, int first, int count)
+{
+    SoftBlitJob    *blitjob = (SoftBlitJob *) job;
+    SDL_BlitInfo    info = *blitjob->info;
+
+    info.s_pixels += first * (info.width * info.s_pxskip + info.s_skip);
+    info.d_pixels += first * (info.width * info.d_pxskip + info.d_skip);
+    info.height = count;
+    blitjob->blitfunc (&info);
+}
+
 static int
 SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect, SDL_Surface * dst,
                 SDL_Rect * dstrect, int the_args)
@@ -106,6 +136,9 @@ SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect, SDL_Surface * dst,
     if (okay && srcrect->w && srcrect->h)
     {
         SDL_BlitInfo    info;
+        void          (*blitfunc) (SDL_BlitInfo *) = NULL;
+        int             overlap;
+        int             nbands;
 
         /* Set up the blit information */
         info.width = srcrect->w;
@@ -138,6 +171,13 @@ SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect, SDL_Surface * dst,
         info.src_has_colorkey = SDL_GetColorKey (src, &info.src_colorkey) == 0;
 #endif /* SDL2 */
 
+        overlap = (info.d_pixels <
+                   info.s_pixels + (info.height - 1) * src->pitch +
+                   info.width * info.s_pxskip &&
+                   info.s_pixels <
+                   info.d_pixels + (info.height - 1) * dst->pitch +
+                   info.width * info.d_pxskip);
+
         if (info.d_pixels > info.s_pixels)
         {
             int span = info.width * info.src->BytesPerPixel;
@@ -174,77 +214,74 @@ SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect, SDL_Surface * dst,
 #else /* SDL2 */
             if (SDL_ISPIXELFORMAT_ALPHA (src->format->format))
 #endif /* SDL2 */
-                alphablit_alpha (&info);
+                blitfunc = alphablit_alpha;
 #ifndef SDL2
             else if (src->flags & SDL_SRCCOLORKEY)
 #else /* SDL2 */
             else if (info.src_has_colorkey)
 #endif /* SDL2 */
-                alphablit_colorkey (&info);
+                blitfunc = alphablit_colorkey;
             else
-                alphablit_solid (&info);
+                blitfunc = alphablit_solid;
             break;
         }
         case PYGAME_BLEND_ADD:
         {
-            blit_blend_add (&info);
+            blitfunc = blit_blend_add;
             break;
         }
         case PYGAME_BLEND_SUB:
         {
-            blit_blend_sub (&info);
+            blitfunc = blit_blend_sub;
             break;
         }
         case PYGAME_BLEND_MULT:
         {
-            blit_blend_mul (&info);
+            blitfunc = blit_blend_mul;
             break;
         }
         case PYGAME_BLEND_MIN:
         {
-            blit_blend_min (&info);
+            blitfunc = blit_blend_min;
             break;
         }
         case PYGAME_BLEND_MAX:
         {
-            blit_blend_max (&info);
+            blitfunc = blit_blend_max;
             break;
         }
 
         case PYGAME_BLEND_RGBA_ADD:
         {
-        blit_blend_rgba_add (&info);
-        break;
+            blitfunc = blit_blend_rgba_add;
+            break;
         }
         case PYGAME_BLEND_RGBA_SUB:
         {
-            blit_blend_rgba_sub (&info);
+            blitfunc = blit_blend_rgba_sub;
             break;
         }
         case PYGAME_BLEND_RGBA_MULT:
         {
-            blit_blend_rgba_mul (&info);
+            blitfunc = blit_blend_rgba_mul;
             break;
         }
         case PYGAME_BLEND_RGBA_MIN:
         {
-            blit_blend_rgba_min (&info);
+            blitfunc = blit_blend_rgba_min;
             break;
         }
         case PYGAME_BLEND_RGBA_MAX:
         {
-            blit_blend_rgba_max (&info);
+            blitfunc = blit_blend_rgba_max;
             break;
         }
         case PYGAME_BLEND_PREMULTIPLIED:
         {
-            blit_blend_premultiplied (&info);
+            blitfunc = blit_blend_premultiplied;
             break;
         }
 
-
-
-
         default:
         {
             SDL_SetError ("Invalid argument passed to blit.");
@@ -252,6 +289,24 @@ SoftBlitPyGame (SDL_Surface * src, SDL_Rect * srcrect, SDL_Surface * dst,
             break;
         }
         }
+
+        if (blitfunc)
+        {
+            /* Row bands only work when no band reads what another writes */
+            nbands = overlap ? 1 : pg_workers_bands (info.width, info.height);
+            if (nbands > 1)
+            {
+                SoftBlitJob job;
+
+                job.info = &info;
+                job.blitfunc = blitfunc;
+                Py_BEGIN_ALLOW_THREADS;
+                pg_workers_run (softblit_band, &job, info.height, nbands);
+                Py_END_ALLOW_THREADS;
+            }
+            else
+                blitfunc (&info);
+        }
     }
     /* We need to unlock the surfaces if they're locked */
     if (dst_locked)
@@ -305,6 +360,9 @@ blit_blend_rgba_add (SDL_BlitInfo * info)
         return;
     }
 
+    if (blit_blend_packed (info, PACKED_BLEND_ADD, 1))
+        return;
+
     if (srcbpp == 4 && dstbpp == 4 &&
         srcfmt->Rmask == dstfmt->Rmask &&
         srcfmt->Gmask == dstfmt->Gmask &&
@@ -494,6 +552,9 @@ blit_blend_rgba_sub (SDL_BlitInfo * info)
         return;
     }
 
+    if (blit_blend_packed (info, PACKED_BLEND_SUB, 1))
+        return;
+
     if (srcbpp == 4 && dstbpp == 4 &&
         srcfmt->Rmask == dstfmt->Rmask &&
         srcfmt->Gmask == dstfmt->Gmask &&
@@ -683,6 +744,9 @@ blit_blend_rgba_mul (SDL_BlitInfo * info)
         return;
     }
 
+    if (blit_blend_packed (info, PACKED_BLEND_MULT, 1))
+        return;
+
     if (srcbpp == 4 && dstbpp == 4 &&
         srcfmt->Rmask == dstfmt->Rmask &&
         srcfmt->Gmask == dstfmt->Gmask &&
@@ -871,6 +935,9 @@ blit_blend_rgba_min (SDL_BlitInfo * info)
     return;
     }
 
+    if (blit_blend_packed (info, PACKED_BLEND_MIN, 1))
+        return;
+
     if (srcbpp == 4 && dstbpp == 4 &&
         srcfmt->Rmask == dstfmt->Rmask &&
         srcfmt->Gmask == dstfmt->Gmask &&
@@ -1059,6 +1126,9 @@ blit_blend_rgba_max (SDL_BlitInfo * info)
         return;
     }
 
+    if (blit_blend_packed (info, PACKED_BLEND_MAX, 1))
+        return;
+
     if (srcbpp == 4 && dstbpp == 4 &&
         srcfmt->Rmask == dstfmt->Rmask &&
         srcfmt->Gmask == dstfmt->Gmask &&
@@ -1405,6 +1475,9 @@ blit_blend_add (SDL_BlitInfo * info)
     int             srcppa = SDL_ISPIXELFORMAT_ALPHA (srcfmt->format);
 #endif /* SDL2 */
 
+    if (blit_blend_packed (info, PACKED_BLEND_ADD, 0))
+        return;
+
 #ifndef SDL2
     if (srcbpp >= 3 && dstbpp >= 3 && !(info->src_flags & SDL_SRCALPHA))
 #else /* SDL2 */
@@ -1683,6 +1756,9 @@ blit_blend_sub (SDL_BlitInfo * info)
     int             srcppa = SDL_ISPIXELFORMAT_ALPHA (srcfmt->format);
 #endif /* SDL2 */
 
+    if (blit_blend_packed (info, PACKED_BLEND_SUB, 0))
+        return;
+
 #ifndef SDL2
     if (srcbpp >= 3 && dstbpp >= 3 && !(info->src_flags & SDL_SRCALPHA))
 #else /* SDL2 */
@@ -1961,6 +2037,9 @@ blit_blend_mul (SDL_BlitInfo * info)
     int             srcppa = SDL_ISPIXELFORMAT_ALPHA (srcfmt->format);
 #endif /* SDL2 */
 
+    if (blit_blend_packed (info, PACKED_BLEND_MULT, 0))
+        return;
+
 #ifndef SDL2
     if (srcbpp >= 3 && dstbpp >= 3 && !(info->src_flags & SDL_SRCALPHA))
 #else /* SDL2 */
@@ -2241,6 +2320,9 @@ blit_blend_min (SDL_BlitInfo * info)
     int             srcppa = SDL_ISPIXELFORMAT_ALPHA (srcfmt->format);
 #endif /* SDL2 */
 
+    if (blit_blend_packed (info, PACKED_BLEND_MIN, 0))
+        return;
+
 #ifndef SDL2
     if (srcbpp >= 3 && dstbpp >= 3 && !(info->src_flags & SDL_SRCALPHA))
 #else /* SDL2 */
@@ -2524,6 +2606,9 @@ blit_blend_max (SDL_BlitInfo * info)
     int             srcppa = SDL_ISPIXELFORMAT_ALPHA (srcfmt->format);
 #endif /* SDL2 */
 
+    if (blit_blend_packed (info, PACKED_BLEND_MAX, 0))
+        return;
+
 #ifndef SDL2
     if (srcbpp >= 3 && dstbpp >= 3 && !(info->src_flags & SDL_SRCALPHA))
 #else /* SDL2 */
@@ -2847,6 +2932,18 @@ alphablit_alpha (SDL_BlitInfo * info)
        printf ("Alpha blit with %d and %d\n", srcbpp, dstbpp);
        */
 
+    if (srcbpp == 4 && dstbpp == 4)
+    {
+        AlphaBlitLayout32 layout;
+
+        if (alphablit_alpha_32_layout (info, &layout))
+        {
+            simd_select_alphablit_alpha_32 () (src, srcskip, dst, dstskip,
+                                               width, height, &layout);
+            return;
+        }
+    }
+
     if (srcbpp == 1)
     {
         if (dstbpp == 1)
@@ -2988,6 +3085,142 @@ alphablit_alpha (SDL_BlitInfo * info)
     }
 }
 
+/* Check whether a 32 bit to 32 bit alpha blit can go through the packed
+ * pixel kernels of simd_blitters.c. That needs 8 bit channels, the alpha
+ * byte in the same place, and the same or red/blue swapped color order.
+ * The blit must also run forward, which it does unless it is an overlapping
+ * self blit.
+ */
+static int
+alphablit_alpha_32_layout (SDL_BlitInfo * info, AlphaBlitLayout32 * layout)
+{
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+    Uint32 lowshift, highshift;
+
+    if (info->s_pxskip != 4 || info->d_pxskip != 4)
+        return 0;
+    if (srcfmt->Rloss || srcfmt->Gloss || srcfmt->Bloss || srcfmt->Aloss ||
+        dstfmt->Rloss || dstfmt->Gloss || dstfmt->Bloss ||
+        ((srcfmt->Rshift | srcfmt->Gshift | srcfmt->Bshift |
+          srcfmt->Ashift) & 7))
+        return 0;
+    if (dstfmt->Amask && dstfmt->Amask != srcfmt->Amask)
+        return 0;
+    if (srcfmt->Gmask != dstfmt->Gmask)
+        return 0;
+
+    if (srcfmt->Rmask == dstfmt->Rmask && srcfmt->Bmask == dstfmt->Bmask)
+    {
+        layout->swapshift = 0;
+        layout->swaplow = 0;
+    }
+    else if (srcfmt->Rmask == dstfmt->Bmask &&
+             srcfmt->Bmask == dstfmt->Rmask)
+    {
+        lowshift = MIN (srcfmt->Rshift, srcfmt->Bshift);
+        highshift = MAX (srcfmt->Rshift, srcfmt->Bshift);
+        layout->swapshift = highshift - lowshift;
+        layout->swaplow = (Uint32) 0xff << lowshift;
+    }
+    else
+        return 0;
+
+    layout->ashift = srcfmt->Ashift;
+    layout->rgbmask = dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask;
+    layout->amask = dstfmt->Amask;
+#ifndef SDL2
+    layout->dafill =
+        (info->dst_flags & SDL_SRCALPHA && dstfmt->Amask) ? 0 : 0xff;
+#else /* SDL2 */
+    layout->dafill = dstfmt->Amask ? 0 : 0xff;
+#endif /* SDL2 */
+    return 1;
+}
+
+/* Blit with a blend operation straight on the packed pixels when source
+ * and destination share a layout the kernels in simd_blitters.c handle.
+ * Returns 0, having done nothing, for the generic code to take over.
+ * rgba is set for the BLEND_RGBA_* flags, and then only when the
+ * destination has per pixel alpha.
+ */
+static int
+blit_blend_packed (SDL_BlitInfo * info, PackedBlendOp op, int rgba)
+{
+    SDL_PixelFormat *srcfmt = info->src;
+    SDL_PixelFormat *dstfmt = info->dst;
+    BlendBlitLayout32 layout;
+    Uint32 rgbmask;
+    int srcalpha, dstppa;
+
+    if (srcfmt->BytesPerPixel != dstfmt->BytesPerPixel ||
+        info->s_pxskip != srcfmt->BytesPerPixel ||
+        info->d_pxskip != dstfmt->BytesPerPixel ||
+        srcfmt->Rmask != dstfmt->Rmask ||
+        srcfmt->Gmask != dstfmt->Gmask ||
+        srcfmt->Bmask != dstfmt->Bmask ||
+        srcfmt->Amask != dstfmt->Amask)
+        return 0;
+
+    if (srcfmt->BytesPerPixel == 2)
+    {
+        /* RGB565 or BGR565 */
+        if (op == PACKED_BLEND_MULT || srcfmt->Amask ||
+            srcfmt->Gmask != 0x07e0 ||
+            (srcfmt->Rmask | srcfmt->Bmask) != 0xf81f ||
+            (srcfmt->Rmask != 0xf800 && srcfmt->Rmask != 0x001f))
+            return 0;
+        simd_select_blend_blit_565 () (op, info->s_pixels, info->s_skip,
+                                       info->d_pixels, info->d_skip,
+                                       info->width, info->height);
+        return 1;
+    }
+
+    if (srcfmt->BytesPerPixel != 4 ||
+        srcfmt->Rloss || srcfmt->Gloss || srcfmt->Bloss ||
+        ((srcfmt->Rshift | srcfmt->Gshift | srcfmt->Bshift) & 7) ||
+        (srcfmt->Amask && (srcfmt->Aloss || (srcfmt->Ashift & 7))))
+        return 0;
+
+    rgbmask = dstfmt->Rmask | dstfmt->Gmask | dstfmt->Bmask;
+#ifndef SDL2
+    srcalpha = info->src_flags & SDL_SRCALPHA;
+    dstppa = (info->dst_flags & SDL_SRCALPHA && dstfmt->Amask);
+#else /* SDL2 */
+    srcalpha = SDL_ISPIXELFORMAT_ALPHA (srcfmt->format);
+    dstppa = SDL_ISPIXELFORMAT_ALPHA (dstfmt->format);
+#endif /* SDL2 */
+
+    if (rgba)
+    {
+        /* All four channels, as the byte loops in blit_blend_rgba_* */
+        if (!srcalpha || !srcfmt->Amask)
+            return 0;
+        layout.opmask = 0xffffffff;
+        layout.keepmask = 0;
+        layout.fill = 0;
+    }
+    else if (!srcalpha)
+    {
+        /* Only the color bytes are written */
+        layout.opmask = rgbmask;
+        layout.keepmask = ~rgbmask;
+        layout.fill = 0;
+    }
+    else
+    {
+        /* The destination alpha goes back as read, 255 if it has none */
+        layout.opmask = rgbmask;
+        layout.keepmask = dstppa ? dstfmt->Amask : 0;
+        layout.fill = dstppa ? 0 : dstfmt->Amask;
+    }
+
+    simd_select_blend_blit_32 () (op, info->s_pixels, info->s_skip,
+                                  info->d_pixels, info->d_skip,
+                                  info->width, info->height, &layout);
+    return 1;
+}
+
 static void
 alphablit_colorkey (SDL_BlitInfo * info)
 {
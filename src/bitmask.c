@@ -85,6 +85,56 @@ static INLINE unsigned int bitcount(BITMASK_W n)
   }
 }
 
+static int stripe_overlap_C(const BITMASK_W *ap, const BITMASK_W *app,
+                            const BITMASK_W *bp, int n, unsigned int shift)
+{
+  const BITMASK_W *a_end = ap + n;
+  unsigned int rshift = BITMASK_W_LEN - shift;
+
+  if (app)
+  {
+    while (ap < a_end)
+      if ((*ap++ >> shift) & *bp || (*app++ << rshift) & *bp++) return 1;
+  }
+  else
+  {
+    while (ap < a_end)
+      if ((*ap++ >> shift) & *bp++) return 1;
+  }
+  return 0;
+}
+
+static unsigned int stripe_area_C(const BITMASK_W *ap, const BITMASK_W *app,
+                                  const BITMASK_W *bp, int n,
+                                  unsigned int shift)
+{
+  const BITMASK_W *a_end = ap + n;
+  unsigned int rshift = BITMASK_W_LEN - shift;
+  unsigned int count = 0;
+
+  if (app)
+  {
+    while (ap < a_end)
+      count += bitcount(((*ap++ >> shift) | (*app++ << rshift)) & *bp++);
+  }
+  else
+  {
+    while (ap < a_end)
+      count += bitcount((*ap++ >> shift) & *bp++);
+  }
+  return count;
+}
+
+static bitmask_stripe_overlap_t stripe_overlap = stripe_overlap_C;
+static bitmask_stripe_area_t stripe_area = stripe_area_C;
+
+void bitmask_set_stripe_funcs(bitmask_stripe_overlap_t overlap,
+                              bitmask_stripe_area_t area)
+{
+  stripe_overlap = overlap ? overlap : stripe_overlap_C;
+  stripe_area = area ? area : stripe_area_C;
+}
+
 bitmask_t *bitmask_create(int w, int h)
 {
   bitmask_t *temp;
@@ -148,22 +198,16 @@ void bitmask_invert(bitmask_t *m)
 
 unsigned int bitmask_count(bitmask_t *m)
 {
-    BITMASK_W *pixels;
-    unsigned int tot = 0;
-
-    for (pixels=m->bits; pixels<(m->bits+m->h*((m->w-1)/BITMASK_W_LEN + 1)); pixels++) {
-        tot += bitcount(*pixels);
-    }
-
-    return tot;
+    /* every word anded with itself */
+    return stripe_area(m->bits, NULL, m->bits,
+                       m->h*((m->w-1)/BITMASK_W_LEN + 1), 0);
 }
 
 int bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset, int yoffset)
 {
   const BITMASK_W *a_entry,*a_end;
   const BITMASK_W *b_entry;
-  const BITMASK_W *ap,*app,*bp;
-  unsigned int shift,rshift,i,astripes,bstripes;
+  unsigned int shift,i,astripes,bstripes;
 
   if ((xoffset >= a->w) || (yoffset >= a->h) || (b->h + yoffset <= 0) || (b->w + xoffset <= 0))
     return 0;
@@ -186,29 +230,24 @@ int bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset, int yof
     shift = xoffset & BITMASK_W_MASK;
     if (shift)
     {
-      rshift = BITMASK_W_LEN - shift;
       astripes = ((unsigned int)(a->w - 1))/BITMASK_W_LEN - (unsigned int)xoffset/BITMASK_W_LEN;
       bstripes = ((unsigned int)(b->w - 1))/BITMASK_W_LEN + 1;
       if (bstripes > astripes) /* zig-zag .. zig*/
       {
         for (i=0;i<astripes;i++)
         {
-          for (ap = a_entry, app = ap + a->h, bp = b_entry;ap < a_end;)
-            if ((*ap++ >> shift) & *bp || (*app++ << rshift) & *bp++) return 1;
+          if (stripe_overlap(a_entry, a_entry + a->h, b_entry, a_end - a_entry, shift)) return 1;
           a_entry += a->h;
           a_end += a->h;
           b_entry += b->h;
         }
-          for (ap = a_entry,bp = b_entry;ap < a_end;)
-          if ((*ap++ >> shift) & *bp++) return 1;
-          return 0;
+        return stripe_overlap(a_entry, NULL, b_entry, a_end - a_entry, shift);
       }
       else /* zig-zag */
       {
         for (i=0;i<bstripes;i++)
         {
-          for (ap = a_entry, app = ap + a->h, bp = b_entry;ap < a_end;)
-            if ((*ap++ >> shift) & *bp || (*app++ << rshift) & *bp++) return 1;
+          if (stripe_overlap(a_entry, a_entry + a->h, b_entry, a_end - a_entry, shift)) return 1;
           a_entry += a->h;
           a_end += a->h;
           b_entry += b->h;
@@ -221,8 +260,7 @@ int bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset, int yof
       astripes = (MIN(b->w,a->w - xoffset) - 1)/BITMASK_W_LEN + 1;
       for (i=0;i<astripes;i++)
       {
-        for (ap = a_entry,bp = b_entry;ap < a_end;)
-          if (*ap++ & *bp++) return 1;
+        if (stripe_overlap(a_entry, NULL, b_entry, a_end - a_entry, 0)) return 1;
         a_entry += a->h;
         a_end += a->h;
         b_entry += b->h;
@@ -378,8 +416,8 @@ int bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset, int
 
 int bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset, int yoffset)
 {
-  const BITMASK_W *a_entry,*a_end, *b_entry, *ap,*bp;
-  unsigned int shift,rshift,i,astripes,bstripes;
+  const BITMASK_W *a_entry,*a_end, *b_entry;
+  unsigned int shift,i,astripes,bstripes;
   unsigned int count = 0;
 
   if ((xoffset >= a->w) || (yoffset >= a->h) || (b->h + yoffset <= 0) || (b->w + xoffset <= 0))
@@ -403,29 +441,25 @@ int bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset, in
     shift = xoffset & BITMASK_W_MASK;
     if (shift)
     {
-      rshift = BITMASK_W_LEN - shift;
       astripes = (a->w - 1)/BITMASK_W_LEN - xoffset/BITMASK_W_LEN;
       bstripes = (b->w - 1)/BITMASK_W_LEN + 1;
       if (bstripes > astripes) /* zig-zag .. zig*/
       {
         for (i=0;i<astripes;i++)
         {
-          for (ap = a_entry,bp = b_entry;ap < a_end;ap++,bp++)
-            count += bitcount(((*ap >> shift) | (*(ap + a->h) << rshift)) & *bp);
+          count += stripe_area(a_entry, a_entry + a->h, b_entry, a_end - a_entry, shift);
           a_entry += a->h;
           a_end += a->h;
           b_entry += b->h;
         }
-        for (ap = a_entry,bp = b_entry;ap < a_end;)
-          count += bitcount((*ap++ >> shift) & *bp++);
+        count += stripe_area(a_entry, NULL, b_entry, a_end - a_entry, shift);
         return count;
       }
       else /* zig-zag */
       {
         for (i=0;i<bstripes;i++)
         {
-          for (ap = a_entry,bp = b_entry;ap < a_end;ap++,bp++)
-            count += bitcount(((*ap >> shift) | (*(ap + a->h) << rshift)) & *bp);
+          count += stripe_area(a_entry, a_entry + a->h, b_entry, a_end - a_entry, shift);
           a_entry += a->h;
           a_end += a->h;
           b_entry += b->h;
@@ -438,9 +472,7 @@ int bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset, in
       astripes = (MIN(b->w,a->w - xoffset) - 1)/BITMASK_W_LEN + 1;
       for (i=0;i<astripes;i++)
       {
-        for (ap = a_entry,bp = b_entry;ap < a_end;)
-          count += bitcount(*ap++ & *bp++);
-
+        count += stripe_area(a_entry, NULL, b_entry, a_end - a_entry, 0);
         a_entry += a->h;
         a_end += a->h;
         b_entry += b->h;
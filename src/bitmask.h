@@ -139,6 +139,43 @@ bitmask_t *bitmask_scale(const bitmask_t *m, int w, int h);
  *                [yoffset ... yoffset + a->h + b->h - 1). */
 void bitmask_convolve(const bitmask_t *a, const bitmask_t *b, bitmask_t *o, int xoffset, int yoffset);
 
+/* bitmask_overlap(), bitmask_overlap_area() and bitmask_count() do their
+   work a column of words (a stripe) at a time, with the functions below.
+   Over n words, a stripe function takes ap[i] >> shift, or'ed with
+   app[i] << (BITMASK_W_LEN - shift) when app is not NULL, and ands it
+   with bp[i]. The overlap function returns nonzero if any result has a
+   bit set; the area function returns the number of bits set. app is only
+   given with a shift other than 0. */
+typedef int (*bitmask_stripe_overlap_t)(const BITMASK_W *ap,
+                                        const BITMASK_W *app,
+                                        const BITMASK_W *bp,
+                                        int n, unsigned int shift);
+typedef unsigned int (*bitmask_stripe_area_t)(const BITMASK_W *ap,
+                                              const BITMASK_W *app,
+                                              const BITMASK_W *bp,
+                                              int n, unsigned int shift);
+
+/* Replaces the stripe functions, or restores the plain C ones for NULL. */
+void bitmask_set_stripe_funcs(bitmask_stripe_overlap_t overlap,
+                              bitmask_stripe_area_t area);
+
+/* Replace row y of m with bits for the m->w 32 bit pixels of row.
+   bitmask_row_alpha sets a bit where ((pixel & amask) >> ashift) is
+   above threshold. bitmask_row_near sets a bit where every byte of the
+   pixel picked by channels is less than the same byte of threshold away
+   from the same byte of color, or of row2 when it is not NULL. With
+   invert it sets the other bits instead. */
+void bitmask_row_alpha(bitmask_t *m, int y, const unsigned int *row,
+                       unsigned int amask, int ashift, int threshold);
+void bitmask_row_near(bitmask_t *m, int y, const unsigned int *row,
+                      const unsigned int *row2, unsigned int color,
+                      unsigned int threshold, unsigned int channels,
+                      int invert);
+
+/* Sets the fastest stripe and row functions of bitmask_simd.c the CPU
+   can run, and returns the name of the instruction set, or "GENERIC". */
+const char *bitmask_simd_init(void);
+
 #ifdef __cplusplus
 } /* End of extern "C" { */
 #endif
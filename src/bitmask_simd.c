@@ -0,0 +1,559 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/* Intrinsic stripe functions of bitmask.c for SSE2, AVX2 and NEON.
+ *
+ * A stripe is a column of words, one per row of a mask, so the words of
+ * a vector are the same bits of consecutive rows and shift together. The
+ * overlap functions stop at the first vector with a bit set. The area
+ * functions count bits a byte at a time, with the SWAR sums of bitcount
+ * for SSE2, a table of nibbles for AVX2 and vcnt for NEON, and add the
+ * bytes up into 64 bit lanes. BITMASK_W is 64 bits on most systems but
+ * 32 on 64 bit Windows, so the shifts come in both sizes.
+ *
+ * The row functions build a row of a mask from 32 bit pixels for
+ * from_surface and from_threshold. They test 16 pixels at a time, narrow
+ * the lane results to bytes and take their top bits with movemask, or a
+ * weighted pairwise add on NEON, 16 bits of a mask word at once.
+ */
+
+#include <stdlib.h>
+#include "pgsimd.h"
+#include "bitmask.h"
+
+#ifdef PG_SIMD_X86
+#include <immintrin.h>
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_NEON
+#include <arm_neon.h>
+#endif /* PG_SIMD_NEON */
+
+#if ULONG_MAX > 0xffffffffUL
+#define BITMASK_W_64
+#endif
+
+/* The bits set in one word, for the words after the last vector */
+static INLINE unsigned int
+word_count (BITMASK_W w)
+{
+#ifdef BITMASK_W_64
+    return (unsigned int) (pg_popcount32 ((Uint32) w) +
+                           pg_popcount32 ((Uint32) (w >> 32)));
+#else
+    return (unsigned int) pg_popcount32 ((Uint32) w);
+#endif
+}
+
+/* The stripe words from i on, one at a time */
+#define STRIPE_TAIL(i, OP)                                              \
+    for (; i < n; i++)                                                  \
+    {                                                                   \
+        BITMASK_W w = ap[i] >> shift;                                   \
+        if (app)                                                        \
+            w |= app[i] << (BITMASK_W_LEN - shift);                     \
+        w &= bp[i];                                                     \
+        OP;                                                             \
+    }
+
+#define STRIPE_TAIL_OVERLAP(i) STRIPE_TAIL (i, if (w) return 1)
+#define STRIPE_TAIL_AREA(i, count) STRIPE_TAIL (i, count += word_count (w))
+
+typedef void (*row_alpha_t) (const unsigned int *row, int w,
+                             unsigned int amask, int ashift, int threshold,
+                             BITMASK_W *bits, int stride);
+typedef void (*row_near_t) (const unsigned int *row, const unsigned int *row2,
+                            unsigned int color, unsigned int threshold,
+                            unsigned int channels, int invert, int w,
+                            BITMASK_W *bits, int stride);
+
+static INLINE int
+alpha_test (unsigned int p, unsigned int amask, int ashift, int threshold)
+{
+    return (int) ((p & amask) >> ashift) > threshold;
+}
+
+static INLINE int
+near_test (unsigned int p, unsigned int q, unsigned int threshold,
+           unsigned int channels)
+{
+#define FAR_BYTE(i)                                                     \
+    ((abs ((int) ((p >> i) & 0xff) - (int) ((q >> i) & 0xff)) >=       \
+      (int) ((threshold >> i) & 0xff)) & (int) ((channels >> i) & 1))
+
+    return !(FAR_BYTE (0) | FAR_BYTE (8) | FAR_BYTE (16) | FAR_BYTE (24));
+#undef FAR_BYTE
+}
+
+/* Fills the words of a row of a mask, stride words apart, 16 bits at a
+   time from TEST16 (x) when VECTOR and single bits from TEST1 (x), which
+   is 0 or 1, for the rest */
+#define ROW_BODY(VECTOR, TEST16, TEST1)                                 \
+    BITMASK_W word;                                                     \
+    int x = 0, bit;                                                     \
+                                                                        \
+    for (; x < w; bits += stride)                                       \
+    {                                                                   \
+        word = 0;                                                       \
+        for (bit = 0; VECTOR && bit < (int) BITMASK_W_LEN && x + 16 <= w; \
+             bit += 16, x += 16)                                        \
+            word |= (BITMASK_W) (TEST16 (x)) << bit;                    \
+        for (; bit < (int) BITMASK_W_LEN && x < w; bit++, x++)          \
+            word |= (BITMASK_W) (TEST1 (x)) << bit;                     \
+        *bits = word;                                                   \
+    }
+
+#define ALPHA1(x) alpha_test (row[x], amask, ashift, threshold)
+#define NEAR1(x)                                                        \
+    (near_test (row[x], row2 ? row2[x] : color, threshold, channels) ^ \
+     invert)
+
+static void
+row_alpha_C (const unsigned int *row, int w, unsigned int amask, int ashift,
+             int threshold, BITMASK_W *bits, int stride)
+{
+    ROW_BODY (0, 0 *, ALPHA1)
+}
+
+static void
+row_near_C (const unsigned int *row, const unsigned int *row2,
+            unsigned int color, unsigned int threshold, unsigned int channels,
+            int invert, int w, BITMASK_W *bits, int stride)
+{
+    ROW_BODY (0, 0 *, NEAR1)
+}
+
+#ifdef PG_SIMD_X86
+#ifdef BITMASK_W_64
+#define SSE2_SRL _mm_srl_epi64
+#define SSE2_SLL _mm_sll_epi64
+#define AVX2_SRL _mm256_srl_epi64
+#define AVX2_SLL _mm256_sll_epi64
+#else
+#define SSE2_SRL _mm_srl_epi32
+#define SSE2_SLL _mm_sll_epi32
+#define AVX2_SRL _mm256_srl_epi32
+#define AVX2_SLL _mm256_sll_epi32
+#endif
+
+#define SSE2_WORDS ((int) (16 / sizeof (BITMASK_W)))
+
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_stripe (const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+             __m128i sh, __m128i rsh)
+{
+    __m128i a = SSE2_SRL (_mm_loadu_si128 ((const __m128i *) ap), sh);
+
+    if (app)
+        a = _mm_or_si128 (a, SSE2_SLL (_mm_loadu_si128 (
+                                           (const __m128i *) app), rsh));
+    return _mm_and_si128 (a, _mm_loadu_si128 ((const __m128i *) bp));
+}
+
+PG_TARGET_SSE2 int
+bitmask_stripe_overlap_SSE2 (const BITMASK_W *ap, const BITMASK_W *app,
+                             const BITMASK_W *bp, int n, unsigned int shift)
+{
+    __m128i sh = _mm_cvtsi32_si128 ((int) shift);
+    __m128i rsh = _mm_cvtsi32_si128 ((int) (BITMASK_W_LEN - shift));
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i v;
+    int i;
+
+    for (i = 0; i + SSE2_WORDS <= n; i += SSE2_WORDS)
+    {
+        v = sse2_stripe (ap + i, app ? app + i : NULL, bp + i, sh, rsh);
+        if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (v, zero)) != 0xffff)
+            return 1;
+    }
+    STRIPE_TAIL_OVERLAP (i)
+    return 0;
+}
+
+PG_TARGET_SSE2 unsigned int
+bitmask_stripe_area_SSE2 (const BITMASK_W *ap, const BITMASK_W *app,
+                          const BITMASK_W *bp, int n, unsigned int shift)
+{
+    __m128i sh = _mm_cvtsi32_si128 ((int) shift);
+    __m128i rsh = _mm_cvtsi32_si128 ((int) (BITMASK_W_LEN - shift));
+    __m128i m1 = _mm_set1_epi8 (0x55);
+    __m128i m2 = _mm_set1_epi8 (0x33);
+    __m128i m4 = _mm_set1_epi8 (0x0f);
+    __m128i sums = _mm_setzero_si128 ();
+    __m128i v;
+    unsigned int count;
+    int i;
+
+    for (i = 0; i + SSE2_WORDS <= n; i += SSE2_WORDS)
+    {
+        v = sse2_stripe (ap + i, app ? app + i : NULL, bp + i, sh, rsh);
+        v = _mm_sub_epi8 (v, _mm_and_si128 (_mm_srli_epi64 (v, 1), m1));
+        v = _mm_add_epi8 (_mm_and_si128 (v, m2),
+                          _mm_and_si128 (_mm_srli_epi64 (v, 2), m2));
+        v = _mm_and_si128 (_mm_add_epi8 (v, _mm_srli_epi64 (v, 4)), m4);
+        sums = _mm_add_epi64 (sums, _mm_sad_epu8 (v, _mm_setzero_si128 ()));
+    }
+    count = (unsigned int) (_mm_cvtsi128_si32 (sums) +
+                            _mm_cvtsi128_si32 (_mm_srli_si128 (sums, 8)));
+    STRIPE_TAIL_AREA (i, count)
+    return count;
+}
+
+#define SSE2_LOAD(p) _mm_loadu_si128 ((const __m128i *) (p))
+
+/* 16 lanes of all ones or zeros, in four vectors, to 16 bits */
+PG_TARGET_SSE2 static INLINE int
+sse2_pack16 (__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    return _mm_movemask_epi8 (_mm_packs_epi16 (_mm_packs_epi32 (a, b),
+                                               _mm_packs_epi32 (c, d)));
+}
+
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_alpha4 (const unsigned int *p, __m128i amask, __m128i sh, __m128i thr)
+{
+    return _mm_cmpgt_epi32 (
+        _mm_srl_epi32 (_mm_and_si128 (SSE2_LOAD (p), amask), sh), thr);
+}
+
+/* A byte is far when its difference is not below the threshold */
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_near4 (__m128i p, __m128i q, __m128i thr, __m128i chan)
+{
+    __m128i d = _mm_or_si128 (_mm_subs_epu8 (p, q), _mm_subs_epu8 (q, p));
+    __m128i far = _mm_and_si128 (_mm_cmpeq_epi8 (_mm_max_epu8 (d, thr), d),
+                                 chan);
+
+    return _mm_cmpeq_epi32 (far, _mm_setzero_si128 ());
+}
+
+#define ALPHA16_SSE2(x)                                                 \
+    sse2_pack16 (sse2_alpha4 (row + (x), vamask, sh, thr),             \
+                 sse2_alpha4 (row + (x) + 4, vamask, sh, thr),         \
+                 sse2_alpha4 (row + (x) + 8, vamask, sh, thr),         \
+                 sse2_alpha4 (row + (x) + 12, vamask, sh, thr))
+#define NEAR4_SSE2(x)                                                   \
+    sse2_near4 (SSE2_LOAD (row + (x)),                                  \
+                row2 ? SSE2_LOAD (row2 + (x)) : vcolor, thr, chan)
+#define NEAR16_SSE2(x)                                                  \
+    (sse2_pack16 (NEAR4_SSE2 (x), NEAR4_SSE2 ((x) + 4),                 \
+                  NEAR4_SSE2 ((x) + 8), NEAR4_SSE2 ((x) + 12)) ^ flip)
+
+PG_TARGET_SSE2 static void
+row_alpha_SSE2 (const unsigned int *row, int w, unsigned int amask,
+                int ashift, int threshold, BITMASK_W *bits, int stride)
+{
+    __m128i vamask = _mm_set1_epi32 ((int) amask);
+    __m128i sh = _mm_cvtsi32_si128 (ashift);
+    __m128i thr = _mm_set1_epi32 (threshold);
+
+    ROW_BODY (1, ALPHA16_SSE2, ALPHA1)
+}
+
+PG_TARGET_SSE2 static void
+row_near_SSE2 (const unsigned int *row, const unsigned int *row2,
+               unsigned int color, unsigned int threshold,
+               unsigned int channels, int invert, int w, BITMASK_W *bits,
+               int stride)
+{
+    __m128i vcolor = _mm_set1_epi32 ((int) color);
+    __m128i thr = _mm_set1_epi32 ((int) threshold);
+    __m128i chan = _mm_set1_epi32 ((int) channels);
+    int flip = invert ? 0xffff : 0;
+
+    ROW_BODY (1, NEAR16_SSE2, NEAR1)
+}
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+#define AVX2_WORDS ((int) (32 / sizeof (BITMASK_W)))
+
+PG_TARGET_AVX2 static INLINE __m256i
+avx2_stripe (const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+             __m128i sh, __m128i rsh)
+{
+    __m256i a = AVX2_SRL (_mm256_loadu_si256 ((const __m256i *) ap), sh);
+
+    if (app)
+        a = _mm256_or_si256 (a, AVX2_SLL (_mm256_loadu_si256 (
+                                              (const __m256i *) app), rsh));
+    return _mm256_and_si256 (a, _mm256_loadu_si256 ((const __m256i *) bp));
+}
+
+PG_TARGET_AVX2 int
+bitmask_stripe_overlap_AVX2 (const BITMASK_W *ap, const BITMASK_W *app,
+                             const BITMASK_W *bp, int n, unsigned int shift)
+{
+    __m128i sh = _mm_cvtsi32_si128 ((int) shift);
+    __m128i rsh = _mm_cvtsi32_si128 ((int) (BITMASK_W_LEN - shift));
+    __m256i v;
+    int i;
+
+    for (i = 0; i + AVX2_WORDS <= n; i += AVX2_WORDS)
+    {
+        v = avx2_stripe (ap + i, app ? app + i : NULL, bp + i, sh, rsh);
+        if (!_mm256_testz_si256 (v, v))
+            return 1;
+    }
+    STRIPE_TAIL_OVERLAP (i)
+    return 0;
+}
+
+PG_TARGET_AVX2 unsigned int
+bitmask_stripe_area_AVX2 (const BITMASK_W *ap, const BITMASK_W *app,
+                          const BITMASK_W *bp, int n, unsigned int shift)
+{
+    __m128i sh = _mm_cvtsi32_si128 ((int) shift);
+    __m128i rsh = _mm_cvtsi32_si128 ((int) (BITMASK_W_LEN - shift));
+    __m256i nibbles = _mm256_setr_epi8 (0, 1, 1, 2, 1, 2, 2, 3,
+                                        1, 2, 2, 3, 2, 3, 3, 4,
+                                        0, 1, 1, 2, 1, 2, 2, 3,
+                                        1, 2, 2, 3, 2, 3, 3, 4);
+    __m256i m4 = _mm256_set1_epi8 (0x0f);
+    __m256i sums = _mm256_setzero_si256 ();
+    __m256i v;
+    __m128i half;
+    unsigned int count;
+    int i;
+
+    for (i = 0; i + AVX2_WORDS <= n; i += AVX2_WORDS)
+    {
+        v = avx2_stripe (ap + i, app ? app + i : NULL, bp + i, sh, rsh);
+        v = _mm256_add_epi8 (
+            _mm256_shuffle_epi8 (nibbles, _mm256_and_si256 (v, m4)),
+            _mm256_shuffle_epi8 (nibbles, _mm256_and_si256 (
+                                     _mm256_srli_epi16 (v, 4), m4)));
+        sums = _mm256_add_epi64 (sums, _mm256_sad_epu8 (
+                                     v, _mm256_setzero_si256 ()));
+    }
+    half = _mm_add_epi64 (_mm256_castsi256_si128 (sums),
+                          _mm256_extracti128_si256 (sums, 1));
+    count = (unsigned int) (_mm_cvtsi128_si32 (half) +
+                            _mm_cvtsi128_si32 (_mm_srli_si128 (half, 8)));
+    STRIPE_TAIL_AREA (i, count)
+    return count;
+}
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+#define NEON_WORDS ((int) (16 / sizeof (BITMASK_W)))
+
+#ifdef BITMASK_W_64
+#define NEON_LOAD(p) vreinterpretq_u8_u64 (vld1q_u64 ((const uint64_t *) (p)))
+#define NEON_SHIFT(v, s)                                                \
+    vreinterpretq_u8_u64 (vshlq_u64 (vreinterpretq_u64_u8 (v),         \
+                                     vdupq_n_s64 (s)))
+#else
+#define NEON_LOAD(p) vreinterpretq_u8_u32 (vld1q_u32 ((const uint32_t *) (p)))
+#define NEON_SHIFT(v, s)                                                \
+    vreinterpretq_u8_u32 (vshlq_u32 (vreinterpretq_u32_u8 (v),         \
+                                     vdupq_n_s32 (s)))
+#endif
+
+/* vshl shifts right for a negative count */
+static INLINE uint8x16_t
+neon_stripe (const BITMASK_W *ap, const BITMASK_W *app, const BITMASK_W *bp,
+             unsigned int shift)
+{
+    uint8x16_t a = NEON_SHIFT (NEON_LOAD (ap), -(int) shift);
+
+    if (app)
+        a = vorrq_u8 (a, NEON_SHIFT (NEON_LOAD (app),
+                                     (int) (BITMASK_W_LEN - shift)));
+    return vandq_u8 (a, NEON_LOAD (bp));
+}
+
+int
+bitmask_stripe_overlap_NEON (const BITMASK_W *ap, const BITMASK_W *app,
+                             const BITMASK_W *bp, int n, unsigned int shift)
+{
+    uint64x2_t v;
+    int i;
+
+    for (i = 0; i + NEON_WORDS <= n; i += NEON_WORDS)
+    {
+        v = vreinterpretq_u64_u8 (neon_stripe (ap + i, app ? app + i : NULL,
+                                               bp + i, shift));
+        if (vgetq_lane_u64 (v, 0) | vgetq_lane_u64 (v, 1))
+            return 1;
+    }
+    STRIPE_TAIL_OVERLAP (i)
+    return 0;
+}
+
+unsigned int
+bitmask_stripe_area_NEON (const BITMASK_W *ap, const BITMASK_W *app,
+                          const BITMASK_W *bp, int n, unsigned int shift)
+{
+    uint64x2_t sums = vdupq_n_u64 (0);
+    uint8x16_t v;
+    unsigned int count;
+    int i;
+
+    for (i = 0; i + NEON_WORDS <= n; i += NEON_WORDS)
+    {
+        v = neon_stripe (ap + i, app ? app + i : NULL, bp + i, shift);
+        sums = vpadalq_u32 (sums, vpaddlq_u16 (vpaddlq_u8 (vcntq_u8 (v))));
+    }
+    count = (unsigned int) (vgetq_lane_u64 (sums, 0) +
+                            vgetq_lane_u64 (sums, 1));
+    STRIPE_TAIL_AREA (i, count)
+    return count;
+}
+/* 16 lanes of all ones or zeros, in four vectors, to 16 bits. The bytes
+   are weighted by their bit and added up pairwise. */
+static INLINE int
+neon_pack16 (uint32x4_t a, uint32x4_t b, uint32x4_t c, uint32x4_t d)
+{
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                        1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t m = vcombine_u8 (
+        vmovn_u16 (vcombine_u16 (vmovn_u32 (a), vmovn_u32 (b))),
+        vmovn_u16 (vcombine_u16 (vmovn_u32 (c), vmovn_u32 (d))));
+    uint8x8_t t;
+
+    m = vandq_u8 (m, vld1q_u8 (weights));
+    t = vpadd_u8 (vget_low_u8 (m), vget_high_u8 (m));
+    t = vpadd_u8 (t, t);
+    t = vpadd_u8 (t, t);
+    return vget_lane_u8 (t, 0) | (vget_lane_u8 (t, 1) << 8);
+}
+
+static INLINE uint32x4_t
+neon_alpha4 (const unsigned int *p, uint32x4_t amask, int32x4_t sh,
+             int32x4_t thr)
+{
+    uint32x4_t a = vshlq_u32 (vandq_u32 (vld1q_u32 ((const uint32_t *) p),
+                                         amask), sh);
+
+    return vcgtq_s32 (vreinterpretq_s32_u32 (a), thr);
+}
+
+static INLINE uint32x4_t
+neon_near4 (uint8x16_t p, uint8x16_t q, uint8x16_t thr, uint8x16_t chan)
+{
+    uint8x16_t far = vandq_u8 (vcgeq_u8 (vabdq_u8 (p, q), thr), chan);
+
+    return vceqq_u32 (vreinterpretq_u32_u8 (far), vdupq_n_u32 (0));
+}
+
+#define NEON_LOADPX(p) vld1q_u8 ((const uint8_t *) (p))
+#define ALPHA16_NEON(x)                                                 \
+    neon_pack16 (neon_alpha4 (row + (x), vamask, sh, thr),             \
+                 neon_alpha4 (row + (x) + 4, vamask, sh, thr),         \
+                 neon_alpha4 (row + (x) + 8, vamask, sh, thr),         \
+                 neon_alpha4 (row + (x) + 12, vamask, sh, thr))
+#define NEAR4_NEON(x)                                                   \
+    neon_near4 (NEON_LOADPX (row + (x)),                                \
+                row2 ? NEON_LOADPX (row2 + (x)) : vcolor, thr, chan)
+#define NEAR16_NEON(x)                                                  \
+    (neon_pack16 (NEAR4_NEON (x), NEAR4_NEON ((x) + 4),                 \
+                  NEAR4_NEON ((x) + 8), NEAR4_NEON ((x) + 12)) ^ flip)
+
+static void
+row_alpha_NEON (const unsigned int *row, int w, unsigned int amask,
+                int ashift, int threshold, BITMASK_W *bits, int stride)
+{
+    uint32x4_t vamask = vdupq_n_u32 (amask);
+    int32x4_t sh = vdupq_n_s32 (-ashift);
+    int32x4_t thr = vdupq_n_s32 (threshold);
+
+    ROW_BODY (1, ALPHA16_NEON, ALPHA1)
+}
+
+static void
+row_near_NEON (const unsigned int *row, const unsigned int *row2,
+               unsigned int color, unsigned int threshold,
+               unsigned int channels, int invert, int w, BITMASK_W *bits,
+               int stride)
+{
+    uint8x16_t vcolor = vreinterpretq_u8_u32 (vdupq_n_u32 (color));
+    uint8x16_t thr = vreinterpretq_u8_u32 (vdupq_n_u32 (threshold));
+    uint8x16_t chan = vreinterpretq_u8_u32 (vdupq_n_u32 (channels));
+    int flip = invert ? 0xffff : 0;
+
+    ROW_BODY (1, NEAR16_NEON, NEAR1)
+}
+#endif /* PG_SIMD_NEON */
+
+static row_alpha_t row_alpha = row_alpha_C;
+static row_near_t row_near = row_near_C;
+
+void
+bitmask_row_alpha (bitmask_t *m, int y, const unsigned int *row,
+                   unsigned int amask, int ashift, int threshold)
+{
+    row_alpha (row, m->w, amask, ashift, threshold, m->bits + y, m->h);
+}
+
+void
+bitmask_row_near (bitmask_t *m, int y, const unsigned int *row,
+                  const unsigned int *row2, unsigned int color,
+                  unsigned int threshold, unsigned int channels, int invert)
+{
+    row_near (row, row2, color, threshold, channels, !!invert, m->w,
+              m->bits + y, m->h);
+}
+
+const char *
+bitmask_simd_init (void)
+{
+#if defined(PG_SIMD_X86)
+    if (SDL_HasSSE2 ())
+    {
+        row_alpha = row_alpha_SSE2;
+        row_near = row_near_SSE2;
+    }
+#endif
+#if defined(PG_SIMD_NEON)
+    if (SDL_HasNEON ())
+    {
+        row_alpha = row_alpha_NEON;
+        row_near = row_near_NEON;
+    }
+#endif
+#if defined(PG_SIMD_AVX2)
+    if (SDL_HasAVX2 ())
+    {
+        bitmask_set_stripe_funcs (bitmask_stripe_overlap_AVX2,
+                                  bitmask_stripe_area_AVX2);
+        return "AVX2";
+    }
+#endif
+#if defined(PG_SIMD_X86)
+    if (SDL_HasSSE2 ())
+    {
+        bitmask_set_stripe_funcs (bitmask_stripe_overlap_SSE2,
+                                  bitmask_stripe_area_SSE2);
+        return "SSE2";
+    }
+#endif
+#if defined(PG_SIMD_NEON)
+    if (SDL_HasNEON ())
+    {
+        bitmask_set_stripe_funcs (bitmask_stripe_overlap_NEON,
+                                  bitmask_stripe_area_NEON);
+        return "NEON";
+    }
+#endif
+    bitmask_set_stripe_funcs (NULL, NULL);
+    return "GENERIC";
+}
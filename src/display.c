@@ -475,6 +475,27 @@ pg_get_driver (PyObject* self)
 #endif
 }
 
+/*the display Surface object, or NULL; a borrowed reference*/
+static PyObject*
+pg_display_surface (void)
+{
+#ifdef SDL2
+    return Py_GetDefaultWindowSurface ();
+#else
+    return pgDisplaySurfaceObject;
+#endif
+}
+
+/*forget changes already pushed by a full update*/
+static void
+pg_clear_dirty (void)
+{
+    PyObject* surfobj = pg_display_surface ();
+
+    if (surfobj && ((PySurfaceObject*) surfobj)->dirty)
+        ((PySurfaceObject*) surfobj)->dirty->count = 0;
+}
+
 static PyObject*
 pg_get_surface (PyObject* self)
 {
@@ -758,6 +779,7 @@ pg_set_mode (PyObject* self, PyObject* arg)
         SDL_SetWindowIcon (win, PySurface_AsSurface (state->icon));
 #endif /* SDL2 */
 #endif
+    pg_clear_dirty ();
 #ifndef SDL2
     Py_INCREF (pgDisplaySurfaceObject);
     return pgDisplaySurfaceObject;
@@ -859,6 +881,7 @@ pg_flip (PyObject* self)
 
     if (status == -1)
         return RAISE (PyExc_SDLError, SDL_GetError ());
+    pg_clear_dirty ();
     Py_RETURN_NONE;
 #else
     SDL_Surface* screen;
@@ -879,6 +902,7 @@ pg_flip (PyObject* self)
 
     if (status == -1)
         return RAISE(PyExc_SDLError, SDL_GetError());
+    pg_clear_dirty ();
     Py_RETURN_NONE;
 #endif
 }
@@ -938,6 +962,7 @@ pg_update (PyObject* self, PyObject* arg)
 #else
         SDL_UpdateRect(screen, 0, 0, 0, 0);
 #endif
+        pg_clear_dirty ();
 
         Py_RETURN_NONE;
     } else {
@@ -1028,6 +1053,96 @@ pg_update (PyObject* self, PyObject* arg)
     Py_RETURN_NONE;
 }
 
+static PyObject*
+pg_set_dirty_tracking (PyObject* self, PyObject* args)
+{
+    PyObject* surfobj;
+    PySurfaceObject* surface;
+    int enabled = 1;
+
+    if (!PyArg_ParseTuple (args, "|i", &enabled))
+        return NULL;
+
+    VIDEO_INIT_CHECK ();
+
+    surfobj = pg_display_surface ();
+    if (!surfobj)
+        return RAISE (PyExc_SDLError, "Display mode not set");
+    surface = (PySurfaceObject*) surfobj;
+
+    if (enabled && !surface->dirty) {
+        surface->dirty = PyMem_New (struct DirtyRegion_Data, 1);
+        if (!surface->dirty)
+            return PyErr_NoMemory ();
+        surface->dirty->count = 0;
+    }
+    else if (!enabled && surface->dirty) {
+        PyMem_Del (surface->dirty);
+        surface->dirty = NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+pg_update_dirty (PyObject* self)
+{
+#ifdef SDL2
+    SDL_Window* win = Py_GetDefaultWindow ();
+#else
+    SDL_Surface* screen;
+#endif
+    SDL_Rect rects[PG_DIRTY_MAXRECTS];
+    struct DirtyRegion_Data* dirty;
+    PyObject *surfobj, *list, *rect;
+    int loop, count;
+
+    VIDEO_INIT_CHECK ();
+
+#ifdef SDL2
+    if (!win)
+        return RAISE (PyExc_SDLError, "Display mode not set");
+    if (SDL_GetWindowFlags (win) & SDL_WINDOW_OPENGL)
+        return RAISE (PyExc_SDLError, "Cannot update an OPENGL display");
+#else
+    screen = SDL_GetVideoSurface ();
+    if (!screen)
+        return RAISE (PyExc_SDLError, SDL_GetError ());
+    if (screen->flags & SDL_OPENGL)
+        return RAISE (PyExc_SDLError, "Cannot update an OPENGL display");
+#endif
+
+    surfobj = pg_display_surface ();
+    if (!surfobj || !((PySurfaceObject*) surfobj)->dirty)
+        return RAISE (PyExc_SDLError, "Dirty tracking is not enabled");
+    dirty = ((PySurfaceObject*) surfobj)->dirty;
+
+    count = dirty->count;
+    list = PyList_New (count);
+    if (!list)
+        return NULL;
+    for (loop = 0; loop < count; ++loop) {
+        rects[loop] = dirty->rects[loop];
+        rect = PyRect_New (rects + loop);
+        if (!rect) {
+            Py_DECREF (list);
+            return NULL;
+        }
+        PyList_SET_ITEM (list, loop, rect);
+    }
+    dirty->count = 0;
+
+    if (count) {
+        Py_BEGIN_ALLOW_THREADS;
+#ifndef SDL2
+        SDL_UpdateRects (screen, count, rects);
+#else /* SDL2 */
+        SDL_UpdateWindowSurfaceRects (win, rects, count);
+#endif /* SDL2 */
+        Py_END_ALLOW_THREADS;
+    }
+    return list;
+}
+
 static PyObject*
 pg_set_palette (PyObject* self, PyObject* args)
 {
@@ -1494,6 +1609,10 @@ static PyMethodDef _pg_display_methods[] =
 
     { "flip", (PyCFunction) pg_flip, METH_NOARGS, DOC_PYGAMEDISPLAYFLIP },
     { "update", pg_update, METH_VARARGS, DOC_PYGAMEDISPLAYUPDATE },
+    { "set_dirty_tracking", pg_set_dirty_tracking, METH_VARARGS,
+      DOC_PYGAMEDISPLAYSETDIRTYTRACKING },
+    { "update_dirty", (PyCFunction) pg_update_dirty, METH_NOARGS,
+      DOC_PYGAMEDISPLAYUPDATEDIRTY },
 
     { "set_palette", pg_set_palette, METH_VARARGS, DOC_PYGAMEDISPLAYSETPALETTE },
     { "set_gamma", pg_set_gamma, METH_VARARGS, DOC_PYGAMEDISPLAYSETGAMMA },
@@ -47,6 +47,9 @@
 
 #define DOC_PYGAMEDISPLAYSETPALETTE "set_palette(palette=None) -> None\nSet the display color palette for indexed displays"
 
+#define DOC_PYGAMEDISPLAYSETDIRTYTRACKING "set_dirty_tracking(enabled=True) -> None\nRecord the areas of the display Surface that are drawn to"
+
+#define DOC_PYGAMEDISPLAYUPDATEDIRTY "update_dirty() -> Rect_list\nUpdate only the areas of the screen drawn to since the last update"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -149,4 +152,12 @@ pygame.display.set_palette
  set_palette(palette=None) -> None
 Set the display color palette for indexed displays
 
+pygame.display.set_dirty_tracking
+ set_dirty_tracking(enabled=True) -> None
+Record the areas of the display Surface that are drawn to
+
+pygame.display.update_dirty
+ update_dirty() -> Rect_list
+Update only the areas of the screen drawn to since the last update
+
 */
\ No newline at end of file
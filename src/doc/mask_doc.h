@@ -43,10 +43,23 @@
 
 #define DOC_MASKCONNECTEDCOMPONENT "connected_component((x,y) = None) -> Mask\nReturns a mask of a connected region of pixels."
 
-#define DOC_MASKCONNECTEDCOMPONENTS "connected_components(min = 0) -> [Masks]\nReturns a list of masks of connected regions of pixels."
+#define DOC_MASKCONNECTEDCOMPONENTS "connected_components(min = 0, crop = False) -> [Masks]\nReturns a list of masks of connected regions of pixels."
 
 #define DOC_MASKGETBOUNDINGRECTS "get_bounding_rects() -> Rects\nReturns a list of bounding rects of regions of set pixels."
 
+#define DOC_PYGAMEMASKMASKWORLD "MaskWorld() -> MaskWorld\npygame object finding the colliding pairs among many masks"
+
+#define DOC_MASKWORLDADD "add(mask, (x, y)) -> id\nadd a mask at a position"
+
+#define DOC_MASKWORLDMOVE "move(id, (x, y)) -> None\nmove an added mask"
+
+#define DOC_MASKWORLDREMOVE "remove(id) -> None\ntake a mask out of the world"
+
+#define DOC_MASKWORLDQUERYPAIRS "query_pairs() -> [(id1, id2, (x, y)), ...]\nfind all pairs of overlapping masks"
+
+#define DOC_MASKOVERLAPMANY "overlap_many([(othermask, offset), ...]) -> [index, ...]\nReturns the indices of the masks that overlap this one"
+
+#define DOC_MASKOVERLAPAREAMANY "overlap_area_many([(othermask, offset), ...]) -> [numpixels, ...]\nReturns the overlapping area with each of many masks"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -141,11 +154,39 @@ pygame.mask.Mask.connected_component
 Returns a mask of a connected region of pixels.
 
 pygame.mask.Mask.connected_components
- connected_components(min = 0) -> [Masks]
+ connected_components(min = 0, crop = False) -> [Masks]
 Returns a list of masks of connected regions of pixels.
 
 pygame.mask.Mask.get_bounding_rects
  get_bounding_rects() -> Rects
 Returns a list of bounding rects of regions of set pixels.
 
+pygame.mask.MaskWorld
+ MaskWorld() -> MaskWorld
+pygame object finding the colliding pairs among many masks
+
+pygame.mask.MaskWorld.add
+ add(mask, (x, y)) -> id
+add a mask at a position
+
+pygame.mask.MaskWorld.move
+ move(id, (x, y)) -> None
+move an added mask
+
+pygame.mask.MaskWorld.remove
+ remove(id) -> None
+take a mask out of the world
+
+pygame.mask.MaskWorld.query_pairs
+ query_pairs() -> [(id1, id2, (x, y)), ...]
+find all pairs of overlapping masks
+
+pygame.mask.Mask.overlap_many
+ overlap_many([(othermask, offset), ...]) -> [index, ...]
+Returns the indices of the masks that overlap this one
+
+pygame.mask.Mask.overlap_area_many
+ overlap_area_many([(othermask, offset), ...]) -> [numpixels, ...]
+Returns the overlapping area with each of many masks
+
 */
\ No newline at end of file
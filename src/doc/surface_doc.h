@@ -3,6 +3,10 @@
 
 #define DOC_SURFACEBLIT "blit(source, dest, area=None, special_flags = 0) -> Rect\ndraw one image onto another"
 
+#define DOC_SURFACEBLITS "blits(blit_sequence=((source, dest), ...), doreturn=1) -> [Rect, ...] or None\nblits(((source, dest, area), ...)) -> [Rect, ...]\nblits(((source, dest, area, special_flags), ...)) -> [Rect, ...]\ndraw many images onto another"
+
+#define DOC_SURFACEBLITTRANSFORMED "blit_transformed(source, center, angle=0, scale=1.0, smooth=False) -> Rect\ndraw a rotated and scaled image onto another"
+
 #define DOC_SURFACECONVERT "convert(Surface) -> Surface\nconvert(depth, flags=0) -> Surface\nconvert(masks, flags=0) -> Surface\nconvert() -> Surface\nchange the pixel format of an image"
 
 #define DOC_SURFACECONVERTALPHA "convert_alpha(Surface) -> Surface\nconvert_alpha() -> Surface\nchange the pixel format of an image including per pixel alphas"
@@ -89,7 +93,7 @@
 
 #define DOC_SURFACEGETLOSSES "get_losses() -> (R, G, B, A)\nthe significant bits used to convert between a color and a mapped integer"
 
-#define DOC_SURFACEGETBOUNDINGRECT "get_bounding_rect(min_alpha = 1) -> Rect\nfind the smallest rect containing data"
+#define DOC_SURFACEGETBOUNDINGRECT "get_bounding_rect(min_alpha = 1, cache = False) -> Rect\nfind the smallest rect containing data"
 
 #define DOC_SURFACEGETVIEW "get_view(<kind>='2') -> BufferProxy\nreturn a buffer view of the Surface's pixels."
 
@@ -97,6 +101,23 @@
 
 #define DOC_SURFACEPIXELSADDRESS "_pixels_address -> int\npixel buffer address"
 
+#define DOC_PYGAMESURFACESETPARALLELISM "set_parallelism(n=0, min_pixels=65536) -> None\nsplit large software blits and fills across threads"
+
+#define DOC_PYGAMESURFACEGETPARALLELISM "get_parallelism() -> (n, min_pixels)\nget the thread count and size threshold for software blits"
+
+#define DOC_PYGAMESURFACESETBLITSTATS "set_blit_stats(enabled) -> None\nturn blit counting on or off"
+
+#define DOC_PYGAMESURFACEGETBLITSTATS "get_blit_stats() -> dict\nget blit counts by blitter, pixel sizes and special flags"
+
+#define DOC_PYGAMESURFACERESETBLITSTATS "reset_blit_stats() -> None\nclear the blit counters"
+
+#define DOC_PYGAMESURFACESETPOOLLIMIT "set_pool_limit(nbytes) -> None\nlimit the memory kept for reuse by new surfaces"
+
+#define DOC_PYGAMESURFACEGETPOOLSTATS "get_pool_stats() -> dict\nget counters for the surface pixel pool"
+
+#define DOC_PYGAMESURFACEGETSIMDBACKEND "get_simd_backend() -> str\nget the SIMD instruction set used by blits: 'GENERIC', 'SSE2', 'AVX2' or 'NEON'"
+
+#define DOC_PYGAMESURFACESETSIMDBACKEND "set_simd_backend(type) -> None\nlimit the SIMD instruction set used by blits to one of: 'GENERIC', 'SSE2', 'AVX2' or 'NEON'"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -112,6 +133,16 @@ pygame.Surface.blit
  blit(source, dest, area=None, special_flags = 0) -> Rect
 draw one image onto another
 
+pygame.Surface.blits
+ blits(blit_sequence=((source, dest), ...), doreturn=1) -> [Rect, ...] or None
+ blits(((source, dest, area), ...)) -> [Rect, ...]
+ blits(((source, dest, area, special_flags), ...)) -> [Rect, ...]
+draw many images onto another
+
+pygame.Surface.blit_transformed
+ blit_transformed(source, center, angle=0, scale=1.0, smooth=False) -> Rect
+draw a rotated and scaled image onto another
+
 pygame.Surface.convert
  convert(Surface) -> Surface
  convert(depth, flags=0) -> Surface
@@ -292,7 +323,7 @@ pygame.Surface.get_losses
 the significant bits used to convert between a color and a mapped integer
 
 pygame.Surface.get_bounding_rect
- get_bounding_rect(min_alpha = 1) -> Rect
+ get_bounding_rect(min_alpha = 1, cache = False) -> Rect
 find the smallest rect containing data
 
 pygame.Surface.get_view
@@ -307,4 +338,40 @@ pygame.Surface._pixels_address
  _pixels_address -> int
 pixel buffer address
 
+pygame.surface.set_parallelism
+ set_parallelism(n=0, min_pixels=65536) -> None
+split large software blits and fills across threads
+
+pygame.surface.get_parallelism
+ get_parallelism() -> (n, min_pixels)
+get the thread count and size threshold for software blits
+
+pygame.surface.set_blit_stats
+ set_blit_stats(enabled) -> None
+turn blit counting on or off
+
+pygame.surface.get_blit_stats
+ get_blit_stats() -> dict
+get blit counts by blitter, pixel sizes and special flags
+
+pygame.surface.reset_blit_stats
+ reset_blit_stats() -> None
+clear the blit counters
+
+pygame.surface.set_pool_limit
+ set_pool_limit(nbytes) -> None
+limit the memory kept for reuse by new surfaces
+
+pygame.surface.get_pool_stats
+ get_pool_stats() -> dict
+get counters for the surface pixel pool
+
+pygame.surface.get_simd_backend
+ get_simd_backend() -> str
+get the SIMD instruction set used by blits: 'GENERIC', 'SSE2', 'AVX2' or 'NEON'
+
+pygame.surface.set_simd_backend
+ set_simd_backend(type) -> None
+limit the SIMD instruction set used by blits to one of: 'GENERIC', 'SSE2', 'AVX2' or 'NEON'
+
 */
\ No newline at end of file
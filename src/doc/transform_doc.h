@@ -5,7 +5,7 @@
 
 #define DOC_PYGAMETRANSFORMSCALE "scale(Surface, (width, height), DestSurface = None) -> Surface\nresize to new resolution"
 
-#define DOC_PYGAMETRANSFORMROTATE "rotate(Surface, angle) -> Surface\nrotate an image"
+#define DOC_PYGAMETRANSFORMROTATE "rotate(Surface, angle, smooth=False) -> Surface\nrotate an image"
 
 #define DOC_PYGAMETRANSFORMROTOZOOM "rotozoom(Surface, angle, scale) -> Surface\nfiltered scale and rotation"
 
@@ -13,11 +13,11 @@
 
 #define DOC_PYGAMETRANSFORMSMOOTHSCALE "smoothscale(Surface, (width, height), DestSurface = None) -> Surface\nscale a surface to an arbitrary size smoothly"
 
-#define DOC_PYGAMETRANSFORMGETSMOOTHSCALEBACKEND "get_smoothscale_backend() -> String\nreturn smoothscale filter version in use: 'GENERIC', 'MMX', or 'SSE'"
+#define DOC_PYGAMETRANSFORMGETSMOOTHSCALEBACKEND "get_smoothscale_backend() -> String\nreturn smoothscale filter version in use: 'GENERIC', 'MMX', 'SSE', 'SSE2', 'AVX2' or 'NEON'"
 
-#define DOC_PYGAMETRANSFORMSETSMOOTHSCALEBACKEND "set_smoothscale_backend(type) -> None\nset smoothscale filter version to one of: 'GENERIC', 'MMX', or 'SSE'"
+#define DOC_PYGAMETRANSFORMSETSMOOTHSCALEBACKEND "set_smoothscale_backend(type) -> None\nset smoothscale filter version to one of: 'GENERIC', 'MMX', 'SSE', 'SSE2', 'AVX2' or 'NEON'"
 
-#define DOC_PYGAMETRANSFORMCHOP "chop(Surface, rect) -> Surface\ngets a copy of an image with an interior area removed"
+#define DOC_PYGAMETRANSFORMCHOP "chop(Surface, rect, view=False) -> Surface\ngets a copy of an image with an interior area removed"
 
 #define DOC_PYGAMETRANSFORMLAPLACIAN "laplacian(Surface, DestSurface = None) -> Surface\nfind edges in a surface"
 
@@ -27,6 +27,49 @@
 
 #define DOC_PYGAMETRANSFORMTHRESHOLD "threshold(DestSurface, Surface, color, threshold = (0,0,0,0), diff_color = (0,0,0,0), change_return = 1, Surface = None, inverse = False) -> num_threshold_pixels\nfinds which, and how many pixels in a surface are within a threshold of a color."
 
+#define DOC_PYGAMETRANSFORMBUILDPYRAMID "build_pyramid(Surface, levels) -> list\nmake successively halved copies of a surface"
+
+#define DOC_PYGAMETRANSFORMPYRAMIDSCALE "pyramid_scale(pyramid, (width, height), DestSurface = None) -> Surface\nscale smoothly from the nearest level of a pyramid"
+
+#define DOC_PYGAMETRANSFORMROTATIONCACHE "RotationCache(Surface, step, budget=16777216) -> RotationCache\npygame object keeping the rotations of a surface"
+
+#define DOC_ROTATIONCACHEGET "get(angle) -> Surface\nget the rotation at the nearest step to an angle"
+
+#define DOC_ROTATIONCACHECLEAR "clear() -> None\ndrop all kept rotations"
+
+#define DOC_ROTATIONCACHESETBUDGET "set_budget(nbytes) -> None\nset the most bytes of rotations to keep"
+
+#define DOC_ROTATIONCACHEGETSTATS "get_stats() -> dict\nget counters for the cache"
+
+#define DOC_PYGAMETRANSFORMINTEGRALIMAGE "IntegralImage(Surface) -> IntegralImage\npygame object for fast sums and averages over rects of a surface"
+
+#define DOC_INTEGRALIMAGESUM "sum() -> (r, g, b, a)\nsum(Rect) -> (r, g, b, a)\nget the channel sums over a rect"
+
+#define DOC_INTEGRALIMAGEAVERAGE "average() -> (r, g, b, a)\naverage(Rect) -> (r, g, b, a)\nget the average color over a rect"
+
+#define DOC_INTEGRALIMAGESUMMANY "sum_many(rects) -> list\nget the channel sums over many rects"
+
+#define DOC_INTEGRALIMAGEAVERAGEMANY "average_many(rects) -> list\nget the average colors over many rects"
+
+#define DOC_INTEGRALIMAGEGETSIZE "get_size() -> (width, height)\nget the size of the surface the image was made from"
+
+#define DOC_PYGAMETRANSFORMACCUMULATOR "Accumulator((width, height), window=0, alpha=0.0) -> Accumulator\npygame object averaging a stream of surfaces"
+
+#define DOC_ACCUMULATORADD "add(Surface) -> None\nadd a surface to the average"
+
+#define DOC_ACCUMULATORREMOVE "remove(Surface) -> None\ntake an added surface out of the average"
+
+#define DOC_ACCUMULATORTOSURFACE "to_surface(DestSurface = None) -> Surface\nget the average as a surface"
+
+#define DOC_ACCUMULATORCLEAR "clear() -> None\nforget all added surfaces"
+
+#define DOC_ACCUMULATORGETCOUNT "get_count() -> int\nget the number of surfaces in the average"
+
+#define DOC_PYGAMETRANSFORMBOXBLUR "box_blur(Surface, radius, DestSurface = None) -> Surface\nblur a surface with a box filter"
+
+#define DOC_PYGAMETRANSFORMGAUSSIANBLUR "gaussian_blur(Surface, sigma, DestSurface = None) -> Surface\nblur a surface with an approximate gaussian"
+
+#define DOC_PYGAMETRANSFORMFLIPIP "flip_ip(Surface, xbool, ybool) -> None\nflip a surface in place"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -45,7 +88,7 @@ pygame.transform.scale
 resize to new resolution
 
 pygame.transform.rotate
- rotate(Surface, angle) -> Surface
+ rotate(Surface, angle, smooth=False) -> Surface
 rotate an image
 
 pygame.transform.rotozoom
@@ -62,14 +105,14 @@ scale a surface to an arbitrary size smoothly
 
 pygame.transform.get_smoothscale_backend
  get_smoothscale_backend() -> String
-return smoothscale filter version in use: 'GENERIC', 'MMX', or 'SSE'
+return smoothscale filter version in use: 'GENERIC', 'MMX', 'SSE', 'SSE2', 'AVX2' or 'NEON'
 
 pygame.transform.set_smoothscale_backend
  set_smoothscale_backend(type) -> None
-set smoothscale filter version to one of: 'GENERIC', 'MMX', or 'SSE'
+set smoothscale filter version to one of: 'GENERIC', 'MMX', 'SSE', 'SSE2', 'AVX2' or 'NEON'
 
 pygame.transform.chop
- chop(Surface, rect) -> Surface
+ chop(Surface, rect, view=False) -> Surface
 gets a copy of an image with an interior area removed
 
 pygame.transform.laplacian
@@ -88,4 +131,94 @@ pygame.transform.threshold
  threshold(DestSurface, Surface, color, threshold = (0,0,0,0), diff_color = (0,0,0,0), change_return = 1, Surface = None, inverse = False) -> num_threshold_pixels
 finds which, and how many pixels in a surface are within a threshold of a color.
 
+pygame.transform.build_pyramid
+ build_pyramid(Surface, levels) -> list
+make successively halved copies of a surface
+
+pygame.transform.pyramid_scale
+ pyramid_scale(pyramid, (width, height), DestSurface = None) -> Surface
+scale smoothly from the nearest level of a pyramid
+
+pygame.transform.RotationCache
+ RotationCache(Surface, step, budget=16777216) -> RotationCache
+pygame object keeping the rotations of a surface
+
+pygame.transform.RotationCache.get
+ get(angle) -> Surface
+get the rotation at the nearest step to an angle
+
+pygame.transform.RotationCache.clear
+ clear() -> None
+drop all kept rotations
+
+pygame.transform.RotationCache.set_budget
+ set_budget(nbytes) -> None
+set the most bytes of rotations to keep
+
+pygame.transform.RotationCache.get_stats
+ get_stats() -> dict
+get counters for the cache
+
+pygame.transform.IntegralImage
+ IntegralImage(Surface) -> IntegralImage
+pygame object for fast sums and averages over rects of a surface
+
+pygame.transform.IntegralImage.sum
+ sum() -> (r, g, b, a)
+ sum(Rect) -> (r, g, b, a)
+get the channel sums over a rect
+
+pygame.transform.IntegralImage.average
+ average() -> (r, g, b, a)
+ average(Rect) -> (r, g, b, a)
+get the average color over a rect
+
+pygame.transform.IntegralImage.sum_many
+ sum_many(rects) -> list
+get the channel sums over many rects
+
+pygame.transform.IntegralImage.average_many
+ average_many(rects) -> list
+get the average colors over many rects
+
+pygame.transform.IntegralImage.get_size
+ get_size() -> (width, height)
+get the size of the surface the image was made from
+
+pygame.transform.Accumulator
+ Accumulator((width, height), window=0, alpha=0.0) -> Accumulator
+pygame object averaging a stream of surfaces
+
+pygame.transform.Accumulator.add
+ add(Surface) -> None
+add a surface to the average
+
+pygame.transform.Accumulator.remove
+ remove(Surface) -> None
+take an added surface out of the average
+
+pygame.transform.Accumulator.to_surface
+ to_surface(DestSurface = None) -> Surface
+get the average as a surface
+
+pygame.transform.Accumulator.clear
+ clear() -> None
+forget all added surfaces
+
+pygame.transform.Accumulator.get_count
+ get_count() -> int
+get the number of surfaces in the average
+
+pygame.transform.box_blur
+ box_blur(Surface, radius, DestSurface = None) -> Surface
+blur a surface with a box filter
+
+pygame.transform.gaussian_blur
+ gaussian_blur(Surface, sigma, DestSurface = None) -> Surface
+blur a surface with an approximate gaussian
+
+pygame.transform.flip_ip
+ flip_ip(Surface, xbool, ybool) -> None
+flip a surface in place
+
 */
\ No newline at end of file
@@ -51,6 +51,7 @@ static void draw_arc(SDL_Surface *dst, int x, int y, int radius1, int radius2, d
 static void draw_ellipse(SDL_Surface *dst, int x, int y, int rx, int ry, Uint32 color);
 static void draw_fillellipse(SDL_Surface *dst, int x, int y, int rx, int ry, Uint32 color);
 static void draw_fillpoly(SDL_Surface *dst, int *vx, int *vy, int n, Uint32 color);
+static void mark_dirty(PyObject* surfobj, int x, int y, int w, int h);
 
 
 
@@ -115,6 +116,7 @@ static PyObject* aaline(PyObject* self, PyObject* arg)
         top = (int)(pts[3]);
         bottom = (int)(pts[1]);
     }
+    mark_dirty(surfobj, left, top, right-left+2, bottom-top+2);
     return PyRect_New4(left, top, right-left+2, bottom-top+2);
 }
 
@@ -182,6 +184,11 @@ static PyObject* line(PyObject* self, PyObject* arg)
         rwidth = dx + width;
         rheight = dy + 1;
     }
+    /*wide lines are drawn on both sides of the points*/
+    if (dx > dy)
+        mark_dirty(surfobj, rleft, rtop - (width-1)/2, rwidth, rheight);
+    else
+        mark_dirty(surfobj, rleft - (width-1)/2, rtop, rwidth, rheight);
     return PyRect_New4(rleft, rtop, rwidth, rheight);
 }
 
@@ -271,6 +278,7 @@ static PyObject* aalines(PyObject* self, PyObject* arg)
     if(!PySurface_Unlock(surfobj)) return NULL;
 
     /*compute return rect*/
+    mark_dirty(surfobj, left, top, right-left+2, bottom-top+2);
     return PyRect_New4(left, top, right-left+2, bottom-top+2);
 }
 
@@ -363,6 +371,7 @@ static PyObject* lines(PyObject* self, PyObject* arg)
     if(!PySurface_Unlock(surfobj)) return NULL;
 
     /*compute return rect*/
+    mark_dirty(surfobj, left, top, right-left+1, bottom-top+1);
     return PyRect_New4(left, top, right-left+1, bottom-top+1);
 }
 
@@ -420,6 +429,7 @@ static PyObject* arc(PyObject* self, PyObject* arg)
     t = MAX(rect->y, surf->clip_rect.y);
     r = MIN(rect->x + rect->w, surf->clip_rect.x + surf->clip_rect.w);
     b = MIN(rect->y + rect->h, surf->clip_rect.y + surf->clip_rect.h);
+    mark_dirty(surfobj, l, t, MAX(r-l, 0), MAX(b-t, 0));
     return PyRect_New4(l, t, MAX(r-l, 0), MAX(b-t, 0));
 }
 
@@ -477,6 +487,7 @@ static PyObject* ellipse(PyObject* self, PyObject* arg)
     t = MAX(rect->y, surf->clip_rect.y);
     r = MIN(rect->x + rect->w, surf->clip_rect.x + surf->clip_rect.w);
     b = MIN(rect->y + rect->h, surf->clip_rect.y + surf->clip_rect.h);
+    mark_dirty(surfobj, l, t, MAX(r-l, 0), MAX(b-t, 0));
     return PyRect_New4(l, t, MAX(r-l, 0), MAX(b-t, 0));
 }
 
@@ -527,6 +538,7 @@ static PyObject* circle(PyObject* self, PyObject* arg)
     t = MAX(posy - radius, surf->clip_rect.y);
     r = MIN(posx + radius, surf->clip_rect.x + surf->clip_rect.w);
     b = MIN(posy + radius, surf->clip_rect.y + surf->clip_rect.h);
+    mark_dirty(surfobj, l, t, MAX(r-l, 0), MAX(b-t, 0));
     return PyRect_New4(l, t, MAX(r-l, 0), MAX(b-t, 0));
 }
 
@@ -618,6 +630,7 @@ static PyObject* polygon(PyObject* self, PyObject* arg)
     top = MAX(top, surf->clip_rect.y);
     right = MIN(right, surf->clip_rect.x + surf->clip_rect.w);
     bottom = MIN(bottom, surf->clip_rect.y + surf->clip_rect.h);
+    mark_dirty(surfobj, left, top, right-left+1, bottom-top+1);
     return PyRect_New4(left, top, right-left+1, bottom-top+1);
 }
 
@@ -651,6 +664,20 @@ static PyObject* rect(PyObject* self, PyObject* arg)
 
 
 
+/*report a changed area to a surface tracking dirty rects*/
+static void mark_dirty(PyObject* surfobj, int x, int y, int w, int h)
+{
+    SDL_Rect r;
+
+    if(w > 0 && h > 0)
+    {
+        r.x = x; r.y = y;
+        r.w = w; r.h = h;
+        PySurface_AddDirty(surfobj, &r);
+    }
+}
+
+
 /*internal drawing tools*/
 
 static int clip_and_draw_aaline(SDL_Surface* surf, SDL_Rect* rect, Uint32 color, float* pts, int blend)
@@ -129,6 +129,112 @@ static PyObject* mask_overlap_area(PyObject* self, PyObject* args)
     return PyInt_FromLong(val);
 }
 
+/* One (mask, (x, y)) entry of the list given to overlap_many and
+   overlap_area_many. Returns 0 if the bounding boxes do not meet, -1 on
+   an error. */
+static int overlap_many_item(bitmask_t *mask, PyObject *item,
+                             bitmask_t **other, int *x, int *y)
+{
+    PyObject *maskobj;
+
+    if (!PyTuple_Check(item)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "expected a sequence of (mask, offset) tuples");
+        return -1;
+    }
+    if (!PyArg_ParseTuple(item, "O!(ii)", &PyMask_Type, &maskobj, x, y))
+        return -1;
+    *other = PyMask_AsBitmap(maskobj);
+    return (*x < mask->w && *y < mask->h &&
+            *x + (*other)->w > 0 && *y + (*other)->h > 0 &&
+            mask->w && mask->h && (*other)->w && (*other)->h);
+}
+
+static PyObject* mask_overlap_many(PyObject* self, PyObject* args)
+{
+    bitmask_t *mask = PyMask_AsBitmap(self);
+    bitmask_t *othermask;
+    PyObject *list, *seq, *index;
+    Py_ssize_t i, n;
+    int x, y, hit;
+
+    if(!PyArg_ParseTuple(args, "O", &list))
+        return NULL;
+    seq = PySequence_Fast(list, "expected a sequence of (mask, offset) tuples");
+    if (seq == NULL)
+        return NULL;
+    list = PyList_New(0);
+    if (list == NULL) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+
+    n = PySequence_Fast_GET_SIZE(seq);
+    for (i = 0; i < n; i++) {
+        hit = overlap_many_item(mask, PySequence_Fast_GET_ITEM(seq, i),
+                                &othermask, &x, &y);
+        if (hit > 0)
+            hit = bitmask_overlap(mask, othermask, x, y);
+        if (hit < 0)
+            goto fail;
+        if (hit) {
+            index = PyInt_FromSsize_t(i);
+            if (index == NULL || PyList_Append(list, index)) {
+                Py_XDECREF(index);
+                goto fail;
+            }
+            Py_DECREF(index);
+        }
+    }
+    Py_DECREF(seq);
+    return list;
+
+fail:
+    Py_DECREF(seq);
+    Py_DECREF(list);
+    return NULL;
+}
+
+static PyObject* mask_overlap_area_many(PyObject* self, PyObject* args)
+{
+    bitmask_t *mask = PyMask_AsBitmap(self);
+    bitmask_t *othermask;
+    PyObject *list, *seq, *area;
+    Py_ssize_t i, n;
+    int x, y, hit;
+
+    if(!PyArg_ParseTuple(args, "O", &list))
+        return NULL;
+    seq = PySequence_Fast(list, "expected a sequence of (mask, offset) tuples");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE(seq);
+    list = PyList_New(n);
+    if (list == NULL) {
+        Py_DECREF(seq);
+        return NULL;
+    }
+
+    for (i = 0; i < n; i++) {
+        hit = overlap_many_item(mask, PySequence_Fast_GET_ITEM(seq, i),
+                                &othermask, &x, &y);
+        if (hit < 0)
+            goto fail;
+        area = PyInt_FromLong(hit ? bitmask_overlap_area(mask, othermask,
+                                                         x, y) : 0);
+        if (area == NULL)
+            goto fail;
+        PyList_SET_ITEM(list, i, area);
+    }
+    Py_DECREF(seq);
+    return list;
+
+fail:
+    Py_DECREF(seq);
+    Py_DECREF(list);
+    return NULL;
+}
+
 static PyObject* mask_overlap_mask(PyObject* self, PyObject* args)
 {
     int x, y;
@@ -445,7 +551,7 @@ static PyObject* mask_from_surface(PyObject* self, PyObject* args)
     PyObject* surfobj;
     PyMaskObject *maskobj;
 
-    int x, y, threshold, ashift, aloss, usethresh;
+    int x, y, threshold, ashift, aloss, usethresh, rows32;
     Uint8 *pixels;
 
     SDL_PixelFormat *format;
@@ -495,8 +601,29 @@ static PyObject* mask_from_surface(PyObject* self, PyObject* args)
     usethresh = (SDL_GetColorKey(surf, &colorkey) == -1);
 #endif /* SDL2 */
 
+    /* 32 bit rows go a mask word at a time when the alpha is a plain
+       field of up to 8 bits */
+    rows32 = (format->BytesPerPixel == 4 &&
+              (!usethresh || amask == 0 ||
+               (aloss == 0 && (amask >> ashift) <= 0xff)));
+
     for(y=0; y < surf->h; y++) {
         pixels = (Uint8 *) surf->pixels + y*surf->pitch;
+        if (rows32) {
+            if (usethresh)
+                bitmask_row_alpha(mask, y, (const unsigned int *) pixels,
+                                  amask, ashift, threshold);
+            else
+#ifndef SDL2
+                bitmask_row_near(mask, y, (const unsigned int *) pixels,
+                                 NULL, format->colorkey, 0x01010101,
+                                 0xffffffff, 1);
+#else /* SDL2 */
+                bitmask_row_near(mask, y, (const unsigned int *) pixels,
+                                 NULL, colorkey, 0x01010101, 0xffffffff, 1);
+#endif /* SDL2 */
+            continue;
+        }
         for(x=0; x < surf->w; x++) {
             /* Get the color.  TODO: should use an inline helper
              *   function for this common function. */
@@ -574,6 +701,18 @@ palette_colors - this only affects surfaces with a palette
 
 */
 
+/* whether red, green and blue are each a whole byte of a 32 bit pixel */
+static int rgb_bytes (SDL_PixelFormat *format)
+{
+    return (format->BytesPerPixel == 4 &&
+            format->Rloss == 0 && format->Rshift % 8 == 0 &&
+            format->Rmask == 0xffU << format->Rshift &&
+            format->Gloss == 0 && format->Gshift % 8 == 0 &&
+            format->Gmask == 0xffU << format->Gshift &&
+            format->Bloss == 0 && format->Bshift % 8 == 0 &&
+            format->Bmask == 0xffU << format->Bshift);
+}
+
 void bitmask_threshold (bitmask_t *m,
                         SDL_Surface *surf,
                         SDL_Surface *surf2,
@@ -589,7 +728,7 @@ void bitmask_threshold (bitmask_t *m,
     Uint8 *pix;
     Uint8 r, g, b, a;
     Uint8 tr, tg, tb, ta;
-    int bpp1, bpp2;
+    int bpp1, bpp2, rows32;
 
 
     pixels = (Uint8 *) surf->pixels;
@@ -631,11 +770,26 @@ void bitmask_threshold (bitmask_t *m,
     SDL_GetRGBA (color, format, &r, &g, &b, &a);
     SDL_GetRGBA (threshold, format, &tr, &tg, &tb, &ta);
 
+    /* with whole byte colors, 32 bit rows are compared a byte at a time
+       and go a mask word at a time */
+    rows32 = rgb_bytes (format);
+    if (surf2) {
+        rows32 = (rows32 && rgb_bytes (format2) &&
+                  rmask2 == rmask && gmask2 == gmask && bmask2 == bmask &&
+                  surf2->w >= surf->w && surf2->h >= surf->h);
+    }
+
     for(y=0; y < surf->h; y++) {
         pixels = (Uint8 *) surf->pixels + y*surf->pitch;
         if (surf2) {
             pixels2 = (Uint8 *) surf2->pixels + y*surf2->pitch;
         }
+        if (rows32) {
+            bitmask_row_near (m, y, (const unsigned int *) pixels,
+                              (const unsigned int *) pixels2, color,
+                              threshold, rmask | gmask | bmask, 0);
+            continue;
+        }
         for(x=0; x < surf->w; x++) {
             /* the_color = surf->get_at(x,y) */
             switch (bpp1)
@@ -806,287 +960,281 @@ static PyObject* mask_from_threshold(PyObject* self, PyObject* args)
 
 
 
-/* the initial labelling phase of the connected components algorithm
-
-Returns: The highest label in the labelled image
+/* Connected components are found from the runs of set bits in each row.
+   The runs of a row are read from the mask a word at a time. Each run is
+   joined to the runs of the row above that touch it, diagonals included,
+   in a union-find forest with path halving. The rows are labelled in
+   bands, on the worker threads for big masks, and the bands are joined
+   where they meet. Components are numbered in the order of their first
+   pixel, top to bottom and left to right. */
 
-input - The input Mask
-image - An array to store labelled pixels
-ufind - The union-find label equivalence array
-largest - An array to store the number of pixels for each label
+typedef struct {
+    int x0, x1;                 /* the set bits [x0, x1) of a row */
+} CCRun;
 
-*/
-unsigned int cc_label(bitmask_t *input, unsigned int* image, unsigned int* ufind, unsigned int* largest) {
-    unsigned int *buf;
-    unsigned int x, y, w, h, root, aroot, croot, temp, label;
-
-    label = 0;
-    w = input->w;
-    h = input->h;
-
-    ufind[0] = 0;
-    buf = image;
-
-    /* special case for first pixel */
-    if(bitmask_getbit(input, 0, 0)) { /* process for a new connected comp: */
-        label++;              /* create a new label */
-        *buf = label;         /* give the pixel the label */
-        ufind[label] = label; /* put the label in the equivalence array */
-        largest[label] = 1;   /* the label has 1 pixel associated with it */
-    } else {
-        *buf = 0;
-    }
-    buf++;
+typedef struct {
+    int x0, y0, x1, y1;         /* bounding box, ends excluded */
+    long count;                 /* number of set bits */
+} CCComp;
 
+typedef struct {
+    bitmask_t *mask;
+    int *rowstart;              /* runs of row y are from rowstart[y] up to
+                                   rowstart[y + 1] */
+    CCRun *runs;
+    int *parent;                /* union-find forest over the runs */
+    int *label;                 /* component of each run */
+    char *bandstart;            /* the rows bands start at */
+    CCComp *comps;
+    int ncomps;
+} CCLabels;
+
+static INLINE int cc_ctz(BITMASK_W w)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzl(w);
+#else
+    int n = 0;
 
+    while (!(w & 1)) {
+        w >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
 
-    /* special case for first row.
-           Go over the first row except the first pixel.
-    */
-    for(x = 1; x < w; x++) {
-        if (bitmask_getbit(input, x, 0)) {
-            if (*(buf-1)) {                    /* d label */
-                *buf = *(buf-1);
-            } else {                           /* create label */
-                label++;
-                *buf = label;
-                ufind[label] = label;
-                largest[label] = 0;
+/* Finds the runs of row y, or only counts them when out is NULL */
+static int cc_row_runs(const bitmask_t *m, int y, CCRun *out)
+{
+    const BITMASK_W *bits = m->bits + y;
+    BITMASK_W word, edges, carry = 0;
+    int nstripes = m->w ? (m->w - 1) / (int)BITMASK_W_LEN + 1 : 0;
+    int s, x, x0 = 0, n = 0, inrun = 0;
+
+    for (s = 0; s < nstripes; s++, bits += m->h) {
+        word = *bits;
+        /* a bit for each pixel that differs from the one on its left */
+        edges = word ^ ((word << 1) | carry);
+        carry = word >> (BITMASK_W_LEN - 1);
+        while (edges) {
+            x = s * (int)BITMASK_W_LEN + cc_ctz(edges);
+            edges &= edges - 1;
+            if (!inrun) {
+                x0 = x;
             }
-            largest[*buf]++;
-        } else {
-            *buf = 0;
+            else if (x0 < m->w) {
+                if (out) {
+                    out[n].x0 = x0;
+                    out[n].x1 = MIN(x, m->w);
+                }
+                n++;
+            }
+            inrun = !inrun;
         }
-        buf++;
     }
+    if (inrun && x0 < m->w) {
+        if (out) {
+            out[n].x0 = x0;
+            out[n].x1 = m->w;
+        }
+        n++;
+    }
+    return n;
+}
 
+static int cc_find(int *parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
 
-
-    /* the rest of the image */
-    for(y = 1; y < h; y++) {
-        /* first pixel of the row */
-        if (bitmask_getbit(input, 0, y)) {
-            if (*(buf-w)) {                    /* b label */
-                *buf = *(buf-w);
-            } else if (*(buf-w+1)) {           /* c label */
-                *buf = *(buf-w+1);
-            } else {                           /* create label */
-                label++;
-                *buf = label;
-                ufind[label] = label;
-                largest[label] = 0;
-            }
-            largest[*buf]++;
-        } else {
-            *buf = 0;
+/* join the runs of row y to those of row y - 1 that touch them */
+static void cc_join_rows(CCLabels *l, int y)
+{
+    int i = l->rowstart[y - 1], iend = l->rowstart[y];
+    int j = l->rowstart[y], jend = l->rowstart[y + 1];
+    CCRun *runs = l->runs;
+    int a, b;
+
+    while (i < iend && j < jend) {
+        if (runs[i].x1 < runs[j].x0) {
+            i++;
         }
-        buf++;
-        /* middle pixels of the row */
-        for(x = 1; x < (w-1); x++) {
-            if (bitmask_getbit(input, x, y)) {
-                if (*(buf-w)) {                /* b label */
-                    *buf = *(buf-w);
-                } else if (*(buf-w+1)) {       /* c branch of tree */
-                    if (*(buf-w-1)) {                      /* union(c, a) */
-                        croot = root = *(buf-w+1);
-                        while (ufind[root] < root) {       /* find root */
-                            root = ufind[root];
-                        }
-                        if (croot != *(buf-w-1)) {
-                            temp = aroot = *(buf-w-1);
-                            while (ufind[aroot] < aroot) { /* find root */
-                                aroot = ufind[aroot];
-                            }
-                            if (root > aroot) {
-                                root = aroot;
-                            }
-                            while (ufind[temp] > root) {   /* set root */
-                                aroot = ufind[temp];
-                                ufind[temp] = root;
-                                temp = aroot;
-                            }
-                        }
-                        while (ufind[croot] > root) {      /* set root */
-                            temp = ufind[croot];
-                            ufind[croot] = root;
-                            croot = temp;
-                        }
-                        *buf = root;
-                    } else if (*(buf-1)) {                 /* union(c, d) */
-                        croot = root = *(buf-w+1);
-                        while (ufind[root] < root) {       /* find root */
-                            root = ufind[root];
-                        }
-                        if (croot != *(buf-1)) {
-                            temp = aroot = *(buf-1);
-                            while (ufind[aroot] < aroot) { /* find root */
-                                aroot = ufind[aroot];
-                            }
-                            if (root > aroot) {
-                                root = aroot;
-                            }
-                            while (ufind[temp] > root) {   /* set root */
-                                aroot = ufind[temp];
-                                ufind[temp] = root;
-                                temp = aroot;
-                            }
-                        }
-                        while (ufind[croot] > root) {      /* set root */
-                            temp = ufind[croot];
-                            ufind[croot] = root;
-                            croot = temp;
-                        }
-                        *buf = root;
-                    } else {                   /* c label */
-                        *buf = *(buf-w+1);
-                    }
-                } else if (*(buf-w-1)) {       /* a label */
-                    *buf = *(buf-w-1);
-                } else if (*(buf-1)) {         /* d label */
-                    *buf = *(buf-1);
-                } else {                       /* create label */
-                    label++;
-                    *buf = label;
-                    ufind[label] = label;
-                    largest[label] = 0;
-                }
-                largest[*buf]++;
-            } else {
-                *buf = 0;
-            }
-            buf++;
+        else if (runs[j].x1 < runs[i].x0) {
+            j++;
         }
-        /* last pixel of the row, if its not also the first pixel of the row */
-        if (w > 1) {
-            if (bitmask_getbit(input, x, y)) {
-                if (*(buf-w)) {                /* b label */
-                    *buf = *(buf-w);
-                } else if (*(buf-w-1)) {       /* a label */
-                    *buf = *(buf-w-1);
-                } else if (*(buf-1)) {         /* d label */
-                    *buf = *(buf-1);
-                } else {                       /* create label */
-                    label++;
-                    *buf = label;
-                    ufind[label] = label;
-                    largest[label] = 0;
-                }
-                largest[*buf]++;
-            } else {
-                *buf = 0;
-            }
-            buf++;
+        else {
+            a = cc_find(l->parent, i);
+            b = cc_find(l->parent, j);
+            if (a < b)
+                l->parent[b] = a;
+            else if (b < a)
+                l->parent[a] = b;
+            if (runs[i].x1 < runs[j].x1)
+                i++;
+            else
+                j++;
         }
     }
+}
+
+static void cc_count_band(void *job, int first, int count)
+{
+    CCLabels *l = (CCLabels *)job;
+    int y;
 
-    return label;
+    for (y = first; y < first + count; y++)
+        l->rowstart[y + 1] = cc_row_runs(l->mask, y, NULL);
 }
 
+static void cc_label_band(void *job, int first, int count)
+{
+    CCLabels *l = (CCLabels *)job;
+    int y, i, n;
+
+    l->bandstart[first] = 1;
+    for (y = first; y < first + count; y++) {
+        n = cc_row_runs(l->mask, y, l->runs + l->rowstart[y]);
+        for (i = l->rowstart[y]; i < l->rowstart[y] + n; i++)
+            l->parent[i] = i;
+        if (y > first)
+            cc_join_rows(l, y);
+    }
+}
 
+static void cc_free(CCLabels *l)
+{
+    free(l->rowstart);
+    free(l->bandstart);
+    free(l->runs);
+    free(l->parent);
+    free(l->label);
+    free(l->comps);
+}
 
-/* Connected component labeling based on the SAUF algorithm by Kesheng Wu,
-   Ekow Otoo, and Kenji Suzuki.  The algorithm is best explained by their paper,
-   "Two Strategies to Speed up Connected Component Labeling Algorithms", but in
-   summary, it is a very efficient two pass method for 8-connected components.
-   It uses a decision tree to minimize the number of neighbors that need to be
-   checked.  It stores equivalence information in an array based union-find.
-   This implementation also has a final step of finding bounding boxes. */
+/* Labels the components of mask in nbands bands. Returns -2 on memory
+   allocation error, otherwise 0. l must be given to cc_free after. */
+static int cc_label(bitmask_t *mask, CCLabels *l, int nbands)
+{
+    CCComp *c;
+    long total = 0;
+    int h = mask->h;
+    int y, i, r;
+
+    memset(l, 0, sizeof(CCLabels));
+    l->mask = mask;
+    l->rowstart = (int *) malloc(sizeof(int) * (h + 1));
+    l->bandstart = (char *) calloc(h + 1, 1);
+    if (!l->rowstart || !l->bandstart) { return -2; }
+    if (nbands > h) { nbands = h; }
+
+    /* count the runs of each row, then place them */
+    l->rowstart[0] = 0;
+    PySurface_WorkersRun(cc_count_band, l, h, nbands);
+    for (y = 0; y < h; y++) {
+        total += l->rowstart[y + 1];
+        if (total > INT_MAX / (long) sizeof(CCRun)) { return -2; }
+        l->rowstart[y + 1] = (int) total;
+    }
+
+    /* at least one of each, so an empty mask is not an allocation error */
+    l->runs = (CCRun *) malloc(sizeof(CCRun) * (total + 1));
+    l->parent = (int *) malloc(sizeof(int) * (total + 1));
+    l->label = (int *) malloc(sizeof(int) * (total + 1));
+    l->comps = (CCComp *) malloc(sizeof(CCComp) * (total + 1));
+    if (!l->runs || !l->parent || !l->label || !l->comps) { return -2; }
+
+    PySurface_WorkersRun(cc_label_band, l, h, nbands);
+    for (y = 1; y < h; y++) {
+        if (l->bandstart[y])
+            cc_join_rows(l, y);
+    }
+
+    /* number the components and find their boxes. The root of a
+       component is its first run, so it comes before the rest. */
+    for (y = 0; y < h; y++) {
+        for (i = l->rowstart[y]; i < l->rowstart[y + 1]; i++) {
+            r = cc_find(l->parent, i);
+            if (r == i) {
+                l->label[i] = l->ncomps;
+                c = &l->comps[l->ncomps++];
+                c->x0 = l->runs[i].x0;
+                c->x1 = l->runs[i].x1;
+                c->y0 = y;
+                c->count = 0;
+            }
+            else {
+                l->label[i] = l->label[r];
+                c = &l->comps[l->label[i]];
+                c->x0 = MIN(c->x0, l->runs[i].x0);
+                c->x1 = MAX(c->x1, l->runs[i].x1);
+            }
+            c->y1 = y + 1;
+            c->count += l->runs[i].x1 - l->runs[i].x0;
+        }
+    }
+    return 0;
+}
+
+/* set the bits [x0, x1) of row y */
+static void cc_fill_run(bitmask_t *m, int y, int x0, int x1)
+{
+    BITMASK_W *word;
+    int bit, n;
+
+    while (x0 < x1) {
+        word = m->bits + x0 / (int)BITMASK_W_LEN * m->h + y;
+        bit = x0 & BITMASK_W_MASK;
+        n = MIN(x1 - x0, (int)BITMASK_W_LEN - bit);
+        if (n == (int)BITMASK_W_LEN)
+            *word = ~(BITMASK_W)0;
+        else
+            *word |= (BITMASK_N(n) - 1) << bit;
+        x0 += n;
+    }
+}
 
 /*
 returns -2 on memory allocation error, otherwise 0 on success.
 
 input - the input mask.
+nbands - the number of row bands to label in.
 num_bounding_boxes - returns the number of bounding rects found.
 rects - returns the rects that are found.  Allocates the memory for the rects.
 
 */
-static int get_bounding_rects(bitmask_t *input, int *num_bounding_boxes, GAME_Rect** ret_rects)
+static int get_bounding_rects(bitmask_t *input, int nbands, int *num_bounding_boxes, GAME_Rect** ret_rects)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    int x, y, w, h, temp, label, relabel;
-    GAME_Rect* rects;
-
-    rects = NULL;
-    label = 0;
+    CCLabels l;
+    GAME_Rect *rects = NULL;
+    int i;
 
-    w = input->w;
-    h = input->h;
-
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *) malloc(sizeof(int)*w*h);
-    if(!image) { return -2; }
-
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *) malloc(sizeof(int)*(w/2 + 1)*(h/2 + 1));
-    if(!ufind) { return -2; }
-
-    largest = (unsigned int *) malloc(sizeof(int)*(w/2 + 1)*(h/2 + 1));
-    if(!largest) { return -2; }
-
-
-    /* do the initial labelling */
-    label = cc_label(input, image, ufind, largest);
-
-    relabel = 0;
-    /* flatten and relabel the union-find equivalence array.  Start at label 1
-       because label 0 indicates an unset pixel.  For this reason, we also use
-       <= label rather than < label. */
-    for (x = 1; x <= label; x++) {
-         if (ufind[x] < x) {             /* is it a union find root? */
-             ufind[x] = ufind[ufind[x]]; /* relabel it to its root */
-         } else {                 /* its a root */
-             relabel++;
-             ufind[x] = relabel;  /* assign the lowest label available */
-         }
-    }
-
-    *num_bounding_boxes = relabel;
-
-    if (relabel == 0) {
-    /* early out, as we didn't find anything. */
-        free(image);
-        free(ufind);
-        free(largest);
-        *ret_rects = rects;
-        return 0;
-    }
-
-    /* the bounding rects, need enough space for the number of labels */
-    rects = (GAME_Rect *) malloc(sizeof(GAME_Rect) * (relabel +1));
-    if(!rects) { return -2; }
-
-    for (temp = 0; temp <= relabel; temp++) {
-        rects[temp].h = 0;        /* so we know if its a new rect or not */
+    if (cc_label(input, &l, nbands)) {
+        cc_free(&l);
+        return -2;
     }
 
-    /* find the bounding rect of each connected component */
-    buf = image;
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf]) {         /* if the pixel is part of a component */
-                if (rects[ufind[*buf]].h) {   /* the component has a rect */
-                    temp = rects[ufind[*buf]].x;
-                    rects[ufind[*buf]].x = MIN(x, temp);
-                    rects[ufind[*buf]].y = MIN(y, rects[ufind[*buf]].y);
-                    rects[ufind[*buf]].w = MAX(rects[ufind[*buf]].w + temp, x + 1) - rects[ufind[*buf]].x;
-                    rects[ufind[*buf]].h = MAX(rects[ufind[*buf]].h, y - rects[ufind[*buf]].y + 1);
-                } else {                      /* otherwise, start the rect */
-                    rects[ufind[*buf]].x = x;
-                    rects[ufind[*buf]].y = y;
-                    rects[ufind[*buf]].w = 1;
-                    rects[ufind[*buf]].h = 1;
-                }
-            }
-            buf++;
+    if (l.ncomps) {
+        rects = (GAME_Rect *) malloc(sizeof(GAME_Rect) * l.ncomps);
+        if (!rects) {
+            cc_free(&l);
+            return -2;
         }
     }
+    for (i = 0; i < l.ncomps; i++) {
+        rects[i].x = l.comps[i].x0;
+        rects[i].y = l.comps[i].y0;
+        rects[i].w = l.comps[i].x1 - l.comps[i].x0;
+        rects[i].h = l.comps[i].y1 - l.comps[i].y0;
+    }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    *num_bounding_boxes = l.ncomps;
     *ret_rects = rects;
-
+    cc_free(&l);
     return 0;
 }
 
@@ -1094,7 +1242,7 @@ static PyObject* mask_get_bounding_rects(PyObject* self, PyObject* args)
 {
     GAME_Rect *regions;
     GAME_Rect *aregion;
-    int num_bounding_boxes, i, r;
+    int num_bounding_boxes, i, r, nbands;
     PyObject* ret;
     PyObject* rect;
 
@@ -1106,10 +1254,11 @@ static PyObject* mask_get_bounding_rects(PyObject* self, PyObject* args)
     aregion = NULL;
 
     num_bounding_boxes = 0;
+    nbands = PySurface_WorkersBands(mask->w, mask->h);
 
     Py_BEGIN_ALLOW_THREADS;
 
-    r = get_bounding_rects(mask, &num_bounding_boxes, &regions);
+    r = get_bounding_rects(mask, nbands, &num_bounding_boxes, &regions);
 
     Py_END_ALLOW_THREADS;
 
@@ -1120,14 +1269,21 @@ static PyObject* mask_get_bounding_rects(PyObject* self, PyObject* args)
     }
 
     ret = PyList_New (0);
-    if (!ret)
+    if (!ret) {
+        free(regions);
         return NULL;
+    }
 
-    /* build a list of rects to return.  Starts at 1 because we never use 0. */
-    for(i=1; i <= num_bounding_boxes; i++) {
+    /* build a list of rects to return. */
+    for(i=0; i < num_bounding_boxes; i++) {
         aregion = regions + i;
         rect = PyRect_New4 ( aregion->x, aregion->y, aregion->w, aregion->h );
-        PyList_Append (ret, rect);
+        if (!rect || PyList_Append (ret, rect)) {
+            Py_XDECREF (rect);
+            Py_DECREF (ret);
+            free(regions);
+            return NULL;
+        }
         Py_DECREF (rect);
     }
 
@@ -1140,243 +1296,232 @@ static PyObject* mask_get_bounding_rects(PyObject* self, PyObject* args)
 /*
 returns the number of connected components.
 returns -2 on memory allocation error.
-Allocates memory for components.
+Allocates memory for components, and for their bounding rects.
 
+With crop each mask is the size of its bounding rect, otherwise the size
+of the input mask.
 */
-static int get_connected_components(bitmask_t *mask, bitmask_t ***components, int min)
+static int get_connected_components(bitmask_t *mask, int nbands, int min,
+                                    int crop, bitmask_t ***components,
+                                    GAME_Rect **ret_rects)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    int x, y, w, h, label, relabel;
-    bitmask_t** comps;
-
-    label = 0;
-
-    w = mask->w;
-    h = mask->h;
-
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *) malloc(sizeof(int)*w*h);
-    if(!image) { return -2; }
-
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *) malloc(sizeof(int)*(w/2 + 1)*(h/2 + 1));
-    if(!ufind) {
-        free(image);
+    CCLabels l;
+    CCComp *c;
+    bitmask_t **comps;
+    GAME_Rect *rects;
+    int y, i, n = 0;
+
+    if (cc_label(mask, &l, nbands)) {
+        cc_free(&l);
         return -2;
     }
 
-    largest = (unsigned int *) malloc(sizeof(int)*(w/2 + 1)*(h/2 + 1));
-    if(!largest) {
-        free(image);
-        free(ufind);
+    /* indexed by component at first, NULL for those below min */
+    comps = (bitmask_t **) calloc(l.ncomps + 1, sizeof(bitmask_t *));
+    rects = (GAME_Rect *) malloc(sizeof(GAME_Rect) * (l.ncomps + 1));
+    if (!comps || !rects) {
+        free(comps);
+        free(rects);
+        cc_free(&l);
         return -2;
     }
 
-    /* do the initial labelling */
-    label = cc_label(mask, image, ufind, largest);
-
-    for (x = 1; x <= label; x++) {
-        if (ufind[x] < x) {
-            largest[ufind[x]] += largest[x];
-        }
-    }
-
-    relabel = 0;
-    /* flatten and relabel the union-find equivalence array.  Start at label 1
-       because label 0 indicates an unset pixel.  For this reason, we also use
-       <= label rather than < label. */
-    for (x = 1; x <= label; x++) {
-        if (ufind[x] < x) {             /* is it a union find root? */
-            ufind[x] = ufind[ufind[x]]; /* relabel it to its root */
-        } else {                 /* its a root */
-            if (largest[x] >= min) {
-                relabel++;
-                ufind[x] = relabel;  /* assign the lowest label available */
-            } else {
-                ufind[x] = 0;
+    for (i = 0; i < l.ncomps; i++) {
+        c = &l.comps[i];
+        if (c->count < min)
+            continue;
+        if (crop)
+            comps[i] = bitmask_create(c->x1 - c->x0, c->y1 - c->y0);
+        else
+            comps[i] = bitmask_create(mask->w, mask->h);
+        if (!comps[i]) {
+            for (i = 0; i < l.ncomps; i++) {
+                if (comps[i])
+                    bitmask_free(comps[i]);
             }
+            free(comps);
+            free(rects);
+            cc_free(&l);
+            return -2;
         }
     }
 
-    if (relabel == 0) {
-    /* early out, as we didn't find anything. */
-        free(image);
-        free(ufind);
-        free(largest);
-        return 0;
-    }
-
-    /* allocate space for the mask array */
-    comps = (bitmask_t **) malloc(sizeof(bitmask_t *) * (relabel +1));
-    if(!comps) {
-        free(image);
-        free(ufind);
-        free(largest);
-        return -2;
-    }
-
-    /* create the empty masks */
-    for (x = 1; x <= relabel; x++) {
-        comps[x] = bitmask_create(w, h);
-    }
-
     /* set the bits in each mask */
-    buf = image;
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf]) {         /* if the pixel is part of a component */
-                bitmask_setbit(comps[ufind[*buf]], x, y);
-            }
-            buf++;
+    for (y = 0; y < mask->h; y++) {
+        for (i = l.rowstart[y]; i < l.rowstart[y + 1]; i++) {
+            if (!comps[l.label[i]])
+                continue;
+            c = &l.comps[l.label[i]];
+            if (crop)
+                cc_fill_run(comps[l.label[i]], y - c->y0,
+                            l.runs[i].x0 - c->x0, l.runs[i].x1 - c->x0);
+            else
+                cc_fill_run(comps[l.label[i]], y,
+                            l.runs[i].x0, l.runs[i].x1);
         }
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    for (i = 0; i < l.ncomps; i++) {
+        if (!comps[i])
+            continue;
+        c = &l.comps[i];
+        comps[n] = comps[i];
+        rects[n].x = c->x0;
+        rects[n].y = c->y0;
+        rects[n].w = c->x1 - c->x0;
+        rects[n].h = c->y1 - c->y0;
+        n++;
+    }
 
+    cc_free(&l);
     *components = comps;
+    *ret_rects = rects;
 
-    return relabel;
+    return n;
 }
 
-static PyObject* mask_connected_components(PyObject* self, PyObject* args)
+static PyObject* mask_connected_components(PyObject* self, PyObject* args,
+                                           PyObject* kwds)
 {
     PyObject* ret;
+    PyObject* item;
+    PyObject* rect;
     PyMaskObject *maskobj;
     bitmask_t **components;
+    GAME_Rect *rects;
     bitmask_t *mask = PyMask_AsBitmap(self);
-    int i, num_components, min;
+    int i, num_components, min, crop, nbands;
+    static char *keywords[] = {"min", "crop", NULL};
 
     min = 0;
+    crop = 0;
     components = NULL;
+    rects = NULL;
 
-    if(!PyArg_ParseTuple(args, "|i", &min)) {
+    if(!PyArg_ParseTupleAndKeywords(args, kwds, "|ii", keywords,
+                                    &min, &crop)) {
         return NULL;
     }
 
+    nbands = PySurface_WorkersBands(mask->w, mask->h);
     Py_BEGIN_ALLOW_THREADS;
-    num_components = get_connected_components(mask, &components, min);
+    num_components = get_connected_components(mask, nbands, min, crop,
+                                              &components, &rects);
     Py_END_ALLOW_THREADS;
 
     if (num_components == -2)
         return RAISE (PyExc_MemoryError, "Not enough memory to get components. \n");
 
     ret = PyList_New(0);
-    if (!ret)
-        return NULL;
-
-    for (i=1; i <= num_components; i++) {
-        maskobj = PyObject_New(PyMaskObject, &PyMask_Type);
-        if(maskobj) {
-            maskobj->mask = components[i];
-            PyList_Append (ret, (PyObject *) maskobj);
-            Py_DECREF((PyObject *) maskobj);
+    for (i = 0; i < num_components; i++) {
+        maskobj = ret ? PyObject_New(PyMaskObject, &PyMask_Type) : NULL;
+        if (!maskobj) {
+            bitmask_free(components[i]);
+            Py_CLEAR(ret);
+            continue;
+        }
+        maskobj->mask = components[i];
+        item = (PyObject *) maskobj;
+        if (crop) {
+            rect = PyRect_New4(rects[i].x, rects[i].y,
+                               rects[i].w, rects[i].h);
+            if (rect)
+                item = Py_BuildValue("(NN)", item, rect);
+            else
+                Py_CLEAR(item);
         }
+        if (!item || PyList_Append(ret, item)) {
+            Py_CLEAR(ret);
+        }
+        Py_XDECREF(item);
     }
 
     free(components);
+    free(rects);
     return ret;
 }
 
-/* Connected component labeling based on the SAUF algorithm by Kesheng Wu,
-   Ekow Otoo, and Kenji Suzuki.  The algorithm is best explained by their paper,
-   "Two Strategies to Speed up Connected Component Labeling Algorithms", but in
-   summary, it is a very efficient two pass method for 8-connected components.
-   It uses a decision tree to minimize the number of neighbors that need to be
-   checked.  It stores equivalence information in an array based union-find.
-   This implementation also tracks the number of pixels in each label, finding
-   the biggest one while flattening the union-find equivalence array.  It then
-   writes an output mask containing only the largest connected component. */
-
 
 /*
 returns -2 on memory allocation error.
+
+Writes the component with the pixel at (ccx, ccy) into output, or the one
+with the most pixels if ccx is -1. On a tie the first one wins.
 */
-static int largest_connected_comp(bitmask_t* input, bitmask_t* output, int ccx, int ccy)
+static int largest_connected_comp(bitmask_t* input, bitmask_t* output, int nbands, int ccx, int ccy)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    unsigned int max, x, y, w, h, label;
-
-    w = input->w;
-    h = input->h;
-
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *) malloc(sizeof(int)*w*h);
-    if(!image) { return -2; }
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *) malloc(sizeof(int)*(w/2 + 1)*(h/2 + 1));
-    if(!ufind) {
-        free(image);
-        return -2;
-    }
-    /* an array to track the number of pixels associated with each label */
-    largest = (unsigned int *) malloc(sizeof(int)*(w/2 + 1)*(h/2 + 1));
-    if(!largest) {
-        free(image);
-        free(ufind);
+    CCLabels l;
+    int y, i, max = -1;
+
+    if (cc_label(input, &l, nbands)) {
+        cc_free(&l);
         return -2;
     }
 
-    /* do the initial labelling */
-    label = cc_label(input, image, ufind, largest);
-
-    max = 1;
-    /* flatten the union-find equivalence array */
-    for (x = 2; x <= label; x++) {
-         if (ufind[x] != x) {                 /* is it a union find root? */
-             largest[ufind[x]] += largest[x]; /* add its pixels to its root */
-             ufind[x] = ufind[ufind[x]];      /* relabel it to its root */
-         }
-         if (largest[ufind[x]] > largest[max]) { /* is it the new biggest? */
-             max = ufind[x];
-         }
+    if (ccx >= 0) {
+        for (i = l.rowstart[ccy]; i < l.rowstart[ccy + 1]; i++) {
+            if (l.runs[i].x0 <= ccx && ccx < l.runs[i].x1)
+                max = l.label[i];
+        }
+    }
+    else {
+        for (i = 0; i < l.ncomps; i++) {
+            if (max < 0 || l.comps[i].count > l.comps[max].count)
+                max = i;
+        }
     }
 
     /* write out the final image */
-    buf = image;
-    if (ccx >= 0)
-        max = ufind[*(buf+ccy*w+ccx)];
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf] == max) {         /* if the label is the max one */
-                bitmask_setbit(output, x, y); /* set the bit in the mask */
+    if (max >= 0) {
+        for (y = l.comps[max].y0; y < l.comps[max].y1; y++) {
+            for (i = l.rowstart[y]; i < l.rowstart[y + 1]; i++) {
+                if (l.label[i] == max)
+                    cc_fill_run(output, y, l.runs[i].x0, l.runs[i].x1);
             }
-            buf++;
         }
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
-
+    cc_free(&l);
     return 0;
 }
 
 static PyObject* mask_connected_component(PyObject* self, PyObject* args)
 {
     bitmask_t *input = PyMask_AsBitmap(self);
-    bitmask_t *output = bitmask_create(input->w, input->h);
-    PyMaskObject *maskobj = PyObject_New(PyMaskObject, &PyMask_Type);
-    int x, y;
+    bitmask_t *output;
+    PyMaskObject *maskobj;
+    int x, y, r, nbands;
 
     x = -1;
+    y = 0;
 
     if(!PyArg_ParseTuple(args, "|(ii)", &x, &y)) {
         return NULL;
     }
+    if (x != -1 && (x < 0 || x >= input->w || y < 0 || y >= input->h)) {
+        PyErr_Format(PyExc_IndexError, "%d, %d is out of bounds", x, y);
+        return NULL;
+    }
 
-    /* if a coordinate is specified, make the pixel there is actually set */
-    if (x == -1 || bitmask_getbit(input, x, y)) {
-        if (largest_connected_comp(input, output, x, y) == -2) {
-            return RAISE (PyExc_MemoryError, "Not enough memory to get bounding rects. \n");
-        }
+    output = bitmask_create(input->w, input->h);
+    if (!output)
+        return PyErr_NoMemory();
+
+    nbands = PySurface_WorkersBands(input->w, input->h);
+    Py_BEGIN_ALLOW_THREADS;
+    r = largest_connected_comp(input, output, nbands, x, y);
+    Py_END_ALLOW_THREADS;
+
+    if (r == -2) {
+        bitmask_free(output);
+        return RAISE (PyExc_MemoryError, "Not enough memory to get bounding rects. \n");
     }
 
+    maskobj = PyObject_New(PyMaskObject, &PyMask_Type);
     if(maskobj)
         maskobj->mask = output;
+    else
+        bitmask_free(output);
 
     return (PyObject*)maskobj;
 }
@@ -1390,6 +1535,9 @@ static PyMethodDef mask_methods[] =
     { "overlap", mask_overlap, METH_VARARGS, DOC_MASKOVERLAP },
     { "overlap_area", mask_overlap_area, METH_VARARGS, DOC_MASKOVERLAPAREA },
     { "overlap_mask", mask_overlap_mask, METH_VARARGS, DOC_MASKOVERLAPMASK },
+    { "overlap_many", mask_overlap_many, METH_VARARGS, DOC_MASKOVERLAPMANY },
+    { "overlap_area_many", mask_overlap_area_many, METH_VARARGS,
+      DOC_MASKOVERLAPAREAMANY },
     { "fill", mask_fill, METH_NOARGS, DOC_MASKFILL },
     { "clear", mask_clear, METH_NOARGS, DOC_MASKCLEAR },
     { "invert", mask_invert, METH_NOARGS, DOC_MASKINVERT },
@@ -1403,8 +1551,8 @@ static PyMethodDef mask_methods[] =
     { "convolve", mask_convolve, METH_VARARGS, DOC_MASKCONVOLVE },
     { "connected_component", mask_connected_component, METH_VARARGS,
       DOC_MASKCONNECTEDCOMPONENT },
-    { "connected_components", mask_connected_components, METH_VARARGS,
-      DOC_MASKCONNECTEDCOMPONENTS },
+    { "connected_components", (PyCFunction) mask_connected_components,
+      METH_VARARGS | METH_KEYWORDS, DOC_MASKCONNECTEDCOMPONENTS },
     { "get_bounding_rects", mask_get_bounding_rects, METH_NOARGS,
       DOC_MASKGETBOUNDINGRECTS },
 
@@ -1464,6 +1612,303 @@ static PyTypeObject PyMask_Type =
 };
 
 
+/* MaskWorld: sweep and prune over the bounding boxes of many masks.
+ * The items stay sorted by left edge from one query_pairs() to the next,
+ * so when things move a little between frames the insertion sort that
+ * puts them back in order is close to linear. Only pairs whose boxes
+ * overlap get to bitmask_overlap_pos.
+ */
+
+typedef struct {
+    PyObject *maskobj;          /* NULL for a free slot */
+    int x, y;
+    int next_free;
+} MaskWorldEntry;
+
+typedef struct {
+    int x0, y0, x1, y1;
+    int id;
+    bitmask_t *mask;
+} MaskWorldItem;
+
+typedef struct {
+    PyObject_HEAD
+    MaskWorldEntry *entries;    /* indexed by id */
+    MaskWorldItem *items;       /* live ids, sorted as of the last query */
+    int nslots;
+    int maxslots;
+    int nitems;
+    int free_slot;              /* head of the free slots, or -1 */
+} PyMaskWorldObject;
+
+static int maskworld_item_cmp(const void *a, const void *b)
+{
+    const MaskWorldItem *ia = (const MaskWorldItem *)a;
+    const MaskWorldItem *ib = (const MaskWorldItem *)b;
+
+    if (ia->x0 != ib->x0)
+        return ia->x0 < ib->x0 ? -1 : 1;
+    return ia->id - ib->id;
+}
+
+/* Insertion sort while the items are nearly in order, qsort once they
+   turn out not to be. */
+static void maskworld_sort(MaskWorldItem *items, int n)
+{
+    MaskWorldItem item;
+    long moves = 0, limit = 8L * n + 64;
+    int i, j;
+
+    for (i = 1; i < n; i++) {
+        item = items[i];
+        for (j = i; j > 0 && maskworld_item_cmp(&items[j - 1], &item) > 0;
+             j--)
+            items[j] = items[j - 1];
+        items[j] = item;
+        moves += i - j;
+        if (moves > limit) {
+            qsort(items, n, sizeof(MaskWorldItem), maskworld_item_cmp);
+            return;
+        }
+    }
+}
+
+static MaskWorldEntry* maskworld_entry(PyMaskWorldObject* self, int id)
+{
+    if (id < 0 || id >= self->nslots || self->entries[id].maskobj == NULL) {
+        PyErr_Format(PyExc_KeyError, "%d is not in the MaskWorld", id);
+        return NULL;
+    }
+    return &self->entries[id];
+}
+
+static PyObject* maskworld_add(PyMaskWorldObject* self, PyObject* args)
+{
+    PyObject *maskobj;
+    MaskWorldEntry *entries;
+    MaskWorldItem *items;
+    int x, y, id, maxslots;
+
+    if(!PyArg_ParseTuple(args, "O!(ii)", &PyMask_Type, &maskobj, &x, &y))
+        return NULL;
+
+    if (self->free_slot >= 0) {
+        id = self->free_slot;
+        self->free_slot = self->entries[id].next_free;
+    }
+    else {
+        if (self->nslots == self->maxslots) {
+            if (self->maxslots > INT_MAX / 2)
+                return PyErr_NoMemory();
+            maxslots = self->maxslots ? self->maxslots * 2 : 16;
+            entries = (MaskWorldEntry *)PyMem_Realloc(
+                self->entries, maxslots * sizeof(MaskWorldEntry));
+            if (entries == NULL)
+                return PyErr_NoMemory();
+            self->entries = entries;
+            items = (MaskWorldItem *)PyMem_Realloc(
+                self->items, maxslots * sizeof(MaskWorldItem));
+            if (items == NULL)
+                return PyErr_NoMemory();
+            self->items = items;
+            self->maxslots = maxslots;
+        }
+        id = self->nslots++;
+    }
+
+    Py_INCREF(maskobj);
+    self->entries[id].maskobj = maskobj;
+    self->entries[id].x = x;
+    self->entries[id].y = y;
+    /* the box is filled in by query_pairs, x0 is only a sort hint */
+    self->items[self->nitems].x0 = x;
+    self->items[self->nitems].id = id;
+    self->nitems++;
+    return PyInt_FromLong(id);
+}
+
+static PyObject* maskworld_move(PyMaskWorldObject* self, PyObject* args)
+{
+    MaskWorldEntry *entry;
+    int id, x, y;
+
+    if(!PyArg_ParseTuple(args, "i(ii)", &id, &x, &y))
+        return NULL;
+    entry = maskworld_entry(self, id);
+    if (entry == NULL)
+        return NULL;
+
+    entry->x = x;
+    entry->y = y;
+    Py_RETURN_NONE;
+}
+
+static PyObject* maskworld_remove(PyMaskWorldObject* self, PyObject* args)
+{
+    MaskWorldEntry *entry;
+    PyObject *maskobj;
+    int id, i;
+
+    if(!PyArg_ParseTuple(args, "i", &id))
+        return NULL;
+    entry = maskworld_entry(self, id);
+    if (entry == NULL)
+        return NULL;
+
+    for (i = 0; self->items[i].id != id; i++)
+        ;
+    memmove(self->items + i, self->items + i + 1,
+            (self->nitems - i - 1) * sizeof(MaskWorldItem));
+    self->nitems--;
+
+    maskobj = entry->maskobj;
+    entry->maskobj = NULL;
+    entry->next_free = self->free_slot;
+    self->free_slot = id;
+    Py_DECREF(maskobj);
+    Py_RETURN_NONE;
+}
+
+static PyObject* maskworld_query_pairs(PyMaskWorldObject* self)
+{
+    MaskWorldItem *items = self->items;
+    MaskWorldItem *a, *b;
+    MaskWorldEntry *entry;
+    PyObject *pairs, *pair;
+    int n = self->nitems;
+    int i, j, x, y;
+
+    for (i = 0; i < n; i++) {
+        entry = &self->entries[items[i].id];
+        items[i].mask = PyMask_AsBitmap(entry->maskobj);
+        items[i].x0 = entry->x;
+        items[i].y0 = entry->y;
+        items[i].x1 = entry->x + items[i].mask->w;
+        items[i].y1 = entry->y + items[i].mask->h;
+    }
+    maskworld_sort(items, n);
+
+    pairs = PyList_New(0);
+    if (pairs == NULL)
+        return NULL;
+    for (i = 0; i < n; i++) {
+        a = &items[i];
+        if (a->x0 == a->x1 || a->y0 == a->y1)
+            continue;
+        for (j = i + 1; j < n && items[j].x0 < a->x1; j++) {
+            b = &items[j];
+            if (b->y0 >= a->y1 || a->y0 >= b->y1 ||
+                b->x0 == b->x1 || b->y0 == b->y1)
+                continue;
+            if (!bitmask_overlap_pos(a->mask, b->mask, b->x0 - a->x0,
+                                     b->y0 - a->y0, &x, &y))
+                continue;
+            if (a->id < b->id)
+                pair = Py_BuildValue("(ii(ii))", a->id, b->id,
+                                     a->x0 + x, a->y0 + y);
+            else
+                pair = Py_BuildValue("(ii(ii))", b->id, a->id,
+                                     a->x0 + x, a->y0 + y);
+            if (pair == NULL || PyList_Append(pairs, pair)) {
+                Py_XDECREF(pair);
+                Py_DECREF(pairs);
+                return NULL;
+            }
+            Py_DECREF(pair);
+        }
+    }
+    return pairs;
+}
+
+static Py_ssize_t maskworld_length(PyMaskWorldObject* self)
+{
+    return self->nitems;
+}
+
+static PyMethodDef maskworld_methods[] =
+{
+    { "add", (PyCFunction)maskworld_add, METH_VARARGS, DOC_MASKWORLDADD },
+    { "move", (PyCFunction)maskworld_move, METH_VARARGS, DOC_MASKWORLDMOVE },
+    { "remove", (PyCFunction)maskworld_remove, METH_VARARGS,
+      DOC_MASKWORLDREMOVE },
+    { "query_pairs", (PyCFunction)maskworld_query_pairs, METH_NOARGS,
+      DOC_MASKWORLDQUERYPAIRS },
+    { NULL, NULL, 0, NULL }
+};
+
+static PySequenceMethods maskworld_as_sequence =
+{
+    (lenfunc)maskworld_length,          /* sq_length */
+};
+
+static PyObject* maskworld_new(PyTypeObject *type, PyObject *args,
+                               PyObject *kwds)
+{
+    PyMaskWorldObject *self;
+    static char *keywords[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, ":MaskWorld", keywords))
+        return NULL;
+    self = (PyMaskWorldObject *)type->tp_alloc(type, 0);
+    if (self)
+        self->free_slot = -1;
+    return (PyObject*)self;
+}
+
+static void maskworld_dealloc(PyMaskWorldObject* self)
+{
+    int i;
+
+    for (i = 0; i < self->nslots; i++)
+        Py_XDECREF(self->entries[i].maskobj);
+    PyMem_Free(self->entries);
+    PyMem_Free(self->items);
+    Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyTypeObject PyMaskWorld_Type =
+{
+    TYPE_HEAD (NULL, 0)
+    "pygame.mask.MaskWorld",            /* tp_name */
+    sizeof(PyMaskWorldObject),          /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)maskworld_dealloc,      /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_compare */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    &maskworld_as_sequence,             /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    DOC_PYGAMEMASKMASKWORLD,            /* Documentation string */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    maskworld_methods,                  /* tp_methods */
+    0,                                  /* tp_members */
+    0,                                  /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    0,                                  /* tp_init */
+    0,                                  /* tp_alloc */
+    maskworld_new,                      /* tp_new */
+};
+
+
 /*mask module methods*/
 
 static PyObject* Mask(PyObject* self, PyObject* args)
@@ -1537,6 +1982,12 @@ MODINIT_DEFINE (mask)
     if (PyType_Ready (&PyMask_Type) < 0) {
         MODINIT_ERROR;
     }
+    if (PyType_Ready (&PyMaskWorld_Type) < 0) {
+        MODINIT_ERROR;
+    }
+
+    /* pick the overlap and overlap_area stripe functions for this cpu */
+    bitmask_simd_init ();
 
     /* create the module */
 #if PY3
@@ -1553,6 +2004,11 @@ MODINIT_DEFINE (mask)
         DECREF_MOD(module);
         MODINIT_ERROR;
     }
+    if (PyDict_SetItemString (dict, "MaskWorld",
+                              (PyObject *)&PyMaskWorld_Type) == -1) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
     /* export the c api */
     c_api[0] = &PyMask_Type;
     apiobj = encapsulate_api (c_api, "mask");
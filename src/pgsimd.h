@@ -0,0 +1,83 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/* Compiler and CPU feature macros shared by the SIMD code of several
+ * modules.
+ *
+ * PG_SIMD_X86, PG_SIMD_AVX2 and PG_SIMD_NEON are defined when the compiler
+ * can build SSE2, AVX2 and NEON code, and SDL can tell at runtime whether
+ * the CPU has it. Functions using SSE2 or AVX2 intrinsics are marked with
+ * PG_TARGET_SSE2 or PG_TARGET_AVX2, so only they need the instructions.
+ */
+
+#ifndef PGSIMD_H
+#define PGSIMD_H
+
+#include <SDL.h>
+
+/* Define INLINE for different compilers. */
+#ifndef INLINE
+# ifdef __GNUC__
+#  define INLINE inline
+# else
+#  ifdef _MSC_VER
+#   define INLINE __inline
+#  else
+#   define INLINE
+#  endif
+# endif
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PG_SIMD_X86
+#define PG_TARGET_SSE2 __attribute__((target("sse2")))
+#define PG_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define PG_SIMD_X86
+#define PG_TARGET_SSE2
+#define PG_TARGET_AVX2
+#endif
+
+#if defined(PG_SIMD_X86) && SDL_VERSION_ATLEAST(2, 0, 4)
+#define PG_SIMD_AVX2
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+    SDL_VERSION_ATLEAST(2, 0, 6)
+#define PG_SIMD_NEON
+#endif
+
+/* The number of bits set in x */
+static INLINE int
+pg_popcount32 (Uint32 x)
+{
+#ifdef __GNUC__
+    return __builtin_popcount (x);
+#else
+    x = x - ((x >> 1) & 0x55555555);
+    x = (x & 0x33333333) + ((x >> 2) & 0x33333333);
+    x = (x + (x >> 4)) & 0x0f0f0f0f;
+    return (int) ((x * 0x01010101) >> 24);
+#endif
+}
+
+#endif /* PGSIMD_H */
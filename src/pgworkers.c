@@ -0,0 +1,228 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+#include "pgworkers.h"
+
+/* Configuration, only changed with the GIL held */
+static int workers_wanted = 0;
+static int workers_min_pixels = PG_WORKERS_MIN_PIXELS;
+
+/* pool_run_lock lets one job at a time use the pool, and guards pool_size.
+ * pool_lock guards the job fields and pool_quit. Both locks are created
+ * once and never freed, so they are safe to use without the GIL.
+ */
+static SDL_mutex *pool_run_lock = NULL;
+static SDL_mutex *pool_lock = NULL;
+static SDL_cond *pool_wake = NULL;
+static SDL_cond *pool_done = NULL;
+static SDL_Thread *pool_threads[PG_WORKERS_MAX];
+static int pool_size = 0;
+static int pool_quit = 0;
+
+static PgWorkersBandFunc job_func = NULL;
+static void *job_data = NULL;
+static int job_height = 0;
+static int job_nbands = 0;
+static int job_next = 0;
+static int job_pending = 0;
+
+static int
+workers_count (void)
+{
+    int n = workers_wanted;
+
+    if (n <= 0) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+        n = SDL_GetCPUCount ();
+#else
+        n = 1;
+#endif
+    }
+    if (n < 1)
+        n = 1;
+    if (n > PG_WORKERS_MAX)
+        n = PG_WORKERS_MAX;
+    return n;
+}
+
+/* Hand out bands of the current job until none are left. Called, and
+ * returns, with pool_lock held.
+ */
+static void
+workers_take_bands (void)
+{
+    PgWorkersBandFunc func;
+    void *data;
+    int band, first, end;
+
+    while (job_next < job_nbands) {
+        band = job_next++;
+        first = (int) ((long long) job_height * band / job_nbands);
+        end = (int) ((long long) job_height * (band + 1) / job_nbands);
+        func = job_func;
+        data = job_data;
+
+        SDL_UnlockMutex (pool_lock);
+        if (end > first)
+            func (data, first, end - first);
+        SDL_LockMutex (pool_lock);
+
+        if (--job_pending == 0)
+            SDL_CondSignal (pool_done);
+    }
+}
+
+static int
+workers_thread (void *unused)
+{
+    SDL_LockMutex (pool_lock);
+    for (;;) {
+        while (!pool_quit && job_next >= job_nbands)
+            SDL_CondWait (pool_wake, pool_lock);
+        if (pool_quit)
+            break;
+        workers_take_bands ();
+    }
+    SDL_UnlockMutex (pool_lock);
+    return 0;
+}
+
+/* Make sure nthreads worker threads are running. Returns 0 if none could
+ * be started.
+ */
+static int
+workers_start (int nthreads)
+{
+    SDL_Thread *thread;
+
+    if (!pool_run_lock) {
+        pool_run_lock = SDL_CreateMutex ();
+        pool_lock = SDL_CreateMutex ();
+        pool_wake = SDL_CreateCond ();
+        pool_done = SDL_CreateCond ();
+    }
+    if (!pool_run_lock || !pool_lock || !pool_wake || !pool_done)
+        return 0;
+
+    SDL_LockMutex (pool_run_lock);
+    while (pool_size < nthreads) {
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+        thread = SDL_CreateThread (workers_thread, "pygame worker", NULL);
+#else
+        thread = SDL_CreateThread (workers_thread, NULL);
+#endif
+        if (!thread)
+            break;
+        pool_threads[pool_size++] = thread;
+    }
+    nthreads = pool_size;
+    SDL_UnlockMutex (pool_run_lock);
+    return nthreads > 0;
+}
+
+void
+pg_workers_quit (void)
+{
+    int i;
+
+    if (!pool_run_lock || !pool_lock)
+        return;
+
+    SDL_LockMutex (pool_run_lock);
+    if (pool_size) {
+        SDL_LockMutex (pool_lock);
+        pool_quit = 1;
+        SDL_CondBroadcast (pool_wake);
+        SDL_UnlockMutex (pool_lock);
+
+        for (i = 0; i < pool_size; ++i)
+            SDL_WaitThread (pool_threads[i], NULL);
+        pool_size = 0;
+
+        SDL_LockMutex (pool_lock);
+        pool_quit = 0;
+        SDL_UnlockMutex (pool_lock);
+    }
+    SDL_UnlockMutex (pool_run_lock);
+}
+
+void
+pg_workers_configure (int nthreads, int min_pixels)
+{
+    pg_workers_quit ();
+    workers_wanted = nthreads < 0 ? 0 : nthreads;
+    workers_min_pixels = min_pixels < 0 ? 0 : min_pixels;
+}
+
+void
+pg_workers_get_config (int *nthreads, int *min_pixels)
+{
+    *nthreads = workers_count ();
+    *min_pixels = workers_min_pixels;
+}
+
+int
+pg_workers_bands (int width, int height)
+{
+    int n = workers_count ();
+
+    if (n < 2 || height < 2 ||
+        (long long) width * height < (long long) workers_min_pixels)
+        return 1;
+    if (!workers_start (n - 1))
+        return 1;
+    return n < height ? n : height;
+}
+
+void
+pg_workers_run (PgWorkersBandFunc func, void *job, int height, int nbands)
+{
+    if (nbands < 2 || !pool_run_lock) {
+        func (job, 0, height);
+        return;
+    }
+
+    SDL_LockMutex (pool_run_lock);
+    if (!pool_size) {
+        /* The pool was stopped after the bands were counted */
+        func (job, 0, height);
+        SDL_UnlockMutex (pool_run_lock);
+        return;
+    }
+
+    SDL_LockMutex (pool_lock);
+    job_func = func;
+    job_data = job;
+    job_height = height;
+    job_nbands = nbands;
+    job_next = 0;
+    job_pending = nbands;
+    SDL_CondBroadcast (pool_wake);
+
+    workers_take_bands ();
+    while (job_pending)
+        SDL_CondWait (pool_done, pool_lock);
+    job_func = NULL;
+    job_data = NULL;
+    SDL_UnlockMutex (pool_lock);
+    SDL_UnlockMutex (pool_run_lock);
+}
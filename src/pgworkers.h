@@ -0,0 +1,75 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/* A small pool of worker threads for splitting pixel loops into row bands.
+ *
+ * The pool is started on first use and sized by pg_workers_configure. The
+ * caller decides how many bands a job gets with pg_workers_bands, which
+ * must be called with the GIL held, then runs it with pg_workers_run, which
+ * may be called with the GIL released. Band functions must not touch any
+ * Python object.
+ */
+
+#ifndef PGWORKERS_H
+#define PGWORKERS_H
+
+#include <SDL.h>
+
+/* Upper limit on the number of threads working on one job */
+#define PG_WORKERS_MAX 64
+
+/* Default smallest job, in pixels, that is split across threads */
+#define PG_WORKERS_MIN_PIXELS 65536
+
+/* Process rows [first, first + count) of job. */
+typedef void (*PgWorkersBandFunc) (void *job, int first, int count);
+
+/* Set the number of threads, 0 for one per CPU and 1 to run everything
+ * on the calling thread, and the smallest job in pixels worth splitting.
+ * Running workers are stopped; the pool restarts on the next big job.
+ */
+void
+pg_workers_configure (int nthreads, int min_pixels);
+
+/* Get the thread count in use, after resolving 0 to the CPU count, and
+ * the pixel threshold.
+ */
+void
+pg_workers_get_config (int *nthreads, int *min_pixels);
+
+/* Return how many row bands a width by height job should be split into.
+ * 1 means run it directly on the calling thread.
+ */
+int
+pg_workers_bands (int width, int height);
+
+/* Run func over rows [0, height) in nbands bands and wait for them all.
+ * The calling thread takes bands too.
+ */
+void
+pg_workers_run (PgWorkersBandFunc func, void *job, int height, int nbands);
+
+/* Stop and join the worker threads. */
+void
+pg_workers_quit (void);
+
+#endif /* PGWORKERS_H */
@@ -29,6 +29,9 @@
 #if !defined(SCALE_HEADER)
 #define SCALE_HEADER
 
+#include <stdlib.h>
+#include "pgsimd.h"
+
 #if (defined(__GNUC__) && ((defined(__x86_64__) && !defined(_NO_MMX_FOR_X86_64)) || defined(__i386__))) || (defined(MS_WIN32) && !(defined(_M_X64) && defined(_NO_MMX_FOR_X86_64)))
 #define SCALE_MMX_SUPPORT
 
@@ -70,4 +73,148 @@ void filter_expand_X_SSE_gcc(Uint8 *srcpix, Uint8 *dstpix, int *xidx0, int *xmul
 
 #endif /* #if (defined(__GNUC__) && .....) */
 
+/* Intrinsic versions of the filters, in scale_simd.c. They give the same
+ * results as the C filters in transform.c.
+ */
+#if defined(PG_SIMD_X86)
+void filter_shrink_X_SSE2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int srcwidth, int dstwidth);
+
+void filter_shrink_Y_SSE2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int srcheight, int dstheight);
+
+void filter_expand_X_SSE2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int srcwidth, int dstwidth);
+
+void filter_expand_Y_SSE2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int srcheight, int dstheight);
+
+void filter_halve_SSE2(Uint8 *srcpix, Uint8 *dstpix, int srcpitch, int dstpitch, int dstwidth, int dstheight);
+
+int threshold_row_SSE2(Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix, int width, Uint32 color, Uint32 threshold, int change_return, int inverse);
+
+void accumulate_add_SSE2(Uint32 *acc, Uint8 *src, int count);
+
+void accumulate_sub_SSE2(Uint32 *acc, Uint8 *src, int count);
+
+void accumulate_ema_SSE2(float *acc, Uint8 *src, int count, float alpha);
+
+void filter_blur_X_SSE2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int width, int radius);
+
+void filter_blur_Y_SSE2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int height, int radius);
+
+void flip_row_SSE2(Uint8 *row, int width, int bpp);
+#endif /* #if defined(PG_SIMD_X86) */
+
+#if defined(PG_SIMD_AVX2)
+void filter_shrink_X_AVX2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int srcwidth, int dstwidth);
+
+void filter_shrink_Y_AVX2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int srcheight, int dstheight);
+
+void filter_expand_X_AVX2(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int srcwidth, int dstwidth);
+
+void filter_expand_Y_AVX2(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int srcheight, int dstheight);
+
+int threshold_row_AVX2(Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix, int width, Uint32 color, Uint32 threshold, int change_return, int inverse);
+#endif /* #if defined(PG_SIMD_AVX2) */
+
+#if defined(PG_SIMD_NEON)
+void filter_shrink_X_NEON(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int srcwidth, int dstwidth);
+
+void filter_shrink_Y_NEON(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int srcheight, int dstheight);
+
+void filter_expand_X_NEON(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int srcwidth, int dstwidth);
+
+void filter_expand_Y_NEON(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int srcheight, int dstheight);
+
+void filter_halve_NEON(Uint8 *srcpix, Uint8 *dstpix, int srcpitch, int dstpitch, int dstwidth, int dstheight);
+
+int threshold_row_NEON(Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix, int width, Uint32 color, Uint32 threshold, int change_return, int inverse);
+
+void accumulate_add_NEON(Uint32 *acc, Uint8 *src, int count);
+
+void accumulate_sub_NEON(Uint32 *acc, Uint8 *src, int count);
+
+void accumulate_ema_NEON(float *acc, Uint8 *src, int count, float alpha);
+
+void filter_blur_X_NEON(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int width, int radius);
+
+void filter_blur_Y_NEON(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int height, int radius);
+
+void flip_row_NEON(Uint8 *row, int width, int bpp);
+#endif /* #if defined(PG_SIMD_NEON) */
+
+/* The accumulate functions, for transform.Accumulator, add count bytes
+ * to or take them from as many Uint32 sums, or move as many floats the
+ * fraction alpha of the way to the bytes. The tails are done by
+ * ACCUMULATE_TAIL with OP one of the three below.
+ */
+#define ACCUMULATE_ADD(i) (acc[i] += src[i])
+#define ACCUMULATE_SUB(i) (acc[i] -= src[i])
+#define ACCUMULATE_EMA(i) (acc[i] += (src[i] - acc[i]) * alpha)
+
+#define ACCUMULATE_TAIL(i, OP)                                          \
+    for (; i < count; i++)                                              \
+        OP (i);
+
+/* The blur filters average each byte of a 32 bit pixel with the same
+ * byte of the radius pixels either side of it, along a row for X or
+ * down a column for Y, repeating the edge pixels. They keep running sums,
+ * so the radius does not change the work per pixel, and divide them by
+ * 2 * radius + 1 with BLUR_OUT, which rounds to nearest.
+ */
+#define BLUR_RECIP(radius) (0x1000000U / ((Uint32) (radius) * 2 + 1))
+#define BLUR_OUT(sum, recip) ((Uint8) (((sum) * (recip) + 0x800000) >> 24))
+
+/* The threshold_row functions do one row of transform.threshold for 32
+ * bit pixels with 8 bit channels. A pixel matches when each of its bytes
+ * is within the byte of threshold of the same byte of color, or of cmppix
+ * if not NULL; threshold has 0xff for bytes not compared. Where a pixel
+ * matches, or does not with inverse, dstpix gets color when change_return
+ * is 1 or the pixel when it is 2. They return the number of matches.
+ * threshold_pixel and THRESHOLD_ROW_TAIL are the C version, one pixel at
+ * a time.
+ */
+#define THRESHOLD_BYTE(a, b, t, i)                                      \
+    (abs ((int) (((a) >> (i)) & 0xff) - (int) (((b) >> (i)) & 0xff)) <=  \
+     (int) (((t) >> (i)) & 0xff))
+
+static INLINE int
+threshold_pixel(Uint32 pixel, Uint32 other, Uint32 threshold)
+{
+    return (THRESHOLD_BYTE (pixel, other, threshold, 0) &
+            THRESHOLD_BYTE (pixel, other, threshold, 8) &
+            THRESHOLD_BYTE (pixel, other, threshold, 16) &
+            THRESHOLD_BYTE (pixel, other, threshold, 24));
+}
+
+#define THRESHOLD_ROW_TAIL(x)                                           \
+    for (; x < width; x++) {                                            \
+        if (threshold_pixel (srcpix[x], cmppix ? cmppix[x] : color,     \
+                             threshold) ^ inverse) {                    \
+            if (change_return == 2)                                     \
+                dstpix[x] = srcpix[x];                                  \
+            else if (change_return == 1)                                \
+                dstpix[x] = color;                                      \
+            similar++;                                                  \
+        }                                                               \
+    }
+
+/* The flip_row functions reverse the order of the width pixels of row in
+ * place, for transform.flip_ip. flip_row_tail swaps the pixels between
+ * left and right, from the outside in.
+ */
+static INLINE void
+flip_row_tail(Uint8 *left, Uint8 *right, int bpp)
+{
+    Uint8 t;
+    int i;
+
+    while (right - left >= 2 * bpp) {
+        right -= bpp;
+        for (i = 0; i < bpp; i++) {
+            t = left[i];
+            left[i] = right[i];
+            right[i] = t;
+        }
+        left += bpp;
+    }
+}
+
 #endif /* #if !defined(SCALE_HEADER) */
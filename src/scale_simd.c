@@ -0,0 +1,1144 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+  Copyright (C) 2007  Rene Dudfield, Richard Goedeken
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/* Intrinsic smoothscale filters for SSE2, AVX2 and NEON.
+ *
+ * These give exactly the results of the filter_*_ONLYC functions in
+ * transform.c. The bytes of a row, widened to 16 bits, are worked on a
+ * vector at a time, except by filter_shrink_X, whose running sums go
+ * along a row: it does several rows at once instead, as every row of an
+ * image has the same pattern of sums. The products of the filters have
+ * up to 24 bits; the X and Y expand filters get them from the high and
+ * low 16 bit halves, adding the carry out of the low halves.
+ *
+ * filter_halve, the 2x2 box filter of transform.build_pyramid, the box
+ * blur filters, the 32 bit rows of transform.threshold, the sums of
+ * transform.Accumulator and the row reversal of transform.flip_ip are
+ * here too.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "scale.h"
+
+#ifdef PG_SIMD_X86
+#include <immintrin.h>
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_NEON
+#include <arm_neon.h>
+#endif /* PG_SIMD_NEON */
+
+/* Each ISA below defines, for a VEC of V_BYTES 16 bit lanes:
+ *
+ *   V_LOADB(p), V_STOREB(p, v)   V_BYTES bytes to and from lanes
+ *   V_LOADW(p), V_STOREW(p, v)   V_BYTES Uint16 to and from lanes
+ *   V_ADD(a, b)                  a + b, wrapping like Uint16
+ *   V_SETW(c)                    c in every lane
+ *   V_MULHI(v, c)                (v * c) >> 16, c < 0x10000
+ *   V_LERP(a, b, m0, m1, f)      (a * m0 + b * m1) >> 16, with m0 of
+ *                                0x10000 given as 0 and f all ones
+ *   V_SHRINKOUT(acc, t, recip)   (Uint8) (((acc + t) * recip) >> 16)
+ *   V_LOADPX(rows, x)            pixel x of each of V_BYTES / 4 rows
+ *   V_GATHER(a, b, row, idx)     pixels idx[i] and idx[i] + 1 of a row
+ */
+
+/* Area averaging shrink in X, V_BYTES / 4 rows at a time. A leftover
+ * row is read twice and written once. Like the C filter, a destination
+ * pixel is written each time the running sum passes a whole xspace, but
+ * no more than dstwidth of them.
+ */
+#define SHRINK_X_BODY                                                   \
+    int xspace = 0x10000 * srcwidth / dstwidth;                         \
+    int xrecip = (int) (0x100000000LL / xspace);                        \
+    Uint8 *rows[V_BYTES / 4], *dsts[V_BYTES / 4];                       \
+    Uint32 px[V_BYTES / 4];                                             \
+    int x, y, i, n, nrows, xcounter, xfrac;                             \
+    VEC acc, s, t;                                                      \
+                                                                        \
+    for (y = 0; y < height; y += V_BYTES / 4)                           \
+    {                                                                   \
+        nrows = height - y < V_BYTES / 4 ? height - y : V_BYTES / 4;    \
+        for (i = 0; i < V_BYTES / 4; i++)                               \
+        {                                                               \
+            rows[i] = srcpix + (y + (i < nrows ? i : 0)) * srcpitch;    \
+            dsts[i] = dstpix + (y + i) * dstpitch;                      \
+        }                                                               \
+        acc = V_SETW (0);                                               \
+        xcounter = xspace;                                              \
+        n = 0;                                                          \
+        for (x = 0; x < srcwidth; x++)                                  \
+        {                                                               \
+            s = V_LOADPX (rows, x);                                     \
+            if (xcounter > 0x10000)                                     \
+            {                                                           \
+                acc = V_ADD (acc, s);                                   \
+                xcounter -= 0x10000;                                    \
+                continue;                                               \
+            }                                                           \
+            xfrac = 0x10000 - xcounter;                                 \
+            if (n < dstwidth)                                           \
+            {                                                           \
+                t = xcounter == 0x10000 ? s : V_MULHI (s, V_SETW (xcounter)); \
+                V_STOREB ((Uint8 *) px, V_SHRINKOUT (acc, t, xrecip));  \
+                for (i = 0; i < nrows; i++)                             \
+                    ((Uint32 *) dsts[i])[n] = px[i];                    \
+                n++;                                                    \
+            }                                                           \
+            acc = V_MULHI (s, V_SETW (xfrac));                          \
+            xcounter = xspace - xfrac;                                  \
+        }                                                               \
+    }
+
+/* Area averaging shrink in Y, into no more than dstheight rows */
+#define SHRINK_Y_BODY                                                   \
+    int bytes = width * 4;                                              \
+    int yspace = 0x10000 * srcheight / dstheight;                       \
+    int yrecip = (int) (0x100000000LL / yspace);                        \
+    int ycounter = yspace;                                              \
+    int x, y, yfrac, n = 0;                                             \
+    Uint16 *templine;                                                   \
+    Uint8 *src, *dst;                                                   \
+    VEC s, t;                                                           \
+                                                                        \
+    templine = (Uint16 *) calloc (bytes, sizeof (Uint16));              \
+    if (templine == NULL)                                               \
+        return;                                                         \
+    for (y = 0; y < srcheight; y++)                                     \
+    {                                                                   \
+        src = srcpix + y * srcpitch;                                    \
+        if (ycounter > 0x10000)                                         \
+        {                                                               \
+            for (x = 0; x + V_BYTES <= bytes; x += V_BYTES)             \
+                V_STOREW (templine + x, V_ADD (V_LOADW (templine + x),  \
+                                               V_LOADB (src + x)));     \
+            for (; x < bytes; x++)                                      \
+                templine[x] += src[x];                                  \
+            ycounter -= 0x10000;                                        \
+            continue;                                                   \
+        }                                                               \
+        yfrac = 0x10000 - ycounter;                                     \
+        if (n < dstheight)                                              \
+        {                                                               \
+            dst = dstpix + n * dstpitch;                                \
+            for (x = 0; x + V_BYTES <= bytes; x += V_BYTES)             \
+            {                                                           \
+                s = V_LOADB (src + x);                                  \
+                t = ycounter == 0x10000 ? s : V_MULHI (s, V_SETW (ycounter)); \
+                V_STOREB (dst + x, V_SHRINKOUT (V_LOADW (templine + x), \
+                                                t, yrecip));            \
+            }                                                           \
+            for (; x < bytes; x++)                                      \
+                dst[x] = (Uint8) (((templine[x] +                       \
+                                    ((src[x] * ycounter) >> 16)) *      \
+                                   yrecip) >> 16);                      \
+            n++;                                                        \
+        }                                                               \
+        for (x = 0; x + V_BYTES <= bytes; x += V_BYTES)                 \
+            V_STOREW (templine + x,                                     \
+                      V_MULHI (V_LOADB (src + x), V_SETW (yfrac)));     \
+        for (; x < bytes; x++)                                          \
+            templine[x] = (Uint16) ((src[x] * yfrac) >> 16);            \
+        ycounter = yspace - yfrac;                                      \
+    }                                                                   \
+    free (templine);
+
+/* Bilinear expand in X. The weights of each destination pixel are laid
+ * out per byte, so V_BYTES / 4 pixels take one vector load each. A
+ * pixel with no weight on its right neighbour does not read it, as a one
+ * pixel wide row has none.
+ */
+#define EXPAND_X_BODY                                                   \
+    int *xidx0;                                                         \
+    Uint16 *xmult0, *xmult1, *xfull;                                    \
+    Uint8 *srcrow, *dst, *src, *src1;                                   \
+    int x, y, i, xm1;                                                   \
+    VEC a, b;                                                           \
+                                                                        \
+    xidx0 = (int *) malloc (dstwidth * sizeof (int));                   \
+    xmult0 = (Uint16 *) malloc (dstwidth * 12 * sizeof (Uint16));       \
+    if (xidx0 == NULL || xmult0 == NULL)                                \
+    {                                                                   \
+        free (xidx0);                                                   \
+        free (xmult0);                                                  \
+        return;                                                         \
+    }                                                                   \
+    xmult1 = xmult0 + dstwidth * 4;                                     \
+    xfull = xmult1 + dstwidth * 4;                                      \
+    for (x = 0; x < dstwidth; x++)                                      \
+    {                                                                   \
+        xidx0[x] = x * (srcwidth - 1) / dstwidth;                       \
+        xm1 = 0x10000 * ((x * (srcwidth - 1)) % dstwidth) / dstwidth;   \
+        for (i = 0; i < 4; i++)                                         \
+        {                                                               \
+            xmult0[x * 4 + i] = (Uint16) (0x10000 - xm1);               \
+            xmult1[x * 4 + i] = (Uint16) xm1;                           \
+            xfull[x * 4 + i] = xm1 ? 0 : 0xffff;                        \
+        }                                                               \
+    }                                                                   \
+                                                                        \
+    for (y = 0; y < height; y++)                                        \
+    {                                                                   \
+        srcrow = srcpix + y * srcpitch;                                 \
+        dst = dstpix + y * dstpitch;                                    \
+        for (x = 0; srcwidth > 1 && x + V_BYTES / 4 <= dstwidth;        \
+             x += V_BYTES / 4)                                          \
+        {                                                               \
+            V_GATHER (a, b, srcrow, xidx0 + x);                         \
+            V_STOREB (dst + x * 4,                                      \
+                      V_LERP (a, b, V_LOADW (xmult0 + x * 4),           \
+                              V_LOADW (xmult1 + x * 4),                 \
+                              V_LOADW (xfull + x * 4)));                \
+        }                                                               \
+        for (; x < dstwidth; x++)                                       \
+        {                                                               \
+            src = srcrow + xidx0[x] * 4;                                \
+            xm1 = xmult1[x * 4];                                        \
+            src1 = xm1 ? src + 4 : src;                                 \
+            for (i = 0; i < 4; i++)                                     \
+                dst[x * 4 + i] = (Uint8) (((src[i] * (0x10000 - xm1)) + \
+                                           (src1[i] * xm1)) >> 16);     \
+        }                                                               \
+    }                                                                   \
+    free (xidx0);                                                       \
+    free (xmult0);
+
+/* Bilinear expand in Y */
+#define EXPAND_Y_BODY                                                   \
+    int bytes = width * 4;                                              \
+    int x, y, yidx0, ymult0, ymult1;                                    \
+    Uint8 *srcrow0, *srcrow1, *dst;                                     \
+    VEC m0, m1, f;                                                      \
+                                                                        \
+    for (y = 0; y < dstheight; y++)                                     \
+    {                                                                   \
+        yidx0 = y * (srcheight - 1) / dstheight;                        \
+        srcrow0 = srcpix + yidx0 * srcpitch;                            \
+        ymult1 = 0x10000 * ((y * (srcheight - 1)) % dstheight) / dstheight; \
+        srcrow1 = ymult1 ? srcrow0 + srcpitch : srcrow0;                \
+        dst = dstpix + y * dstpitch;                                    \
+        ymult0 = 0x10000 - ymult1;                                      \
+        m0 = V_SETW (ymult0 & 0xffff);                                  \
+        m1 = V_SETW (ymult1);                                           \
+        f = V_SETW (ymult1 ? 0 : 0xffff);                               \
+        for (x = 0; x + V_BYTES <= bytes; x += V_BYTES)                 \
+            V_STOREB (dst + x, V_LERP (V_LOADB (srcrow0 + x),           \
+                                       V_LOADB (srcrow1 + x),           \
+                                       m0, m1, f));                     \
+        for (; x < bytes; x++)                                          \
+            dst[x] = (Uint8) (((srcrow0[x] * ymult0) +                  \
+                               (srcrow1[x] * ymult1)) >> 16);           \
+    }
+
+/* 2x2 box filter halving, for transform.build_pyramid. STORE4 writes
+ * destination pixels x to x + 3.
+ */
+#define HALVE_BODY(STORE4)                                              \
+    Uint8 *src0, *src1, *dst;                                           \
+    int x, y, i;                                                        \
+                                                                        \
+    for (y = 0; y < dstheight; y++)                                     \
+    {                                                                   \
+        src0 = srcpix + y * 2 * srcpitch;                               \
+        src1 = src0 + srcpitch;                                         \
+        dst = dstpix + y * dstpitch;                                    \
+        for (x = 0; x + 4 <= dstwidth; x += 4)                          \
+            STORE4;                                                     \
+        for (; x < dstwidth; x++)                                       \
+        {                                                               \
+            for (i = 0; i < 4; i++)                                     \
+                dst[x * 4 + i] = (Uint8) ((src0[x * 8 + i] +            \
+                                           src0[x * 8 + i + 4] +        \
+                                           src1[x * 8 + i] +            \
+                                           src1[x * 8 + i + 4] + 2) >> 2); \
+        }                                                               \
+    }
+
+/* Box blur along each row, for filter_blur_X, and down each column, for
+ * filter_blur_Y, with the sums of a pixel's 4 bytes in one VEC32:
+ *
+ *   V32_LOADPX(p)                the 4 bytes at p in 32 bit lanes
+ *   V32_LOAD(p), V32_STORE(p, v) 4 Uint32 to and from lanes
+ *   V32_ADD(a, b), V32_SUB(a, b) a + b and a - b
+ *   V32_BLUROUT(v, recip)        BLUR_OUT of each lane, as a pixel
+ *
+ * The sums start with the first pixel radius + 1 times and the next
+ * radius ones, clamped to the last, then move along a pixel at a time.
+ */
+#define BLUR_X_BODY                                                     \
+    Uint32 recip = BLUR_RECIP (radius);                                 \
+    int x, y, k, last = width - 1;                                      \
+    Uint8 *src;                                                         \
+    Uint32 *dst;                                                        \
+    VEC32 acc, first;                                                   \
+                                                                        \
+    for (y = 0; y < height; y++)                                        \
+    {                                                                   \
+        src = srcpix + y * srcpitch;                                    \
+        dst = (Uint32 *) (dstpix + y * dstpitch);                       \
+        first = V32_LOADPX (src);                                       \
+        acc = first;                                                    \
+        for (k = 1; k <= radius; k++)                                   \
+            acc = V32_ADD (V32_ADD (acc, first),                        \
+                           V32_LOADPX (src + (k < last ? k : last) * 4)); \
+        for (x = 0; x < width; x++)                                     \
+        {                                                               \
+            dst[x] = V32_BLUROUT (acc, recip);                          \
+            k = x + radius + 1;                                         \
+            acc = V32_ADD (acc, V32_LOADPX (src + (k < last ? k : last) * 4)); \
+            k = x - radius;                                             \
+            acc = V32_SUB (acc, V32_LOADPX (src + (k > 0 ? k : 0) * 4)); \
+        }                                                               \
+    }
+
+#define BLUR_Y_BODY                                                     \
+    Uint32 recip = BLUR_RECIP (radius);                                 \
+    int x, y, k, last = height - 1;                                     \
+    Uint32 *sums;                                                       \
+    Uint8 *in, *out;                                                    \
+    Uint32 *dst;                                                        \
+    VEC32 acc;                                                          \
+                                                                        \
+    sums = (Uint32 *) malloc (width * 4 * sizeof (Uint32));             \
+    if (sums == NULL)                                                   \
+        return;                                                         \
+    for (x = 0; x < width; x++)                                         \
+        V32_STORE (sums + x * 4, V32_LOADPX (srcpix + x * 4));          \
+    for (k = 1; k <= radius; k++)                                       \
+    {                                                                   \
+        in = srcpix + (k < last ? k : last) * srcpitch;                 \
+        for (x = 0; x < width; x++)                                     \
+            V32_STORE (sums + x * 4,                                    \
+                       V32_ADD (V32_ADD (V32_LOAD (sums + x * 4),       \
+                                         V32_LOADPX (srcpix + x * 4)),  \
+                                V32_LOADPX (in + x * 4)));              \
+    }                                                                   \
+    for (y = 0; y < height; y++)                                        \
+    {                                                                   \
+        k = y + radius + 1;                                             \
+        in = srcpix + (k < last ? k : last) * srcpitch;                 \
+        k = y - radius;                                                 \
+        out = srcpix + (k > 0 ? k : 0) * srcpitch;                      \
+        dst = (Uint32 *) (dstpix + y * dstpitch);                       \
+        for (x = 0; x < width; x++)                                     \
+        {                                                               \
+            acc = V32_LOAD (sums + x * 4);                              \
+            dst[x] = V32_BLUROUT (acc, recip);                          \
+            acc = V32_SUB (V32_ADD (acc, V32_LOADPX (in + x * 4)),      \
+                           V32_LOADPX (out + x * 4));                   \
+            V32_STORE (sums + x * 4, acc);                              \
+        }                                                               \
+    }                                                                   \
+    free (sums);
+
+/* Reverse the pixels of a row 16 bytes from each end at a time, with
+ * V_REVERSE(v, bpp) reversing the pixels of one vector; 24 bit pixels do
+ * not fit one and are left to flip_row_tail.
+ */
+#define FLIP_ROW_BODY(VTYPE, LOAD, STORE)                               \
+    Uint8 *left = row, *right = row + width * bpp;                      \
+    VTYPE a, b;                                                         \
+                                                                        \
+    while (bpp != 3 && right - left >= 32)                              \
+    {                                                                   \
+        right -= 16;                                                    \
+        a = LOAD (left);                                                \
+        b = LOAD (right);                                               \
+        STORE (left, V_REVERSE (b, bpp));                               \
+        STORE (right, V_REVERSE (a, bpp));                              \
+        left += 16;                                                     \
+    }                                                                   \
+    flip_row_tail (left, right, bpp);
+
+#ifdef PG_SIMD_X86
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_lerp (__m128i a, __m128i b, __m128i m0, __m128i m1, __m128i f)
+{
+    __m128i lo0 = _mm_mullo_epi16 (a, m0);
+    __m128i lo1 = _mm_mullo_epi16 (b, m1);
+    __m128i hi = _mm_add_epi16 (_mm_mulhi_epu16 (a, m0),
+                                _mm_mulhi_epu16 (b, m1));
+    /* all ones where the low halves add up without a carry */
+    __m128i nocarry = _mm_cmpeq_epi16 (_mm_adds_epu16 (lo0, lo1),
+                                       _mm_add_epi16 (lo0, lo1));
+
+    hi = _mm_add_epi16 (hi, _mm_andnot_si128 (nocarry, _mm_set1_epi16 (1)));
+    return _mm_add_epi16 (hi, _mm_and_si128 (a, f));
+}
+
+/* Bits 16 to 23 of the 32 bit products v * r */
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_mul_byte2 (__m128i v, __m128i r)
+{
+    __m128i mask = _mm_set_epi32 (0, 0xff, 0, 0xff);
+    __m128i even = _mm_srli_epi64 (_mm_mul_epu32 (v, r), 16);
+    __m128i odd = _mm_srli_epi64 (_mm_mul_epu32 (_mm_srli_epi64 (v, 32), r),
+                                  16);
+
+    return _mm_or_si128 (_mm_and_si128 (even, mask),
+                         _mm_slli_epi64 (_mm_and_si128 (odd, mask), 32));
+}
+
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_shrink_out (__m128i acc, __m128i t, int recip)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i r = _mm_set1_epi32 (recip);
+    __m128i lo = _mm_add_epi32 (_mm_unpacklo_epi16 (acc, zero),
+                                _mm_unpacklo_epi16 (t, zero));
+    __m128i hi = _mm_add_epi32 (_mm_unpackhi_epi16 (acc, zero),
+                                _mm_unpackhi_epi16 (t, zero));
+
+    return _mm_packs_epi32 (sse2_mul_byte2 (lo, r), sse2_mul_byte2 (hi, r));
+}
+
+#define VEC __m128i
+#define V_BYTES 8
+#define V_LOADB(p)                                                      \
+    _mm_unpacklo_epi8 (_mm_loadl_epi64 ((__m128i *) (p)),               \
+                       _mm_setzero_si128 ())
+#define V_STOREB(p, v)                                                  \
+    _mm_storel_epi64 ((__m128i *) (p), _mm_packus_epi16 (v, v))
+#define V_LOADW(p) _mm_loadu_si128 ((__m128i *) (p))
+#define V_STOREW(p, v) _mm_storeu_si128 ((__m128i *) (p), v)
+#define V_ADD _mm_add_epi16
+#define V_SETW(c) _mm_set1_epi16 ((short) (c))
+#define V_MULHI _mm_mulhi_epu16
+#define V_LERP sse2_lerp
+#define V_SHRINKOUT sse2_shrink_out
+#define V_LOADPX(rows, x)                                               \
+    _mm_unpacklo_epi8 (_mm_unpacklo_epi32 (                             \
+        _mm_cvtsi32_si128 (((int *) (rows)[0])[x]),                     \
+        _mm_cvtsi32_si128 (((int *) (rows)[1])[x])),                    \
+        _mm_setzero_si128 ())
+#define V_GATHER(a, b, row, idx)                                        \
+    do {                                                                \
+        __m128i p0 = V_LOADB ((row) + (idx)[0] * 4);                    \
+        __m128i p1 = V_LOADB ((row) + (idx)[1] * 4);                    \
+        a = _mm_unpacklo_epi64 (p0, p1);                                \
+        b = _mm_unpackhi_epi64 (p0, p1);                                \
+    } while (0)
+
+PG_TARGET_SSE2 void
+filter_shrink_X_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int height,
+                      int srcpitch, int dstpitch, int srcwidth, int dstwidth)
+{
+    SHRINK_X_BODY
+}
+
+PG_TARGET_SSE2 void
+filter_shrink_Y_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int width,
+                      int srcpitch, int dstpitch, int srcheight, int dstheight)
+{
+    SHRINK_Y_BODY
+}
+
+PG_TARGET_SSE2 void
+filter_expand_X_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int height,
+                      int srcpitch, int dstpitch, int srcwidth, int dstwidth)
+{
+    EXPAND_X_BODY
+}
+
+PG_TARGET_SSE2 void
+filter_expand_Y_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int width,
+                      int srcpitch, int dstpitch, int srcheight, int dstheight)
+{
+    EXPAND_Y_BODY
+}
+
+/* The rounded 2x2 averages of the 4 pixels at src0 and src1 */
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_halve (Uint8 *src0, Uint8 *src1)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i a = _mm_loadu_si128 ((__m128i *) src0);
+    __m128i b = _mm_loadu_si128 ((__m128i *) src1);
+    __m128i lo = _mm_add_epi16 (_mm_unpacklo_epi8 (a, zero),
+                                _mm_unpacklo_epi8 (b, zero));
+    __m128i hi = _mm_add_epi16 (_mm_unpackhi_epi8 (a, zero),
+                                _mm_unpackhi_epi8 (b, zero));
+    __m128i sum = _mm_add_epi16 (_mm_unpacklo_epi64 (lo, hi),
+                                 _mm_unpackhi_epi64 (lo, hi));
+
+    return _mm_srli_epi16 (_mm_add_epi16 (sum, _mm_set1_epi16 (2)), 2);
+}
+
+PG_TARGET_SSE2 void
+filter_halve_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int srcpitch, int dstpitch,
+                   int dstwidth, int dstheight)
+{
+    HALVE_BODY (_mm_storeu_si128 ((__m128i *) (dst + x * 4),
+                                  _mm_packus_epi16 (
+                                      sse2_halve (src0 + x * 8,
+                                                  src1 + x * 8),
+                                      sse2_halve (src0 + x * 8 + 16,
+                                                  src1 + x * 8 + 16))))
+}
+
+/* transform.threshold for the 4 pixels at src, compared with color when
+ * there is no cmp row. Returns the number of matches.
+ */
+PG_TARGET_SSE2 static INLINE int
+sse2_threshold (Uint32 *src, Uint32 *cmp, Uint32 *dst, __m128i color,
+                __m128i t, __m128i inv, int change_return)
+{
+    __m128i a = _mm_loadu_si128 ((__m128i *) src);
+    __m128i b = cmp ? _mm_loadu_si128 ((__m128i *) cmp) : color;
+    __m128i d = _mm_or_si128 (_mm_subs_epu8 (a, b), _mm_subs_epu8 (b, a));
+    __m128i m = _mm_xor_si128 (_mm_cmpeq_epi32 (_mm_subs_epu8 (d, t),
+                                                _mm_setzero_si128 ()), inv);
+
+    if (change_return)
+    {
+        __m128i v = change_return == 2 ? a : color;
+        __m128i old = _mm_loadu_si128 ((__m128i *) dst);
+
+        _mm_storeu_si128 ((__m128i *) dst,
+                          _mm_or_si128 (_mm_and_si128 (m, v),
+                                        _mm_andnot_si128 (m, old)));
+    }
+    return pg_popcount32 (_mm_movemask_ps (_mm_castsi128_ps (m)));
+}
+
+PG_TARGET_SSE2 int
+threshold_row_SSE2 (Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix,
+                    int width, Uint32 color, Uint32 threshold,
+                    int change_return, int inverse)
+{
+    __m128i colorv = _mm_set1_epi32 ((int) color);
+    __m128i t = _mm_set1_epi32 ((int) threshold);
+    __m128i inv = _mm_set1_epi32 (inverse ? -1 : 0);
+    int x, similar = 0;
+
+    for (x = 0; x + 4 <= width; x += 4)
+        similar += sse2_threshold (srcpix + x, cmppix ? cmppix + x : NULL,
+                                   dstpix + x, colorv, t, inv,
+                                   change_return);
+    THRESHOLD_ROW_TAIL (x)
+    return similar;
+}
+
+/* The 16 bytes at src widened to 4 vectors of 32 bit lanes */
+#define SSE2_WIDEN(src, w)                                              \
+    do {                                                                \
+        __m128i zero = _mm_setzero_si128 ();                            \
+        __m128i b = _mm_loadu_si128 ((__m128i *) (src));                \
+        __m128i lo = _mm_unpacklo_epi8 (b, zero);                       \
+        __m128i hi = _mm_unpackhi_epi8 (b, zero);                       \
+        w[0] = _mm_unpacklo_epi16 (lo, zero);                           \
+        w[1] = _mm_unpackhi_epi16 (lo, zero);                           \
+        w[2] = _mm_unpacklo_epi16 (hi, zero);                           \
+        w[3] = _mm_unpackhi_epi16 (hi, zero);                           \
+    } while (0)
+
+PG_TARGET_SSE2 void
+accumulate_add_SSE2 (Uint32 *acc, Uint8 *src, int count)
+{
+    __m128i w[4];
+    int i, j;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        SSE2_WIDEN (src + i, w);
+        for (j = 0; j < 4; j++)
+            _mm_storeu_si128 ((__m128i *) (acc + i + j * 4),
+                              _mm_add_epi32 (_mm_loadu_si128 (
+                                                 (__m128i *) (acc + i + j * 4)),
+                                             w[j]));
+    }
+    ACCUMULATE_TAIL (i, ACCUMULATE_ADD)
+}
+
+PG_TARGET_SSE2 void
+accumulate_sub_SSE2 (Uint32 *acc, Uint8 *src, int count)
+{
+    __m128i w[4];
+    int i, j;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        SSE2_WIDEN (src + i, w);
+        for (j = 0; j < 4; j++)
+            _mm_storeu_si128 ((__m128i *) (acc + i + j * 4),
+                              _mm_sub_epi32 (_mm_loadu_si128 (
+                                                 (__m128i *) (acc + i + j * 4)),
+                                             w[j]));
+    }
+    ACCUMULATE_TAIL (i, ACCUMULATE_SUB)
+}
+
+PG_TARGET_SSE2 void
+accumulate_ema_SSE2 (float *acc, Uint8 *src, int count, float alpha)
+{
+    __m128 va = _mm_set1_ps (alpha);
+    __m128i w[4];
+    __m128 a;
+    int i, j;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        SSE2_WIDEN (src + i, w);
+        for (j = 0; j < 4; j++)
+        {
+            a = _mm_loadu_ps (acc + i + j * 4);
+            a = _mm_add_ps (a, _mm_mul_ps (_mm_sub_ps (_mm_cvtepi32_ps (w[j]),
+                                                       a), va));
+            _mm_storeu_ps (acc + i + j * 4, a);
+        }
+    }
+    ACCUMULATE_TAIL (i, ACCUMULATE_EMA)
+}
+
+/* The 4 bytes at p widened to 32 bit lanes */
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_loadpx (Uint8 *p)
+{
+    __m128i zero = _mm_setzero_si128 ();
+
+    return _mm_unpacklo_epi16 (_mm_unpacklo_epi8 (
+                                   _mm_cvtsi32_si128 (*(int *) p), zero),
+                               zero);
+}
+
+/* BLUR_OUT of the 4 lanes of acc, from 64 bit products, packed back into
+ * a pixel
+ */
+PG_TARGET_SSE2 static INLINE Uint32
+sse2_blur_out (__m128i acc, Uint32 recip)
+{
+    __m128i r = _mm_set1_epi32 ((int) recip);
+    __m128i half = _mm_set_epi32 (0, 0x800000, 0, 0x800000);
+    __m128i even = _mm_srli_epi64 (_mm_add_epi64 (_mm_mul_epu32 (acc, r),
+                                                  half), 24);
+    __m128i odd = _mm_srli_epi64 (_mm_add_epi64 (
+                                      _mm_mul_epu32 (_mm_srli_epi64 (acc, 32),
+                                                     r), half), 24);
+    __m128i v = _mm_or_si128 (even, _mm_slli_epi64 (odd, 32));
+
+    v = _mm_packs_epi32 (v, v);
+    return (Uint32) _mm_cvtsi128_si32 (_mm_packus_epi16 (v, v));
+}
+
+#define VEC32 __m128i
+#define V32_LOADPX sse2_loadpx
+#define V32_LOAD(p) _mm_loadu_si128 ((__m128i *) (p))
+#define V32_STORE(p, v) _mm_storeu_si128 ((__m128i *) (p), v)
+#define V32_ADD _mm_add_epi32
+#define V32_SUB _mm_sub_epi32
+#define V32_BLUROUT sse2_blur_out
+
+PG_TARGET_SSE2 void
+filter_blur_X_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int height,
+                    int srcpitch, int dstpitch, int width, int radius)
+{
+    BLUR_X_BODY
+}
+
+PG_TARGET_SSE2 void
+filter_blur_Y_SSE2 (Uint8 *srcpix, Uint8 *dstpix, int width,
+                    int srcpitch, int dstpitch, int height, int radius)
+{
+    BLUR_Y_BODY
+}
+
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_reverse (__m128i v, int bpp)
+{
+    v = _mm_shuffle_epi32 (v, 0x1b);
+    if (bpp < 4)
+        v = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (v, 0xb1), 0xb1);
+    if (bpp < 2)
+        v = _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+    return v;
+}
+
+#define V_REVERSE sse2_reverse
+#define SSE2_LOADU(p) _mm_loadu_si128 ((__m128i *) (p))
+#define SSE2_STOREU(p, v) _mm_storeu_si128 ((__m128i *) (p), v)
+
+PG_TARGET_SSE2 void
+flip_row_SSE2 (Uint8 *row, int width, int bpp)
+{
+    FLIP_ROW_BODY (__m128i, SSE2_LOADU, SSE2_STOREU)
+}
+
+#undef V_REVERSE
+#undef SSE2_LOADU
+#undef SSE2_STOREU
+
+#undef VEC
+#undef V_BYTES
+#undef V_LOADB
+#undef V_STOREB
+#undef V_LOADW
+#undef V_STOREW
+#undef V_ADD
+#undef V_SETW
+#undef V_MULHI
+#undef V_LERP
+#undef V_SHRINKOUT
+#undef V_LOADPX
+#undef V_GATHER
+#undef VEC32
+#undef V32_LOADPX
+#undef V32_LOAD
+#undef V32_STORE
+#undef V32_ADD
+#undef V32_SUB
+#undef V32_BLUROUT
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+PG_TARGET_AVX2 static INLINE __m256i
+avx2_lerp (__m256i a, __m256i b, __m256i m0, __m256i m1, __m256i f)
+{
+    __m256i lo0 = _mm256_mullo_epi16 (a, m0);
+    __m256i lo1 = _mm256_mullo_epi16 (b, m1);
+    __m256i hi = _mm256_add_epi16 (_mm256_mulhi_epu16 (a, m0),
+                                   _mm256_mulhi_epu16 (b, m1));
+    __m256i nocarry = _mm256_cmpeq_epi16 (_mm256_adds_epu16 (lo0, lo1),
+                                          _mm256_add_epi16 (lo0, lo1));
+
+    hi = _mm256_add_epi16 (hi, _mm256_andnot_si256 (nocarry,
+                                                    _mm256_set1_epi16 (1)));
+    return _mm256_add_epi16 (hi, _mm256_and_si256 (a, f));
+}
+
+PG_TARGET_AVX2 static INLINE __m256i
+avx2_shrink_out (__m256i acc, __m256i t, int recip)
+{
+    __m256i r = _mm256_set1_epi32 (recip);
+    __m256i mask = _mm256_set1_epi32 (0xff);
+    __m256i lo = _mm256_add_epi32 (
+        _mm256_cvtepu16_epi32 (_mm256_castsi256_si128 (acc)),
+        _mm256_cvtepu16_epi32 (_mm256_castsi256_si128 (t)));
+    __m256i hi = _mm256_add_epi32 (
+        _mm256_cvtepu16_epi32 (_mm256_extracti128_si256 (acc, 1)),
+        _mm256_cvtepu16_epi32 (_mm256_extracti128_si256 (t, 1)));
+
+    lo = _mm256_and_si256 (_mm256_srli_epi32 (_mm256_mullo_epi32 (lo, r), 16),
+                           mask);
+    hi = _mm256_and_si256 (_mm256_srli_epi32 (_mm256_mullo_epi32 (hi, r), 16),
+                           mask);
+    /* the pack works within 128 bit lanes, put the quarters back in order */
+    return _mm256_permute4x64_epi64 (_mm256_packus_epi32 (lo, hi), 0xd8);
+}
+
+#define VEC __m256i
+#define V_BYTES 16
+#define V_LOADB(p) _mm256_cvtepu8_epi16 (_mm_loadu_si128 ((__m128i *) (p)))
+#define V_STOREB(p, v)                                                  \
+    _mm_storeu_si128 ((__m128i *) (p), _mm256_castsi256_si128 (         \
+        _mm256_permute4x64_epi64 (_mm256_packus_epi16 (v, v), 0xd8)))
+#define V_LOADW(p) _mm256_loadu_si256 ((__m256i *) (p))
+#define V_STOREW(p, v) _mm256_storeu_si256 ((__m256i *) (p), v)
+#define V_ADD _mm256_add_epi16
+#define V_SETW(c) _mm256_set1_epi16 ((short) (c))
+#define V_MULHI _mm256_mulhi_epu16
+#define V_LERP avx2_lerp
+#define V_SHRINKOUT avx2_shrink_out
+#define V_LOADPX(rows, x)                                               \
+    _mm256_cvtepu8_epi16 (_mm_set_epi32 (((int *) (rows)[3])[x],        \
+                                         ((int *) (rows)[2])[x],        \
+                                         ((int *) (rows)[1])[x],        \
+                                         ((int *) (rows)[0])[x]))
+#define V_GATHER(a, b, row, idx)                                        \
+    do {                                                                \
+        __m256i p01 = _mm256_cvtepu8_epi16 (_mm_unpacklo_epi64 (        \
+            _mm_loadl_epi64 ((__m128i *) ((row) + (idx)[0] * 4)),       \
+            _mm_loadl_epi64 ((__m128i *) ((row) + (idx)[1] * 4))));     \
+        __m256i p23 = _mm256_cvtepu8_epi16 (_mm_unpacklo_epi64 (        \
+            _mm_loadl_epi64 ((__m128i *) ((row) + (idx)[2] * 4)),       \
+            _mm_loadl_epi64 ((__m128i *) ((row) + (idx)[3] * 4))));     \
+        __m256i lo = _mm256_permute2x128_si256 (p01, p23, 0x20);        \
+        __m256i hi = _mm256_permute2x128_si256 (p01, p23, 0x31);        \
+        a = _mm256_unpacklo_epi64 (lo, hi);                             \
+        b = _mm256_unpackhi_epi64 (lo, hi);                             \
+    } while (0)
+
+PG_TARGET_AVX2 void
+filter_shrink_X_AVX2 (Uint8 *srcpix, Uint8 *dstpix, int height,
+                      int srcpitch, int dstpitch, int srcwidth, int dstwidth)
+{
+    SHRINK_X_BODY
+}
+
+PG_TARGET_AVX2 void
+filter_shrink_Y_AVX2 (Uint8 *srcpix, Uint8 *dstpix, int width,
+                      int srcpitch, int dstpitch, int srcheight, int dstheight)
+{
+    SHRINK_Y_BODY
+}
+
+PG_TARGET_AVX2 void
+filter_expand_X_AVX2 (Uint8 *srcpix, Uint8 *dstpix, int height,
+                      int srcpitch, int dstpitch, int srcwidth, int dstwidth)
+{
+    EXPAND_X_BODY
+}
+
+PG_TARGET_AVX2 void
+filter_expand_Y_AVX2 (Uint8 *srcpix, Uint8 *dstpix, int width,
+                      int srcpitch, int dstpitch, int srcheight, int dstheight)
+{
+    EXPAND_Y_BODY
+}
+
+/* transform.threshold for the 8 pixels at src, like sse2_threshold */
+PG_TARGET_AVX2 static INLINE int
+avx2_threshold (Uint32 *src, Uint32 *cmp, Uint32 *dst, __m256i color,
+                __m256i t, __m256i inv, int change_return)
+{
+    __m256i a = _mm256_loadu_si256 ((__m256i *) src);
+    __m256i b = cmp ? _mm256_loadu_si256 ((__m256i *) cmp) : color;
+    __m256i d = _mm256_or_si256 (_mm256_subs_epu8 (a, b),
+                                 _mm256_subs_epu8 (b, a));
+    __m256i m = _mm256_xor_si256 (
+        _mm256_cmpeq_epi32 (_mm256_subs_epu8 (d, t),
+                            _mm256_setzero_si256 ()), inv);
+
+    if (change_return)
+    {
+        __m256i v = change_return == 2 ? a : color;
+        __m256i old = _mm256_loadu_si256 ((__m256i *) dst);
+
+        _mm256_storeu_si256 ((__m256i *) dst,
+                             _mm256_blendv_epi8 (old, v, m));
+    }
+    return pg_popcount32 (_mm256_movemask_ps (_mm256_castsi256_ps (m)));
+}
+
+PG_TARGET_AVX2 int
+threshold_row_AVX2 (Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix,
+                    int width, Uint32 color, Uint32 threshold,
+                    int change_return, int inverse)
+{
+    __m256i colorv = _mm256_set1_epi32 ((int) color);
+    __m256i t = _mm256_set1_epi32 ((int) threshold);
+    __m256i inv = _mm256_set1_epi32 (inverse ? -1 : 0);
+    int x, similar = 0;
+
+    for (x = 0; x + 8 <= width; x += 8)
+        similar += avx2_threshold (srcpix + x, cmppix ? cmppix + x : NULL,
+                                   dstpix + x, colorv, t, inv,
+                                   change_return);
+    THRESHOLD_ROW_TAIL (x)
+    return similar;
+}
+
+#undef VEC
+#undef V_BYTES
+#undef V_LOADB
+#undef V_STOREB
+#undef V_LOADW
+#undef V_STOREW
+#undef V_ADD
+#undef V_SETW
+#undef V_MULHI
+#undef V_LERP
+#undef V_SHRINKOUT
+#undef V_LOADPX
+#undef V_GATHER
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+static INLINE uint16x8_t
+neon_mulhi (uint16x8_t v, uint16x8_t c)
+{
+    return vcombine_u16 (
+        vshrn_n_u32 (vmull_u16 (vget_low_u16 (v), vget_low_u16 (c)), 16),
+        vshrn_n_u32 (vmull_u16 (vget_high_u16 (v), vget_high_u16 (c)), 16));
+}
+
+static INLINE uint16x8_t
+neon_lerp (uint16x8_t a, uint16x8_t b, uint16x8_t m0, uint16x8_t m1,
+           uint16x8_t f)
+{
+    uint32x4_t lo = vmlal_u16 (vmull_u16 (vget_low_u16 (a), vget_low_u16 (m0)),
+                               vget_low_u16 (b), vget_low_u16 (m1));
+    uint32x4_t hi = vmlal_u16 (vmull_u16 (vget_high_u16 (a),
+                                          vget_high_u16 (m0)),
+                               vget_high_u16 (b), vget_high_u16 (m1));
+
+    return vaddq_u16 (vcombine_u16 (vshrn_n_u32 (lo, 16),
+                                    vshrn_n_u32 (hi, 16)),
+                      vandq_u16 (a, f));
+}
+
+static INLINE uint16x8_t
+neon_shrink_out (uint16x8_t acc, uint16x8_t t, int recip)
+{
+    uint32x4_t mask = vdupq_n_u32 (0xff);
+    uint32x4_t lo = vaddl_u16 (vget_low_u16 (acc), vget_low_u16 (t));
+    uint32x4_t hi = vaddl_u16 (vget_high_u16 (acc), vget_high_u16 (t));
+
+    lo = vandq_u32 (vshrq_n_u32 (vmulq_n_u32 (lo, (Uint32) recip), 16), mask);
+    hi = vandq_u32 (vshrq_n_u32 (vmulq_n_u32 (hi, (Uint32) recip), 16), mask);
+    return vcombine_u16 (vmovn_u32 (lo), vmovn_u32 (hi));
+}
+
+#define VEC uint16x8_t
+#define V_BYTES 8
+#define V_LOADB(p) vmovl_u8 (vld1_u8 (p))
+#define V_STOREB(p, v) vst1_u8 (p, vmovn_u16 (v))
+#define V_LOADW(p) vld1q_u16 (p)
+#define V_STOREW(p, v) vst1q_u16 (p, v)
+#define V_ADD vaddq_u16
+#define V_SETW(c) vdupq_n_u16 ((Uint16) (c))
+#define V_MULHI neon_mulhi
+#define V_LERP neon_lerp
+#define V_SHRINKOUT neon_shrink_out
+#define V_LOADPX(rows, x)                                               \
+    vmovl_u8 (vreinterpret_u8_u32 (vset_lane_u32 (                      \
+        ((Uint32 *) (rows)[1])[x],                                      \
+        vdup_n_u32 (((Uint32 *) (rows)[0])[x]), 1)))
+#define V_GATHER(a, b, row, idx)                                        \
+    do {                                                                \
+        uint16x8_t p0 = V_LOADB ((row) + (idx)[0] * 4);                 \
+        uint16x8_t p1 = V_LOADB ((row) + (idx)[1] * 4);                 \
+        a = vcombine_u16 (vget_low_u16 (p0), vget_low_u16 (p1));        \
+        b = vcombine_u16 (vget_high_u16 (p0), vget_high_u16 (p1));      \
+    } while (0)
+
+void
+filter_shrink_X_NEON (Uint8 *srcpix, Uint8 *dstpix, int height,
+                      int srcpitch, int dstpitch, int srcwidth, int dstwidth)
+{
+    SHRINK_X_BODY
+}
+
+void
+filter_shrink_Y_NEON (Uint8 *srcpix, Uint8 *dstpix, int width,
+                      int srcpitch, int dstpitch, int srcheight, int dstheight)
+{
+    SHRINK_Y_BODY
+}
+
+void
+filter_expand_X_NEON (Uint8 *srcpix, Uint8 *dstpix, int height,
+                      int srcpitch, int dstpitch, int srcwidth, int dstwidth)
+{
+    EXPAND_X_BODY
+}
+
+void
+filter_expand_Y_NEON (Uint8 *srcpix, Uint8 *dstpix, int width,
+                      int srcpitch, int dstpitch, int srcheight, int dstheight)
+{
+    EXPAND_Y_BODY
+}
+
+/* The rounded 2x2 averages of the 4 pixels at src0 and src1 */
+static INLINE uint8x8_t
+neon_halve (Uint8 *src0, Uint8 *src1)
+{
+    uint8x16_t a = vld1q_u8 (src0);
+    uint8x16_t b = vld1q_u8 (src1);
+    uint16x8_t lo = vaddl_u8 (vget_low_u8 (a), vget_low_u8 (b));
+    uint16x8_t hi = vaddl_u8 (vget_high_u8 (a), vget_high_u8 (b));
+
+    return vrshrn_n_u16 (vcombine_u16 (vadd_u16 (vget_low_u16 (lo),
+                                                 vget_high_u16 (lo)),
+                                       vadd_u16 (vget_low_u16 (hi),
+                                                 vget_high_u16 (hi))), 2);
+}
+
+void
+filter_halve_NEON (Uint8 *srcpix, Uint8 *dstpix, int srcpitch, int dstpitch,
+                   int dstwidth, int dstheight)
+{
+    HALVE_BODY (vst1q_u8 (dst + x * 4,
+                          vcombine_u8 (neon_halve (src0 + x * 8,
+                                                   src1 + x * 8),
+                                       neon_halve (src0 + x * 8 + 16,
+                                                   src1 + x * 8 + 16))))
+}
+
+/* transform.threshold for the 4 pixels at src, like sse2_threshold */
+static INLINE int
+neon_threshold (Uint32 *src, Uint32 *cmp, Uint32 *dst, uint32x4_t color,
+                uint8x16_t t, uint32x4_t inv, int change_return)
+{
+    uint32x4_t a = vld1q_u32 (src);
+    uint32x4_t b = cmp ? vld1q_u32 (cmp) : color;
+    uint8x16_t d = vabdq_u8 (vreinterpretq_u8_u32 (a),
+                             vreinterpretq_u8_u32 (b));
+    uint32x4_t m = veorq_u32 (vceqq_u32 (vreinterpretq_u32_u8 (
+                                             vcleq_u8 (d, t)),
+                                         vdupq_n_u32 (0xffffffff)), inv);
+    uint32x2_t n;
+
+    if (change_return)
+        vst1q_u32 (dst, vbslq_u32 (m, change_return == 2 ? a : color,
+                                   vld1q_u32 (dst)));
+    m = vshrq_n_u32 (m, 31);
+    n = vpadd_u32 (vget_low_u32 (m), vget_high_u32 (m));
+    return (int) vget_lane_u32 (vpadd_u32 (n, n), 0);
+}
+
+int
+threshold_row_NEON (Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix,
+                    int width, Uint32 color, Uint32 threshold,
+                    int change_return, int inverse)
+{
+    uint32x4_t colorv = vdupq_n_u32 (color);
+    uint8x16_t t = vreinterpretq_u8_u32 (vdupq_n_u32 (threshold));
+    uint32x4_t inv = vdupq_n_u32 (inverse ? 0xffffffff : 0);
+    int x, similar = 0;
+
+    for (x = 0; x + 4 <= width; x += 4)
+        similar += neon_threshold (srcpix + x, cmppix ? cmppix + x : NULL,
+                                   dstpix + x, colorv, t, inv,
+                                   change_return);
+    THRESHOLD_ROW_TAIL (x)
+    return similar;
+}
+
+/* The 16 bytes at src widened to 4 vectors of 32 bit lanes */
+#define NEON_WIDEN(src, w)                                              \
+    do {                                                                \
+        uint8x16_t b = vld1q_u8 (src);                                  \
+        uint16x8_t lo = vmovl_u8 (vget_low_u8 (b));                     \
+        uint16x8_t hi = vmovl_u8 (vget_high_u8 (b));                    \
+        w[0] = vmovl_u16 (vget_low_u16 (lo));                           \
+        w[1] = vmovl_u16 (vget_high_u16 (lo));                          \
+        w[2] = vmovl_u16 (vget_low_u16 (hi));                           \
+        w[3] = vmovl_u16 (vget_high_u16 (hi));                          \
+    } while (0)
+
+void
+accumulate_add_NEON (Uint32 *acc, Uint8 *src, int count)
+{
+    uint32x4_t w[4];
+    int i, j;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        NEON_WIDEN (src + i, w);
+        for (j = 0; j < 4; j++)
+            vst1q_u32 (acc + i + j * 4,
+                       vaddq_u32 (vld1q_u32 (acc + i + j * 4), w[j]));
+    }
+    ACCUMULATE_TAIL (i, ACCUMULATE_ADD)
+}
+
+void
+accumulate_sub_NEON (Uint32 *acc, Uint8 *src, int count)
+{
+    uint32x4_t w[4];
+    int i, j;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        NEON_WIDEN (src + i, w);
+        for (j = 0; j < 4; j++)
+            vst1q_u32 (acc + i + j * 4,
+                       vsubq_u32 (vld1q_u32 (acc + i + j * 4), w[j]));
+    }
+    ACCUMULATE_TAIL (i, ACCUMULATE_SUB)
+}
+
+void
+accumulate_ema_NEON (float *acc, Uint8 *src, int count, float alpha)
+{
+    float32x4_t va = vdupq_n_f32 (alpha);
+    uint32x4_t w[4];
+    float32x4_t a;
+    int i, j;
+
+    for (i = 0; i + 16 <= count; i += 16)
+    {
+        NEON_WIDEN (src + i, w);
+        for (j = 0; j < 4; j++)
+        {
+            a = vld1q_f32 (acc + i + j * 4);
+            a = vaddq_f32 (a, vmulq_f32 (vsubq_f32 (vcvtq_f32_u32 (w[j]), a),
+                                         va));
+            vst1q_f32 (acc + i + j * 4, a);
+        }
+    }
+    ACCUMULATE_TAIL (i, ACCUMULATE_EMA)
+}
+/* The 4 bytes at p widened to 32 bit lanes */
+static INLINE uint32x4_t
+neon_loadpx (Uint8 *p)
+{
+    return vmovl_u16 (vget_low_u16 (vmovl_u8 (vreinterpret_u8_u32 (
+                                                  vdup_n_u32 (*(Uint32 *) p)))));
+}
+
+/* BLUR_OUT of the 4 lanes of acc, packed back into a pixel */
+static INLINE Uint32
+neon_blur_out (uint32x4_t acc, Uint32 recip)
+{
+    uint16x4_t v = vmovn_u32 (vshrq_n_u32 (vaddq_u32 (vmulq_n_u32 (acc, recip),
+                                                      vdupq_n_u32 (0x800000)),
+                                           24));
+
+    return vget_lane_u32 (vreinterpret_u32_u8 (
+                              vmovn_u16 (vcombine_u16 (v, v))), 0);
+}
+
+#define VEC32 uint32x4_t
+#define V32_LOADPX neon_loadpx
+#define V32_LOAD vld1q_u32
+#define V32_STORE vst1q_u32
+#define V32_ADD vaddq_u32
+#define V32_SUB vsubq_u32
+#define V32_BLUROUT neon_blur_out
+
+void
+filter_blur_X_NEON (Uint8 *srcpix, Uint8 *dstpix, int height,
+                    int srcpitch, int dstpitch, int width, int radius)
+{
+    BLUR_X_BODY
+}
+
+void
+filter_blur_Y_NEON (Uint8 *srcpix, Uint8 *dstpix, int width,
+                    int srcpitch, int dstpitch, int height, int radius)
+{
+    BLUR_Y_BODY
+}
+static INLINE uint8x16_t
+neon_reverse (uint8x16_t v, int bpp)
+{
+    if (bpp == 4)
+        v = vreinterpretq_u8_u32 (vrev64q_u32 (vreinterpretq_u32_u8 (v)));
+    else if (bpp == 2)
+        v = vreinterpretq_u8_u16 (vrev64q_u16 (vreinterpretq_u16_u8 (v)));
+    else
+        v = vrev64q_u8 (v);
+    return vextq_u8 (v, v, 8);
+}
+
+#define V_REVERSE neon_reverse
+
+void
+flip_row_NEON (Uint8 *row, int width, int bpp)
+{
+    FLIP_ROW_BODY (uint8x16_t, vld1q_u8, vst1q_u8)
+}
+
+#undef V_REVERSE
+#endif /* PG_SIMD_NEON */
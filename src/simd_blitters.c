@@ -0,0 +1,1074 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+  Copyright (C) 2007 Marcus von Appen
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+#include "simd_blitters.h"
+
+#ifdef PG_SIMD_X86
+#include <immintrin.h>
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_NEON
+#include <arm_neon.h>
+#endif /* PG_SIMD_NEON */
+#include <string.h>
+
+/* Highest backend the kernels may use, and the kernels picked under it.
+ * The picks are cleared when the limit changes.
+ */
+static int simd_limit = SIMD_BACKEND_AVX2;
+static AlphaBlit32Func alphablit_alpha_32_pick = NULL;
+static BlendBlit32Func blend_blit_32_pick = NULL;
+static BlendBlit565Func blend_blit_565_pick = NULL;
+static BoundsScan32Func bounds_scan_32_pick = NULL;
+
+#define SIMD_ALLOW(level, has) ((level) <= simd_limit && has ())
+
+const char *
+simd_get_backend (void)
+{
+#ifdef PG_SIMD_AVX2
+    if (SIMD_ALLOW (SIMD_BACKEND_AVX2, SDL_HasAVX2))
+        return "AVX2";
+#endif /* PG_SIMD_AVX2 */
+#ifdef PG_SIMD_X86
+    if (SIMD_ALLOW (SIMD_BACKEND_SSE2, SDL_HasSSE2))
+        return "SSE2";
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_NEON
+    if (SIMD_ALLOW (SIMD_BACKEND_NEON, SDL_HasNEON))
+        return "NEON";
+#endif /* PG_SIMD_NEON */
+    return "GENERIC";
+}
+
+int
+simd_set_backend (const char *name)
+{
+    int level;
+    int has = 0;
+
+    if (strcmp (name, "GENERIC") == 0) {
+        level = SIMD_BACKEND_GENERIC;
+        has = 1;
+    }
+    else if (strcmp (name, "SSE2") == 0) {
+        level = SIMD_BACKEND_SSE2;
+#ifdef PG_SIMD_X86
+        has = SDL_HasSSE2 ();
+#endif /* PG_SIMD_X86 */
+    }
+    else if (strcmp (name, "AVX2") == 0) {
+        level = SIMD_BACKEND_AVX2;
+#ifdef PG_SIMD_AVX2
+        has = SDL_HasAVX2 ();
+#endif /* PG_SIMD_AVX2 */
+    }
+    else if (strcmp (name, "NEON") == 0) {
+        level = SIMD_BACKEND_NEON;
+#ifdef PG_SIMD_NEON
+        has = SDL_HasNEON ();
+#endif /* PG_SIMD_NEON */
+    }
+    else
+        return -1;
+    if (!has)
+        return -2;
+
+    simd_limit = level;
+    alphablit_alpha_32_pick = NULL;
+    blend_blit_32_pick = NULL;
+    blend_blit_565_pick = NULL;
+    bounds_scan_32_pick = NULL;
+    return 0;
+}
+
+/* The ALPHA_BLEND macro computes, per color channel,
+ *
+ *     dC = (((sC - dC) * sA + sC) >> 8) + dC
+ *
+ * which is the same as the all positive
+ *
+ *     dC = (sC * (sA + 1) + dC * (256 - sA)) >> 8
+ *
+ * whose terms never exceed 16 bits. The new alpha is
+ *
+ *     dA = sA + dA - sA * dA / 255
+ *
+ * where, for x <= 255 * 255, x / 255 == (x + 1 + (x >> 8)) >> 8.
+ * A destination alpha of 0 just takes the source pixel.
+ */
+
+static INLINE Uint32
+swap_rb_32 (Uint32 pixel, const AlphaBlitLayout32 *layout)
+{
+    Uint32 low = layout->swaplow;
+    Uint32 high = low << layout->swapshift;
+
+    return ((pixel & ~(low | high)) |
+            ((pixel & low) << layout->swapshift) |
+            ((pixel >> layout->swapshift) & low));
+}
+
+static INLINE Uint32
+alpha_blend_32 (Uint32 s, Uint32 d, const AlphaBlitLayout32 *layout)
+{
+    Uint32 sA, dA, prod, out = 0;
+    int shift;
+
+    if (layout->swapshift)
+        s = swap_rb_32 (s, layout);
+    sA = (s >> layout->ashift) & 0xff;
+    dA = ((d >> layout->ashift) & 0xff) | layout->dafill;
+    if (!dA)
+        return s;
+
+    for (shift = 0; shift < 32; shift += 8)
+    {
+        Uint32 sC = (s >> shift) & 0xff;
+        Uint32 dC = (d >> shift) & 0xff;
+
+        out |= ((sC * (sA + 1) + dC * (256 - sA)) >> 8) << shift;
+    }
+    prod = sA * dA;
+    dA = sA + dA - ((prod + 1 + (prod >> 8)) >> 8);
+    return ((out & layout->rgbmask) |
+            ((dA << layout->ashift) & layout->amask));
+}
+
+void
+alphablit_alpha_32_ONLYC (Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                          int width, int height,
+                          const AlphaBlitLayout32 *layout)
+{
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n > 0; --n)
+        {
+            *(Uint32 *) dstp = alpha_blend_32 (*(Uint32 *) srcp,
+                                               *(Uint32 *) dstp, layout);
+            srcp += 4;
+            dstp += 4;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+#ifdef PG_SIMD_X86
+PG_TARGET_SSE2 void
+alphablit_alpha_32_SSE2 (Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                         int width, int height,
+                         const AlphaBlitLayout32 *layout)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i one = _mm_set1_epi16 (1);
+    __m128i c256 = _mm_set1_epi16 (256);
+    __m128i bytemask = _mm_set1_epi32 (0xff);
+    __m128i rgbmask = _mm_set1_epi32 ((int) layout->rgbmask);
+    __m128i amask = _mm_set1_epi32 ((int) layout->amask);
+    __m128i dafill = _mm_set1_epi32 ((int) layout->dafill);
+    __m128i ashift = _mm_cvtsi32_si128 ((int) layout->ashift);
+    __m128i swapshift = _mm_cvtsi32_si128 ((int) layout->swapshift);
+    __m128i swaplow = _mm_set1_epi32 ((int) layout->swaplow);
+    __m128i swapkeep = _mm_set1_epi32 ((int) ~(layout->swaplow |
+                                        (layout->swaplow <<
+                                         layout->swapshift)));
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n >= 4; n -= 4)
+        {
+            __m128i s = _mm_loadu_si128 ((__m128i *) srcp);
+            __m128i d = _mm_loadu_si128 ((__m128i *) dstp);
+            __m128i sa, da, dzero, lo, hi, alo, ahi, color, alpha;
+            __m128i s16, d16, sa16, da16, prod;
+
+            if (layout->swapshift)
+            {
+                s = _mm_or_si128 (
+                    _mm_and_si128 (s, swapkeep),
+                    _mm_or_si128 (
+                        _mm_sll_epi32 (_mm_and_si128 (s, swaplow), swapshift),
+                        _mm_and_si128 (_mm_srl_epi32 (s, swapshift),
+                                       swaplow)));
+            }
+
+            /* Spread each pixel's alphas over its four bytes */
+            sa = _mm_and_si128 (_mm_srl_epi32 (s, ashift), bytemask);
+            da = _mm_or_si128 (_mm_and_si128 (_mm_srl_epi32 (d, ashift),
+                                              bytemask), dafill);
+            dzero = _mm_cmpeq_epi32 (da, zero);
+            sa = _mm_or_si128 (sa, _mm_slli_epi32 (sa, 8));
+            sa = _mm_or_si128 (sa, _mm_slli_epi32 (sa, 16));
+            da = _mm_or_si128 (da, _mm_slli_epi32 (da, 8));
+            da = _mm_or_si128 (da, _mm_slli_epi32 (da, 16));
+
+            /* Pixels 0 and 1 */
+            s16 = _mm_unpacklo_epi8 (s, zero);
+            d16 = _mm_unpacklo_epi8 (d, zero);
+            sa16 = _mm_unpacklo_epi8 (sa, zero);
+            da16 = _mm_unpacklo_epi8 (da, zero);
+            lo = _mm_srli_epi16 (
+                _mm_add_epi16 (
+                    _mm_mullo_epi16 (s16, _mm_add_epi16 (sa16, one)),
+                    _mm_mullo_epi16 (d16, _mm_sub_epi16 (c256, sa16))), 8);
+            prod = _mm_mullo_epi16 (sa16, da16);
+            prod = _mm_srli_epi16 (
+                _mm_add_epi16 (_mm_add_epi16 (prod, one),
+                               _mm_srli_epi16 (prod, 8)), 8);
+            alo = _mm_sub_epi16 (_mm_add_epi16 (sa16, da16), prod);
+
+            /* Pixels 2 and 3 */
+            s16 = _mm_unpackhi_epi8 (s, zero);
+            d16 = _mm_unpackhi_epi8 (d, zero);
+            sa16 = _mm_unpackhi_epi8 (sa, zero);
+            da16 = _mm_unpackhi_epi8 (da, zero);
+            hi = _mm_srli_epi16 (
+                _mm_add_epi16 (
+                    _mm_mullo_epi16 (s16, _mm_add_epi16 (sa16, one)),
+                    _mm_mullo_epi16 (d16, _mm_sub_epi16 (c256, sa16))), 8);
+            prod = _mm_mullo_epi16 (sa16, da16);
+            prod = _mm_srli_epi16 (
+                _mm_add_epi16 (_mm_add_epi16 (prod, one),
+                               _mm_srli_epi16 (prod, 8)), 8);
+            ahi = _mm_sub_epi16 (_mm_add_epi16 (sa16, da16), prod);
+
+            color = _mm_and_si128 (_mm_packus_epi16 (lo, hi), rgbmask);
+            alpha = _mm_and_si128 (_mm_packus_epi16 (alo, ahi), amask);
+            color = _mm_or_si128 (color, alpha);
+            color = _mm_or_si128 (_mm_and_si128 (dzero, s),
+                                  _mm_andnot_si128 (dzero, color));
+            _mm_storeu_si128 ((__m128i *) dstp, color);
+            srcp += 16;
+            dstp += 16;
+        }
+        for (; n > 0; --n)
+        {
+            *(Uint32 *) dstp = alpha_blend_32 (*(Uint32 *) srcp,
+                                               *(Uint32 *) dstp, layout);
+            srcp += 4;
+            dstp += 4;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+PG_TARGET_AVX2 void
+alphablit_alpha_32_AVX2 (Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                         int width, int height,
+                         const AlphaBlitLayout32 *layout)
+{
+    __m256i zero = _mm256_setzero_si256 ();
+    __m256i one = _mm256_set1_epi16 (1);
+    __m256i c256 = _mm256_set1_epi16 (256);
+    __m256i bytemask = _mm256_set1_epi32 (0xff);
+    __m256i rgbmask = _mm256_set1_epi32 ((int) layout->rgbmask);
+    __m256i amask = _mm256_set1_epi32 ((int) layout->amask);
+    __m256i dafill = _mm256_set1_epi32 ((int) layout->dafill);
+    __m128i ashift = _mm_cvtsi32_si128 ((int) layout->ashift);
+    __m128i swapshift = _mm_cvtsi32_si128 ((int) layout->swapshift);
+    __m256i swaplow = _mm256_set1_epi32 ((int) layout->swaplow);
+    __m256i swapkeep = _mm256_set1_epi32 ((int) ~(layout->swaplow |
+                                           (layout->swaplow <<
+                                            layout->swapshift)));
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n >= 8; n -= 8)
+        {
+            __m256i s = _mm256_loadu_si256 ((__m256i *) srcp);
+            __m256i d = _mm256_loadu_si256 ((__m256i *) dstp);
+            __m256i sa, da, dzero, lo, hi, alo, ahi, color, alpha;
+            __m256i s16, d16, sa16, da16, prod;
+
+            if (layout->swapshift)
+            {
+                s = _mm256_or_si256 (
+                    _mm256_and_si256 (s, swapkeep),
+                    _mm256_or_si256 (
+                        _mm256_sll_epi32 (_mm256_and_si256 (s, swaplow),
+                                          swapshift),
+                        _mm256_and_si256 (_mm256_srl_epi32 (s, swapshift),
+                                          swaplow)));
+            }
+
+            sa = _mm256_and_si256 (_mm256_srl_epi32 (s, ashift), bytemask);
+            da = _mm256_or_si256 (
+                _mm256_and_si256 (_mm256_srl_epi32 (d, ashift), bytemask),
+                dafill);
+            dzero = _mm256_cmpeq_epi32 (da, zero);
+            sa = _mm256_or_si256 (sa, _mm256_slli_epi32 (sa, 8));
+            sa = _mm256_or_si256 (sa, _mm256_slli_epi32 (sa, 16));
+            da = _mm256_or_si256 (da, _mm256_slli_epi32 (da, 8));
+            da = _mm256_or_si256 (da, _mm256_slli_epi32 (da, 16));
+
+            /* The unpacks and pack work within each 128 bit lane, so
+               the pixel order comes back out unchanged. */
+            s16 = _mm256_unpacklo_epi8 (s, zero);
+            d16 = _mm256_unpacklo_epi8 (d, zero);
+            sa16 = _mm256_unpacklo_epi8 (sa, zero);
+            da16 = _mm256_unpacklo_epi8 (da, zero);
+            lo = _mm256_srli_epi16 (
+                _mm256_add_epi16 (
+                    _mm256_mullo_epi16 (s16, _mm256_add_epi16 (sa16, one)),
+                    _mm256_mullo_epi16 (d16, _mm256_sub_epi16 (c256, sa16))),
+                8);
+            prod = _mm256_mullo_epi16 (sa16, da16);
+            prod = _mm256_srli_epi16 (
+                _mm256_add_epi16 (_mm256_add_epi16 (prod, one),
+                                  _mm256_srli_epi16 (prod, 8)), 8);
+            alo = _mm256_sub_epi16 (_mm256_add_epi16 (sa16, da16), prod);
+
+            s16 = _mm256_unpackhi_epi8 (s, zero);
+            d16 = _mm256_unpackhi_epi8 (d, zero);
+            sa16 = _mm256_unpackhi_epi8 (sa, zero);
+            da16 = _mm256_unpackhi_epi8 (da, zero);
+            hi = _mm256_srli_epi16 (
+                _mm256_add_epi16 (
+                    _mm256_mullo_epi16 (s16, _mm256_add_epi16 (sa16, one)),
+                    _mm256_mullo_epi16 (d16, _mm256_sub_epi16 (c256, sa16))),
+                8);
+            prod = _mm256_mullo_epi16 (sa16, da16);
+            prod = _mm256_srli_epi16 (
+                _mm256_add_epi16 (_mm256_add_epi16 (prod, one),
+                                  _mm256_srli_epi16 (prod, 8)), 8);
+            ahi = _mm256_sub_epi16 (_mm256_add_epi16 (sa16, da16), prod);
+
+            color = _mm256_and_si256 (_mm256_packus_epi16 (lo, hi), rgbmask);
+            alpha = _mm256_and_si256 (_mm256_packus_epi16 (alo, ahi), amask);
+            color = _mm256_or_si256 (color, alpha);
+            color = _mm256_or_si256 (_mm256_and_si256 (dzero, s),
+                                     _mm256_andnot_si256 (dzero, color));
+            _mm256_storeu_si256 ((__m256i *) dstp, color);
+            srcp += 32;
+            dstp += 32;
+        }
+        for (; n > 0; --n)
+        {
+            *(Uint32 *) dstp = alpha_blend_32 (*(Uint32 *) srcp,
+                                               *(Uint32 *) dstp, layout);
+            srcp += 4;
+            dstp += 4;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+static INLINE uint16x8_t
+neon_blend_half (uint16x8_t s16, uint16x8_t d16, uint16x8_t sa16)
+{
+    uint16x8_t sum = vmulq_u16 (s16, vaddq_u16 (sa16, vdupq_n_u16 (1)));
+
+    sum = vmlaq_u16 (sum, d16, vsubq_u16 (vdupq_n_u16 (256), sa16));
+    return vshrq_n_u16 (sum, 8);
+}
+
+static INLINE uint16x8_t
+neon_alpha_half (uint16x8_t sa16, uint16x8_t da16)
+{
+    uint16x8_t prod = vmulq_u16 (sa16, da16);
+
+    prod = vshrq_n_u16 (vaddq_u16 (vaddq_u16 (prod, vdupq_n_u16 (1)),
+                                   vshrq_n_u16 (prod, 8)), 8);
+    return vsubq_u16 (vaddq_u16 (sa16, da16), prod);
+}
+
+void
+alphablit_alpha_32_NEON (Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                         int width, int height,
+                         const AlphaBlitLayout32 *layout)
+{
+    uint32x4_t bytemask = vdupq_n_u32 (0xff);
+    uint32x4_t rgbmask = vdupq_n_u32 (layout->rgbmask);
+    uint32x4_t amask = vdupq_n_u32 (layout->amask);
+    uint32x4_t dafill = vdupq_n_u32 (layout->dafill);
+    int32x4_t ashift = vdupq_n_s32 (-(int) layout->ashift);
+    int32x4_t swapleft = vdupq_n_s32 ((int) layout->swapshift);
+    int32x4_t swapright = vdupq_n_s32 (-(int) layout->swapshift);
+    uint32x4_t swaplow = vdupq_n_u32 (layout->swaplow);
+    uint32x4_t swapkeep = vdupq_n_u32 (~(layout->swaplow |
+                                         (layout->swaplow <<
+                                          layout->swapshift)));
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n >= 4; n -= 4)
+        {
+            uint32x4_t s = vld1q_u32 ((Uint32 *) srcp);
+            uint32x4_t d = vld1q_u32 ((Uint32 *) dstp);
+            uint32x4_t sa, da, dzero, color, alpha;
+            uint8x16_t s8, d8, sa8, da8;
+            uint16x8_t lo, hi, alo, ahi;
+
+            if (layout->swapshift)
+            {
+                s = vorrq_u32 (
+                    vandq_u32 (s, swapkeep),
+                    vorrq_u32 (vshlq_u32 (vandq_u32 (s, swaplow), swapleft),
+                               vandq_u32 (vshlq_u32 (s, swapright),
+                                          swaplow)));
+            }
+
+            sa = vandq_u32 (vshlq_u32 (s, ashift), bytemask);
+            da = vorrq_u32 (vandq_u32 (vshlq_u32 (d, ashift), bytemask),
+                            dafill);
+            dzero = vceqq_u32 (da, vdupq_n_u32 (0));
+            sa = vmulq_n_u32 (sa, 0x01010101);
+            da = vmulq_n_u32 (da, 0x01010101);
+
+            s8 = vreinterpretq_u8_u32 (s);
+            d8 = vreinterpretq_u8_u32 (d);
+            sa8 = vreinterpretq_u8_u32 (sa);
+            da8 = vreinterpretq_u8_u32 (da);
+
+            lo = neon_blend_half (vmovl_u8 (vget_low_u8 (s8)),
+                                  vmovl_u8 (vget_low_u8 (d8)),
+                                  vmovl_u8 (vget_low_u8 (sa8)));
+            hi = neon_blend_half (vmovl_u8 (vget_high_u8 (s8)),
+                                  vmovl_u8 (vget_high_u8 (d8)),
+                                  vmovl_u8 (vget_high_u8 (sa8)));
+            alo = neon_alpha_half (vmovl_u8 (vget_low_u8 (sa8)),
+                                   vmovl_u8 (vget_low_u8 (da8)));
+            ahi = neon_alpha_half (vmovl_u8 (vget_high_u8 (sa8)),
+                                   vmovl_u8 (vget_high_u8 (da8)));
+
+            color = vreinterpretq_u32_u8 (vcombine_u8 (vqmovn_u16 (lo),
+                                                       vqmovn_u16 (hi)));
+            alpha = vreinterpretq_u32_u8 (vcombine_u8 (vqmovn_u16 (alo),
+                                                       vqmovn_u16 (ahi)));
+            color = vorrq_u32 (vandq_u32 (color, rgbmask),
+                               vandq_u32 (alpha, amask));
+            color = vbslq_u32 (dzero, s, color);
+            vst1q_u32 ((Uint32 *) dstp, color);
+            srcp += 16;
+            dstp += 16;
+        }
+        for (; n > 0; --n)
+        {
+            *(Uint32 *) dstp = alpha_blend_32 (*(Uint32 *) srcp,
+                                               *(Uint32 *) dstp, layout);
+            srcp += 4;
+            dstp += 4;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+#endif /* PG_SIMD_NEON */
+
+AlphaBlit32Func
+simd_select_alphablit_alpha_32 (void)
+{
+    AlphaBlit32Func func;
+
+    if (alphablit_alpha_32_pick)
+        return alphablit_alpha_32_pick;
+
+    func = alphablit_alpha_32_ONLYC;
+#ifdef PG_SIMD_NEON
+    if (SIMD_ALLOW (SIMD_BACKEND_NEON, SDL_HasNEON))
+        func = alphablit_alpha_32_NEON;
+#endif /* PG_SIMD_NEON */
+#ifdef PG_SIMD_X86
+    if (SIMD_ALLOW (SIMD_BACKEND_SSE2, SDL_HasSSE2))
+        func = alphablit_alpha_32_SSE2;
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_AVX2
+    if (SIMD_ALLOW (SIMD_BACKEND_AVX2, SDL_HasAVX2))
+        func = alphablit_alpha_32_AVX2;
+#endif /* PG_SIMD_AVX2 */
+    alphablit_alpha_32_pick = func;
+    return func;
+}
+
+/* Packed blend blits.
+ *
+ * The BLEND_* macros saturate each 8 bit channel, which is exactly what
+ * the unsigned saturating byte instructions do. MULT is (d * s) >> 8 per
+ * channel, done in 16 bit lanes. A 565 pixel is split into its three
+ * fields; for ADD, SUB, MIN and MAX working on the fields gives the same
+ * result as widening them to 8 bits, blending and dropping the low bits.
+ */
+
+#define BLEND_BYTE(op, sC, dC, r)                       \
+    switch (op)                                         \
+    {                                                   \
+    case PACKED_BLEND_ADD:                              \
+        r = sC + dC;                                    \
+        if (r > 255)                                    \
+            r = 255;                                    \
+        break;                                          \
+    case PACKED_BLEND_SUB:                              \
+        r = dC > sC ? dC - sC : 0;                      \
+        break;                                          \
+    case PACKED_BLEND_MULT:                             \
+        r = (dC * sC) >> 8;                             \
+        break;                                          \
+    case PACKED_BLEND_MIN:                              \
+        r = sC < dC ? sC : dC;                          \
+        break;                                          \
+    default:                                            \
+        r = sC > dC ? sC : dC;                          \
+        break;                                          \
+    }
+
+static INLINE Uint32
+blend_pixel_32 (PackedBlendOp op, Uint32 s, Uint32 d,
+                const BlendBlitLayout32 *layout)
+{
+    Uint32 sC, dC, r, out = 0;
+    int shift;
+
+    for (shift = 0; shift < 32; shift += 8)
+    {
+        sC = (s >> shift) & 0xff;
+        dC = (d >> shift) & 0xff;
+        BLEND_BYTE (op, sC, dC, r);
+        out |= r << shift;
+    }
+    return ((out & layout->opmask) | (d & layout->keepmask) | layout->fill);
+}
+
+static INLINE Uint32
+blend_field (PackedBlendOp op, Uint32 sC, Uint32 dC, Uint32 max)
+{
+    switch (op)
+    {
+    case PACKED_BLEND_ADD:
+        return sC + dC > max ? max : sC + dC;
+    case PACKED_BLEND_SUB:
+        return dC > sC ? dC - sC : 0;
+    case PACKED_BLEND_MIN:
+        return sC < dC ? sC : dC;
+    default:
+        return sC > dC ? sC : dC;
+    }
+}
+
+static INLINE Uint16
+blend_pixel_565 (PackedBlendOp op, Uint16 s, Uint16 d)
+{
+    return (Uint16) ((blend_field (op, s >> 11, d >> 11, 31) << 11) |
+                     (blend_field (op, (s >> 5) & 63, (d >> 5) & 63, 63)
+                      << 5) |
+                     blend_field (op, s & 31, d & 31, 31));
+}
+
+void
+blend_blit_32_ONLYC (PackedBlendOp op,
+                     Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                     int width, int height, const BlendBlitLayout32 *layout)
+{
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n > 0; --n)
+        {
+            *(Uint32 *) dstp = blend_pixel_32 (op, *(Uint32 *) srcp,
+                                               *(Uint32 *) dstp, layout);
+            srcp += 4;
+            dstp += 4;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+void
+blend_blit_565_ONLYC (PackedBlendOp op,
+                      Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                      int width, int height)
+{
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n > 0; --n)
+        {
+            *(Uint16 *) dstp = blend_pixel_565 (op, *(Uint16 *) srcp,
+                                                *(Uint16 *) dstp);
+            srcp += 2;
+            dstp += 2;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+/* Run VOP, an expression of the vectors s and d, over every full vector
+ * of each row and blend_pixel_32 over the rest.
+ */
+#define BLEND_BLIT_32_LOOP(vtype, vsize, load, store, VOP, MERGE)      \
+    while (height--)                                                    \
+    {                                                                   \
+        for (n = width; n >= vsize / 4; n -= vsize / 4)                 \
+        {                                                               \
+            vtype s = load (srcp);                                      \
+            vtype d = load (dstp);                                      \
+            store (dstp, MERGE (VOP, d));                               \
+            srcp += vsize;                                              \
+            dstp += vsize;                                              \
+        }                                                               \
+        for (; n > 0; --n)                                              \
+        {                                                               \
+            *(Uint32 *) dstp = blend_pixel_32 (op, *(Uint32 *) srcp,    \
+                                               *(Uint32 *) dstp,        \
+                                               layout);                 \
+            srcp += 4;                                                  \
+            dstp += 4;                                                  \
+        }                                                               \
+        srcp += srcskip;                                                \
+        dstp += dstskip;                                                \
+    }
+
+#define BLEND_BLIT_32_OPS(vtype, vsize, load, store, ADD, SUB, MUL,    \
+                          MIN, MAX, MERGE)                              \
+    switch (op)                                                         \
+    {                                                                   \
+    case PACKED_BLEND_ADD:                                              \
+        BLEND_BLIT_32_LOOP (vtype, vsize, load, store, ADD (s, d),      \
+                            MERGE);                                     \
+        break;                                                          \
+    case PACKED_BLEND_SUB:                                              \
+        BLEND_BLIT_32_LOOP (vtype, vsize, load, store, SUB (d, s),      \
+                            MERGE);                                     \
+        break;                                                          \
+    case PACKED_BLEND_MULT:                                             \
+        BLEND_BLIT_32_LOOP (vtype, vsize, load, store, MUL (s, d),      \
+                            MERGE);                                     \
+        break;                                                          \
+    case PACKED_BLEND_MIN:                                              \
+        BLEND_BLIT_32_LOOP (vtype, vsize, load, store, MIN (s, d),      \
+                            MERGE);                                     \
+        break;                                                          \
+    default:                                                            \
+        BLEND_BLIT_32_LOOP (vtype, vsize, load, store, MAX (s, d),      \
+                            MERGE);                                     \
+        break;                                                          \
+    }
+
+#ifdef PG_SIMD_X86
+#define SSE2_LOAD(p) _mm_loadu_si128 ((__m128i *) (p))
+#define SSE2_STORE(p, v) _mm_storeu_si128 ((__m128i *) (p), v)
+#define SSE2_MERGE(r, d)                                                \
+    _mm_or_si128 (_mm_or_si128 (_mm_and_si128 (r, opmask),              \
+                                _mm_and_si128 (d, keepmask)), fill)
+
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_mul_epu8 (__m128i s, __m128i d)
+{
+    __m128i zero = _mm_setzero_si128 ();
+    __m128i lo = _mm_mullo_epi16 (_mm_unpacklo_epi8 (s, zero),
+                                  _mm_unpacklo_epi8 (d, zero));
+    __m128i hi = _mm_mullo_epi16 (_mm_unpackhi_epi8 (s, zero),
+                                  _mm_unpackhi_epi8 (d, zero));
+
+    return _mm_packus_epi16 (_mm_srli_epi16 (lo, 8), _mm_srli_epi16 (hi, 8));
+}
+
+PG_TARGET_SSE2 void
+blend_blit_32_SSE2 (PackedBlendOp op,
+                    Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                    int width, int height, const BlendBlitLayout32 *layout)
+{
+    __m128i opmask = _mm_set1_epi32 ((int) layout->opmask);
+    __m128i keepmask = _mm_set1_epi32 ((int) layout->keepmask);
+    __m128i fill = _mm_set1_epi32 ((int) layout->fill);
+    int n;
+
+    BLEND_BLIT_32_OPS (__m128i, 16, SSE2_LOAD, SSE2_STORE,
+                       _mm_adds_epu8, _mm_subs_epu8, sse2_mul_epu8,
+                       _mm_min_epu8, _mm_max_epu8, SSE2_MERGE);
+}
+
+/* Blend the fields of eight 565 pixels. */
+PG_TARGET_SSE2 static INLINE __m128i
+sse2_blend_565 (PackedBlendOp op, __m128i s, __m128i d)
+{
+    __m128i mask5 = _mm_set1_epi16 (31);
+    __m128i mask6 = _mm_set1_epi16 (63);
+    __m128i sr = _mm_srli_epi16 (s, 11);
+    __m128i dr = _mm_srli_epi16 (d, 11);
+    __m128i sg = _mm_and_si128 (_mm_srli_epi16 (s, 5), mask6);
+    __m128i dg = _mm_and_si128 (_mm_srli_epi16 (d, 5), mask6);
+    __m128i sb = _mm_and_si128 (s, mask5);
+    __m128i db = _mm_and_si128 (d, mask5);
+
+    switch (op)
+    {
+    case PACKED_BLEND_ADD:
+        dr = _mm_min_epi16 (_mm_add_epi16 (sr, dr), mask5);
+        dg = _mm_min_epi16 (_mm_add_epi16 (sg, dg), mask6);
+        db = _mm_min_epi16 (_mm_add_epi16 (sb, db), mask5);
+        break;
+    case PACKED_BLEND_SUB:
+        dr = _mm_subs_epu16 (dr, sr);
+        dg = _mm_subs_epu16 (dg, sg);
+        db = _mm_subs_epu16 (db, sb);
+        break;
+    case PACKED_BLEND_MIN:
+        dr = _mm_min_epi16 (sr, dr);
+        dg = _mm_min_epi16 (sg, dg);
+        db = _mm_min_epi16 (sb, db);
+        break;
+    default:
+        dr = _mm_max_epi16 (sr, dr);
+        dg = _mm_max_epi16 (sg, dg);
+        db = _mm_max_epi16 (sb, db);
+        break;
+    }
+    return _mm_or_si128 (_mm_or_si128 (_mm_slli_epi16 (dr, 11),
+                                       _mm_slli_epi16 (dg, 5)), db);
+}
+
+PG_TARGET_SSE2 void
+blend_blit_565_SSE2 (PackedBlendOp op,
+                     Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                     int width, int height)
+{
+    int n;
+
+    while (height--)
+    {
+        for (n = width; n >= 8; n -= 8)
+        {
+            __m128i s = _mm_loadu_si128 ((__m128i *) srcp);
+            __m128i d = _mm_loadu_si128 ((__m128i *) dstp);
+
+            _mm_storeu_si128 ((__m128i *) dstp, sse2_blend_565 (op, s, d));
+            srcp += 16;
+            dstp += 16;
+        }
+        for (; n > 0; --n)
+        {
+            *(Uint16 *) dstp = blend_pixel_565 (op, *(Uint16 *) srcp,
+                                                *(Uint16 *) dstp);
+            srcp += 2;
+            dstp += 2;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+#define AVX2_LOAD(p) _mm256_loadu_si256 ((__m256i *) (p))
+#define AVX2_STORE(p, v) _mm256_storeu_si256 ((__m256i *) (p), v)
+#define AVX2_MERGE(r, d)                                                \
+    _mm256_or_si256 (_mm256_or_si256 (_mm256_and_si256 (r, opmask),    \
+                                      _mm256_and_si256 (d, keepmask)),  \
+                     fill)
+
+PG_TARGET_AVX2 static INLINE __m256i
+avx2_mul_epu8 (__m256i s, __m256i d)
+{
+    __m256i zero = _mm256_setzero_si256 ();
+    __m256i lo = _mm256_mullo_epi16 (_mm256_unpacklo_epi8 (s, zero),
+                                     _mm256_unpacklo_epi8 (d, zero));
+    __m256i hi = _mm256_mullo_epi16 (_mm256_unpackhi_epi8 (s, zero),
+                                     _mm256_unpackhi_epi8 (d, zero));
+
+    /* Unpack and pack both stay within 128 bit lanes */
+    return _mm256_packus_epi16 (_mm256_srli_epi16 (lo, 8),
+                                _mm256_srli_epi16 (hi, 8));
+}
+
+PG_TARGET_AVX2 void
+blend_blit_32_AVX2 (PackedBlendOp op,
+                    Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                    int width, int height, const BlendBlitLayout32 *layout)
+{
+    __m256i opmask = _mm256_set1_epi32 ((int) layout->opmask);
+    __m256i keepmask = _mm256_set1_epi32 ((int) layout->keepmask);
+    __m256i fill = _mm256_set1_epi32 ((int) layout->fill);
+    int n;
+
+    BLEND_BLIT_32_OPS (__m256i, 32, AVX2_LOAD, AVX2_STORE,
+                       _mm256_adds_epu8, _mm256_subs_epu8, avx2_mul_epu8,
+                       _mm256_min_epu8, _mm256_max_epu8, AVX2_MERGE);
+}
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+#define NEON_LOAD(p) vld1q_u8 ((Uint8 *) (p))
+#define NEON_STORE(p, v) vst1q_u8 ((Uint8 *) (p), v)
+#define NEON_MERGE(r, d)                                                \
+    vorrq_u8 (vorrq_u8 (vandq_u8 (r, opmask), vandq_u8 (d, keepmask)),  \
+              fill)
+
+static INLINE uint8x16_t
+neon_mul_u8 (uint8x16_t s, uint8x16_t d)
+{
+    return vcombine_u8 (
+        vshrn_n_u16 (vmull_u8 (vget_low_u8 (s), vget_low_u8 (d)), 8),
+        vshrn_n_u16 (vmull_u8 (vget_high_u8 (s), vget_high_u8 (d)), 8));
+}
+
+void
+blend_blit_32_NEON (PackedBlendOp op,
+                    Uint8 *srcp, int srcskip, Uint8 *dstp, int dstskip,
+                    int width, int height, const BlendBlitLayout32 *layout)
+{
+    uint8x16_t opmask = vreinterpretq_u8_u32 (vdupq_n_u32 (layout->opmask));
+    uint8x16_t keepmask =
+        vreinterpretq_u8_u32 (vdupq_n_u32 (layout->keepmask));
+    uint8x16_t fill = vreinterpretq_u8_u32 (vdupq_n_u32 (layout->fill));
+    int n;
+
+    BLEND_BLIT_32_OPS (uint8x16_t, 16, NEON_LOAD, NEON_STORE,
+                       vqaddq_u8, vqsubq_u8, neon_mul_u8,
+                       vminq_u8, vmaxq_u8, NEON_MERGE);
+}
+#endif /* PG_SIMD_NEON */
+
+BlendBlit32Func
+simd_select_blend_blit_32 (void)
+{
+    BlendBlit32Func func;
+
+    if (blend_blit_32_pick)
+        return blend_blit_32_pick;
+
+    func = blend_blit_32_ONLYC;
+#ifdef PG_SIMD_NEON
+    if (SIMD_ALLOW (SIMD_BACKEND_NEON, SDL_HasNEON))
+        func = blend_blit_32_NEON;
+#endif /* PG_SIMD_NEON */
+#ifdef PG_SIMD_X86
+    if (SIMD_ALLOW (SIMD_BACKEND_SSE2, SDL_HasSSE2))
+        func = blend_blit_32_SSE2;
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_AVX2
+    if (SIMD_ALLOW (SIMD_BACKEND_AVX2, SDL_HasAVX2))
+        func = blend_blit_32_AVX2;
+#endif /* PG_SIMD_AVX2 */
+    blend_blit_32_pick = func;
+    return func;
+}
+
+BlendBlit565Func
+simd_select_blend_blit_565 (void)
+{
+    BlendBlit565Func func;
+
+    if (blend_blit_565_pick)
+        return blend_blit_565_pick;
+
+    func = blend_blit_565_ONLYC;
+#ifdef PG_SIMD_X86
+    if (SIMD_ALLOW (SIMD_BACKEND_SSE2, SDL_HasSSE2))
+        func = blend_blit_565_SSE2;
+#endif /* PG_SIMD_X86 */
+    blend_blit_565_pick = func;
+    return func;
+}
+
+/* Bounding rect scans.
+ *
+ * A row is tested a vector at a time, giving a bit per pixel counted.
+ * The first vector with any bit set holds the pixel looked for; pixels
+ * left over at the end of a row (or the start, scanning backwards) go
+ * through the C version.
+ */
+
+static INLINE int
+bounds_counted_32 (Uint32 pixel, const BoundsScan32 *scan)
+{
+    if (scan->colorkey)
+        return (pixel & scan->mask) != scan->key;
+    return (int) ((pixel >> scan->ashift) & 0xff) >= scan->min_alpha;
+}
+
+int
+bounds_scan_32_ONLYC (const Uint32 *row, int width, int last,
+                      const BoundsScan32 *scan)
+{
+    int i;
+
+    if (last) {
+        for (i = width - 1; i >= 0; --i) {
+            if (bounds_counted_32 (row[i], scan))
+                return i;
+        }
+        return -1;
+    }
+    for (i = 0; i < width; ++i) {
+        if (bounds_counted_32 (row[i], scan))
+            return i;
+    }
+    return -1;
+}
+
+#define BOUNDS_SCAN_32(n, HITS)                                         \
+    int i, j, bits;                                                     \
+                                                                        \
+    if (last) {                                                         \
+        for (i = width - n; i >= 0; i -= n) {                           \
+            bits = HITS (row + i);                                      \
+            if (bits) {                                                 \
+                for (j = n - 1; !(bits & (1 << j)); --j);               \
+                return i + j;                                           \
+            }                                                           \
+        }                                                               \
+        return bounds_scan_32_ONLYC (row, i + n, 1, scan);              \
+    }                                                                   \
+    for (i = 0; i + n <= width; i += n) {                               \
+        bits = HITS (row + i);                                          \
+        if (bits) {                                                     \
+            for (j = 0; !(bits & (1 << j)); ++j);                       \
+            return i + j;                                               \
+        }                                                               \
+    }                                                                   \
+    j = bounds_scan_32_ONLYC (row + i, width - i, 0, scan);             \
+    return j < 0 ? -1 : i + j;
+
+#ifdef PG_SIMD_X86
+PG_TARGET_SSE2 static INLINE int
+sse2_bounds_hits (__m128i v, const BoundsScan32 *scan, __m128i mask,
+                  __m128i key, __m128i shift, __m128i threshold)
+{
+    if (scan->colorkey)
+        return ~_mm_movemask_ps (_mm_castsi128_ps (
+            _mm_cmpeq_epi32 (_mm_and_si128 (v, mask), key))) & 0xf;
+    v = _mm_and_si128 (_mm_srl_epi32 (v, shift), _mm_set1_epi32 (0xff));
+    return _mm_movemask_ps (_mm_castsi128_ps (
+        _mm_cmpgt_epi32 (v, threshold)));
+}
+
+#define SSE2_BOUNDS_HITS(p)                                             \
+    sse2_bounds_hits (SSE2_LOAD (p), scan, mask, key, shift, threshold)
+
+PG_TARGET_SSE2 int
+bounds_scan_32_SSE2 (const Uint32 *row, int width, int last,
+                     const BoundsScan32 *scan)
+{
+    __m128i mask = _mm_set1_epi32 ((int) scan->mask);
+    __m128i key = _mm_set1_epi32 ((int) scan->key);
+    __m128i shift = _mm_cvtsi32_si128 ((int) scan->ashift);
+    __m128i threshold = _mm_set1_epi32 (scan->min_alpha - 1);
+
+    BOUNDS_SCAN_32 (4, SSE2_BOUNDS_HITS);
+}
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+PG_TARGET_AVX2 static INLINE int
+avx2_bounds_hits (__m256i v, const BoundsScan32 *scan, __m256i mask,
+                  __m256i key, __m128i shift, __m256i threshold)
+{
+    if (scan->colorkey)
+        return ~_mm256_movemask_ps (_mm256_castsi256_ps (
+            _mm256_cmpeq_epi32 (_mm256_and_si256 (v, mask), key))) & 0xff;
+    v = _mm256_and_si256 (_mm256_srl_epi32 (v, shift),
+                          _mm256_set1_epi32 (0xff));
+    return _mm256_movemask_ps (_mm256_castsi256_ps (
+        _mm256_cmpgt_epi32 (v, threshold)));
+}
+
+#define AVX2_BOUNDS_HITS(p)                                             \
+    avx2_bounds_hits (AVX2_LOAD (p), scan, mask, key, shift, threshold)
+
+PG_TARGET_AVX2 int
+bounds_scan_32_AVX2 (const Uint32 *row, int width, int last,
+                     const BoundsScan32 *scan)
+{
+    __m256i mask = _mm256_set1_epi32 ((int) scan->mask);
+    __m256i key = _mm256_set1_epi32 ((int) scan->key);
+    __m128i shift = _mm_cvtsi32_si128 ((int) scan->ashift);
+    __m256i threshold = _mm256_set1_epi32 (scan->min_alpha - 1);
+
+    BOUNDS_SCAN_32 (8, AVX2_BOUNDS_HITS);
+}
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+static INLINE int
+neon_bounds_hits (uint32x4_t v, const BoundsScan32 *scan, uint32x4_t mask,
+                  uint32x4_t key, int32x4_t shift, uint32x4_t min_alpha)
+{
+    static const Uint32 lanebits[4] = { 1, 2, 4, 8 };
+    uint32x4_t hits;
+    uint32x2_t half;
+
+    if (scan->colorkey)
+        hits = vmvnq_u32 (vceqq_u32 (vandq_u32 (v, mask), key));
+    else
+        hits = vcgeq_u32 (vandq_u32 (vshlq_u32 (v, shift),
+                                     vdupq_n_u32 (0xff)), min_alpha);
+    hits = vandq_u32 (hits, vld1q_u32 (lanebits));
+    half = vorr_u32 (vget_low_u32 (hits), vget_high_u32 (hits));
+    return (int) (vget_lane_u32 (half, 0) | vget_lane_u32 (half, 1));
+}
+
+#define NEON_BOUNDS_HITS(p)                                             \
+    neon_bounds_hits (vld1q_u32 (p), scan, mask, key, shift, min_alpha)
+
+int
+bounds_scan_32_NEON (const Uint32 *row, int width, int last,
+                     const BoundsScan32 *scan)
+{
+    uint32x4_t mask = vdupq_n_u32 (scan->mask);
+    uint32x4_t key = vdupq_n_u32 (scan->key);
+    int32x4_t shift = vdupq_n_s32 (-(int) scan->ashift);
+    uint32x4_t min_alpha = vdupq_n_u32 ((Uint32) scan->min_alpha);
+
+    BOUNDS_SCAN_32 (4, NEON_BOUNDS_HITS);
+}
+#endif /* PG_SIMD_NEON */
+
+BoundsScan32Func
+simd_select_bounds_scan_32 (void)
+{
+    BoundsScan32Func func;
+
+    if (bounds_scan_32_pick)
+        return bounds_scan_32_pick;
+
+    func = bounds_scan_32_ONLYC;
+#ifdef PG_SIMD_NEON
+    if (SIMD_ALLOW (SIMD_BACKEND_NEON, SDL_HasNEON))
+        func = bounds_scan_32_NEON;
+#endif /* PG_SIMD_NEON */
+#ifdef PG_SIMD_X86
+    if (SIMD_ALLOW (SIMD_BACKEND_SSE2, SDL_HasSSE2))
+        func = bounds_scan_32_SSE2;
+#endif /* PG_SIMD_X86 */
+#ifdef PG_SIMD_AVX2
+    if (SIMD_ALLOW (SIMD_BACKEND_AVX2, SDL_HasAVX2))
+        func = bounds_scan_32_AVX2;
+#endif /* PG_SIMD_AVX2 */
+    bounds_scan_32_pick = func;
+    return func;
+}
@@ -0,0 +1,237 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+  Copyright (C) 2007 Marcus von Appen
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/* SIMD kernels for the software blitters in alphablit.c, and for a few
+ * other whole surface loops of the surface module.
+ *
+ * Each kernel family has a portable C version, used for the row tails and
+ * on machines without a vector unit, plus SSE2, AVX2 and NEON versions where
+ * the compiler can build them. The right one is picked at runtime from the
+ * CPU features SDL reports.
+ */
+
+#ifndef SIMD_BLITTERS_H
+#define SIMD_BLITTERS_H
+
+#include <SDL.h>
+#include "pgsimd.h"
+
+/* Which kernels the simd_select_* functions may pick, for testing and
+ * debugging, see pygame.surface.set_simd_backend. Each family takes the
+ * fastest version at or below the level that the CPU supports.
+ */
+#define SIMD_BACKEND_GENERIC 0
+#define SIMD_BACKEND_SSE2 1
+#define SIMD_BACKEND_NEON 1
+#define SIMD_BACKEND_AVX2 2
+
+/* Return the name of the highest backend in use, like "SSE2" */
+const char *
+simd_get_backend (void);
+
+/* Limit the kernels to a backend by name. Returns 0 on success, -1 for an
+ * unknown name and -2 for one this build or CPU does not have.
+ */
+int
+simd_set_backend (const char *name);
+
+/* Pixel layout of a 32 bit per pixel, 8 bit per channel, alpha blit.
+ * The source and destination keep their alpha (or unused) byte in the
+ * same place; the source red and blue bytes may be swapped relative to
+ * the destination, as for RGBA <-> BGRA.
+ */
+typedef struct
+{
+    Uint32 ashift;     /* Bit offset of the alpha byte                  */
+    Uint32 swapshift;  /* Distance between source R and B, 0 if same    */
+    Uint32 swaplow;    /* Mask of the lower of the two swapped bytes    */
+    Uint32 rgbmask;    /* Destination Rmask | Gmask | Bmask             */
+    Uint32 amask;      /* Destination alpha mask, 0 if not written      */
+    Uint32 dafill;     /* 0xff if destination alpha reads as opaque     */
+} AlphaBlitLayout32;
+
+typedef void (*AlphaBlit32Func) (Uint8 *srcp, int srcskip,
+                                 Uint8 *dstp, int dstskip,
+                                 int width, int height,
+                                 const AlphaBlitLayout32 *layout);
+
+/* Per pixel alpha blit of same or red/blue swapped 32 bit layouts.
+ * These produce exactly what the ALPHA_BLEND macro does.
+ */
+void alphablit_alpha_32_ONLYC (Uint8 *srcp, int srcskip,
+                               Uint8 *dstp, int dstskip,
+                               int width, int height,
+                               const AlphaBlitLayout32 *layout);
+
+#ifdef PG_SIMD_X86
+void alphablit_alpha_32_SSE2 (Uint8 *srcp, int srcskip,
+                              Uint8 *dstp, int dstskip,
+                              int width, int height,
+                              const AlphaBlitLayout32 *layout);
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+void alphablit_alpha_32_AVX2 (Uint8 *srcp, int srcskip,
+                              Uint8 *dstp, int dstskip,
+                              int width, int height,
+                              const AlphaBlitLayout32 *layout);
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+void alphablit_alpha_32_NEON (Uint8 *srcp, int srcskip,
+                              Uint8 *dstp, int dstskip,
+                              int width, int height,
+                              const AlphaBlitLayout32 *layout);
+#endif /* PG_SIMD_NEON */
+
+/* Return the fastest alpha blit kernel this machine supports, up to the
+ * simd_set_backend limit. */
+AlphaBlit32Func
+simd_select_alphablit_alpha_32 (void);
+
+/* Per channel operations of the BLEND_* special flags, done directly on
+ * the packed pixels of a source and destination with the same layout.
+ */
+typedef enum
+{
+    PACKED_BLEND_ADD,
+    PACKED_BLEND_SUB,
+    PACKED_BLEND_MULT,
+    PACKED_BLEND_MIN,
+    PACKED_BLEND_MAX
+} PackedBlendOp;
+
+/* Which destination bits of a 32 bit packed blend get the blended value.
+ * Bits in none of the masks are cleared, as CREATE_PIXEL does for an
+ * unused byte.
+ */
+typedef struct
+{
+    Uint32 opmask;     /* Bytes that take the blend result              */
+    Uint32 keepmask;   /* Bytes left as they are in the destination     */
+    Uint32 fill;       /* Bits always set, an alpha that reads as 255   */
+} BlendBlitLayout32;
+
+typedef void (*BlendBlit32Func) (PackedBlendOp op,
+                                 Uint8 *srcp, int srcskip,
+                                 Uint8 *dstp, int dstskip,
+                                 int width, int height,
+                                 const BlendBlitLayout32 *layout);
+
+/* RGB565 and BGR565 need no layout; MULT is not supported as its result
+ * depends on how 5 and 6 bit channels are widened to 8 bits.
+ */
+typedef void (*BlendBlit565Func) (PackedBlendOp op,
+                                  Uint8 *srcp, int srcskip,
+                                  Uint8 *dstp, int dstskip,
+                                  int width, int height);
+
+void blend_blit_32_ONLYC (PackedBlendOp op,
+                          Uint8 *srcp, int srcskip,
+                          Uint8 *dstp, int dstskip,
+                          int width, int height,
+                          const BlendBlitLayout32 *layout);
+void blend_blit_565_ONLYC (PackedBlendOp op,
+                           Uint8 *srcp, int srcskip,
+                           Uint8 *dstp, int dstskip,
+                           int width, int height);
+
+#ifdef PG_SIMD_X86
+void blend_blit_32_SSE2 (PackedBlendOp op,
+                         Uint8 *srcp, int srcskip,
+                         Uint8 *dstp, int dstskip,
+                         int width, int height,
+                         const BlendBlitLayout32 *layout);
+void blend_blit_565_SSE2 (PackedBlendOp op,
+                          Uint8 *srcp, int srcskip,
+                          Uint8 *dstp, int dstskip,
+                          int width, int height);
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+void blend_blit_32_AVX2 (PackedBlendOp op,
+                         Uint8 *srcp, int srcskip,
+                         Uint8 *dstp, int dstskip,
+                         int width, int height,
+                         const BlendBlitLayout32 *layout);
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+void blend_blit_32_NEON (PackedBlendOp op,
+                         Uint8 *srcp, int srcskip,
+                         Uint8 *dstp, int dstskip,
+                         int width, int height,
+                         const BlendBlitLayout32 *layout);
+#endif /* PG_SIMD_NEON */
+
+/* Return the fastest packed blend kernels this machine supports, up to
+ * the simd_set_backend limit. */
+BlendBlit32Func
+simd_select_blend_blit_32 (void);
+
+BlendBlit565Func
+simd_select_blend_blit_565 (void);
+
+/* What Surface.get_bounding_rect counts as a pixel of a 32 bit surface:
+ * one with an 8 bit alpha of at least min_alpha, or, with a colorkey,
+ * one whose color differs from the key.
+ */
+typedef struct
+{
+    int colorkey;      /* Nonzero to test against the colorkey          */
+    Uint32 mask;       /* Color bits compared with the key              */
+    Uint32 key;        /* Colorkey & mask                               */
+    Uint32 ashift;     /* Bit offset of the alpha byte                  */
+    int min_alpha;     /* Lowest alpha counted, clamped to 0 - 256      */
+} BoundsScan32;
+
+/* Return the index of the first, or with last set the last, counted
+ * pixel of a row, or -1 if there is none.
+ */
+typedef int (*BoundsScan32Func) (const Uint32 *row, int width, int last,
+                                 const BoundsScan32 *scan);
+
+int bounds_scan_32_ONLYC (const Uint32 *row, int width, int last,
+                          const BoundsScan32 *scan);
+
+#ifdef PG_SIMD_X86
+int bounds_scan_32_SSE2 (const Uint32 *row, int width, int last,
+                         const BoundsScan32 *scan);
+#endif /* PG_SIMD_X86 */
+
+#ifdef PG_SIMD_AVX2
+int bounds_scan_32_AVX2 (const Uint32 *row, int width, int last,
+                         const BoundsScan32 *scan);
+#endif /* PG_SIMD_AVX2 */
+
+#ifdef PG_SIMD_NEON
+int bounds_scan_32_NEON (const Uint32 *row, int width, int last,
+                         const BoundsScan32 *scan);
+#endif /* PG_SIMD_NEON */
+
+/* Return the fastest bounding rect scan this machine supports, up to the
+ * simd_set_backend limit. */
+BoundsScan32Func
+simd_select_bounds_scan_32 (void);
+
+#endif /* SIMD_BLITTERS_H */
@@ -31,6 +31,8 @@
 #include "structmember.h"
 #include "pgcompat.h"
 #include "pgbufferproxy.h"
+#include "pgworkers.h"
+#include "simd_blitters.h"
 
 typedef enum {
     VIEWKIND_0D = 0,
@@ -54,9 +56,97 @@ typedef struct pg_bufferinternal_s {
     Py_ssize_t mem[6];         /* Enough memory for dim 3 shape and strides  */
 } Pg_bufferinternal;
 
+/* Destination of one or more blits, see surface_blit_begin */
+typedef struct surf_blit_dest_s {
+    PyObject *dstobj;
+    SDL_Surface *dst;          /* The surface actually blitted to          */
+    SDL_Surface *subsurface;   /* Top level owner of a subsurface dstobj   */
+    int suboffsetx, suboffsety;
+    SDL_Rect orig_clip;        /* Owner clip rect to restore               */
+    struct DirtyRegion_Data *dirty;  /* Changed areas of dst, if tracked   */
+} SurfBlitDest;
+
 int
 PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
                 SDL_Rect * srcrect, int the_args);
+static void surface_blit_begin (PyObject *dstobj, SurfBlitDest *bd);
+static void surface_clear_bounds (PyObject *surfobj);
+static void surface_bounds_32 (SDL_Surface *surf, const BoundsScan32 *scan,
+                               int *min_x, int *min_y,
+                               int *max_x, int *max_y);
+
+static int surface_blit_source (SurfBlitDest *bd, PyObject *srcobj,
+                                SDL_Rect *dstrect, SDL_Rect *srcrect,
+                                int the_args);
+static void surface_blit_end (SurfBlitDest *bd);
+
+void
+PySurface_AddDirty (PyObject *surfobj, SDL_Rect *rect);
+static void surface_dirty_add (struct DirtyRegion_Data *dirty,
+                               SDL_Surface *surf, SDL_Rect *rect);
+
+/* Blit counters, see pygame.surface.get_blit_stats */
+#define BLIT_STATS_MAX 128
+
+typedef struct {
+    const char *path;          /* Which blitter surface_blit_source used  */
+    int srcbpp, dstbpp;        /* Bytes per pixel                         */
+    int flags;                 /* special_flags of the blit               */
+    unsigned PY_LONG_LONG calls;
+    unsigned PY_LONG_LONG pixels;
+    unsigned PY_LONG_LONG ns;
+} BlitStat;
+
+static int blit_stats_enabled = 0;
+static int blit_stats_count = 0;
+static BlitStat blit_stats[BLIT_STATS_MAX];
+
+static Uint64 blit_stats_now (void);
+static void blit_stats_record (const char *path, int srcbpp, int dstbpp,
+                               int flags, SDL_Rect *dstrect, Uint64 start);
+
+/* Pixel buffer pool, see pygame.surface.set_pool_limit. Buffers are
+   grouped in size classes four to each power of two, starting at
+   POOL_MIN_BYTES, so a reused buffer wastes at most a quarter.
+*/
+#define POOL_MIN_BYTES 1024
+#define POOL_CLASSES 84
+#define POOL_DEFAULT_LIMIT (16 * 1024 * 1024)
+
+typedef struct PoolBuffer {
+    struct PoolBuffer *next;
+} PoolBuffer;
+
+typedef struct {
+    void *pixels;              /* NULL for an empty slot                  */
+    SDL_Surface *surf;         /* owner; subsurfaces may share pixels     */
+    int sizeclass;
+} PoolLive;
+
+static size_t pool_limit = POOL_DEFAULT_LIMIT;
+static size_t pool_retained = 0;
+static Py_ssize_t pool_retained_count = 0;
+static PoolBuffer *pool_free[POOL_CLASSES];
+static unsigned PY_LONG_LONG pool_hits = 0;
+static unsigned PY_LONG_LONG pool_misses = 0;
+static unsigned PY_LONG_LONG pool_recycled = 0;
+static unsigned PY_LONG_LONG pool_dropped = 0;
+
+/* Buffers handed out by the pool and not yet returned, an open addressed
+   hash set keyed by pixel pointer.
+*/
+static PoolLive *pool_live = NULL;
+static size_t pool_live_size = 0;
+static size_t pool_live_count = 0;
+
+SDL_Surface*
+PySurface_CreatePooled (Uint32 flags, int width, int height, int depth,
+                        Uint32 Rmask, Uint32 Gmask, Uint32 Bmask,
+                        Uint32 Amask);
+void
+PySurface_FreePooled (SDL_Surface *surf);
+static int pool_is_live (SDL_Surface *surf);
+static void pool_trim (size_t limit);
 
 /* statics */
 #ifndef SDL2
@@ -108,6 +198,9 @@ static PyObject *surf_convert_alpha (PyObject *self, PyObject *args);
 static PyObject *surf_set_clip (PyObject *self, PyObject *args);
 static PyObject *surf_get_clip (PyObject *self);
 static PyObject *surf_blit (PyObject *self, PyObject *args, PyObject *keywds);
+static PyObject *surf_blits (PyObject *self, PyObject *args, PyObject *keywds);
+static PyObject *surf_blit_transformed (PyObject *self, PyObject *args,
+                                        PyObject *keywds);
 static PyObject *surf_fill (PyObject *self, PyObject *args, PyObject *keywds);
 static PyObject *surf_scroll (PyObject *self,
                               PyObject *args, PyObject *keywds);
@@ -213,6 +306,10 @@ static struct PyMethodDef surface_methods[] = {
       DOC_SURFACEFILL },
     { "blit", (PyCFunction) surf_blit, METH_VARARGS | METH_KEYWORDS,
       DOC_SURFACEBLIT },
+    { "blits", (PyCFunction) surf_blits, METH_VARARGS | METH_KEYWORDS,
+      DOC_SURFACEBLITS },
+    { "blit_transformed", (PyCFunction) surf_blit_transformed,
+      METH_VARARGS | METH_KEYWORDS, DOC_SURFACEBLITTRANSFORMED },
 
     { "scroll", (PyCFunction) surf_scroll, METH_VARARGS | METH_KEYWORDS,
       DOC_SURFACESCROLL },
@@ -361,6 +458,11 @@ surface_new (PyTypeObject *type, PyObject *args, PyObject *kwds)
         self->weakreflist = NULL;
         self->dependency = NULL;
         self->locklist = NULL;
+        self->locks = self->inlocks;
+        self->nlocks = 0;
+        self->maxlocks = PG_SURFLOCK_INLINE;
+        self->dirty = NULL;
+        self->bounds = NULL;
     }
     return (PyObject *) self;
 }
@@ -375,11 +477,11 @@ surface_cleanup (PySurfaceObject *self)
             SDL_WasInit (SDL_INIT_VIDEO)) {
             /* unsafe to free hardware surfaces without video init */
             /* i question SDL's ability to free a locked hardware surface */
-            SDL_FreeSurface (self->surf);
+            PySurface_FreePooled (self->surf);
         }
 #else /* SDL2 */
     if (self->surf && self->owner) {
-        SDL_FreeSurface (self->surf);
+        PySurface_FreePooled (self->surf);
 #endif /* SDL2 */
         self->surf = NULL;
     }
@@ -393,9 +495,22 @@ surface_cleanup (PySurfaceObject *self)
         self->dependency = NULL;
     }
 
-    if (self->locklist) {
-        Py_DECREF (self->locklist);
-        self->locklist = NULL;
+    while (self->nlocks > 0) {
+        --self->nlocks;
+        Py_XDECREF (self->locks[self->nlocks].ref);
+    }
+    if (self->locks != self->inlocks) {
+        PyMem_Del (self->locks);
+        self->locks = self->inlocks;
+        self->maxlocks = PG_SURFLOCK_INLINE;
+    }
+    if (self->dirty) {
+        PyMem_Del (self->dirty);
+        self->dirty = NULL;
+    }
+    if (self->bounds) {
+        PyMem_Del (self->bounds);
+        self->bounds = NULL;
     }
 #ifdef SDL2
     self->owner = 0;
@@ -631,11 +746,11 @@ surface_init (PySurfaceObject *self, PyObject *args, PyObject *kwds)
     }
 
 #ifndef SDL2
-    surface = SDL_CreateRGBSurface (flags, width, height, bpp, Rmask, Gmask,
+    surface = PySurface_CreatePooled (flags, width, height, bpp,
 #else /* SDL2 */
-    surface = SDL_CreateRGBSurface (0, width, height, bpp, Rmask, Gmask,
+    surface = PySurface_CreatePooled (0, width, height, bpp,
 #endif /* SDL2 */
-                                    Bmask, Amask);
+                                      Rmask, Gmask, Bmask, Amask);
 
     if (!surface) {
 #ifndef SDL2
@@ -665,7 +780,7 @@ surface_init (PySurfaceObject *self, PyObject *args, PyObject *kwds)
              (format->Rloss || format->Gloss || format->Bloss ||
               (surface->flags & SDL_SRCALPHA ?
                format->Aloss : format->Aloss != 8)))) {
-        SDL_FreeSurface (surface);
+        PySurface_FreePooled (surface);
         RAISE (PyExc_ValueError, "Invalid mask values");
         return -1;
 #else /* SDL2 */
@@ -677,7 +792,7 @@ surface_init (PySurfaceObject *self, PyObject *args, PyObject *kwds)
                                   0,
                                   default_palette_size - 1) != 0) {
             PyErr_SetString (PyExc_SDLError, SDL_GetError ());
-            SDL_FreeSurface (surface);
+            PySurface_FreePooled (surface);
             return -1;
 #endif /* SDL2 */
         }
@@ -997,7 +1112,7 @@ surf_get_locked (PyObject *self)
 {
     PySurfaceObject *surf = (PySurfaceObject *) self;
 
-    if (surf->locklist && PyList_Size (surf->locklist) > 0)
+    if (surf->nlocks > 0)
         Py_RETURN_TRUE;
     Py_RETURN_FALSE;
 }
@@ -1006,20 +1121,25 @@ static PyObject*
 surf_get_locks (PyObject *self)
 {
     PySurfaceObject *surf = (PySurfaceObject *) self;
-    Py_ssize_t len, i = 0;
+    struct SurfLock_Record *rec;
+    Py_ssize_t len = 0, i = 0, j;
     PyObject *tuple, *tmp;
-    if (!surf->locklist)
-        return PyTuple_New (0);
+    int n;
 
-    len = PyList_Size (surf->locklist);
+    for (n = 0; n < surf->nlocks; n++)
+        len += surf->locks[n].count;
     tuple = PyTuple_New (len);
     if (!tuple)
         return NULL;
 
-    for (i = 0; i < len; i++) {
-        tmp = PyWeakref_GetObject (PyList_GetItem (surf->locklist, i));
-        Py_INCREF (tmp);
-        PyTuple_SetItem (tuple, i, tmp);
+    /* one entry for each lock held, as each lock needs an unlock */
+    for (n = 0; n < surf->nlocks; n++) {
+        rec = surf->locks + n;
+        tmp = rec->ref ? PyWeakref_GetObject (rec->ref) : rec->lockobj;
+        for (j = 0; j < rec->count; j++) {
+            Py_INCREF (tmp);
+            PyTuple_SetItem (tuple, i++, tmp);
+        }
     }
     return tuple;
 }
@@ -1190,6 +1310,8 @@ surf_set_palette (PyObject *self, PyObject *args)
     if (ecode != 0)
         return RAISE (PyExc_SDLError, SDL_GetError ());
 #endif /* SDL2 */
+    /* which pixels match the colorkey may have changed */
+    PySurface_ClearBounds (self);
     Py_RETURN_NONE;
 }
 
@@ -1245,6 +1367,7 @@ surf_set_palette_at (PyObject *self, PyObject *args)
     if (SDL_SetPaletteColors (pal, &color, _index, 1) != 0)
         return RAISE (PyExc_SDLError, SDL_GetError ());
 #endif /* SDL2 */
+    PySurface_ClearBounds (self);
 
     Py_RETURN_NONE;
 }
@@ -1896,6 +2019,8 @@ surf_fill (PyObject *self, PyObject *args, PyObject *keywds)
         }
         if (result == -1)
             return RAISE (PyExc_SDLError, SDL_GetError ());
+        surface_clear_bounds (self);
+        PySurface_AddDirty (self, &sdlrect);
     }
     return PyRect_New (&sdlrect);
 }
@@ -1970,6 +2095,270 @@ surf_blit (PyObject *self, PyObject *args, PyObject *keywds)
     return PyRect_New (&dest_rect);
 }
 
+/* surf_blits parses this many items before blitting them, so no Python
+   code runs while the destination is set up for blitting.
+*/
+#define SURF_BLITS_CHUNK 64
+
+typedef struct {
+    PyObject *srcobj;          /* New reference                             */
+    SDL_Rect dstrect;
+    SDL_Rect srcrect;
+    int the_args;
+} SurfBlitsItem;
+
+static PyObject*
+surf_blits (PyObject *self, PyObject *args, PyObject *keywds)
+{
+    SDL_Surface *src, *dest = PySurface_AsSurface (self);
+    GAME_Rect *src_rect, temp;
+    PyObject *blitsequence, *iterator = NULL, *item = NULL, *fastitem = NULL;
+    PyObject *srcobject, *argpos, *argrect, *retrect;
+    PyObject *ret = NULL;
+    SurfBlitDest bd;
+    SurfBlitsItem items[SURF_BLITS_CHUNK];
+    SurfBlitsItem *bi;
+    Py_ssize_t itemlength;
+    int dx, dy, sx, sy;
+    int the_args;
+    int doreturn = 1;
+    int nitems = 0, i, done = 0;
+
+    static char *kwids[] = {"blit_sequence", "doreturn", NULL};
+    if (!PyArg_ParseTupleAndKeywords (args, keywds, "O|i", kwids,
+                                      &blitsequence, &doreturn))
+        return NULL;
+
+    if (!dest)
+        return RAISE (PyExc_SDLError, "display Surface quit");
+#ifndef SDL2
+    if (dest->flags & SDL_OPENGL &&
+        !(dest->flags & (SDL_OPENGLBLIT & ~SDL_OPENGL)))
+        return RAISE (PyExc_SDLError,
+                      "Cannot blit to OPENGL Surfaces (OPENGLBLIT is ok)");
+#endif /* ! SDL2 */
+
+    iterator = PyObject_GetIter (blitsequence);
+    if (!iterator)
+        return NULL;
+    if (doreturn) {
+        ret = PyList_New (0);
+        if (!ret)
+            goto error;
+    }
+
+    while (!done) {
+        /* Parsing can run Python code, which must not find the destination
+           prepped or its owner's clip rect changed.
+        */
+        while (nitems < SURF_BLITS_CHUNK) {
+            item = PyIter_Next (iterator);
+            if (!item) {
+                if (PyErr_Occurred ())
+                    goto error;
+                done = 1;
+                break;
+            }
+            fastitem = PySequence_Fast (item,
+                                        "blit_sequence items must be "
+                                        "sequences of (source, dest[, area[, "
+                                        "special_flags]])");
+            if (!fastitem)
+                goto error;
+            itemlength = PySequence_Fast_GET_SIZE (fastitem);
+            if (itemlength < 2 || itemlength > 4) {
+                PyErr_SetString (PyExc_ValueError,
+                                 "blit_sequence items must have 2 to 4 "
+                                 "values");
+                goto error;
+            }
+            srcobject = PySequence_Fast_GET_ITEM (fastitem, 0);
+            argpos = PySequence_Fast_GET_ITEM (fastitem, 1);
+            argrect = itemlength > 2 ? PySequence_Fast_GET_ITEM (fastitem, 2)
+                                     : NULL;
+            the_args = 0;
+            if (itemlength > 3) {
+                the_args = (int) PyInt_AsLong (
+                    PySequence_Fast_GET_ITEM (fastitem, 3));
+                if (the_args == -1 && PyErr_Occurred ())
+                    goto error;
+            }
+
+            if (!PySurface_Check (srcobject)) {
+                PyErr_SetString (PyExc_TypeError,
+                                 "blit source must be a Surface");
+                goto error;
+            }
+            src = PySurface_AsSurface (srcobject);
+            if (!src) {
+                PyErr_SetString (PyExc_SDLError, "display Surface quit");
+                goto error;
+            }
+
+            if ((src_rect = GameRect_FromObject (argpos, &temp))) {
+                dx = src_rect->x;
+                dy = src_rect->y;
+            }
+            else if (TwoIntsFromObj (argpos, &sx, &sy)) {
+                dx = sx;
+                dy = sy;
+            }
+            else {
+                PyErr_SetString (PyExc_TypeError,
+                                 "invalid destination position for blit");
+                goto error;
+            }
+
+            if (argrect && argrect != Py_None) {
+                if (!(src_rect = GameRect_FromObject (argrect, &temp))) {
+                    PyErr_SetString (PyExc_TypeError,
+                                     "Invalid rectstyle argument");
+                    goto error;
+                }
+            }
+            else {
+                temp.x = temp.y = 0;
+                temp.w = src->w;
+                temp.h = src->h;
+                src_rect = &temp;
+            }
+
+            bi = items + nitems++;
+            Py_INCREF (srcobject);
+            bi->srcobj = srcobject;
+            bi->dstrect.x = (short) dx;
+            bi->dstrect.y = (short) dy;
+            bi->dstrect.w = (unsigned short) src_rect->w;
+            bi->dstrect.h = (unsigned short) src_rect->h;
+            bi->srcrect.x = (short) src_rect->x;
+            bi->srcrect.y = (short) src_rect->y;
+            bi->srcrect.w = (unsigned short) src_rect->w;
+            bi->srcrect.h = (unsigned short) src_rect->h;
+            bi->the_args = the_args;
+
+            Py_DECREF (fastitem);
+            Py_DECREF (item);
+            fastitem = item = NULL;
+        }
+        if (!nitems)
+            break;
+
+        /* Python code may have quit the display since */
+        if (!PySurface_AsSurface (self)) {
+            PyErr_SetString (PyExc_SDLError, "display Surface quit");
+            goto error;
+        }
+        for (i = 0; i < nitems; ++i) {
+            if (!PySurface_AsSurface (items[i].srcobj)) {
+                PyErr_SetString (PyExc_SDLError, "display Surface quit");
+                goto error;
+            }
+        }
+        surface_blit_begin (self, &bd);
+        for (i = 0; i < nitems; ++i) {
+            bi = items + i;
+            if (surface_blit_source (&bd, bi->srcobj, &bi->dstrect,
+                                     &bi->srcrect, bi->the_args))
+                break;
+        }
+        surface_blit_end (&bd);
+        if (i < nitems)
+            goto error;
+
+        for (i = 0; doreturn && i < nitems; ++i) {
+            retrect = PyRect_New (&items[i].dstrect);
+            if (!retrect)
+                goto error;
+            if (PyList_Append (ret, retrect)) {
+                Py_DECREF (retrect);
+                goto error;
+            }
+            Py_DECREF (retrect);
+        }
+        while (nitems) {
+            --nitems;
+            Py_DECREF (items[nitems].srcobj);
+        }
+    }
+    Py_DECREF (iterator);
+
+    if (doreturn)
+        return ret;
+    Py_RETURN_NONE;
+
+error:
+    while (nitems) {
+        --nitems;
+        Py_DECREF (items[nitems].srcobj);
+    }
+    Py_XDECREF (fastitem);
+    Py_XDECREF (item);
+    Py_XDECREF (iterator);
+    Py_XDECREF (ret);
+    return NULL;
+}
+
+static PyObject*
+surf_blit_transformed (PyObject *self, PyObject *args, PyObject *keywds)
+{
+    SDL_Surface *src, *dest = PySurface_AsSurface (self);
+    PyObject *srcobject, *argcenter;
+    float cx, cy;
+    double angle = 0.0, scale = 1.0;
+    int smooth = 0;
+    int result;
+    SDL_Rect dest_rect;
+
+    static char *kwids[] = {"source", "center", "angle", "scale", "smooth",
+                            NULL};
+    if (!PyArg_ParseTupleAndKeywords (args, keywds, "O!O|ddi", kwids,
+                                      &PySurface_Type, &srcobject,
+                                      &argcenter, &angle, &scale, &smooth))
+        return NULL;
+
+    src = PySurface_AsSurface (srcobject);
+    if (!dest || !src)
+        return RAISE (PyExc_SDLError, "display Surface quit");
+#ifndef SDL2
+    if (dest->flags & SDL_OPENGL &&
+        !(dest->flags & (SDL_OPENGLBLIT & ~SDL_OPENGL)))
+        return RAISE (PyExc_SDLError,
+                      "Cannot blit to OPENGL Surfaces (OPENGLBLIT is ok)");
+#endif /* ! SDL2 */
+    if (srcobject == self)
+        return RAISE (PyExc_ValueError,
+                      "Cannot blit_transformed a Surface to itself");
+    if (!TwoFloatsFromObj (argcenter, &cx, &cy))
+        return RAISE (PyExc_TypeError, "invalid center position for blit");
+    if (scale < 0.0)
+        return RAISE (PyExc_ValueError, "scale must not be negative");
+    if (!Py_IS_FINITE (scale) ||
+        (scale != 0.0 && scale < PYGAME_TRANSFORMBLIT_MIN_SCALE))
+        return RAISE (PyExc_ValueError, "scale out of range");
+    if (!Py_IS_FINITE (angle) || !Py_IS_FINITE (cx) || !Py_IS_FINITE (cy))
+        return RAISE (PyExc_ValueError,
+                      "angle and center must be finite numbers");
+    if (dest->format->BytesPerPixel < 2)
+        return RAISE (PyExc_ValueError,
+                      "unsupported bit depth for blit_transformed");
+
+    if (!PySurface_Lock (self))
+        return NULL;
+    if (!PySurface_Lock (srcobject)) {
+        PySurface_Unlock (self);
+        return NULL;
+    }
+    result = pygame_TransformBlit (src, dest, cx, cy, angle, scale, smooth,
+                                   &dest_rect);
+    if (!PySurface_Unlock (srcobject) || !PySurface_Unlock (self))
+        return NULL;
+    if (result == -1)
+        return RAISE (PyExc_SDLError, SDL_GetError ());
+
+    PySurface_AddDirty (self, &dest_rect);
+    return PyRect_New (&dest_rect);
+}
+
 static PyObject*
 surf_scroll (PyObject *self, PyObject *args, PyObject *keywds)
 {
@@ -2047,6 +2436,7 @@ surf_scroll (PyObject *self, PyObject *args, PyObject *keywds)
     if (!PySurface_Unlock (self)) {
         return NULL;
     }
+    PySurface_AddDirty (self, clip_rect);
 
     Py_RETURN_NONE;
 }
@@ -2065,9 +2455,14 @@ surf_get_flags (PyObject *self)
     if (!surf)
         return RAISE (PyExc_SDLError, "display Surface quit");
 #ifndef SDL2
+    /* pooled pixels are an implementation detail, not user memory */
+    if (pool_is_live (surf))
+        return PyInt_FromLong ((long)(surf->flags & ~SDL_PREALLOC));
     return PyInt_FromLong ((long)surf->flags);
 #else /* SDL2 */
     sdl_flags = surf->flags;
+    if (pool_is_live (surf))
+        sdl_flags &= ~SDL_PREALLOC;
     if (SDL_GetSurfaceBlendMode (surf, &mode) != 0)
         return RAISE (PyExc_SDLError, SDL_GetError ());
     if (SDL_ISPIXELFORMAT_ALPHA (surf->format->format)) {
@@ -2213,6 +2608,7 @@ surf_set_masks (PyObject *self, PyObject *args)
     surf->format->Gmask = (Uint32)g;
     surf->format->Bmask = (Uint32)b;
     surf->format->Amask = (Uint32)a;
+    PySurface_ClearBounds (self);
 
     Py_RETURN_NONE;
 }
@@ -2248,6 +2644,7 @@ surf_set_shifts (PyObject *self, PyObject *args)
     surf->format->Gshift = (Uint8)g;
     surf->format->Bshift = (Uint8)b;
     surf->format->Ashift = (Uint8)a;
+    PySurface_ClearBounds (self);
 
     Py_RETURN_NONE;
 }
@@ -2481,6 +2878,67 @@ surf_get_abs_parent (PyObject *self)
     return owner;
 }
 
+/* Find the box around the counted pixels of a 32 bit surface a row at a
+   time. Rows are dropped from the bottom, then the top, until one has a
+   counted pixel. Of the rows between, only the pixels left and right of
+   the box found so far need a look.
+*/
+static void
+surface_bounds_32 (SDL_Surface *surf, const BoundsScan32 *scan,
+                   int *min_x, int *min_y, int *max_x, int *max_y)
+{
+    BoundsScan32Func bounds_scan_32 = simd_select_bounds_scan_32 ();
+    Uint8 *pixels = (Uint8 *) surf->pixels;
+    Uint32 *row;
+    int w = surf->w;
+    int left, right, top, bottom, x, y;
+
+    left = -1;
+    for (bottom = surf->h - 1; bottom >= 0; --bottom) {
+        row = (Uint32 *) (pixels + bottom * surf->pitch);
+        left = bounds_scan_32 (row, w, 0, scan);
+        if (left >= 0)
+            break;
+    }
+    if (left < 0) {
+        *min_x = *min_y = *max_x = *max_y = 0;
+        return;
+    }
+    right = bounds_scan_32 (row, w, 1, scan);
+
+    for (top = 0; top < bottom; ++top) {
+        row = (Uint32 *) (pixels + top * surf->pitch);
+        x = bounds_scan_32 (row, w, 0, scan);
+        if (x >= 0) {
+            if (x < left)
+                left = x;
+            x = bounds_scan_32 (row, w, 1, scan);
+            if (x > right)
+                right = x;
+            break;
+        }
+    }
+
+    for (y = top + 1; y < bottom && (left > 0 || right < w - 1); ++y) {
+        row = (Uint32 *) (pixels + y * surf->pitch);
+        if (left > 0) {
+            x = bounds_scan_32 (row, left, 0, scan);
+            if (x >= 0)
+                left = x;
+        }
+        if (right < w - 1) {
+            x = bounds_scan_32 (row + right + 1, w - right - 1, 1, scan);
+            if (x >= 0)
+                right += x + 1;
+        }
+    }
+
+    *min_x = left;
+    *min_y = top;
+    *max_x = right + 1;
+    *max_y = bottom + 1;
+}
+
 static PyObject *
 surf_get_bounding_rect (PyObject *self, PyObject *args, PyObject *kwargs)
 {
@@ -2505,22 +2963,21 @@ surf_get_bounding_rect (PyObject *self, PyObject *args, PyObject *kwargs)
     Uint32 value;
     Uint8 r, g, b, a;
     int has_colorkey = 0;
-#ifdef SDL2
-    Uint32 colorkey;
-#endif /* SDL2 */
+    Uint32 colorkey = 0;
     Uint8 keyr, keyg, keyb;
+    int cache = 0;
+    struct BoundingRect_Data *bounds;
+    BoundsScan32 scan;
 
-    char *kwids[] = { "min_alpha", NULL };
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", kwids, &min_alpha))
+    char *kwids[] = { "min_alpha", "cache", NULL };
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ii", kwids, &min_alpha,
+                                     &cache))
        return RAISE (PyExc_ValueError,
-                     "get_bounding_rect only accepts a single optional min_alpha argument");
+                     "get_bounding_rect only accepts optional min_alpha and cache arguments");
 
     if (!surf)
         return RAISE (PyExc_SDLError, "display Surface quit");
 
-    if (!PySurface_Lock (self))
-        return RAISE (PyExc_SDLError, "could not lock surface");
-
 #ifndef SDL2
     if (surf->flags & SDL_SRCCOLORKEY) {
 #else /* SDL2 */
@@ -2528,14 +2985,25 @@ surf_get_bounding_rect (PyObject *self, PyObject *args, PyObject *kwargs)
 #endif /* SDL2 */
         has_colorkey = 1;
 #ifndef SDL2
-        SDL_GetRGBA (surf->format->colorkey,
-                     surf->format,
-                     &keyr, &keyg, &keyb, &a);
-#else /* SDL2 */
+        colorkey = surf->format->colorkey;
+#endif /* ! SDL2 */
         SDL_GetRGBA (colorkey, surf->format, &keyr, &keyg, &keyb, &a);
-#endif /* SDL2 */
     }
 
+    /* Subsurfaces are not cached, a write to their owner would not
+       clear it. A locked surface may be written to any time.
+    */
+    bounds = ((PySurfaceObject *) self)->bounds;
+    if (cache && bounds && bounds->valid && !surf->locked &&
+        bounds->min_alpha == min_alpha &&
+        bounds->has_colorkey == has_colorkey &&
+        bounds->colorkey == colorkey) {
+        return PyRect_New (&bounds->rect);
+    }
+
+    if (!PySurface_Lock (self))
+        return RAISE (PyExc_SDLError, "could not lock surface");
+
     pixels = (Uint8 *) surf->pixels;
     if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
         pixels += format->BytesPerPixel - sizeof (Uint32);
@@ -2546,141 +3014,173 @@ surf_get_bounding_rect (PyObject *self, PyObject *args, PyObject *kwargs)
     max_x = surf->w;
     max_y = surf->h;
 
-    found_alpha = 0;
-    for (y = max_y - 1; y >= min_y; --y) {
-        for (x = min_x; x < max_x; ++x) {
-            pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
-            switch (format->BytesPerPixel) {
-
-            case 1:
-                value = *pixel;
-                break;
-            case 2:
-                value = *(Uint16 *)pixel;
-                break;
-            case 3:
-                value = pixel[BYTE0];
-                value |= pixel[BYTE1] << 8;
-                value |= pixel[BYTE2] << 16;
-                break;
-            default:
-                assert(format->BytesPerPixel == 4);
-                value = *(Uint32 *)pixel;
+    /* 32 bit pixels with an 8 bit alpha, or 8 bit colors to compare with
+       a colorkey, are tested straight from the pixel values.
+    */
+    if (format->BytesPerPixel == 4 &&
+        (has_colorkey ? !(format->Rloss | format->Gloss | format->Bloss) :
+         format->Amask == (Uint32) 0xff << format->Ashift)) {
+        scan.colorkey = has_colorkey;
+        scan.mask = format->Rmask | format->Gmask | format->Bmask;
+        scan.key = colorkey & scan.mask;
+        scan.ashift = format->Ashift;
+        scan.min_alpha = min_alpha < 0 ? 0 : min_alpha > 256 ? 256 : min_alpha;
+        surface_bounds_32 (surf, &scan, &min_x, &min_y, &max_x, &max_y);
+    }
+    else {
+        found_alpha = 0;
+        for (y = max_y - 1; y >= min_y; --y) {
+            for (x = min_x; x < max_x; ++x) {
+                pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
+                switch (format->BytesPerPixel) {
+
+                case 1:
+                    value = *pixel;
+                    break;
+                case 2:
+                    value = *(Uint16 *)pixel;
+                    break;
+                case 3:
+                    value = pixel[BYTE0];
+                    value |= pixel[BYTE1] << 8;
+                    value |= pixel[BYTE2] << 16;
+                    break;
+                default:
+                    assert(format->BytesPerPixel == 4);
+                    value = *(Uint32 *)pixel;
+                }
+                SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
+                if ((a >= min_alpha && has_colorkey == 0) ||
+                    (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
+                    found_alpha = 1;
+                    break;
+                }
             }
-            SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
-            if ((a >= min_alpha && has_colorkey == 0) ||
-                (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
-                found_alpha = 1;
+            if (found_alpha == 1) {
                 break;
             }
+            max_y = y;
         }
-        if (found_alpha == 1) {
-            break;
-        }
-        max_y = y;
-    }
-    found_alpha = 0;
-    for (x = max_x - 1; x >= min_x; --x) {
-        for (y = min_y; y < max_y; ++y) {
-            pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
-            switch (format->BytesPerPixel) {
-
-            case 1:
-                value = *pixel;
-                break;
-            case 2:
-                value = *(Uint16 *)pixel;
-                break;
-            case 3:
-                value = pixel[BYTE0];
-                value |= pixel[BYTE1] << 8;
-                value |= pixel[BYTE2] << 16;
-                break;
-            default:
-                assert(format->BytesPerPixel == 4);
-                value = *(Uint32 *)pixel;
+        found_alpha = 0;
+        for (x = max_x - 1; x >= min_x; --x) {
+            for (y = min_y; y < max_y; ++y) {
+                pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
+                switch (format->BytesPerPixel) {
+
+                case 1:
+                    value = *pixel;
+                    break;
+                case 2:
+                    value = *(Uint16 *)pixel;
+                    break;
+                case 3:
+                    value = pixel[BYTE0];
+                    value |= pixel[BYTE1] << 8;
+                    value |= pixel[BYTE2] << 16;
+                    break;
+                default:
+                    assert(format->BytesPerPixel == 4);
+                    value = *(Uint32 *)pixel;
+                }
+                SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
+                if ((a >= min_alpha && has_colorkey == 0) ||
+                    (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
+                    found_alpha = 1;
+                    break;
+                }
             }
-            SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
-            if ((a >= min_alpha && has_colorkey == 0) ||
-                (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
-                found_alpha = 1;
+            if (found_alpha == 1) {
                 break;
             }
+            max_x = x;
         }
-        if (found_alpha == 1) {
-            break;
-        }
-        max_x = x;
-    }
-    found_alpha = 0;
-    for (y = min_y; y < max_y; ++y) {
-        min_y = y;
-        for (x = min_x; x < max_x; ++x) {
-            pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
-            switch (format->BytesPerPixel) {
-
-            case 1:
-                value = *pixel;
-                break;
-            case 2:
-                value = *(Uint16 *)pixel;
-                break;
-            case 3:
-                value = pixel[BYTE0];
-                value |= pixel[BYTE1] << 8;
-                value |= pixel[BYTE2] << 16;
-                break;
-            default:
-                assert(format->BytesPerPixel == 4);
-                value = *(Uint32 *)pixel;
+        found_alpha = 0;
+        for (y = min_y; y < max_y; ++y) {
+            min_y = y;
+            for (x = min_x; x < max_x; ++x) {
+                pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
+                switch (format->BytesPerPixel) {
+
+                case 1:
+                    value = *pixel;
+                    break;
+                case 2:
+                    value = *(Uint16 *)pixel;
+                    break;
+                case 3:
+                    value = pixel[BYTE0];
+                    value |= pixel[BYTE1] << 8;
+                    value |= pixel[BYTE2] << 16;
+                    break;
+                default:
+                    assert(format->BytesPerPixel == 4);
+                    value = *(Uint32 *)pixel;
+                }
+                SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
+                if ((a >= min_alpha && has_colorkey == 0) ||
+                    (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
+                    found_alpha = 1;
+                    break;
+                }
             }
-            SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
-            if ((a >= min_alpha && has_colorkey == 0) ||
-                (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
-                found_alpha = 1;
+            if (found_alpha == 1) {
                 break;
             }
         }
-        if (found_alpha == 1) {
-            break;
-        }
-    }
-    found_alpha = 0;
-    for (x = min_x; x < max_x; ++x) {
-        min_x = x;
-        for (y = min_y; y < max_y; ++y) {
-            pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
-            switch (format->BytesPerPixel) {
-
-            case 1:
-                value = *pixel;
-                break;
-            case 2:
-                value = *(Uint16 *)pixel;
-                break;
-            case 3:
-                value = pixel[BYTE0];
-                value |= pixel[BYTE1] << 8;
-                value |= pixel[BYTE2] << 16;
-                break;
-            default:
-                assert(format->BytesPerPixel == 4);
-                value = *(Uint32 *)pixel;
+        found_alpha = 0;
+        for (x = min_x; x < max_x; ++x) {
+            min_x = x;
+            for (y = min_y; y < max_y; ++y) {
+                pixel = (pixels + y * surf->pitch) + x*format->BytesPerPixel;
+                switch (format->BytesPerPixel) {
+
+                case 1:
+                    value = *pixel;
+                    break;
+                case 2:
+                    value = *(Uint16 *)pixel;
+                    break;
+                case 3:
+                    value = pixel[BYTE0];
+                    value |= pixel[BYTE1] << 8;
+                    value |= pixel[BYTE2] << 16;
+                    break;
+                default:
+                    assert(format->BytesPerPixel == 4);
+                    value = *(Uint32 *)pixel;
+                }
+                SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
+                if ((a >= min_alpha && has_colorkey == 0) ||
+                    (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
+                    found_alpha = 1;
+                    break;
+                }
             }
-            SDL_GetRGBA (value, surf->format, &r, &g, &b, &a);
-            if ((a >= min_alpha && has_colorkey == 0) ||
-                (has_colorkey != 0 && (r != keyr || g != keyg || b != keyb))) {
-                found_alpha = 1;
+            if (found_alpha == 1) {
                 break;
             }
         }
-        if (found_alpha == 1) {
-            break;
-        }
     }
     if (!PySurface_Unlock (self))
         return RAISE (PyExc_SDLError, "could not unlock surface");
 
+    if (cache && !((PySurfaceObject *) self)->subsurface) {
+        if (!bounds) {
+            bounds = PyMem_New (struct BoundingRect_Data, 1);
+            if (!bounds)
+                return PyErr_NoMemory ();
+            ((PySurfaceObject *) self)->bounds = bounds;
+        }
+        bounds->valid = 1;
+        bounds->min_alpha = min_alpha;
+        bounds->has_colorkey = has_colorkey;
+        bounds->colorkey = colorkey;
+        bounds->rect.x = min_x;
+        bounds->rect.y = min_y;
+        bounds->rect.w = max_x - min_x;
+        bounds->rect.h = max_y - min_y;
+    }
+
     rect = PyRect_New4 (min_x, min_y, max_x - min_x, max_y - min_y);
     return rect;
 }
@@ -3484,54 +3984,86 @@ surface_do_overlap (SDL_Surface *src, SDL_Rect *srcrect,
     return dstoffset < span || dstoffset > src->pitch - span;
 }
 
-/*this internal blit function is accessable through the C api*/
-int
-PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
-                SDL_Rect * srcrect, int the_args)
+/* The destination side of a blit: a subsurface destination is swapped
+   for its top level owner, with a clip rect and offsets standing in for the
+   subsurface. It is set up once, then any number of sources can be blitted.
+*/
+static void
+surface_blit_begin (PyObject *dstobj, SurfBlitDest *bd)
 {
-    SDL_Surface *src = PySurface_AsSurface (srcobj);
-    SDL_Surface *dst = PySurface_AsSurface (dstobj);
-    SDL_Surface *subsurface = NULL;
-    int result, suboffsetx = 0, suboffsety = 0;
-    SDL_Rect orig_clip, sub_clip;
-#ifdef SDL2
-    Uint8 alpha;
-#endif /* SDL2 */
+    bd->dstobj = dstobj;
+    bd->dst = PySurface_AsSurface (dstobj);
+    bd->subsurface = NULL;
+    bd->suboffsetx = 0;
+    bd->suboffsety = 0;
+    bd->dirty = ((PySurfaceObject *) dstobj)->dirty;
+    surface_clear_bounds (dstobj);
 
     /* passthrough blits to the real surface */
     if (((PySurfaceObject *) dstobj)->subsurface) {
         PyObject *owner;
         struct SubSurface_Data *subdata;
+        SDL_Rect sub_clip;
 
         subdata = ((PySurfaceObject *) dstobj)->subsurface;
         owner = subdata->owner;
-        subsurface = PySurface_AsSurface (owner);
-        suboffsetx = subdata->offsetx;
-        suboffsety = subdata->offsety;
+        bd->subsurface = PySurface_AsSurface (owner);
+        bd->suboffsetx = subdata->offsetx;
+        bd->suboffsety = subdata->offsety;
 
         while (((PySurfaceObject *) owner)->subsurface) {
             subdata = ((PySurfaceObject *) owner)->subsurface;
             owner = subdata->owner;
-            subsurface = PySurface_AsSurface (owner);
-            suboffsetx += subdata->offsetx;
-            suboffsety += subdata->offsety;
+            bd->subsurface = PySurface_AsSurface (owner);
+            bd->suboffsetx += subdata->offsetx;
+            bd->suboffsety += subdata->offsety;
         }
+        bd->dirty = ((PySurfaceObject *) owner)->dirty;
 
-        SDL_GetClipRect (subsurface, &orig_clip);
-        SDL_GetClipRect (dst, &sub_clip);
-        sub_clip.x += suboffsetx;
-        sub_clip.y += suboffsety;
-        SDL_SetClipRect (subsurface, &sub_clip);
-        dstrect->x += suboffsetx;
-        dstrect->y += suboffsety;
-        dst = subsurface;
+        SDL_GetClipRect (bd->subsurface, &bd->orig_clip);
+        SDL_GetClipRect (bd->dst, &sub_clip);
+        sub_clip.x += bd->suboffsetx;
+        sub_clip.y += bd->suboffsety;
+        SDL_SetClipRect (bd->subsurface, &sub_clip);
+        bd->dst = bd->subsurface;
     }
     else {
         PySurface_Prep (dstobj);
-        subsurface = NULL;
     }
+}
+
+static void
+surface_blit_end (SurfBlitDest *bd)
+{
+    if (bd->subsurface)
+        SDL_SetClipRect (bd->subsurface, &bd->orig_clip);
+    else
+        PySurface_Unprep (bd->dstobj);
+}
+
+/* Blit one source to a destination set up by surface_blit_begin. Returns
+   nonzero, with a Python exception set, on failure.
+*/
+static int
+surface_blit_source (SurfBlitDest *bd, PyObject *srcobj, SDL_Rect *dstrect,
+                     SDL_Rect *srcrect, int the_args)
+{
+    SDL_Surface *src = PySurface_AsSurface (srcobj);
+    SDL_Surface *dst = bd->dst;
+    int result;
+    int srcbpp = src->format->BytesPerPixel;
+    const char *path;
+    Uint64 start = 0;
+#ifdef SDL2
+    Uint8 alpha;
+#endif /* SDL2 */
+
+    dstrect->x += bd->suboffsetx;
+    dstrect->y += bd->suboffsety;
 
     PySurface_Prep (srcobj);
+    if (blit_stats_enabled)
+        start = blit_stats_now ();
 
     /* see if we should handle alpha ourselves */
 #ifndef SDL2
@@ -3545,6 +4077,7 @@ PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
 #endif /* SDL2 */
         /* special case, SDL works */
         (dst->format->BytesPerPixel == 2 || dst->format->BytesPerPixel == 4)) {
+        path = "alphablit";
         /* Py_BEGIN_ALLOW_THREADS */
         result = pygame_AlphaBlit (src, srcrect, dst, dstrect, the_args);
         /* Py_END_ALLOW_THREADS */
@@ -3570,6 +4103,7 @@ PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
              dst->pixels == src->pixels &&
              surface_do_overlap (src, srcrect, dst, dstrect))) {
 #endif /* SDL2 */
+        path = "softblit";
         /* Py_BEGIN_ALLOW_THREADS */
         result = pygame_Blit (src, srcrect, dst, dstrect, the_args);
         /* Py_END_ALLOW_THREADS */
@@ -3585,12 +4119,14 @@ PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
 #endif /* SDL2 */
         /* Py_BEGIN_ALLOW_THREADS */
         if (src->format->BytesPerPixel == 1) {
+            path = "softblit";
             result = pygame_Blit (src, srcrect, dst, dstrect, 0);
         }
         else {
             SDL_PixelFormat *fmt = src->format;
             SDL_PixelFormat newfmt;
 
+            path = "sdl_convert";
             newfmt.palette = 0;  /* Set NULL (or SDL gets confused) */
             newfmt.BitsPerPixel = fmt->BitsPerPixel;
             newfmt.BytesPerPixel = fmt->BytesPerPixel;
@@ -3624,18 +4160,20 @@ PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
         /* Py_END_ALLOW_THREADS */
     }
     else {
+        path = "sdl";
         /* Py_BEGIN_ALLOW_THREADS */
         result = SDL_BlitSurface (src, srcrect, dst, dstrect);
         /* Py_END_ALLOW_THREADS */
     }
 
-    if (subsurface) {
-        SDL_SetClipRect (subsurface, &orig_clip);
-        dstrect->x -= suboffsetx;
-        dstrect->y -= suboffsety;
-    }
-    else
-        PySurface_Unprep (dstobj);
+    if (blit_stats_enabled && result == 0)
+        blit_stats_record (path, srcbpp, dst->format->BytesPerPixel,
+                           the_args, dstrect, start);
+    if (bd->dirty && result == 0)
+        surface_dirty_add (bd->dirty, dst, dstrect);
+
+    dstrect->x -= bd->suboffsetx;
+    dstrect->y -= bd->suboffsety;
     PySurface_Unprep (srcobj);
 
     if (result == -1)
@@ -3646,8 +4184,579 @@ PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
     return result != 0;
 }
 
+/*this internal blit function is accessable through the C api*/
+int
+PySurface_Blit (PyObject * dstobj, PyObject * srcobj, SDL_Rect * dstrect,
+                SDL_Rect * srcrect, int the_args)
+{
+    SurfBlitDest bd;
+    int result;
+
+    surface_blit_begin (dstobj, &bd);
+    result = surface_blit_source (&bd, srcobj, dstrect, srcrect, the_args);
+    surface_blit_end (&bd);
+    return result;
+}
+
+/* Forget the cached bounding rect of a surface and those of the surfaces
+   it is a subsurface of.
+*/
+static void
+surface_clear_bounds (PyObject *surfobj)
+{
+    PySurfaceObject *self = (PySurfaceObject *) surfobj;
+
+    for (;;) {
+        PySurface_ClearBounds (self);
+        if (!self->subsurface)
+            break;
+        self = (PySurfaceObject *) self->subsurface->owner;
+    }
+}
+
+/*this internal function is accessable through the C api*/
+void
+PySurface_AddDirty (PyObject *surfobj, SDL_Rect *rect)
+{
+    PySurfaceObject *self = (PySurfaceObject *) surfobj;
+    struct SubSurface_Data *subdata;
+    SDL_Rect r = *rect;
+
+    while (!self->dirty && self->subsurface) {
+        subdata = self->subsurface;
+        r.x += subdata->offsetx;
+        r.y += subdata->offsety;
+        self = (PySurfaceObject *) subdata->owner;
+    }
+    if (self->dirty && self->surf)
+        surface_dirty_add (self->dirty, self->surf, &r);
+}
+
+/* Add a changed area, clipped to surf, to a dirty region. A rect covered
+   by one already there is dropped. Otherwise it is merged with any rect
+   whose union is no bigger than the two areas added together, and when the
+   region is full, with the one whose union grows the least.
+*/
+static void
+surface_dirty_add (struct DirtyRegion_Data *dirty, SDL_Surface *surf,
+                   SDL_Rect *rect)
+{
+    int x1 = MAX (rect->x, 0);
+    int y1 = MAX (rect->y, 0);
+    int x2 = MIN (rect->x + rect->w, surf->w);
+    int y2 = MIN (rect->y + rect->h, surf->h);
+    int ux1, uy1, ux2, uy2;
+    int i, best;
+    long long area, rarea, uarea, growth, bestgrowth;
+    SDL_Rect *cur;
+
+    if (x1 >= x2 || y1 >= y2)
+        return;
+
+    i = 0;
+    while (i < dirty->count || dirty->count == PG_DIRTY_MAXRECTS) {
+        if (i == dirty->count) {
+            /* full, so force a merge with the closest rect */
+            best = 0;
+            bestgrowth = -1;
+            for (i = 0; i < dirty->count; ++i) {
+                cur = dirty->rects + i;
+                ux1 = MIN (x1, cur->x);
+                uy1 = MIN (y1, cur->y);
+                ux2 = MAX (x2, cur->x + cur->w);
+                uy2 = MAX (y2, cur->y + cur->h);
+                growth = (long long) (ux2 - ux1) * (uy2 - uy1) -
+                         (long long) cur->w * cur->h;
+                if (bestgrowth < 0 || growth < bestgrowth) {
+                    best = i;
+                    bestgrowth = growth;
+                }
+            }
+            i = best;
+        }
+        else {
+            cur = dirty->rects + i;
+            if (x1 >= cur->x && y1 >= cur->y &&
+                x2 <= cur->x + cur->w && y2 <= cur->y + cur->h)
+                return;
+            ux1 = MIN (x1, cur->x);
+            uy1 = MIN (y1, cur->y);
+            ux2 = MAX (x2, cur->x + cur->w);
+            uy2 = MAX (y2, cur->y + cur->h);
+            area = (long long) (x2 - x1) * (y2 - y1);
+            rarea = (long long) cur->w * cur->h;
+            uarea = (long long) (ux2 - ux1) * (uy2 - uy1);
+            if (uarea > area + rarea) {
+                ++i;
+                continue;
+            }
+        }
+
+        /* take the rect out and retry with the union */
+        cur = dirty->rects + i;
+        x1 = MIN (x1, cur->x);
+        y1 = MIN (y1, cur->y);
+        x2 = MAX (x2, cur->x + cur->w);
+        y2 = MAX (y2, cur->y + cur->h);
+        dirty->rects[i] = dirty->rects[--dirty->count];
+        i = 0;
+    }
+
+    cur = dirty->rects + dirty->count++;
+    cur->x = x1;
+    cur->y = y1;
+    cur->w = x2 - x1;
+    cur->h = y2 - y1;
+}
+
+static size_t
+pool_class_size (int sizeclass)
+{
+    size_t base = (size_t) POOL_MIN_BYTES << (sizeclass / 4);
+
+    return base + (base / 4) * (sizeclass % 4);
+}
+
+/* Smallest size class holding size bytes, or -1 if it is too big */
+static int
+pool_class (size_t size)
+{
+    int i;
+
+    for (i = 0; i < POOL_CLASSES; ++i) {
+        if (pool_class_size (i) >= size)
+            return i;
+    }
+    return -1;
+}
+
+static size_t
+pool_hash (void *pixels)
+{
+    return (size_t) (((Uint64) (size_t) pixels >> 4) * 2654435761u) &
+           (pool_live_size - 1);
+}
+
+static int
+pool_live_find (SDL_Surface *surf)
+{
+    size_t i;
+
+    if (!pool_live_count || !surf->pixels)
+        return -1;
+    for (i = pool_hash (surf->pixels); pool_live[i].pixels;
+         i = (i + 1) & (pool_live_size - 1)) {
+        if (pool_live[i].pixels == surf->pixels)
+            return pool_live[i].surf == surf ? (int) i : -1;
+    }
+    return -1;
+}
+
+static int
+pool_is_live (SDL_Surface *surf)
+{
+    return (surf->flags & SDL_PREALLOC) && pool_live_find (surf) >= 0;
+}
+
+/* Make room for one more live buffer. Returns 0 if out of memory. */
+static int
+pool_live_reserve (void)
+{
+    PoolLive *old = pool_live;
+    size_t oldsize = pool_live_size;
+    size_t i, j;
+
+    if ((pool_live_count + 1) * 2 <= pool_live_size)
+        return 1;
+    pool_live_size = oldsize ? oldsize * 2 : 64;
+    pool_live = PyMem_New (PoolLive, pool_live_size);
+    if (!pool_live) {
+        pool_live = old;
+        pool_live_size = oldsize;
+        return 0;
+    }
+    memset (pool_live, 0, pool_live_size * sizeof (PoolLive));
+    for (i = 0; i < oldsize; ++i) {
+        if (!old[i].pixels)
+            continue;
+        for (j = pool_hash (old[i].pixels); pool_live[j].pixels;
+             j = (j + 1) & (pool_live_size - 1));
+        pool_live[j] = old[i];
+    }
+    PyMem_Del (old);
+    return 1;
+}
+
+static void
+pool_live_add (SDL_Surface *surf, int sizeclass)
+{
+    size_t i;
+
+    for (i = pool_hash (surf->pixels); pool_live[i].pixels;
+         i = (i + 1) & (pool_live_size - 1));
+    pool_live[i].pixels = surf->pixels;
+    pool_live[i].surf = surf;
+    pool_live[i].sizeclass = sizeclass;
+    ++pool_live_count;
+}
+
+/* Take a buffer out of the live set and return its size class, or -1 if
+   the pool did not hand it out.
+*/
+static int
+pool_live_remove (SDL_Surface *surf)
+{
+    int found = pool_live_find (surf);
+    int sizeclass;
+    size_t i, j, home;
+
+    if (found < 0)
+        return -1;
+    i = (size_t) found;
+    sizeclass = pool_live[i].sizeclass;
+
+    /* shift later entries of the probe run back into the hole */
+    pool_live[i].pixels = NULL;
+    for (j = (i + 1) & (pool_live_size - 1); pool_live[j].pixels;
+         j = (j + 1) & (pool_live_size - 1)) {
+        home = pool_hash (pool_live[j].pixels);
+        if (((j - home) & (pool_live_size - 1)) >=
+            ((j - i) & (pool_live_size - 1))) {
+            pool_live[i] = pool_live[j];
+            pool_live[j].pixels = NULL;
+            i = j;
+        }
+    }
+    --pool_live_count;
+    return sizeclass;
+}
+
+/* Keep a returned buffer for reuse, or free it if the pool is full */
+static void
+pool_put (void *pixels, int sizeclass)
+{
+    PoolBuffer *buffer = (PoolBuffer *) pixels;
+    size_t classsize = pool_class_size (sizeclass);
+
+    if (pool_retained + classsize > pool_limit) {
+        ++pool_dropped;
+        SDL_free (pixels);
+        return;
+    }
+    buffer->next = pool_free[sizeclass];
+    pool_free[sizeclass] = buffer;
+    pool_retained += classsize;
+    ++pool_retained_count;
+    ++pool_recycled;
+}
+
+/* Free kept buffers, biggest first, until no more than limit bytes stay */
+static void
+pool_trim (size_t limit)
+{
+    PoolBuffer *buffer;
+    int i;
+
+    for (i = POOL_CLASSES - 1; i >= 0 && pool_retained > limit; --i) {
+        while (pool_free[i] && pool_retained > limit) {
+            buffer = pool_free[i];
+            pool_free[i] = buffer->next;
+            SDL_free (buffer);
+            pool_retained -= pool_class_size (i);
+            --pool_retained_count;
+        }
+    }
+}
+
+/*this internal function is accessable through the C api*/
+SDL_Surface*
+PySurface_CreatePooled (Uint32 flags, int width, int height, int depth,
+                        Uint32 Rmask, Uint32 Gmask, Uint32 Bmask,
+                        Uint32 Amask)
+{
+    SDL_Surface *surf;
+    PoolBuffer *buffer;
+    size_t size, classsize;
+    int pitch, sizeclass;
+
+    pitch = (width * ((depth + 7) / 8) + 3) & ~3;
+    size = (size_t) pitch * height;
+    if (!pool_limit || width <= 0 || height <= 0 || size < POOL_MIN_BYTES ||
+#ifndef SDL2
+        /* SDL_CreateRGBSurface may put these in video memory, and alone
+           knows what a bare SDL_SRCCOLORKEY request should give */
+        (flags & (SDL_HWSURFACE | SDL_SRCCOLORKEY)) ||
+        ((flags & SDL_SRCALPHA) && SDL_GetVideoSurface () &&
+         (SDL_GetVideoSurface ()->flags & SDL_HWSURFACE)) ||
+#endif /* ! SDL2 */
+        (sizeclass = pool_class (size)) < 0 || !pool_live_reserve ())
+        return SDL_CreateRGBSurface (flags, width, height, depth,
+                                     Rmask, Gmask, Bmask, Amask);
+
+    classsize = pool_class_size (sizeclass);
+    buffer = pool_free[sizeclass];
+    if (buffer) {
+        pool_free[sizeclass] = buffer->next;
+        pool_retained -= classsize;
+        --pool_retained_count;
+        ++pool_hits;
+    }
+    else {
+        buffer = (PoolBuffer *) SDL_malloc (classsize);
+        if (!buffer)
+            return SDL_CreateRGBSurface (flags, width, height, depth,
+                                         Rmask, Gmask, Bmask, Amask);
+        ++pool_misses;
+    }
+    memset (buffer, 0, size);
+
+    /* The pixels are marked SDL_PREALLOC, so SDL never frees them */
+    surf = SDL_CreateRGBSurfaceFrom (buffer, width, height, depth, pitch,
+                                     Rmask, Gmask, Bmask, Amask);
+    if (!surf) {
+        pool_put (buffer, sizeclass);
+        return NULL;
+    }
+#ifndef SDL2
+    /* SDL_CreateRGBSurfaceFrom takes no flags; keep per pixel alpha
+       blitting as SDL_CreateRGBSurface would have */
+    if ((flags & SDL_SRCALPHA) && !(surf->flags & SDL_SRCALPHA) &&
+        SDL_SetAlpha (surf, SDL_SRCALPHA, SDL_ALPHA_OPAQUE) == -1) {
+        SDL_FreeSurface (surf);
+        pool_put (buffer, sizeclass);
+        return NULL;
+    }
+#endif /* ! SDL2 */
+    pool_live_add (surf, sizeclass);
+    return surf;
+}
+
+/*this internal function is accessable through the C api*/
+void
+PySurface_FreePooled (SDL_Surface *surf)
+{
+    int sizeclass;
+
+    if ((surf->flags & SDL_PREALLOC) &&
+        (sizeclass = pool_live_remove (surf)) >= 0) {
+        if (surf->refcount <= 1) {
+            pool_put (surf->pixels, sizeclass);
+            surf->pixels = NULL;
+        }
+        else {
+            /* Someone else still holds the surface. The buffer came from
+               SDL_malloc, so let SDL free it with the last reference. */
+            surf->flags &= ~SDL_PREALLOC;
+        }
+    }
+    SDL_FreeSurface (surf);
+}
+
+static Uint64
+blit_stats_now (void)
+{
+#ifndef SDL2
+    return (Uint64) SDL_GetTicks () * 1000000;
+#else /* SDL2 */
+    return SDL_GetPerformanceCounter ();
+#endif /* SDL2 */
+}
+
+static void
+blit_stats_record (const char *path, int srcbpp, int dstbpp, int flags,
+                   SDL_Rect *dstrect, Uint64 start)
+{
+    Uint64 elapsed = blit_stats_now () - start;
+    BlitStat *stat;
+    int i;
+
+#ifdef SDL2
+    elapsed = (Uint64) ((double) elapsed * 1.0e9 /
+                        (double) SDL_GetPerformanceFrequency ());
+#endif /* SDL2 */
+
+    for (i = 0; i < blit_stats_count; ++i) {
+        stat = blit_stats + i;
+        if (stat->path == path && stat->srcbpp == srcbpp &&
+            stat->dstbpp == dstbpp && stat->flags == flags)
+            break;
+    }
+    if (i == blit_stats_count) {
+        if (blit_stats_count == BLIT_STATS_MAX)
+            return;
+        stat = blit_stats + blit_stats_count++;
+        stat->path = path;
+        stat->srcbpp = srcbpp;
+        stat->dstbpp = dstbpp;
+        stat->flags = flags;
+        stat->calls = 0;
+        stat->pixels = 0;
+        stat->ns = 0;
+    }
+    stat->calls += 1;
+    stat->pixels += (unsigned PY_LONG_LONG) dstrect->w * dstrect->h;
+    stat->ns += elapsed;
+}
+
+static PyObject*
+set_parallelism (PyObject *self, PyObject *args, PyObject *keywds)
+{
+    int nthreads = 0;
+    int min_pixels = PG_WORKERS_MIN_PIXELS;
+
+    static char *kwids[] = {"n", "min_pixels", NULL};
+    if (!PyArg_ParseTupleAndKeywords (args, keywds, "|ii", kwids,
+                                      &nthreads, &min_pixels))
+        return NULL;
+    if (nthreads < 0)
+        return RAISE (PyExc_ValueError, "thread count must not be negative");
+    if (min_pixels < 0)
+        return RAISE (PyExc_ValueError, "min_pixels must not be negative");
+
+    pg_workers_configure (nthreads, min_pixels);
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+get_parallelism (PyObject *self)
+{
+    int nthreads, min_pixels;
+
+    pg_workers_get_config (&nthreads, &min_pixels);
+    return Py_BuildValue ("(ii)", nthreads, min_pixels);
+}
+
+static PyObject*
+set_blit_stats (PyObject *self, PyObject *args)
+{
+    PyObject *enabled;
+
+    if (!PyArg_ParseTuple (args, "O", &enabled))
+        return NULL;
+    blit_stats_enabled = PyObject_IsTrue (enabled);
+    if (blit_stats_enabled == -1) {
+        blit_stats_enabled = 0;
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+get_blit_stats (PyObject *self)
+{
+    PyObject *dict, *key, *value;
+    BlitStat *stat;
+    int i, ecode;
+
+    dict = PyDict_New ();
+    if (!dict)
+        return NULL;
+    for (i = 0; i < blit_stats_count; ++i) {
+        stat = blit_stats + i;
+        key = Py_BuildValue ("(siii)", stat->path, stat->srcbpp,
+                             stat->dstbpp, stat->flags);
+        value = Py_BuildValue ("(KKK)", stat->calls, stat->pixels,
+                               stat->ns);
+        if (!key || !value) {
+            Py_XDECREF (key);
+            Py_XDECREF (value);
+            Py_DECREF (dict);
+            return NULL;
+        }
+        ecode = PyDict_SetItem (dict, key, value);
+        Py_DECREF (key);
+        Py_DECREF (value);
+        if (ecode) {
+            Py_DECREF (dict);
+            return NULL;
+        }
+    }
+    return dict;
+}
+
+static PyObject*
+reset_blit_stats (PyObject *self)
+{
+    blit_stats_count = 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+set_pool_limit (PyObject *self, PyObject *args)
+{
+    Py_ssize_t limit;
+
+    if (!PyArg_ParseTuple (args, "n", &limit))
+        return NULL;
+    if (limit < 0)
+        return RAISE (PyExc_ValueError, "pool limit must not be negative");
+    pool_limit = (size_t) limit;
+    pool_trim (pool_limit);
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+get_pool_stats (PyObject *self)
+{
+    return Py_BuildValue ("{s:K,s:K,s:K,s:K,s:n,s:n,s:n,s:n}",
+                          "hits", pool_hits,
+                          "misses", pool_misses,
+                          "recycled", pool_recycled,
+                          "dropped", pool_dropped,
+                          "retained_bytes", (Py_ssize_t) pool_retained,
+                          "retained_buffers", pool_retained_count,
+                          "live_buffers", (Py_ssize_t) pool_live_count,
+                          "limit", (Py_ssize_t) pool_limit);
+}
+
+static PyObject*
+get_simd_backend (PyObject *self)
+{
+    return Text_FromUTF8 (simd_get_backend ());
+}
+
+static PyObject*
+set_simd_backend (PyObject *self, PyObject *args, PyObject *keywds)
+{
+    const char *type;
+
+    static char *kwids[] = {"type", NULL};
+    if (!PyArg_ParseTupleAndKeywords (args, keywds, "s:set_simd_backend",
+                                      kwids, &type))
+        return NULL;
+    switch (simd_set_backend (type)) {
+
+    case 0:
+        Py_RETURN_NONE;
+    case -2:
+        return PyErr_Format (PyExc_ValueError,
+                             "%s not supported on this machine", type);
+    default:
+        return PyErr_Format (PyExc_ValueError, "Unknown backend type %s",
+                             type);
+    }
+}
+
 static PyMethodDef _surface_methods[] =
 {
+    { "set_blit_stats", set_blit_stats, METH_VARARGS,
+      DOC_PYGAMESURFACESETBLITSTATS },
+    { "get_blit_stats", (PyCFunction) get_blit_stats, METH_NOARGS,
+      DOC_PYGAMESURFACEGETBLITSTATS },
+    { "reset_blit_stats", (PyCFunction) reset_blit_stats, METH_NOARGS,
+      DOC_PYGAMESURFACERESETBLITSTATS },
+    { "set_parallelism", (PyCFunction) set_parallelism,
+      METH_VARARGS | METH_KEYWORDS, DOC_PYGAMESURFACESETPARALLELISM },
+    { "get_parallelism", (PyCFunction) get_parallelism, METH_NOARGS,
+      DOC_PYGAMESURFACEGETPARALLELISM },
+    { "set_pool_limit", set_pool_limit, METH_VARARGS,
+      DOC_PYGAMESURFACESETPOOLLIMIT },
+    { "get_pool_stats", (PyCFunction) get_pool_stats, METH_NOARGS,
+      DOC_PYGAMESURFACEGETPOOLSTATS },
+    { "get_simd_backend", (PyCFunction) get_simd_backend, METH_NOARGS,
+      DOC_PYGAMESURFACEGETSIMDBACKEND },
+    { "set_simd_backend", (PyCFunction) set_simd_backend,
+      METH_VARARGS | METH_KEYWORDS, DOC_PYGAMESURFACESETSIMDBACKEND },
     { NULL, NULL, 0, NULL }
 };
 
@@ -3742,6 +4851,11 @@ MODINIT_DEFINE (surface)
     c_api[1] = PgSurface_New;
 #endif /* SDL2 */
     c_api[2] = PySurface_Blit;
+    c_api[3] = PySurface_AddDirty;
+    c_api[4] = PySurface_CreatePooled;
+    c_api[5] = PySurface_FreePooled;
+    c_api[6] = pg_workers_bands;
+    c_api[7] = pg_workers_run;
     apiobj = encapsulate_api (c_api, "surface");
     if (apiobj == NULL) {
         DECREF_MOD (module);
@@ -365,4 +365,12 @@ int
 pygame_Blit (SDL_Surface * src, SDL_Rect * srcrect,
              SDL_Surface * dst, SDL_Rect * dstrect, int the_args);
 
+/* Smallest nonzero scale pygame_TransformBlit accepts */
+#define PYGAME_TRANSFORMBLIT_MIN_SCALE (1.0 / 65536)
+
+int
+pygame_TransformBlit (SDL_Surface *src, SDL_Surface *dst, double cx,
+                      double cy, double angle, double scale, int smooth,
+                      SDL_Rect *dstrect);
+
 #endif /* SURFACE_H */
@@ -19,6 +19,7 @@
 
 #define NO_PYGAME_C_API
 #include "_surface.h"
+#include "pgworkers.h"
 
 /*
  * Changes SDL_Rect to respect any clipping rect defined on the surface.
@@ -928,88 +929,124 @@ surface_fill_blend_rgba_max (SDL_Surface *surface, SDL_Rect *rect, Uint32 color)
 }
 
 
+/* One blend fill split into row bands for the worker pool */
+typedef struct
+{
+    SDL_Surface *surface;
+    SDL_Rect *rect;
+    Uint32 color;
+    int (*fillfunc) (SDL_Surface *, SDL_Rect *, Uint32);
+    int result;
+} FillBlendJob;
+
+static void
+surface_fill_blend_band (void *job, int first, int count)
+{
+    FillBlendJob *filljob = (FillBlendJob *) job;
+    SDL_Rect band = *filljob->rect;
+
+    band.y += first;
+    band.h = count;
+    if (filljob->fillfunc (filljob->surface, &band, filljob->color))
+        filljob->result = -1;
+}
+
 int
 surface_fill_blend (SDL_Surface *surface, SDL_Rect *rect, Uint32 color,
                     int blendargs)
 {
     int result = -1;
     int locked = 0;
+    int nbands;
+    int (*fillfunc) (SDL_Surface *, SDL_Rect *, Uint32) = NULL;
 
     surface_respect_clip_rect(surface, rect);
 
-    /* Lock the surface, if needed */
-    if (SDL_MUSTLOCK (surface))
-    {
-        if (SDL_LockSurface (surface) < 0)
-            return -1;
-        locked = 1;
-    }
-
     switch (blendargs)
     {
     case PYGAME_BLEND_ADD:
     {
-        result = surface_fill_blend_add (surface, rect, color);
+        fillfunc = surface_fill_blend_add;
         break;
     }
     case PYGAME_BLEND_SUB:
     {
-        result = surface_fill_blend_sub (surface, rect, color);
+        fillfunc = surface_fill_blend_sub;
         break;
     }
     case PYGAME_BLEND_MULT:
     {
-        result =  surface_fill_blend_mult (surface, rect, color);
+        fillfunc = surface_fill_blend_mult;
         break;
     }
     case PYGAME_BLEND_MIN:
     {
-        result =  surface_fill_blend_min (surface, rect, color);
+        fillfunc = surface_fill_blend_min;
         break;
     }
     case PYGAME_BLEND_MAX:
     {
-        result =  surface_fill_blend_max (surface, rect, color);
+        fillfunc = surface_fill_blend_max;
         break;
     }
 
-
-
     case PYGAME_BLEND_RGBA_ADD:
     {
-        result = surface_fill_blend_rgba_add (surface, rect, color);
+        fillfunc = surface_fill_blend_rgba_add;
         break;
     }
     case PYGAME_BLEND_RGBA_SUB:
     {
-        result = surface_fill_blend_rgba_sub (surface, rect, color);
+        fillfunc = surface_fill_blend_rgba_sub;
         break;
     }
     case PYGAME_BLEND_RGBA_MULT:
     {
-        result =  surface_fill_blend_rgba_mult (surface, rect, color);
+        fillfunc = surface_fill_blend_rgba_mult;
         break;
     }
     case PYGAME_BLEND_RGBA_MIN:
     {
-        result =  surface_fill_blend_rgba_min (surface, rect, color);
+        fillfunc = surface_fill_blend_rgba_min;
         break;
     }
     case PYGAME_BLEND_RGBA_MAX:
     {
-        result =  surface_fill_blend_rgba_max (surface, rect, color);
+        fillfunc = surface_fill_blend_rgba_max;
         break;
     }
 
-
-
-
     default:
     {
-        result = -1;
-        break;
+        return -1;
+    }
+    }
+
+    /* Lock the surface, if needed */
+    if (SDL_MUSTLOCK (surface))
+    {
+        if (SDL_LockSurface (surface) < 0)
+            return -1;
+        locked = 1;
     }
+
+    nbands = pg_workers_bands (rect->w, rect->h);
+    if (nbands > 1)
+    {
+        FillBlendJob job;
+
+        job.surface = surface;
+        job.rect = rect;
+        job.color = color;
+        job.fillfunc = fillfunc;
+        job.result = 0;
+        Py_BEGIN_ALLOW_THREADS;
+        pg_workers_run (surface_fill_blend_band, &job, rect->h, nbands);
+        Py_END_ALLOW_THREADS;
+        result = job.result;
     }
+    else
+        result = fillfunc (surface, rect, color);
 
     if (locked)
     {
@@ -68,29 +68,94 @@ PySurface_Unlock (PyObject* surfobj)
     return PySurface_UnlockBy (surfobj, surfobj);
 }
 
+/* Find the record of a lock object. A record whose object died has a dead
+   weak reference, so a new object at the same address does not match it.
+*/
+static struct SurfLock_Record*
+_find_lock (PySurfaceObject* surf, PyObject* lockobj)
+{
+    struct SurfLock_Record *rec = surf->locks;
+    int i;
+
+    for (i = 0; i < surf->nlocks; ++i, ++rec)
+    {
+        if (rec->lockobj == lockobj &&
+            (!rec->ref || PyWeakref_GetObject (rec->ref) == lockobj))
+            return rec;
+    }
+    return NULL;
+}
+
+static struct SurfLock_Record*
+_add_lock (PySurfaceObject* surf, PyObject* lockobj)
+{
+    struct SurfLock_Record *rec;
+    PyObject *ref = NULL;
+
+    if (lockobj != (PyObject*) surf)
+    {
+        ref = PyWeakref_NewRef (lockobj, NULL);
+        if (!ref)
+            return NULL;
+    }
+    if (surf->nlocks == surf->maxlocks)
+    {
+        int size = surf->maxlocks * 2;
+
+        if (surf->locks == surf->inlocks)
+        {
+            rec = PyMem_New (struct SurfLock_Record, size);
+            if (rec)
+                memcpy (rec, surf->inlocks,
+                        sizeof (surf->inlocks[0]) * surf->nlocks);
+        }
+        else
+        {
+            rec = surf->locks;
+            PyMem_Resize (rec, struct SurfLock_Record, size);
+        }
+        if (!rec)
+        {
+            Py_XDECREF (ref);
+            PyErr_NoMemory ();
+            return NULL;
+        }
+        surf->locks = rec;
+        surf->maxlocks = size;
+    }
+    rec = surf->locks + surf->nlocks++;
+    rec->lockobj = lockobj;
+    rec->ref = ref;
+    rec->count = 0;
+    return rec;
+}
+
+static void
+_remove_lock (PySurfaceObject* surf, struct SurfLock_Record* rec)
+{
+    Py_XDECREF (rec->ref);
+    --surf->nlocks;
+    memmove (rec, rec + 1,
+             sizeof (*rec) * (surf->nlocks - (rec - surf->locks)));
+}
+
 static int
 PySurface_LockBy (PyObject* surfobj, PyObject* lockobj)
 {
-    PyObject *ref;
     PySurfaceObject* surf = (PySurfaceObject*) surfobj;
+    struct SurfLock_Record *rec;
 
-    if (!surf->locklist)
+    rec = _find_lock (surf, lockobj);
+    if (!rec)
     {
-        surf->locklist = PyList_New (0);
-        if (!surf->locklist)
+        rec = _add_lock (surf, lockobj);
+        if (!rec)
             return 0;
     }
-    ref = PyWeakref_NewRef (lockobj, NULL);
-    if (!ref)
-        return 0;
-    if (ref == Py_None)
-    {
-        Py_DECREF (ref);
-        return 0;
-    }
-    PyList_Append (surf->locklist, ref);
-    Py_DECREF (ref);
+    ++rec->count;
 
+    /* whoever locks the pixels may change them */
+    PySurface_ClearBounds (surfobj);
     if (surf->subsurface)
         PySurface_Prep (surfobj);
     if (SDL_LockSurface (surf->surf) == -1)
@@ -105,45 +170,29 @@ static int
 PySurface_UnlockBy (PyObject* surfobj, PyObject* lockobj)
 {
     PySurfaceObject* surf = (PySurfaceObject*) surfobj;
-    int found = 0;
-    int noerror = 1;
+    struct SurfLock_Record *rec;
+    Py_ssize_t found = 0;
+    int i;
 
-    if (surf->locklist)
+    rec = _find_lock (surf, lockobj);
+    if (rec)
     {
-        PyObject *item, *ref;
-        Py_ssize_t len = PyList_Size (surf->locklist);
-        while (--len >= 0 && !found)
-        {
-            item = PyList_GetItem (surf->locklist, len);
-            ref = PyWeakref_GetObject (item);
-            if (ref == lockobj)
-            {
-                if (PySequence_DelItem (surf->locklist, len) == -1)
-                    return 0;
-                else
-                    found = 1;
-            }
-        }
+        found = 1;
+        if (--rec->count == 0)
+            _remove_lock (surf, rec);
+    }
 
-        /* Clear dead references */
-        len = PyList_Size (surf->locklist);
-        while (--len >= 0)
+    /* Release the locks of objects that died without unlocking */
+    for (i = surf->nlocks - 1; i >= 0; --i)
+    {
+        rec = surf->locks + i;
+        if (rec->ref && PyWeakref_GetObject (rec->ref) == Py_None)
         {
-            item = PyList_GetItem (surf->locklist, len);
-            ref = PyWeakref_GetObject (item);
-            if (ref == Py_None)
-            {
-                if (PySequence_DelItem (surf->locklist, len) == -1)
-                    noerror = 0;
-                else
-                    found++;
-            }
+            found += rec->count;
+            _remove_lock (surf, rec);
         }
     }
 
-    if (!found)
-        return noerror;
-
     /* Release all found locks. */
     while (found > 0)
     {
@@ -154,7 +203,7 @@ PySurface_UnlockBy (PyObject* surfobj, PyObject* lockobj)
         found--;
     }
 
-    return noerror;
+    return 1;
 }
 
 
@@ -33,42 +33,34 @@
 
 
 typedef void (* SMOOTHSCALE_FILTER_P)(Uint8 *, Uint8 *, int, int, int, int, int);
+typedef void (* SMOOTHSCALE_HALVE_P)(Uint8 *, Uint8 *, int, int, int, int);
 struct _module_state {
     const char *filter_type;
     SMOOTHSCALE_FILTER_P filter_shrink_X;
     SMOOTHSCALE_FILTER_P filter_shrink_Y;
     SMOOTHSCALE_FILTER_P filter_expand_X;
     SMOOTHSCALE_FILTER_P filter_expand_Y;
+    SMOOTHSCALE_HALVE_P filter_halve;
+    SMOOTHSCALE_FILTER_P filter_blur_X;
+    SMOOTHSCALE_FILTER_P filter_blur_Y;
 };
 
-#if defined(SCALE_MMX_SUPPORT)
-
 #include <SDL_cpuinfo.h>
 
 #if PY3
 #define GETSTATE(m) PY3_GETSTATE (_module_state, m)
 #else
-static struct _module_state _state = {0, 0, 0, 0, 0};
+static struct _module_state _state = {0, 0, 0, 0, 0, 0, 0, 0};
 #define GETSTATE(m) PY2_GETSTATE (_state)
 #endif
 
-#else /* if defined(SCALE_MMX_SUPPORT) */
-
 static void filter_shrink_X_ONLYC(Uint8 *, Uint8 *, int, int, int, int, int);
 static void filter_shrink_Y_ONLYC(Uint8 *, Uint8 *, int, int, int, int, int);
 static void filter_expand_X_ONLYC(Uint8 *, Uint8 *, int, int, int, int, int);
 static void filter_expand_Y_ONLYC(Uint8 *, Uint8 *, int, int, int, int, int);
-
-static struct _module_state _state = {
-    "GENERIC",
-    filter_shrink_X_ONLYC,
-    filter_shrink_Y_ONLYC,
-    filter_expand_X_ONLYC,
-    filter_expand_Y_ONLYC};
-#define GETSTATE(m) PY2_GETSTATE (_state)
-#define smoothscale_init(st)
-
-#endif /* if defined(SCALE_MMX_SUPPORT) */
+static void filter_halve_ONLYC(Uint8 *, Uint8 *, int, int, int, int);
+static void filter_blur_X_ONLYC(Uint8 *, Uint8 *, int, int, int, int, int);
+static void filter_blur_Y_ONLYC(Uint8 *, Uint8 *, int, int, int, int, int);
 
 void scale2x (SDL_Surface *src, SDL_Surface *dst);
 extern SDL_Surface* rotozoomSurface (SDL_Surface *src, double angle,
@@ -89,10 +81,12 @@ newsurf_fromsurf (SDL_Surface* surf, int width, int height)
             (RAISE (PyExc_ValueError,
                     "unsupport Surface bit depth for transform"));
 
-    newsurf = SDL_CreateRGBSurface (surf->flags, width, height,
-                                    surf->format->BitsPerPixel,
-                                    surf->format->Rmask, surf->format->Gmask,
-                                    surf->format->Bmask, surf->format->Amask);
+    newsurf = PySurface_CreatePooled (surf->flags, width, height,
+                                      surf->format->BitsPerPixel,
+                                      surf->format->Rmask,
+                                      surf->format->Gmask,
+                                      surf->format->Bmask,
+                                      surf->format->Amask);
     if (!newsurf)
         return (SDL_Surface*) (RAISE (PyExc_SDLError, SDL_GetError ()));
 
@@ -118,7 +112,7 @@ newsurf_fromsurf (SDL_Surface* surf, int width, int height)
                                   0, surf->format->palette->ncolors) != 0)
         {
             PyErr_SetString (PyExc_SDLError, SDL_GetError ());
-            SDL_FreeSurface (newsurf);
+            PySurface_FreePooled (newsurf);
             return NULL;
         }
     }
@@ -129,7 +123,7 @@ newsurf_fromsurf (SDL_Surface* surf, int width, int height)
             SDL_SetSurfaceRLE (newsurf, SDL_TRUE) != 0)
         {
             PyErr_SetString (PyExc_SDLError, SDL_GetError ());
-            SDL_FreeSurface (newsurf);
+            PySurface_FreePooled (newsurf);
             return NULL;
         }
     }
@@ -138,7 +132,7 @@ newsurf_fromsurf (SDL_Surface* surf, int width, int height)
     if (SDL_SetSurfaceAlphaMod (newsurf, alpha) != 0)
     {
         PyErr_SetString (PyExc_SDLError, SDL_GetError ());
-        SDL_FreeSurface (newsurf);
+        PySurface_FreePooled (newsurf);
         return NULL;
 #endif /* SDL2 */
     }
@@ -268,11 +262,85 @@ rotate90 (SDL_Surface *src, int angle)
 }
 
 
+/* Floor and ceiling of n / d for either sign of d */
+static long long
+rotate_floor_div (long long n, long long d)
+{
+    long long q = n / d;
+
+    if ((n % d != 0) && ((n < 0) != (d < 0)))
+        q--;
+    return q;
+}
+
+static long long
+rotate_ceil_div (long long n, long long d)
+{
+    return -rotate_floor_div (-n, d);
+}
+
+/* Narrow [*first, *end) to the x where lo <= start + x * step <= hi */
+static void
+rotate_clip_span (int start, int step, int lo, int hi, int *first, int *end)
+{
+    long long a, b;
+
+    if (step == 0)
+    {
+        if (start < lo || start > hi)
+            *end = *first;
+        return;
+    }
+    if (step > 0)
+    {
+        a = rotate_ceil_div ((long long) lo - start, step);
+        b = rotate_floor_div ((long long) hi - start, step);
+    }
+    else
+    {
+        a = rotate_ceil_div ((long long) hi - start, step);
+        b = rotate_floor_div ((long long) lo - start, step);
+    }
+    if (a > *first)
+        *first = a > *end ? *end : (int) a;
+    if (b + 1 < *end)
+        *end = b + 1 < *first ? *first : (int) (b + 1);
+}
+
+/* The loop over the rows of a rotation. Each row is clipped to the span
+ * of pixels whose source is inside src, so only COPY, which reads the
+ * source at (dx >> 16, dy >> 16), runs there and only FILL outside it.
+ * LO and HI_X, HI_Y bound dx and dy within the span.
+ */
+#define ROTATE_ROWS(LO, HI_X, HI_Y, COPY, FILL)                         \
+    for (y = 0; y < dst->h; y++)                                        \
+    {                                                                   \
+        dx = (ax + (isin * (cy - y))) + xd;                             \
+        dy = (ay - (icos * (cy - y))) + yd;                             \
+        first = 0;                                                      \
+        end = dst->w;                                                   \
+        rotate_clip_span (dx, icos, LO, HI_X, &first, &end);            \
+        rotate_clip_span (dy, isin, LO, HI_Y, &first, &end);            \
+        for (x = 0; x < first; x++)                                     \
+            FILL;                                                       \
+        dx += first * icos;                                             \
+        dy += first * isin;                                             \
+        for (; x < end; x++)                                            \
+        {                                                               \
+            COPY;                                                       \
+            dx += icos;                                                 \
+            dy += isin;                                                 \
+        }                                                               \
+        for (; x < dst->w; x++)                                         \
+            FILL;                                                       \
+        dstrow += dstpitch;                                             \
+    }
+
 static void
 rotate (SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor, double sangle,
         double cangle)
 {
-    int x, y, dx, dy;
+    int x, y, dx, dy, first, end;
 
     Uint8 *srcpix = (Uint8*) src->pixels;
     Uint8 *dstrow = (Uint8*) dst->pixels;
@@ -295,92 +363,168 @@ rotate (SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor, double sangle,
     switch (src->format->BytesPerPixel)
     {
     case 1:
-        for (y = 0; y < dst->h; y++)
-        {
-            Uint8 *dstpos = (Uint8*)dstrow;
-            dx = (ax + (isin * (cy - y))) + xd;
-            dy = (ay - (icos * (cy - y))) + yd;
-            for (x = 0; x < dst->w; x++)
-            {
-                if(dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                    *dstpos++ = bgcolor;
-                else
-                    *dstpos++ = *(Uint8*)
-                        (srcpix + ((dy >> 16) * srcpitch) + (dx >> 16));
-                dx += icos;
-                dy += isin;
-            }
-            dstrow += dstpitch;
-        }
+        ROTATE_ROWS (0, xmaxval, ymaxval,
+                     dstrow[x] = *(srcpix + ((dy >> 16) * srcpitch) +
+                                   (dx >> 16)),
+                     dstrow[x] = (Uint8) bgcolor)
         break;
     case 2:
-        for (y = 0; y < dst->h; y++)
-        {
-            Uint16 *dstpos = (Uint16*)dstrow;
-            dx = (ax + (isin * (cy - y))) + xd;
-            dy = (ay - (icos * (cy - y))) + yd;
-            for (x = 0; x < dst->w; x++)
-            {
-                if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                    *dstpos++ = bgcolor;
-                else
-                    *dstpos++ = *(Uint16*)
-                        (srcpix + ((dy >> 16) * srcpitch) + (dx >> 16 << 1));
-                dx += icos;
-                dy += isin;
-            }
-            dstrow += dstpitch;
-        }
+        ROTATE_ROWS (0, xmaxval, ymaxval,
+                     ((Uint16*)dstrow)[x] = *(Uint16*)
+                         (srcpix + ((dy >> 16) * srcpitch) + (dx >> 16 << 1)),
+                     ((Uint16*)dstrow)[x] = (Uint16) bgcolor)
         break;
     case 4:
-        for (y = 0; y < dst->h; y++)
-        {
-            Uint32 *dstpos = (Uint32*)dstrow;
-            dx = (ax + (isin * (cy - y))) + xd;
-            dy = (ay - (icos * (cy - y))) + yd;
-            for (x = 0; x < dst->w; x++)
-            {
-                if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                    *dstpos++ = bgcolor;
-                else
-                    *dstpos++ = *(Uint32*)
-                        (srcpix + ((dy >> 16) * srcpitch) + (dx >> 16 << 2));
-                dx += icos;
-                dy += isin;
-            }
-            dstrow += dstpitch;
-        }
+        ROTATE_ROWS (0, xmaxval, ymaxval,
+                     ((Uint32*)dstrow)[x] = *(Uint32*)
+                         (srcpix + ((dy >> 16) * srcpitch) + (dx >> 16 << 2)),
+                     ((Uint32*)dstrow)[x] = bgcolor)
         break;
     default: /*case 3:*/
-        for (y = 0; y < dst->h; y++)
-        {
-            Uint8 *dstpos = (Uint8*)dstrow;
-            dx = (ax + (isin * (cy - y))) + xd;
-            dy = (ay - (icos * (cy - y))) + yd;
-            for (x = 0; x < dst->w; x++)
-            {
-                if (dx < 0 || dy < 0 || dx > xmaxval || dy > ymaxval)
-                {
-                    dstpos[0] = ((Uint8*) &bgcolor)[0];
-                    dstpos[1] = ((Uint8*) &bgcolor)[1];
-                    dstpos[2] = ((Uint8*) &bgcolor)[2];
-                    dstpos += 3;
-                }
-                else
-                {
-                    Uint8* srcpos = (Uint8*)
-                        (srcpix + ((dy >> 16) * srcpitch) + ((dx >> 16) * 3));
-                    dstpos[0] = srcpos[0];
-                    dstpos[1] = srcpos[1];
-                    dstpos[2] = srcpos[2];
-                    dstpos += 3;
-                }
-                dx += icos; dy += isin;
-            }
-            dstrow += dstpitch;
-        }
+    {
+        Uint8 *bg = (Uint8*) &bgcolor;
+        Uint8 *srcpos;
+
+        ROTATE_ROWS (0, xmaxval, ymaxval,
+                     (srcpos = srcpix + ((dy >> 16) * srcpitch) +
+                               ((dx >> 16) * 3),
+                      dstrow[x * 3] = srcpos[0],
+                      dstrow[x * 3 + 1] = srcpos[1],
+                      dstrow[x * 3 + 2] = srcpos[2]),
+                     (dstrow[x * 3] = bg[0],
+                      dstrow[x * 3 + 1] = bg[1],
+                      dstrow[x * 3 + 2] = bg[2]))
         break;
     }
+    }
+}
+
+/* Blend two pixels, 8 bits a channel, by f / 256 of b, rounding */
+static INLINE Uint32
+rotate_lerp (Uint32 a, Uint32 b, int f)
+{
+    Uint32 rb = ((((a & 0xff00ff) * (256 - f)) + ((b & 0xff00ff) * f) +
+                  0x800080) >> 8) & 0xff00ff;
+    Uint32 ag = ((((a >> 8) & 0xff00ff) * (256 - f)) +
+                 (((b >> 8) & 0xff00ff) * f) + 0x800080) & 0xff00ff00;
+
+    return rb | ag;
+}
+
+/* Source pixels as 8 bit channels in a Uint32, and the reverse */
+#define ROTATE_GET4(p) (*(Uint32*) (p))
+#define ROTATE_GET3(p)                                                  \
+    ((Uint32) (p)[0] | ((Uint32) (p)[1] << 8) | ((Uint32) (p)[2] << 16))
+#define ROTATE_PUT4(p, c) (*(Uint32*) (p) = (c))
+#define ROTATE_PUT3(p, c)                                               \
+    ((p)[0] = (Uint8) (c), (p)[1] = (Uint8) ((c) >> 8),                 \
+     (p)[2] = (Uint8) ((c) >> 16))
+
+/* A source pixel, or bg outside the source */
+#define ROTATE_EDGE(GET, BPP, px, py)                                   \
+    ((px) < 0 || (py) < 0 || (px) >= src->w || (py) >= src->h ? bg :    \
+     GET (srcpix + (py) * srcpitch + (px) * (BPP)))
+
+/* The bilinear row loop of rotate_smooth. The span where any of the
+ * four source pixels of a dst pixel is inside src is [first, end), and
+ * within it all four are inside for [inner, innerend). Only the pixels
+ * between the two need the checks of ROTATE_EDGE.
+ */
+#define ROTATE_SMOOTH_ROWS(GET, PUT, BPP)                               \
+    for (y = 0; y < dst->h; y++)                                        \
+    {                                                                   \
+        dx = (ax + (isin * (cy - y))) + xd;                             \
+        dy = (ay - (icos * (cy - y))) + yd;                             \
+        first = 0;                                                      \
+        end = dst->w;                                                   \
+        rotate_clip_span (dx, icos, -0x8000, (src->w << 16) + 0x7fff,   \
+                          &first, &end);                                \
+        rotate_clip_span (dy, isin, -0x8000, (src->h << 16) + 0x7fff,   \
+                          &first, &end);                                \
+        inner = first;                                                  \
+        innerend = end;                                                 \
+        rotate_clip_span (dx, icos, 0x8000, (src->w << 16) - 0x8001,    \
+                          &inner, &innerend);                           \
+        rotate_clip_span (dy, isin, 0x8000, (src->h << 16) - 0x8001,    \
+                          &inner, &innerend);                           \
+        if (inner == innerend)                                          \
+            inner = innerend = end;                                     \
+        for (x = 0; x < first; x++)                                     \
+            PUT (dstrow + x * (BPP), bg);                               \
+        dx += first * icos;                                             \
+        dy += first * isin;                                             \
+        for (; x < end; x++)                                            \
+        {                                                               \
+            px = ((dx + 0x8000) >> 16) - 1;                             \
+            py = ((dy + 0x8000) >> 16) - 1;                             \
+            fx = ((dx + 0x8000) >> 8) & 0xff;                           \
+            fy = ((dy + 0x8000) >> 8) & 0xff;                           \
+            if (x >= inner && x < innerend)                             \
+            {                                                           \
+                Uint8 *p = srcpix + py * srcpitch + px * (BPP);         \
+                top = rotate_lerp (GET (p), GET (p + (BPP)), fx);       \
+                p += srcpitch;                                          \
+                bottom = rotate_lerp (GET (p), GET (p + (BPP)), fx);    \
+            }                                                           \
+            else                                                        \
+            {                                                           \
+                top = rotate_lerp (ROTATE_EDGE (GET, BPP, px, py),      \
+                                   ROTATE_EDGE (GET, BPP, px + 1, py),  \
+                                   fx);                                 \
+                bottom = rotate_lerp (                                  \
+                    ROTATE_EDGE (GET, BPP, px, py + 1),                 \
+                    ROTATE_EDGE (GET, BPP, px + 1, py + 1), fx);        \
+            }                                                           \
+            color = rotate_lerp (top, bottom, fy);                      \
+            PUT (dstrow + x * (BPP), color);                            \
+            dx += icos;                                                 \
+            dy += isin;                                                 \
+        }                                                               \
+        for (; x < dst->w; x++)                                         \
+            PUT (dstrow + x * (BPP), bg);                               \
+        dstrow += dstpitch;                                             \
+    }
+
+/* rotate for 24 and 32 bit surfaces with a bilinear filter. Each pixel
+ * blends the four source pixels around its center, taking bgcolor for
+ * those outside the source, so the edges are smoothed too.
+ */
+static void
+rotate_smooth (SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor,
+               double sangle, double cangle)
+{
+    int x, y, dx, dy, first, end, inner, innerend;
+    int px, py, fx, fy;
+    Uint32 bg, top, bottom, color;
+
+    Uint8 *srcpix = (Uint8*) src->pixels;
+    Uint8 *dstrow = (Uint8*) dst->pixels;
+    int srcpitch = src->pitch;
+    int dstpitch = dst->pitch;
+
+    int cy = dst->h / 2;
+    int xd = ((src->w - dst->w) << 15);
+    int yd = ((src->h - dst->h) << 15);
+
+    int isin = (int)(sangle * 65536);
+    int icos = (int)(cangle * 65536);
+
+    int ax = ((dst->w) << 15) - (int)(cangle * ((dst->w - 1) << 15));
+    int ay = ((dst->h) << 15) - (int)(sangle * ((dst->w - 1) << 15));
+
+    /* dx + 0x8000 is the position relative to the center of the pixel
+     * before the first, so px is the left and top of the four pixels.
+     */
+    if (src->format->BytesPerPixel == 4)
+    {
+        bg = bgcolor;
+        ROTATE_SMOOTH_ROWS (ROTATE_GET4, ROTATE_PUT4, 4)
+    }
+    else
+    {
+        bg = ROTATE_GET3 ((Uint8*) &bgcolor);
+        ROTATE_SMOOTH_ROWS (ROTATE_GET3, ROTATE_PUT3, 3)
+    }
 }
 
 static void
@@ -628,27 +772,23 @@ surf_scale2x (PyObject* self, PyObject* arg)
 }
 
 static PyObject*
-surf_rotate (PyObject* self, PyObject* arg)
+rotate_surface (PyObject *surfobj, float angle, int smooth)
 {
-    PyObject *surfobj;
     SDL_Surface* surf, *newsurf;
-    float angle;
 
     double radangle, sangle, cangle;
     double x, y, cx, cy, sx, sy;
     int nxmax,nymax;
     Uint32 bgcolor;
 
-    /*get all the arguments*/
-    if (!PyArg_ParseTuple (arg, "O!f", &PySurface_Type, &surfobj, &angle))
-        return NULL;
     surf = PySurface_AsSurface (surfobj);
 
     if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4)
         return RAISE (PyExc_ValueError,
                       "unsupport Surface bit depth for transform");
-
-
+    if (smooth && surf->format->BytesPerPixel < 3)
+        return RAISE (PyExc_ValueError,
+                      "Only 24-bit or 32-bit surfaces can be smoothly rotated");
 
     if ( !( fmod((double)angle, (double)90.0f) ) ) {
         PySurface_Lock (surfobj);
@@ -722,7 +862,10 @@ surf_rotate (PyObject* self, PyObject* arg)
     PySurface_Lock (surfobj);
 
     Py_BEGIN_ALLOW_THREADS;
-    rotate (surf, newsurf, bgcolor, sangle, cangle);
+    if (smooth)
+        rotate_smooth (surf, newsurf, bgcolor, sangle, cangle);
+    else
+        rotate (surf, newsurf, bgcolor, sangle, cangle);
     Py_END_ALLOW_THREADS;
 
     PySurface_Unlock (surfobj);
@@ -731,6 +874,320 @@ surf_rotate (PyObject* self, PyObject* arg)
     return PySurface_New (newsurf);
 }
 
+static PyObject*
+surf_rotate (PyObject* self, PyObject* arg, PyObject* kwds)
+{
+    PyObject *surfobj;
+    float angle;
+    int smooth = 0;
+    static char *keywords[] = {"surface", "angle", "smooth", NULL};
+
+    /*get all the arguments*/
+    if (!PyArg_ParseTupleAndKeywords (arg, kwds, "O!f|i", keywords,
+                                      &PySurface_Type, &surfobj, &angle,
+                                      &smooth))
+        return NULL;
+    return rotate_surface (surfobj, angle, smooth);
+}
+
+/* RotationCache: the rotations of one surface at multiples of an angle
+ * step, made when first asked for. Once they take more than the byte
+ * budget the least recently used are dropped. The entries form a doubly
+ * linked LRU list by index, most recently used first.
+ */
+#define ROTATIONCACHE_DEFAULT_BUDGET (16 << 20)
+#define ROTATIONCACHE_MAX_ANGLES 3600
+
+typedef struct {
+    PyObject *surfobj;          /* the rotated Surface, or NULL */
+    Py_ssize_t nbytes;
+    int prev;
+    int next;
+} RotationCacheEntry;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject *surfobj;
+    double step;
+    int nangles;
+    RotationCacheEntry *entries;
+    int first;                  /* most recently used, or -1 */
+    int last;                   /* least recently used, or -1 */
+    int count;
+    Py_ssize_t nbytes;
+    Py_ssize_t budget;
+    unsigned PY_LONG_LONG hits;
+    unsigned PY_LONG_LONG misses;
+    unsigned PY_LONG_LONG evictions;
+} PyRotationCacheObject;
+
+static void
+rotationcache_unlink (PyRotationCacheObject *self, int i)
+{
+    RotationCacheEntry *e = &self->entries[i];
+
+    if (e->prev >= 0)
+        self->entries[e->prev].next = e->next;
+    else
+        self->first = e->next;
+    if (e->next >= 0)
+        self->entries[e->next].prev = e->prev;
+    else
+        self->last = e->prev;
+    e->prev = e->next = -1;
+}
+
+static void
+rotationcache_push (PyRotationCacheObject *self, int i)
+{
+    RotationCacheEntry *e = &self->entries[i];
+
+    e->prev = -1;
+    e->next = self->first;
+    if (self->first >= 0)
+        self->entries[self->first].prev = i;
+    else
+        self->last = i;
+    self->first = i;
+}
+
+static void
+rotationcache_drop (PyRotationCacheObject *self, int i)
+{
+    RotationCacheEntry *e = &self->entries[i];
+    PyObject *surfobj = e->surfobj;
+
+    rotationcache_unlink (self, i);
+    self->nbytes -= e->nbytes;
+    self->count--;
+    e->surfobj = NULL;
+    e->nbytes = 0;
+    Py_DECREF (surfobj);
+}
+
+static void
+rotationcache_trim (PyRotationCacheObject *self)
+{
+    while (self->nbytes > self->budget && self->last >= 0)
+    {
+        rotationcache_drop (self, self->last);
+        self->evictions++;
+    }
+}
+
+static PyObject*
+rotationcache_new (PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyRotationCacheObject *self;
+    PyObject *surfobj;
+    double step;
+    Py_ssize_t budget = ROTATIONCACHE_DEFAULT_BUDGET;
+    int i, nangles;
+    static char *keywords[] = {"surface", "step", "budget", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords (args, kwds, "O!d|n:RotationCache",
+                                      keywords, &PySurface_Type, &surfobj,
+                                      &step, &budget))
+        return NULL;
+    if (!(step >= 360.0 / ROTATIONCACHE_MAX_ANGLES && step <= 360.0))
+        return RAISE (PyExc_ValueError,
+                      "step must be at least 0.1 and at most 360 degrees");
+    if (budget < 0)
+        return RAISE (PyExc_ValueError, "budget must not be negative");
+    if (PySurface_AsSurface (surfobj)->format->BytesPerPixel <= 0 ||
+        PySurface_AsSurface (surfobj)->format->BytesPerPixel > 4)
+        return RAISE (PyExc_ValueError,
+                      "unsupport Surface bit depth for transform");
+
+    /* a step that does not divide 360 leaves a shorter last one */
+    nangles = (int) ceil (360.0 / step - 1e-9);
+    if (nangles < 1)
+        nangles = 1;
+
+    self = (PyRotationCacheObject *) type->tp_alloc (type, 0);
+    if (self == NULL)
+        return NULL;
+    self->entries = PyMem_New (RotationCacheEntry, nangles);
+    if (self->entries == NULL)
+    {
+        Py_DECREF (self);
+        return PyErr_NoMemory ();
+    }
+    for (i = 0; i < nangles; i++)
+    {
+        self->entries[i].surfobj = NULL;
+        self->entries[i].nbytes = 0;
+        self->entries[i].prev = self->entries[i].next = -1;
+    }
+    Py_INCREF (surfobj);
+    self->surfobj = surfobj;
+    self->step = step;
+    self->nangles = nangles;
+    self->first = self->last = -1;
+    self->budget = budget;
+    return (PyObject *) self;
+}
+
+static void
+rotationcache_dealloc (PyRotationCacheObject *self)
+{
+    int i;
+
+    if (self->entries != NULL)
+    {
+        for (i = 0; i < self->nangles; i++)
+            Py_XDECREF (self->entries[i].surfobj);
+        PyMem_Del (self->entries);
+    }
+    Py_XDECREF (self->surfobj);
+    Py_TYPE (self)->tp_free ((PyObject *) self);
+}
+
+static PyObject*
+rotationcache_get (PyRotationCacheObject *self, PyObject *args)
+{
+    RotationCacheEntry *e;
+    PyObject *surfobj;
+    SDL_Surface *surf;
+    double angle, above;
+    int i;
+
+    if (!PyArg_ParseTuple (args, "d", &angle))
+        return NULL;
+    if (!Py_IS_FINITE (angle))
+        return RAISE (PyExc_ValueError, "angle must be a finite number");
+
+    /* the nearest step; the one above the last entry is 360, that is 0 */
+    angle = fmod (angle, 360.0);
+    if (angle < 0.0)
+        angle += 360.0;
+    i = (int) floor (angle / self->step);
+    above = (i + 1 < self->nangles) ? (i + 1) * self->step : 360.0;
+    if (above - angle <= angle - i * self->step)
+        i++;
+    if (i < 0 || i >= self->nangles)
+        i = 0;
+    e = &self->entries[i];
+
+    if (e->surfobj != NULL)
+    {
+        self->hits++;
+        rotationcache_unlink (self, i);
+        rotationcache_push (self, i);
+        Py_INCREF (e->surfobj);
+        return e->surfobj;
+    }
+
+    self->misses++;
+    surfobj = rotate_surface (self->surfobj, (float) (i * self->step), 0);
+    if (surfobj == NULL)
+        return NULL;
+    surf = PySurface_AsSurface (surfobj);
+    e->nbytes = (Py_ssize_t) surf->pitch * surf->h;
+    if (e->nbytes > self->budget)
+    {
+        /* too big to keep at all */
+        e->nbytes = 0;
+        return surfobj;
+    }
+    Py_INCREF (surfobj);
+    e->surfobj = surfobj;
+    rotationcache_push (self, i);
+    self->nbytes += e->nbytes;
+    self->count++;
+    rotationcache_trim (self);
+    return surfobj;
+}
+
+static PyObject*
+rotationcache_clear (PyRotationCacheObject *self)
+{
+    while (self->first >= 0)
+        rotationcache_drop (self, self->first);
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+rotationcache_set_budget (PyRotationCacheObject *self, PyObject *args)
+{
+    Py_ssize_t budget;
+
+    if (!PyArg_ParseTuple (args, "n", &budget))
+        return NULL;
+    if (budget < 0)
+        return RAISE (PyExc_ValueError, "budget must not be negative");
+    self->budget = budget;
+    rotationcache_trim (self);
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+rotationcache_get_stats (PyRotationCacheObject *self)
+{
+    return Py_BuildValue ("{s:K,s:K,s:K,s:i,s:n,s:n}",
+                          "hits", self->hits,
+                          "misses", self->misses,
+                          "evictions", self->evictions,
+                          "entries", self->count,
+                          "bytes", self->nbytes,
+                          "budget", self->budget);
+}
+
+static PyMethodDef rotationcache_methods[] =
+{
+    { "get", (PyCFunction) rotationcache_get, METH_VARARGS,
+          DOC_ROTATIONCACHEGET },
+    { "clear", (PyCFunction) rotationcache_clear, METH_NOARGS,
+          DOC_ROTATIONCACHECLEAR },
+    { "set_budget", (PyCFunction) rotationcache_set_budget, METH_VARARGS,
+          DOC_ROTATIONCACHESETBUDGET },
+    { "get_stats", (PyCFunction) rotationcache_get_stats, METH_NOARGS,
+          DOC_ROTATIONCACHEGETSTATS },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject PyRotationCache_Type =
+{
+    TYPE_HEAD (NULL, 0)
+    "pygame.transform.RotationCache",   /* tp_name */
+    sizeof (PyRotationCacheObject),     /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor) rotationcache_dealloc, /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_compare */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    DOC_PYGAMETRANSFORMROTATIONCACHE,   /* Documentation string */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    rotationcache_methods,              /* tp_methods */
+    0,                                  /* tp_members */
+    0,                                  /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    0,                                  /* tp_init */
+    0,                                  /* tp_alloc */
+    rotationcache_new,                  /* tp_new */
+};
+
 static PyObject*
 surf_flip (PyObject* self, PyObject* arg)
 {
@@ -896,6 +1353,124 @@ surf_flip (PyObject* self, PyObject* arg)
     return PySurface_New (newsurf);
 }
 
+typedef void (* FLIP_ROW_P)(Uint8 *, int, int);
+
+static void
+flip_row_ONLYC (Uint8 *row, int width, int bpp)
+{
+    int x;
+
+    switch (bpp)
+    {
+    case 1:
+    {
+        Uint8 *pix = row, t;
+        for (x = 0; x < width / 2; x++)
+        {
+            t = pix[x];
+            pix[x] = pix[width - 1 - x];
+            pix[width - 1 - x] = t;
+        }
+        break;
+    }
+    case 2:
+    {
+        Uint16 *pix = (Uint16 *) row, t;
+        for (x = 0; x < width / 2; x++)
+        {
+            t = pix[x];
+            pix[x] = pix[width - 1 - x];
+            pix[width - 1 - x] = t;
+        }
+        break;
+    }
+    case 4:
+    {
+        Uint32 *pix = (Uint32 *) row, t;
+        for (x = 0; x < width / 2; x++)
+        {
+            t = pix[x];
+            pix[x] = pix[width - 1 - x];
+            pix[width - 1 - x] = t;
+        }
+        break;
+    }
+    default:
+        flip_row_tail (row, row + width * bpp, bpp);
+        break;
+    }
+}
+
+static FLIP_ROW_P
+flip_row_pick (void)
+{
+#if defined(PG_SIMD_X86)
+    if (SDL_HasSSE2 ())
+        return flip_row_SSE2;
+#endif
+#if defined(PG_SIMD_NEON)
+    if (SDL_HasNEON ())
+        return flip_row_NEON;
+#endif
+    return flip_row_ONLYC;
+}
+
+static PyObject*
+surf_flip_ip (PyObject* self, PyObject* arg)
+{
+    PyObject *surfobj;
+    SDL_Surface *surf;
+    FLIP_ROW_P flip_row = flip_row_pick ();
+    int xaxis, yaxis;
+    int y, bpp, pitch, rowlen;
+    Uint8 *pixels, *top, *bottom, *temp = NULL;
+
+    if (!PyArg_ParseTuple (arg, "O!ii", &PySurface_Type, &surfobj,
+                           &xaxis, &yaxis))
+        return NULL;
+    surf = PySurface_AsSurface (surfobj);
+    bpp = surf->format->BytesPerPixel;
+    pitch = surf->pitch;
+    rowlen = surf->w * bpp;
+
+    if (yaxis && surf->h > 1)
+    {
+        temp = (Uint8 *) malloc (rowlen ? rowlen : 1);
+        if (temp == NULL)
+            return PyErr_NoMemory ();
+    }
+
+    PySurface_Lock (surfobj);
+    pixels = (Uint8 *) surf->pixels;
+
+    Py_BEGIN_ALLOW_THREADS;
+    /* Swap the rows from the outside in, reversing each while it is in
+     * the cache. A middle row is only reversed.
+     */
+    for (y = 0; y < (surf->h + 1) / 2; y++)
+    {
+        top = pixels + y * pitch;
+        bottom = pixels + (surf->h - 1 - y) * pitch;
+        if (xaxis)
+        {
+            flip_row (top, surf->w, bpp);
+            if (bottom != top)
+                flip_row (bottom, surf->w, bpp);
+        }
+        if (temp && bottom != top)
+        {
+            memcpy (temp, top, rowlen);
+            memcpy (top, bottom, rowlen);
+            memcpy (bottom, temp, rowlen);
+        }
+    }
+    Py_END_ALLOW_THREADS;
+
+    PySurface_Unlock (surfobj);
+    free (temp);
+    Py_RETURN_NONE;
+}
+
 static PyObject*
 surf_rotozoom (PyObject* self, PyObject* arg)
 {
@@ -940,98 +1515,118 @@ surf_rotozoom (PyObject* self, PyObject* arg)
     return PySurface_New (newsurf);
 }
 
-static SDL_Surface*
-chop (SDL_Surface *src, int x, int y, int width, int height)
-{
-    SDL_Surface* dst;
-    int dstwidth,dstheight;
-    char *srcpix, *dstpix, *srcrow, *dstrow;
-    int srcstepx, srcstepy, dststepx, dststepy;
-    int loopx,loopy;
-
-    if ((x + width) > src->w)
-        width = src->w - x;
-    if ((y + height) > src->h)
-        height=src->h - y;
-    if (x < 0)
+/* Clip the rect of chop to src, leaving width and height 0 when it does
+ * not cover src at all.
+ */
+static void
+chop_clip (SDL_Surface *src, int *x, int *y, int *width, int *height)
+{
+    if ((*x + *width) > src->w)
+        *width = src->w - *x;
+    if ((*y + *height) > src->h)
+        *height = src->h - *y;
+    if (*x < 0)
     {
-        width -= (-x);
-        x = 0;
+        *width -= (-*x);
+        *x = 0;
     }
-    if (y < 0)
+    if (*y < 0)
     {
-        height -= (-y);
-        y = 0;
+        *height -= (-*y);
+        *y = 0;
     }
+    if (*width < 0)
+        *width = 0;
+    if (*height < 0)
+        *height = 0;
+}
+
+/* Copy the pixels of src outside the rows and columns of the clipped
+ * rect to dst. Called with the GIL released.
+ */
+static void
+chop (SDL_Surface *src, SDL_Surface *dst, int x, int y, int width,
+      int height)
+{
+    int bpp = src->format->BytesPerPixel;
+    int left, right, loopy;
+    Uint8 *srcrow, *dstrow;
 
-    dstwidth = src->w-width;
-    dstheight = src->h-height;
+    /* the kept pixels of a kept row are the ones left of x and the ones
+     * from right on
+     */
+    left = x < src->w ? x : src->w;
+    right = width ? x + width : left;
 
-    dst = newsurf_fromsurf (src,dstwidth,dstheight);
-    if (!dst)
-        return NULL;
     SDL_LockSurface (dst);
-    srcrow = (char*) src->pixels;
-    dstrow = (char*) dst->pixels;
-    srcstepx = dststepx = src->format->BytesPerPixel;
-    srcstepy = src->pitch;
-    dststepy = dst->pitch;
-
+    srcrow = (Uint8*) src->pixels;
+    dstrow = (Uint8*) dst->pixels;
     for (loopy = 0; loopy < src->h; loopy++)
     {
         if ((loopy < y) || (loopy >= (y + height)))
-    {
-            dstpix = dstrow;
-            srcpix = srcrow;
-            for (loopx = 0; loopx < src->w; loopx++)
         {
-                if ((loopx < x) || (loopx >= (x + width)))
-        {
-                    switch (src->format->BytesPerPixel)
-            {
-            case 1:
-                        *dstpix = *srcpix;
-                        break;
-            case 2:
-                        *(Uint16*) dstpix = *(Uint16*) srcpix;
-                        break;
-            case 3:
-                        dstpix[0] = srcpix[0];
-                        dstpix[1] = srcpix[1];
-                        dstpix[2] = srcpix[2];
-                        break;
-            case 4:
-                        *(Uint32*) dstpix = *(Uint32*) srcpix;
-                        break;
-            }
-                    dstpix += dststepx;
-        }
-                srcpix += srcstepx;
+            memcpy (dstrow, srcrow, left * bpp);
+            memcpy (dstrow + left * bpp, srcrow + right * bpp,
+                    (src->w - right) * bpp);
+            dstrow += dst->pitch;
         }
-            dstrow += dststepy;
-    }
-        srcrow += srcstepy;
+        srcrow += src->pitch;
     }
     SDL_UnlockSurface (dst);
-    return dst;
+}
+
+/* The part of src that chop keeps is one rectangle, a view of which can
+ * stand for the copy, when the clipped rect only cuts at the edges.
+ */
+static int
+chop_view_rect (SDL_Surface *src, int x, int y, int width, int height,
+                GAME_Rect *keep)
+{
+    if (width && x > 0 && x + width < src->w)
+        return 0;
+    if (height && y > 0 && y + height < src->h)
+        return 0;
+    keep->x = width && x == 0 ? width : 0;
+    keep->y = height && y == 0 ? height : 0;
+    keep->w = src->w - width;
+    keep->h = src->h - height;
+    return 1;
 }
 
 static PyObject*
-surf_chop (PyObject* self, PyObject* arg)
+surf_chop (PyObject* self, PyObject* arg, PyObject* kwds)
 {
     PyObject *surfobj, *rectobj;
     SDL_Surface* surf, *newsurf;
-    GAME_Rect* rect, temp;
+    GAME_Rect* rect, temp, keep;
+    int x, y, width, height, view = 0;
+    static char *kwids[] = {"surface", "rect", "view", NULL};
 
-    if (!PyArg_ParseTuple (arg, "O!O", &PySurface_Type, &surfobj, &rectobj))
+    if (!PyArg_ParseTupleAndKeywords (arg, kwds, "O!O|i", kwids,
+                                      &PySurface_Type, &surfobj, &rectobj,
+                                      &view))
         return NULL;
     if (!(rect = GameRect_FromObject (rectobj, &temp)))
         return RAISE (PyExc_TypeError, "Rect argument is invalid");
 
     surf=PySurface_AsSurface (surfobj);
+    x = rect->x;
+    y = rect->y;
+    width = rect->w;
+    height = rect->h;
+    chop_clip (surf, &x, &y, &width, &height);
+    if (view && chop_view_rect (surf, x, y, width, height, &keep))
+        return PyObject_CallMethod (surfobj, "subsurface", "(iiii)",
+                                    keep.x, keep.y, keep.w, keep.h);
+
+    newsurf = newsurf_fromsurf (surf, surf->w - width, surf->h - height);
+    if (!newsurf)
+        return NULL;
+    PySurface_Lock (surfobj);
     Py_BEGIN_ALLOW_THREADS;
-    newsurf = chop (surf, rect->x, rect->y, rect->w, rect->h);
+    chop (surf, newsurf, x, y, width, height);
     Py_END_ALLOW_THREADS;
+    PySurface_Unlock (surfobj);
 
     return PySurface_New (newsurf);
 }
@@ -1167,6 +1762,7 @@ static void filter_expand_X_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int height, int
         free(xidx0);
         if (xmult0) free(xmult0);
         if (xmult1) free(xmult1);
+        return;
     }
 
     /* Create multiplier factors and starting indices and put them in arrays */
@@ -1186,10 +1782,12 @@ static void filter_expand_X_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int height, int
             Uint8 *src = srcrow0 + xidx0[x] * 4;
             int xm0 = xmult0[x];
             int xm1 = xmult1[x];
-            *dstpix++ = (Uint8) (((src[0] * xm0) + (src[4] * xm1)) >> 16);
-            *dstpix++ = (Uint8) (((src[1] * xm0) + (src[5] * xm1)) >> 16);
-            *dstpix++ = (Uint8) (((src[2] * xm0) + (src[6] * xm1)) >> 16);
-            *dstpix++ = (Uint8) (((src[3] * xm0) + (src[7] * xm1)) >> 16);
+            /* likewise for the last pixel of a one pixel wide source */
+            Uint8 *src1 = xm1 ? src + 4 : src;
+            *dstpix++ = (Uint8) (((src[0] * xm0) + (src1[0] * xm1)) >> 16);
+            *dstpix++ = (Uint8) (((src[1] * xm0) + (src1[1] * xm1)) >> 16);
+            *dstpix++ = (Uint8) (((src[2] * xm0) + (src1[2] * xm1)) >> 16);
+            *dstpix++ = (Uint8) (((src[3] * xm0) + (src1[3] * xm1)) >> 16);
         }
         dstpix += dstdiff;
     }
@@ -1209,52 +1807,189 @@ static void filter_expand_Y_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int width, int s
     {
         int yidx0 = y * (srcheight - 1) / dstheight;
         Uint8 *srcrow0 = srcpix + yidx0 * srcpitch;
-        Uint8 *srcrow1 = srcrow0 + srcpitch;
         int ymult1 = 0x10000 * ((y * (srcheight - 1)) % dstheight) / dstheight;
         int ymult0 = 0x10000 - ymult1;
+        /* a one row source has no next row, and it has no weight anyway */
+        Uint8 *srcrow1 = ymult1 ? srcrow0 + srcpitch : srcrow0;
+        Uint8 *dst = dstpix + y * dstpitch;
         for (x = 0; x < width; x++)
         {
-            *dstpix++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
-            *dstpix++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
-            *dstpix++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
-            *dstpix++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
+            *dst++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
+            *dst++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
+            *dst++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
+            *dst++ = (Uint8) (((*srcrow0++ * ymult0) + (*srcrow1++ * ymult1)) >> 16);
         }
     }
 }
 
-#if defined(SCALE_MMX_SUPPORT)
-static void
-smoothscale_init (struct _module_state *st)
+/* this function halves a 32 bit image with a 2x2 box filter */
+static void filter_halve_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int srcpitch, int dstpitch, int dstwidth, int dstheight)
 {
-    if (st->filter_shrink_X == 0)
-    {
-    if (SDL_HasSSE ())
+    int x, y, i;
+
+    for (y = 0; y < dstheight; y++)
     {
-        st->filter_type = "SSE";
-        st->filter_shrink_X = filter_shrink_X_SSE;
-        st->filter_shrink_Y = filter_shrink_Y_SSE;
-        st->filter_expand_X = filter_expand_X_SSE;
-        st->filter_expand_Y = filter_expand_Y_SSE;
+        Uint8 *srcrow0 = srcpix + y * 2 * srcpitch;
+        Uint8 *srcrow1 = srcrow0 + srcpitch;
+        Uint8 *dst = dstpix + y * dstpitch;
+        for (x = 0; x < dstwidth * 8; x += 8)
+        {
+            for (i = 0; i < 4; i++)
+                *dst++ = (Uint8) ((srcrow0[x + i] + srcrow0[x + i + 4] +
+                                   srcrow1[x + i] + srcrow1[x + i + 4] + 2) >> 2);
+        }
     }
-    else if (SDL_HasMMX ())
+}
+
+/* these functions implement a box blur of the given radius in the X and
+ * Y dimensions, with running sums and the edge pixels repeated
+ */
+static void filter_blur_X_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int height, int srcpitch, int dstpitch, int width, int radius)
+{
+    Uint32 recip = BLUR_RECIP (radius);
+    Uint32 acc[4];
+    Uint8 *src, *dst, *in, *out;
+    int x, y, i, k, last = width - 1;
+
+    for (y = 0; y < height; y++)
     {
-        st->filter_type = "MMX";
-        st->filter_shrink_X = filter_shrink_X_MMX;
-        st->filter_shrink_Y = filter_shrink_Y_MMX;
-        st->filter_expand_X = filter_expand_X_MMX;
-        st->filter_expand_Y = filter_expand_Y_MMX;
+        src = srcpix + y * srcpitch;
+        dst = dstpix + y * dstpitch;
+        for (i = 0; i < 4; i++)
+            acc[i] = src[i];
+        for (k = 1; k <= radius; k++)
+        {
+            in = src + (k < last ? k : last) * 4;
+            for (i = 0; i < 4; i++)
+                acc[i] += src[i] + in[i];
+        }
+        for (x = 0; x < width; x++)
+        {
+            k = x + radius + 1;
+            in = src + (k < last ? k : last) * 4;
+            k = x - radius;
+            out = src + (k > 0 ? k : 0) * 4;
+            for (i = 0; i < 4; i++)
+            {
+                *dst++ = BLUR_OUT (acc[i], recip);
+                acc[i] += in[i] - out[i];
+            }
+        }
     }
-    else
+}
+
+static void filter_blur_Y_ONLYC(Uint8 *srcpix, Uint8 *dstpix, int width, int srcpitch, int dstpitch, int height, int radius)
+{
+    Uint32 recip = BLUR_RECIP (radius);
+    int bytes = width * 4;
+    Uint32 *sums;
+    Uint8 *in, *out, *dst;
+    int x, y, k, last = height - 1;
+
+    sums = (Uint32 *) malloc (bytes * sizeof (Uint32));
+    if (sums == NULL)
+        return;
+    for (x = 0; x < bytes; x++)
+        sums[x] = srcpix[x];
+    for (k = 1; k <= radius; k++)
     {
-        st->filter_type = "GENERIC";
-        st->filter_shrink_X = filter_shrink_X_ONLYC;
-        st->filter_shrink_Y = filter_shrink_Y_ONLYC;
-        st->filter_expand_X = filter_expand_X_ONLYC;
-        st->filter_expand_Y = filter_expand_Y_ONLYC;
+        in = srcpix + (k < last ? k : last) * srcpitch;
+        for (x = 0; x < bytes; x++)
+            sums[x] += srcpix[x] + in[x];
     }
+    for (y = 0; y < height; y++)
+    {
+        k = y + radius + 1;
+        in = srcpix + (k < last ? k : last) * srcpitch;
+        k = y - radius;
+        out = srcpix + (k > 0 ? k : 0) * srcpitch;
+        dst = dstpix + y * dstpitch;
+        for (x = 0; x < bytes; x++)
+        {
+            dst[x] = BLUR_OUT (sums[x], recip);
+            sums[x] += in[x] - out[x];
+        }
     }
+    free (sums);
 }
+
+/* The smoothscale filter sets built for this machine, fastest first.
+ * The default is the first one the processor has.
+ */
+typedef struct {
+    const char *name;
+    SDL_bool (SDLCALL *has) (void);
+    SMOOTHSCALE_FILTER_P filter_shrink_X;
+    SMOOTHSCALE_FILTER_P filter_shrink_Y;
+    SMOOTHSCALE_FILTER_P filter_expand_X;
+    SMOOTHSCALE_FILTER_P filter_expand_Y;
+    SMOOTHSCALE_HALVE_P filter_halve;
+    SMOOTHSCALE_FILTER_P filter_blur_X;
+    SMOOTHSCALE_FILTER_P filter_blur_Y;
+} SmoothscaleBackend;
+
+static const SmoothscaleBackend smoothscale_backends[] = {
+#if defined(PG_SIMD_AVX2)
+    {"AVX2", SDL_HasAVX2, filter_shrink_X_AVX2, filter_shrink_Y_AVX2,
+     filter_expand_X_AVX2, filter_expand_Y_AVX2, filter_halve_SSE2,
+     filter_blur_X_SSE2, filter_blur_Y_SSE2},
+#endif
+#if defined(PG_SIMD_X86)
+    {"SSE2", SDL_HasSSE2, filter_shrink_X_SSE2, filter_shrink_Y_SSE2,
+     filter_expand_X_SSE2, filter_expand_Y_SSE2, filter_halve_SSE2,
+     filter_blur_X_SSE2, filter_blur_Y_SSE2},
+#endif
+#if defined(SCALE_MMX_SUPPORT)
+    {"SSE", SDL_HasSSE, filter_shrink_X_SSE, filter_shrink_Y_SSE,
+     filter_expand_X_SSE, filter_expand_Y_SSE, filter_halve_ONLYC,
+     filter_blur_X_ONLYC, filter_blur_Y_ONLYC},
+    {"MMX", SDL_HasMMX, filter_shrink_X_MMX, filter_shrink_Y_MMX,
+     filter_expand_X_MMX, filter_expand_Y_MMX, filter_halve_ONLYC,
+     filter_blur_X_ONLYC, filter_blur_Y_ONLYC},
 #endif
+#if defined(PG_SIMD_NEON)
+    {"NEON", SDL_HasNEON, filter_shrink_X_NEON, filter_shrink_Y_NEON,
+     filter_expand_X_NEON, filter_expand_Y_NEON, filter_halve_NEON,
+     filter_blur_X_NEON, filter_blur_Y_NEON},
+#endif
+    {"GENERIC", NULL, filter_shrink_X_ONLYC, filter_shrink_Y_ONLYC,
+     filter_expand_X_ONLYC, filter_expand_Y_ONLYC, filter_halve_ONLYC,
+     filter_blur_X_ONLYC, filter_blur_Y_ONLYC}
+};
+
+#define NUM_SMOOTHSCALE_BACKENDS \
+    ((int) (sizeof (smoothscale_backends) / sizeof (smoothscale_backends[0])))
+
+/* Backends some other build may have */
+static const char *smoothscale_names[] = {
+    "AVX2", "SSE2", "SSE", "MMX", "NEON", NULL
+};
+
+static void
+smoothscale_use (struct _module_state *st, const SmoothscaleBackend *backend)
+{
+    st->filter_type = backend->name;
+    st->filter_shrink_X = backend->filter_shrink_X;
+    st->filter_shrink_Y = backend->filter_shrink_Y;
+    st->filter_expand_X = backend->filter_expand_X;
+    st->filter_expand_Y = backend->filter_expand_Y;
+    st->filter_halve = backend->filter_halve;
+    st->filter_blur_X = backend->filter_blur_X;
+    st->filter_blur_Y = backend->filter_blur_Y;
+}
+
+static void
+smoothscale_init (struct _module_state *st)
+{
+    int i;
+
+    for (i = 0; i < NUM_SMOOTHSCALE_BACKENDS - 1; i++)
+    {
+        if (smoothscale_backends[i].has ())
+            break;
+    }
+    smoothscale_use (st, &smoothscale_backends[i]);
+}
 
 static void convert_24_32(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpitch, int width, int height)
 {
@@ -1296,9 +2031,64 @@ static void convert_32_24(Uint8 *srcpix, int srcpitch, Uint8 *dstpix, int dstpit
     }
 }
 
+/* One pass of scalesmooth or blur over bands of rows, or of columns for
+ * the Y filters, whose sums run down each column. The 24 bit conversions
+ * have no filter, and the blur filters take their radius as dstlen.
+ */
+typedef struct {
+    SMOOTHSCALE_FILTER_P filter;
+    void (*convert) (Uint8 *, int, Uint8 *, int, int, int);
+    int columns;
+    Uint8 *srcpix;
+    Uint8 *dstpix;
+    int srcpitch;
+    int dstpitch;
+    int srclen;
+    int dstlen;
+} SmoothscalePass;
+
+static void
+smoothscale_band (void *job, int first, int count)
+{
+    SmoothscalePass *pass = (SmoothscalePass *) job;
+    Uint8 *srcpix = pass->srcpix;
+    Uint8 *dstpix = pass->dstpix;
+
+    if (pass->columns)
+    {
+        srcpix += first * 4;
+        dstpix += first * 4;
+    }
+    else
+    {
+        srcpix += first * pass->srcpitch;
+        dstpix += first * pass->dstpitch;
+    }
+    if (pass->filter)
+        pass->filter (srcpix, dstpix, count, pass->srcpitch, pass->dstpitch,
+                      pass->srclen, pass->dstlen);
+    else
+        pass->convert (srcpix, pass->srcpitch, dstpix, pass->dstpitch,
+                       pass->srclen, count);
+}
+
+static void
+smoothscale_run (SmoothscalePass *pass, int lines, int nbands)
+{
+    if (nbands > lines)
+        nbands = lines;
+    if (nbands > 1)
+        PySurface_WorkersRun (smoothscale_band, pass, lines, nbands);
+    else
+        smoothscale_band (pass, 0, lines);
+}
+
+/* Scale src into dst, each pass split into up to nbands bands. Called
+ * with the GIL released.
+ */
 static void
 scalesmooth(SDL_Surface *src, SDL_Surface *dst,
-            struct _module_state *st)
+            struct _module_state *st, int nbands)
 {
     Uint8* srcpix = (Uint8*)src->pixels;
     Uint8* dstpix = (Uint8*)dst->pixels;
@@ -1314,7 +2104,8 @@ scalesmooth(SDL_Surface *src, SDL_Surface *dst,
     int bpp = src->format->BytesPerPixel;
 
     Uint8 *temppix = NULL;
-    int tempwidth=0, temppitch=0, tempheight=0;
+    int temppitch=0;
+    SmoothscalePass pass;
 
     /* convert to 32-bit if necessary */
     if (bpp == 3)
@@ -1323,7 +2114,15 @@ scalesmooth(SDL_Surface *src, SDL_Surface *dst,
         Uint8 *newsrc = (Uint8 *) malloc(newpitch * srcheight);
         if (!newsrc)
             return;
-        convert_24_32(srcpix, srcpitch, newsrc, newpitch, srcwidth, srcheight);
+        pass.filter = NULL;
+        pass.convert = convert_24_32;
+        pass.columns = 0;
+        pass.srcpix = srcpix;
+        pass.srcpitch = srcpitch;
+        pass.dstpix = newsrc;
+        pass.dstpitch = newpitch;
+        pass.srclen = srcwidth;
+        smoothscale_run (&pass, srcheight, nbands);
         srcpix = newsrc;
         srcpitch = newpitch;
         /* create a destination buffer for the 32-bit result */
@@ -1340,10 +2139,8 @@ scalesmooth(SDL_Surface *src, SDL_Surface *dst,
     /* Create a temporary processing buffer if we will be scaling both X and Y */
     if (srcwidth != dstwidth && srcheight != dstheight)
     {
-        tempwidth = dstwidth;
-        temppitch = tempwidth << 2;
-        tempheight = srcheight;
-        temppix = (Uint8 *) malloc(temppitch * tempheight);
+        temppitch = dstwidth << 2;
+        temppix = (Uint8 *) malloc(temppitch * srcheight);
         if (temppix == NULL)
         {
             if (bpp == 3)
@@ -1355,41 +2152,51 @@ scalesmooth(SDL_Surface *src, SDL_Surface *dst,
         }
     }
 
-    /* Start the filter by doing X-scaling */
-    if (dstwidth < srcwidth) /* shrink */
-    {
-        if (srcheight != dstheight)
-            st->filter_shrink_X(srcpix, temppix, srcheight, srcpitch, temppitch, srcwidth, dstwidth);
-        else
-            st->filter_shrink_X(srcpix, dstpix, srcheight, srcpitch, dstpitch, srcwidth, dstwidth);
-    }
-    else if (dstwidth > srcwidth) /* expand */
+    /* Start the filter by doing X-scaling, a band of rows at a time */
+    if (dstwidth != srcwidth)
     {
-        if (srcheight != dstheight)
-            st->filter_expand_X(srcpix, temppix, srcheight, srcpitch, temppitch, srcwidth, dstwidth);
-        else
-            st->filter_expand_X(srcpix, dstpix, srcheight, srcpitch, dstpitch, srcwidth, dstwidth);
-    }
-    /* Now do the Y scale */
-    if (dstheight < srcheight) /* shrink */
-    {
-        if (srcwidth != dstwidth)
-            st->filter_shrink_Y(temppix, dstpix, tempwidth, temppitch, dstpitch, srcheight, dstheight);
-        else
-            st->filter_shrink_Y(srcpix, dstpix, srcwidth, srcpitch, dstpitch, srcheight, dstheight);
+        if (dstwidth < srcwidth) /* shrink */
+            pass.filter = st->filter_shrink_X;
+        else /* expand */
+            pass.filter = st->filter_expand_X;
+        pass.columns = 0;
+        pass.srcpix = srcpix;
+        pass.srcpitch = srcpitch;
+        pass.dstpix = temppix ? temppix : dstpix;
+        pass.dstpitch = temppix ? temppitch : dstpitch;
+        pass.srclen = srcwidth;
+        pass.dstlen = dstwidth;
+        smoothscale_run (&pass, srcheight, nbands);
     }
-    else if (dstheight > srcheight)  /* expand */
+    /* Now do the Y scale, a band of columns at a time */
+    if (dstheight != srcheight)
     {
-        if (srcwidth != dstwidth)
-            st->filter_expand_Y(temppix, dstpix, tempwidth, temppitch, dstpitch, srcheight, dstheight);
-        else
-            st->filter_expand_Y(srcpix, dstpix, srcwidth, srcpitch, dstpitch, srcheight, dstheight);
+        if (dstheight < srcheight) /* shrink */
+            pass.filter = st->filter_shrink_Y;
+        else /* expand */
+            pass.filter = st->filter_expand_Y;
+        pass.columns = 1;
+        pass.srcpix = temppix ? temppix : srcpix;
+        pass.srcpitch = temppix ? temppitch : srcpitch;
+        pass.dstpix = dstpix;
+        pass.dstpitch = dstpitch;
+        pass.srclen = srcheight;
+        pass.dstlen = dstheight;
+        smoothscale_run (&pass, dstwidth, nbands);
     }
 
     /* Convert back to 24-bit if necessary */
     if (bpp == 3)
     {
-        convert_32_24(dst32, dstpitch, (Uint8*)dst->pixels, dst->pitch, dstwidth, dstheight);
+        pass.filter = NULL;
+        pass.convert = convert_32_24;
+        pass.columns = 0;
+        pass.srcpix = dst32;
+        pass.srcpitch = dstpitch;
+        pass.dstpix = (Uint8*)dst->pixels;
+        pass.dstpitch = dst->pitch;
+        pass.srclen = dstwidth;
+        smoothscale_run (&pass, dstheight, nbands);
         free(dst32);
         dst32 = NULL;
         free(srcpix);
@@ -1402,17 +2209,13 @@ scalesmooth(SDL_Surface *src, SDL_Surface *dst,
 }
 
 
-static PyObject* surf_scalesmooth(PyObject* self, PyObject* arg)
+/* smoothscale surfobj into surfobj2, or a new surface if it is NULL */
+static PyObject*
+smoothscale_surface (PyObject *self, PyObject *surfobj, int width, int height,
+                     PyObject *surfobj2)
 {
-    PyObject *surfobj, *surfobj2;
     SDL_Surface* surf, *newsurf;
-    int width, height, bpp;
-    surfobj2 = NULL;
-
-    /*get all the arguments*/
-    if (!PyArg_ParseTuple (arg, "O!(ii)|O!", &PySurface_Type, &surfobj,
-                           &width, &height, &PySurface_Type, &surfobj2))
-        return NULL;
+    int bpp;
 
     if (width < 0 || height < 0)
         return RAISE (PyExc_ValueError, "Cannot scale to negative size");
@@ -1445,6 +2248,10 @@ static PyObject* surf_scalesmooth(PyObject* self, PyObject* arg)
 
     if(width && height)
     {
+        int nbands = PySurface_WorkersBands (
+            surf->w > width ? surf->w : width,
+            surf->h > height ? surf->h : height);
+
         SDL_LockSurface(newsurf);
         PySurface_Lock(surfobj);
         Py_BEGIN_ALLOW_THREADS;
@@ -1458,7 +2265,7 @@ static PyObject* surf_scalesmooth(PyObject* self, PyObject* arg)
             }
         }
         else {
-            scalesmooth(surf, newsurf, GETSTATE (self));
+            scalesmooth(surf, newsurf, GETSTATE (self), nbands);
         }
         Py_END_ALLOW_THREADS;
 
@@ -1476,105 +2283,569 @@ static PyObject* surf_scalesmooth(PyObject* self, PyObject* arg)
 
 }
 
-static PyObject *
-surf_get_smoothscale_backend (PyObject *self)
+static PyObject*
+surf_scalesmooth (PyObject* self, PyObject* arg)
 {
-    return Text_FromUTF8 (GETSTATE (self)->filter_type);
+    PyObject *surfobj, *surfobj2 = NULL;
+    int width, height;
+
+    /*get all the arguments*/
+    if (!PyArg_ParseTuple (arg, "O!(ii)|O!", &PySurface_Type, &surfobj,
+                           &width, &height, &PySurface_Type, &surfobj2))
+        return NULL;
+    return smoothscale_surface (self, surfobj, width, height, surfobj2);
 }
 
-static  PyObject *
-surf_set_smoothscale_backend (PyObject *self, PyObject *args, PyObject *kwds)
+/* Halve src into dst with a 2x2 box filter. A side of one pixel stays
+ * one pixel, and is averaged along the other side only.
+ */
+static void
+halve_surface (SDL_Surface *src, SDL_Surface *dst,
+               struct _module_state *st)
 {
-    struct _module_state *st = GETSTATE (self);
-    char *keywords[] = {"type", NULL};
-    const char *type;
-
-    if (!PyArg_ParseTupleAndKeywords (args, kwds, "s:set_smoothscale_backend",
-                                      keywords, &type))
-    {
-        return NULL;
-    }
+    int bpp = src->format->BytesPerPixel;
+    int xstep = src->w > 1 ? bpp : 0;
+    int ystep = src->h > 1 ? src->pitch : 0;
+    Uint8 *srcpix = (Uint8 *) src->pixels;
+    Uint8 *dstpix = (Uint8 *) dst->pixels;
+    int x, y, i;
 
-#if defined(SCALE_MMX_SUPPORT)
-    if (strcmp (type, "GENERIC") == 0)
+    if (bpp == 4 && xstep && ystep)
     {
-        st->filter_type = "GENERIC";
-        st->filter_shrink_X = filter_shrink_X_ONLYC;
-        st->filter_shrink_Y = filter_shrink_Y_ONLYC;
-        st->filter_expand_X = filter_expand_X_ONLYC;
-        st->filter_expand_Y = filter_expand_Y_ONLYC;
+        st->filter_halve (srcpix, dstpix, src->pitch, dst->pitch,
+                          dst->w, dst->h);
+        return;
     }
-    else if (strcmp (type, "MMX") == 0)
+    for (y = 0; y < dst->h; y++)
     {
-        if (!SDL_HasMMX ())
+        Uint8 *srcrow = srcpix + y * 2 * ystep;
+        Uint8 *dstrow = dstpix + y * dst->pitch;
+        for (x = 0; x < dst->w; x++)
         {
-            return RAISE (PyExc_ValueError,
-                          "MMX not supported on this machine");
+            Uint8 *p = srcrow + x * 2 * xstep;
+            for (i = 0; i < bpp; i++)
+                *dstrow++ = (Uint8) ((p[i] + p[i + xstep] + p[i + ystep] +
+                                      p[i + xstep + ystep] + 2) >> 2);
         }
-        st->filter_type = "MMX";
-        st->filter_shrink_X = filter_shrink_X_MMX;
-        st->filter_shrink_Y = filter_shrink_Y_MMX;
-        st->filter_expand_X = filter_expand_X_MMX;
-        st->filter_expand_Y = filter_expand_Y_MMX;
     }
-    else if (strcmp (type, "SSE") == 0)
+}
+
+static PyObject*
+surf_build_pyramid (PyObject* self, PyObject* arg)
+{
+    PyObject *surfobj, *levelobj, *list;
+    SDL_Surface *surf, *newsurf;
+    int levels, bpp, i;
+
+    if (!PyArg_ParseTuple (arg, "O!i", &PySurface_Type, &surfobj, &levels))
+        return NULL;
+    if (levels < 0)
+        return RAISE (PyExc_ValueError, "levels must not be negative");
+
+    surf = PySurface_AsSurface (surfobj);
+    bpp = surf->format->BytesPerPixel;
+    if (bpp < 3 || bpp > 4)
+        return RAISE (PyExc_ValueError,
+                      "Only 24-bit or 32-bit surfaces can be made a pyramid");
+
+    list = PyList_New (1);
+    if (list == NULL)
+        return NULL;
+    Py_INCREF (surfobj);
+    PyList_SET_ITEM (list, 0, surfobj);
+
+    for (i = 0; i < levels && (surf->w > 1 || surf->h > 1); i++)
     {
-        if (!SDL_HasSSE ())
+        newsurf = newsurf_fromsurf (surf, surf->w > 1 ? surf->w / 2 : 1,
+                                    surf->h > 1 ? surf->h / 2 : 1);
+        if (newsurf == NULL)
         {
-            return RAISE (PyExc_ValueError,
-                          "SSE not supported on this machine");
+            Py_DECREF (list);
+            return NULL;
         }
-        st->filter_type = "SSE";
-        st->filter_shrink_X = filter_shrink_X_SSE;
-        st->filter_shrink_Y = filter_shrink_Y_SSE;
-        st->filter_expand_X = filter_expand_X_SSE;
-        st->filter_expand_Y = filter_expand_Y_SSE;
-    }
-    else
-    {
-        return PyErr_Format (PyExc_ValueError,
-                             "Unknown backend type %s", type);
+
+        PySurface_Lock (surfobj);
+        SDL_LockSurface (newsurf);
+        Py_BEGIN_ALLOW_THREADS;
+        halve_surface (surf, newsurf, GETSTATE (self));
+        Py_END_ALLOW_THREADS;
+        SDL_UnlockSurface (newsurf);
+        PySurface_Unlock (surfobj);
+
+        levelobj = PySurface_New (newsurf);
+        if (levelobj == NULL)
+        {
+            PySurface_FreePooled (newsurf);
+            Py_DECREF (list);
+            return NULL;
+        }
+        if (PyList_Append (list, levelobj) != 0)
+        {
+            Py_DECREF (levelobj);
+            Py_DECREF (list);
+            return NULL;
+        }
+        Py_DECREF (levelobj);
+        surfobj = levelobj;
+        surf = newsurf;
     }
-    Py_RETURN_NONE;
-#else /* Not an x86 processor */
-    if (strcmp (type, "GENERIC") != 0)
+    return list;
+}
+
+static PyObject*
+surf_pyramid_scale (PyObject* self, PyObject* arg)
+{
+    PyObject *pyramid, *seq, *levelobj, *result;
+    PyObject *surfobj = NULL, *surfobj2 = NULL;
+    SDL_Surface *surf;
+    int width, height, fits, bestfits = 0;
+    long long area, bestarea = 0;
+    Py_ssize_t i, n;
+
+    if (!PyArg_ParseTuple (arg, "O(ii)|O!", &pyramid, &width, &height,
+                           &PySurface_Type, &surfobj2))
+        return NULL;
+
+    seq = PySequence_Fast (pyramid, "pyramid must be a sequence of Surfaces");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE (seq);
+
+    /* Take the smallest level at least as big as the result, so the last
+     * scale shrinks by less than half, or else the biggest level.
+     */
+    for (i = 0; i < n; i++)
     {
-        if (strcmp (st->filter_type, "MMX") == 0 ||
-            strcmp (st->filter_type, "SSE") == 0    )
+        levelobj = PySequence_Fast_GET_ITEM (seq, i);
+        if (!PySurface_Check (levelobj))
         {
-            return PyErr_Format (PyExc_ValueError,
-                                 "%s not supported on this machine", type);
+            Py_DECREF (seq);
+            return RAISE (PyExc_TypeError,
+                          "pyramid must be a sequence of Surfaces");
+        }
+        surf = PySurface_AsSurface (levelobj);
+        fits = surf->w >= width && surf->h >= height;
+        area = (long long) surf->w * surf->h;
+        if (surfobj == NULL ||
+            (fits && (!bestfits || area < bestarea)) ||
+            (!fits && !bestfits && area > bestarea))
+        {
+            surfobj = levelobj;
+            bestfits = fits;
+            bestarea = area;
         }
-        return PyErr_Format (PyExc_ValueError,
-                             "Unknown backend type %s", type);
     }
-    Py_RETURN_NONE;
-#endif /* defined(SCALE_MMX_SUPPORT) */
+    if (surfobj == NULL)
+    {
+        Py_DECREF (seq);
+        return RAISE (PyExc_ValueError, "pyramid has no levels");
+    }
+
+    result = smoothscale_surface (self, surfobj, width, height, surfobj2);
+    Py_DECREF (seq);
+    return result;
 }
 
+/* Largest blur radius, which keeps BLUR_OUT within 1 of the exact
+ * average of 2 * radius + 1 bytes
+ */
+#define BLUR_MAX_RADIUS 0x7fff
 
-static int get_threshold (SDL_Surface *destsurf, SDL_Surface *surf,
-                          SDL_Surface *surf2, Uint32 color,  Uint32 threshold,
-                          Uint32 diff_color, int change_return, int inverse)
+/* Blur src into dst with a box filter of each of the n radii in turn, in
+ * X and then in Y, each pass split into up to nbands bands. src and dst
+ * may be the same surface. Called with the GIL released; returns -1 when
+ * out of memory.
+ */
+static int
+blur (SDL_Surface *src, SDL_Surface *dst, const int *radii, int n,
+      struct _module_state *st, int nbands)
 {
-    int x, y, result, similar, rshift, gshift, bshift, rshift2, gshift2, bshift2;
-    int rloss, gloss, bloss, rloss2, gloss2, bloss2;
-    Uint8 *pixels, *destpixels, *pixels2;
-    SDL_Rect sdlrect;
-    SDL_PixelFormat *format, *destformat, *format2;
-    Uint32 the_color, the_color2, rmask, gmask, bmask, rmask2, gmask2, bmask2;
-    Uint8 *pix, *byte_buf;
-    Uint8 r, g, b, a;
-    Uint8 dr, dg, db, da;
-    Uint8 tr, tg, tb, ta;
+    int width = src->w;
+    int height = src->h;
+    int bpp = src->format->BytesPerPixel;
+    int pitch = width * 4;
+    size_t size = (size_t) pitch * height;
+    Uint8 *srcpix = (Uint8 *) src->pixels;
+    Uint8 *dstpix = (Uint8 *) dst->pixels;
+    int srcpitch = src->pitch;
+    int dstpitch = dst->pitch;
+    Uint8 *bufs[2] = {NULL, NULL};
+    Uint8 *src32 = NULL, *dst32 = NULL;
+    SmoothscalePass pass;
+    int i, npasses = n * 2, result = -1;
+
+    bufs[0] = (Uint8 *) malloc (size);
+    if (npasses > 2)
+        bufs[1] = (Uint8 *) malloc (size);
+    if (bufs[0] == NULL || (npasses > 2 && bufs[1] == NULL))
+        goto end;
+
+    /* the filters work on 32 bit pixels, like scalesmooth */
+    pass.convert = convert_24_32;
+    if (bpp == 3)
+    {
+        src32 = (Uint8 *) malloc (size);
+        dst32 = (Uint8 *) malloc (size);
+        if (src32 == NULL || dst32 == NULL)
+            goto end;
+        pass.filter = NULL;
+        pass.columns = 0;
+        pass.srcpix = srcpix;
+        pass.srcpitch = srcpitch;
+        pass.dstpix = src32;
+        pass.dstpitch = pitch;
+        pass.srclen = width;
+        smoothscale_run (&pass, height, nbands);
+        srcpix = src32;
+        srcpitch = pitch;
+        dstpix = dst32;
+        dstpitch = pitch;
+    }
 
-    similar = 0;
-    pixels = (Uint8 *) surf->pixels;
-    format = surf->format;
-    rmask = format->Rmask;
-    gmask = format->Gmask;
-    bmask = format->Bmask;
-    rshift = format->Rshift;
+    /* Ping-pong between the buffers, from src in the first pass and to
+     * dst in the last, so no pass reads what it writes.
+     */
+    for (i = 0; i < npasses; i++)
+    {
+        pass.columns = i >= n;
+        pass.filter = pass.columns ? st->filter_blur_Y : st->filter_blur_X;
+        pass.srcpix = i ? bufs[(i - 1) % 2] : srcpix;
+        pass.srcpitch = i ? pitch : srcpitch;
+        pass.dstpix = i < npasses - 1 ? bufs[i % 2] : dstpix;
+        pass.dstpitch = i < npasses - 1 ? pitch : dstpitch;
+        pass.srclen = pass.columns ? height : width;
+        pass.dstlen = radii[i % n];
+        smoothscale_run (&pass, pass.columns ? width : height, nbands);
+    }
+
+    if (bpp == 3)
+    {
+        pass.filter = NULL;
+        pass.convert = convert_32_24;
+        pass.columns = 0;
+        pass.srcpix = dst32;
+        pass.srcpitch = pitch;
+        pass.dstpix = (Uint8 *) dst->pixels;
+        pass.dstpitch = dst->pitch;
+        pass.srclen = width;
+        smoothscale_run (&pass, height, nbands);
+    }
+    result = 0;
+
+end:
+    free (bufs[0]);
+    free (bufs[1]);
+    free (src32);
+    free (dst32);
+    return result;
+}
+
+/* blur surfobj into surfobj2, or a new surface if it is NULL */
+static PyObject*
+blur_surface (PyObject *self, PyObject *surfobj, const int *radii, int n,
+              PyObject *surfobj2)
+{
+    SDL_Surface *surf, *newsurf;
+    int bpp, result = 0;
+
+    surf = PySurface_AsSurface (surfobj);
+    bpp = surf->format->BytesPerPixel;
+    if (bpp < 3 || bpp > 4)
+        return RAISE (PyExc_ValueError,
+                      "Only 24-bit or 32-bit surfaces can be blurred");
+
+    if (!surfobj2)
+    {
+        newsurf = newsurf_fromsurf (surf, surf->w, surf->h);
+        if (!newsurf)
+            return NULL;
+    }
+    else
+    {
+        newsurf = PySurface_AsSurface (surfobj2);
+        if (newsurf->w != surf->w || newsurf->h != surf->h)
+            return RAISE (PyExc_ValueError,
+                          "Destination surface not the same size.");
+        if (newsurf->format->BytesPerPixel != bpp)
+            return RAISE (PyExc_ValueError,
+                          "Destination surface not the same depth.");
+    }
+
+    if (surf->w && surf->h)
+    {
+        int nbands = PySurface_WorkersBands (surf->w, surf->h);
+
+        SDL_LockSurface (newsurf);
+        PySurface_Lock (surfobj);
+        Py_BEGIN_ALLOW_THREADS;
+        result = blur (surf, newsurf, radii, n, GETSTATE (self), nbands);
+        Py_END_ALLOW_THREADS;
+        PySurface_Unlock (surfobj);
+        SDL_UnlockSurface (newsurf);
+    }
+
+    if (result == -1)
+    {
+        if (!surfobj2)
+            PySurface_FreePooled (newsurf);
+        return PyErr_NoMemory ();
+    }
+    if (surfobj2)
+    {
+        Py_INCREF (surfobj2);
+        return surfobj2;
+    }
+    return PySurface_New (newsurf);
+}
+
+static PyObject*
+surf_box_blur (PyObject* self, PyObject* arg)
+{
+    PyObject *surfobj, *surfobj2 = NULL;
+    int radius;
+
+    if (!PyArg_ParseTuple (arg, "O!i|O!", &PySurface_Type, &surfobj,
+                           &radius, &PySurface_Type, &surfobj2))
+        return NULL;
+    if (radius < 0 || radius > BLUR_MAX_RADIUS)
+        return RAISE (PyExc_ValueError, "radius out of range");
+    return blur_surface (self, surfobj, &radius, 1, surfobj2);
+}
+
+/* Three box blurs come close to a gaussian. Their widths are the odd
+ * numbers either side of the ideal one, as many of each as gives the
+ * nearest variance to sigma squared.
+ */
+static void
+gaussian_radii (double sigma, int radii[3])
+{
+    double var = 12.0 * sigma * sigma;
+    int lower = (int) floor (sqrt (var / 3 + 1));
+    int i, m;
+
+    if (lower % 2 == 0)
+        lower--;
+    m = (int) floor ((var - 3 * lower * lower - 12 * lower - 9) /
+                     (-4 * lower - 4) + 0.5);
+    for (i = 0; i < 3; i++)
+        radii[i] = (i < m ? lower : lower + 2) / 2;
+}
+
+static PyObject*
+surf_gaussian_blur (PyObject* self, PyObject* arg)
+{
+    PyObject *surfobj, *surfobj2 = NULL;
+    double sigma;
+    int radii[3];
+
+    if (!PyArg_ParseTuple (arg, "O!d|O!", &PySurface_Type, &surfobj,
+                           &sigma, &PySurface_Type, &surfobj2))
+        return NULL;
+    if (!(sigma >= 0 && sigma <= BLUR_MAX_RADIUS / 2))
+        return RAISE (PyExc_ValueError, "sigma out of range");
+    gaussian_radii (sigma, radii);
+    return blur_surface (self, surfobj, radii, 3, surfobj2);
+}
+
+static PyObject *
+surf_get_smoothscale_backend (PyObject *self)
+{
+    return Text_FromUTF8 (GETSTATE (self)->filter_type);
+}
+
+static  PyObject *
+surf_set_smoothscale_backend (PyObject *self, PyObject *args, PyObject *kwds)
+{
+    struct _module_state *st = GETSTATE (self);
+    char *keywords[] = {"type", NULL};
+    const char *type;
+    int i;
+
+    if (!PyArg_ParseTupleAndKeywords (args, kwds, "s:set_smoothscale_backend",
+                                      keywords, &type))
+    {
+        return NULL;
+    }
+
+    for (i = 0; i < NUM_SMOOTHSCALE_BACKENDS; i++)
+    {
+        const SmoothscaleBackend *backend = &smoothscale_backends[i];
+
+        if (strcmp (type, backend->name) == 0)
+        {
+            if (backend->has != NULL && !backend->has ())
+                break;
+            smoothscale_use (st, backend);
+            Py_RETURN_NONE;
+        }
+    }
+    for (i = 0; smoothscale_names[i] != NULL; i++)
+    {
+        if (strcmp (type, smoothscale_names[i]) == 0)
+        {
+            return PyErr_Format (PyExc_ValueError,
+                                 "%s not supported on this machine", type);
+        }
+    }
+    return PyErr_Format (PyExc_ValueError, "Unknown backend type %s", type);
+}
+
+
+/* The 32 bit path of get_threshold, for pixels with 8 bit red, green
+ * and blue channels in bytes. It compares whole pixels a byte at a time,
+ * with SIMD where the CPU has it, and splits the rows across the worker
+ * threads. See the threshold_row functions in scale.h.
+ */
+typedef int (*THRESHOLD_ROW_P)(Uint32 *, Uint32 *, Uint32 *, int, Uint32,
+                               Uint32, int, int);
+
+static int
+threshold_row_ONLYC (Uint32 *srcpix, Uint32 *cmppix, Uint32 *dstpix,
+                     int width, Uint32 color, Uint32 threshold,
+                     int change_return, int inverse)
+{
+    int x = 0, similar = 0;
+
+    THRESHOLD_ROW_TAIL (x)
+    return similar;
+}
+
+static THRESHOLD_ROW_P
+threshold_row_pick (void)
+{
+#if defined(PG_SIMD_AVX2)
+    if (SDL_HasAVX2 ())
+        return threshold_row_AVX2;
+#endif
+#if defined(PG_SIMD_X86)
+    if (SDL_HasSSE2 ())
+        return threshold_row_SSE2;
+#endif
+#if defined(PG_SIMD_NEON)
+    if (SDL_HasNEON ())
+        return threshold_row_NEON;
+#endif
+    return threshold_row_ONLYC;
+}
+
+static int
+threshold_fast_format (SDL_PixelFormat *format)
+{
+    return (format->BytesPerPixel == 4 &&
+            format->Rshift % 8 == 0 &&
+            format->Rmask == 0xffU << format->Rshift &&
+            format->Gshift % 8 == 0 &&
+            format->Gmask == 0xffU << format->Gshift &&
+            format->Bshift % 8 == 0 &&
+            format->Bmask == 0xffU << format->Bshift);
+}
+
+typedef struct {
+    THRESHOLD_ROW_P row;
+    Uint8 *srcpix;
+    Uint8 *cmppix;
+    Uint8 *dstpix;
+    int srcpitch;
+    int cmppitch;
+    int dstpitch;
+    int width;
+    Uint32 color;
+    Uint32 threshold;
+    int change_return;
+    int inverse;
+    int *counts;                /* matches in each row, or NULL */
+    int count;                  /* all matches when counts is NULL */
+} ThresholdJob;
+
+static void
+threshold_band (void *job, int first, int count)
+{
+    ThresholdJob *t = (ThresholdJob *) job;
+    int y, n;
+
+    for (y = first; y < first + count; y++)
+    {
+        n = t->row (
+            (Uint32 *) (t->srcpix + y * t->srcpitch),
+            t->cmppix ? (Uint32 *) (t->cmppix + y * t->cmppitch) : NULL,
+            t->dstpix ? (Uint32 *) (t->dstpix + y * t->dstpitch) : NULL,
+            t->width, t->color, t->threshold, t->change_return, t->inverse);
+        if (t->counts)
+            t->counts[y] = n;
+        else
+            t->count += n;
+    }
+}
+
+static int
+threshold_rows (SDL_Surface *destsurf, SDL_Surface *surf, SDL_Surface *surf2,
+                Uint32 color, Uint32 threshold, int change_return,
+                int inverse, int nbands)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint32 rgbmask = format->Rmask | format->Gmask | format->Bmask;
+    ThresholdJob job;
+    int y;
+
+    job.row = threshold_row_pick ();
+    job.srcpix = (Uint8 *) surf->pixels;
+    job.srcpitch = surf->pitch;
+    job.cmppix = surf2 ? (Uint8 *) surf2->pixels : NULL;
+    job.cmppitch = surf2 ? surf2->pitch : 0;
+    job.dstpix = change_return ? (Uint8 *) destsurf->pixels : NULL;
+    job.dstpitch = change_return ? destsurf->pitch : 0;
+    job.width = surf->w;
+    job.color = color;
+    /* the bytes other than red, green and blue always match */
+    job.threshold = (threshold & rgbmask) | ~rgbmask;
+    job.change_return = change_return;
+    job.inverse = inverse;
+    if (inverse & ~1)
+    {
+        /* match ^ inverse is never 0 */
+        job.threshold = 0xffffffff;
+        job.inverse = 0;
+    }
+    job.count = 0;
+
+    if (nbands > surf->h)
+        nbands = surf->h;
+    job.counts = nbands > 1 ? (int *) malloc (sizeof (int) * surf->h) : NULL;
+    if (job.counts)
+    {
+        PySurface_WorkersRun (threshold_band, &job, surf->h, nbands);
+        for (y = 0; y < surf->h; y++)
+            job.count += job.counts[y];
+        free (job.counts);
+    }
+    else
+        threshold_band (&job, 0, surf->h);
+    return job.count;
+}
+
+static int get_threshold (SDL_Surface *destsurf, SDL_Surface *surf,
+                          SDL_Surface *surf2, Uint32 color,  Uint32 threshold,
+                          Uint32 diff_color, int change_return, int inverse,
+                          int nbands)
+{
+    int x, y, result, similar, rshift, gshift, bshift, rshift2, gshift2, bshift2;
+    int rloss, gloss, bloss, rloss2, gloss2, bloss2;
+    Uint8 *pixels, *destpixels, *pixels2;
+    SDL_Rect sdlrect;
+    SDL_PixelFormat *format, *destformat, *format2;
+    Uint32 the_color, the_color2, rmask, gmask, bmask, rmask2, gmask2, bmask2;
+    Uint8 *pix, *byte_buf;
+    Uint8 r, g, b, a;
+    Uint8 dr, dg, db, da;
+    Uint8 tr, tg, tb, ta;
+
+    similar = 0;
+    pixels = (Uint8 *) surf->pixels;
+    format = surf->format;
+    rmask = format->Rmask;
+    gmask = format->Gmask;
+    bmask = format->Bmask;
+    rshift = format->Rshift;
     gshift = format->Gshift;
     bshift = format->Bshift;
     rloss = format->Rloss;
@@ -1593,6 +2864,16 @@ static int get_threshold (SDL_Surface *destsurf, SDL_Surface *surf,
         destformat = NULL;
     }
 
+    if (threshold_fast_format (format) &&
+        (!surf2 || (surf2->format->BytesPerPixel == 4 &&
+                    surf2->format->Rmask == rmask &&
+                    surf2->format->Gmask == gmask &&
+                    surf2->format->Bmask == bmask)) &&
+        (!change_return || destsurf->format->BytesPerPixel == 4))
+        return threshold_rows (destsurf, surf, surf2, color, threshold,
+                               change_return == 1 || change_return == 2 ?
+                               change_return : 0, inverse, nbands);
+
     if(surf2) {
         format2 = surf2->format;
         rmask2 = format2->Rmask;
@@ -1818,7 +3099,7 @@ static PyObject* surf_threshold(PyObject* self, PyObject* arg)
 {
     PyObject *surfobj, *surfobj2 = NULL, *surfobj3 = NULL;
     SDL_Surface* surf = NULL, *destsurf = NULL, *surf2 = NULL;
-    int bpp, change_return = 1, inverse = 0;
+    int bpp, change_return = 1, inverse = 0, nbands;
     int num_threshold_pixels = 0;
 
     PyObject *rgba_obj_color;
@@ -1909,6 +3190,7 @@ static PyObject* surf_threshold(PyObject* self, PyObject* arg)
     }
 
     bpp = surf->format->BytesPerPixel;
+    nbands = PySurface_WorkersBands (surf->w, surf->h);
 
     PySurface_Lock(surfobj);
     PySurface_Lock(surfobj2);
@@ -1926,7 +3208,8 @@ static PyObject* surf_threshold(PyObject* self, PyObject* arg)
                                           color_threshold,
                                           color_diff_color,
                                           change_return,
-                                          inverse);
+                                          inverse,
+                                          nbands);
 
 
     Py_END_ALLOW_THREADS;
@@ -2819,15 +4102,895 @@ static PyObject* surf_average_color(PyObject* self, PyObject* arg)
     return Py_BuildValue ("(bbbb)", r, g, b, a);
 }
 
+/* IntegralImage: the summed-area table of a surface. Entry (x, y) holds
+ * the sums of each channel over the pixels above and left of (x, y), so
+ * the sums over any rect come from its four corners. The sums are Uint32
+ * when those of the whole surface fit and Uint64 otherwise; with Uint32
+ * the differences are right even where the corners themselves wrapped.
+ */
+typedef struct {
+    PyObject_HEAD
+    int w;
+    int h;
+    int wide;                   /* the sums are Uint64 */
+    void *sums;                 /* (w + 1) * (h + 1) entries of 4 channels */
+} PyIntegralImageObject;
+
+/* Fill the table one row at a time, reading pixels with GET at pixels and
+ * moving STEP bytes, with channels taken like average_color does.
+ */
+#define INTEGRAL_BUILD(TYPE, GET, STEP)                                 \
+    {                                                                   \
+        TYPE *sums = (TYPE *) self->sums;                               \
+        TYPE *above, *row, rtot, gtot, btot, atot;                      \
+                                                                        \
+        memset (sums, 0, sizeof (TYPE) * stride);                       \
+        for (y = 0; y < surf->h; y++)                                   \
+        {                                                               \
+            pixels = (Uint8 *) surf->pixels + y * surf->pitch;          \
+            above = sums + y * stride;                                  \
+            row = above + stride;                                       \
+            row[0] = row[1] = row[2] = row[3] = 0;                      \
+            rtot = gtot = btot = atot = 0;                              \
+            for (x = 0; x < surf->w; x++)                               \
+            {                                                           \
+                color = GET;                                            \
+                pixels += STEP;                                         \
+                rtot += ((color & rmask) >> rshift) << rloss;           \
+                gtot += ((color & gmask) >> gshift) << gloss;           \
+                btot += ((color & bmask) >> bshift) << bloss;           \
+                atot += ((color & amask) >> ashift) << aloss;           \
+                row[x * 4 + 4] = above[x * 4 + 4] + rtot;               \
+                row[x * 4 + 5] = above[x * 4 + 5] + gtot;               \
+                row[x * 4 + 6] = above[x * 4 + 6] + btot;               \
+                row[x * 4 + 7] = above[x * 4 + 7] + atot;               \
+            }                                                           \
+        }                                                               \
+    }
+
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define INTEGRAL_GET3 (pixels[0] + (pixels[1] << 8) + (pixels[2] << 16))
+#else
+#define INTEGRAL_GET3 (pixels[2] + (pixels[1] << 8) + (pixels[0] << 16))
+#endif
+
+#define INTEGRAL_BUILD_BPP(TYPE)                                        \
+    switch (format->BytesPerPixel)                                      \
+    {                                                                   \
+    case 1:                                                             \
+        INTEGRAL_BUILD (TYPE, (Uint32) *pixels, 1)                      \
+        break;                                                          \
+    case 2:                                                             \
+        INTEGRAL_BUILD (TYPE, (Uint32) *(Uint16 *) pixels, 2)           \
+        break;                                                          \
+    case 3:                                                             \
+        INTEGRAL_BUILD (TYPE, (Uint32) INTEGRAL_GET3, 3)                \
+        break;                                                          \
+    default: /* case 4: */                                              \
+        INTEGRAL_BUILD (TYPE, *(Uint32 *) pixels, 4)                    \
+        break;                                                          \
+    }
+
+static void
+integralimage_build (PyIntegralImageObject *self, SDL_Surface *surf)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint32 rmask = format->Rmask, gmask = format->Gmask;
+    Uint32 bmask = format->Bmask, amask = format->Amask;
+    int rshift = format->Rshift, gshift = format->Gshift;
+    int bshift = format->Bshift, ashift = format->Ashift;
+    int rloss = format->Rloss, gloss = format->Gloss;
+    int bloss = format->Bloss, aloss = format->Aloss;
+    int stride = (surf->w + 1) * 4;
+    Uint32 color;
+    Uint8 *pixels;
+    int x, y;
+
+    if (self->wide)
+        INTEGRAL_BUILD_BPP (Uint64)
+    else
+        INTEGRAL_BUILD_BPP (Uint32)
+}
+
+/* The channel sums over rect, clipped to the image. Returns the number
+ * of pixels summed.
+ */
+static Py_ssize_t
+integralimage_sum (PyIntegralImageObject *self, GAME_Rect *rect,
+                   Uint64 tot[4])
+{
+    int x0 = MAX (rect->x, 0);
+    int y0 = MAX (rect->y, 0);
+    int x1 = (int) MIN ((long long) rect->x + rect->w, self->w);
+    int y1 = (int) MIN ((long long) rect->y + rect->h, self->h);
+    Py_ssize_t stride = (Py_ssize_t) (self->w + 1) * 4;
+    Py_ssize_t a, b, c, d;
+    int i;
+
+    if (x1 <= x0 || y1 <= y0)
+    {
+        tot[0] = tot[1] = tot[2] = tot[3] = 0;
+        return 0;
+    }
+    a = y0 * stride + x0 * 4;
+    b = y0 * stride + x1 * 4;
+    c = y1 * stride + x0 * 4;
+    d = y1 * stride + x1 * 4;
+    if (self->wide)
+    {
+        Uint64 *sums = (Uint64 *) self->sums;
+
+        for (i = 0; i < 4; i++)
+            tot[i] = sums[d + i] - sums[b + i] - sums[c + i] + sums[a + i];
+    }
+    else
+    {
+        Uint32 *sums = (Uint32 *) self->sums;
+
+        for (i = 0; i < 4; i++)
+            tot[i] = (Uint32) (sums[d + i] - sums[b + i] - sums[c + i] +
+                               sums[a + i]);
+    }
+    return (Py_ssize_t) (x1 - x0) * (y1 - y0);
+}
+
+/* The sums, or with average the truncated means, over the rect rectobj,
+ * or over the whole image for NULL.
+ */
+static PyObject*
+integralimage_query (PyIntegralImageObject *self, PyObject *rectobj,
+                     int average)
+{
+    GAME_Rect *rect, temp;
+    Uint64 tot[4];
+    Py_ssize_t size;
+    int i;
+
+    if (rectobj == NULL)
+    {
+        temp.x = temp.y = 0;
+        temp.w = self->w;
+        temp.h = self->h;
+        rect = &temp;
+    }
+    else if (!(rect = GameRect_FromObject (rectobj, &temp)))
+        return RAISE (PyExc_TypeError, "Rect argument is invalid");
+
+    size = integralimage_sum (self, rect, tot);
+    if (!average)
+        return Py_BuildValue ("(KKKK)", (unsigned PY_LONG_LONG) tot[0],
+                              (unsigned PY_LONG_LONG) tot[1],
+                              (unsigned PY_LONG_LONG) tot[2],
+                              (unsigned PY_LONG_LONG) tot[3]);
+    for (i = 0; i < 4; i++)
+        tot[i] = size ? tot[i] / size : 0;
+    return Py_BuildValue ("(iiii)", (int) tot[0], (int) tot[1],
+                          (int) tot[2], (int) tot[3]);
+}
+
+static PyObject*
+integralimage_query_many (PyIntegralImageObject *self, PyObject *rects,
+                          int average)
+{
+    PyObject *seq, *list, *item;
+    Py_ssize_t i, n;
+
+    seq = PySequence_Fast (rects, "rects must be a sequence of rects");
+    if (seq == NULL)
+        return NULL;
+    n = PySequence_Fast_GET_SIZE (seq);
+    list = PyList_New (n);
+    if (list == NULL)
+    {
+        Py_DECREF (seq);
+        return NULL;
+    }
+    for (i = 0; i < n; i++)
+    {
+        item = integralimage_query (self, PySequence_Fast_GET_ITEM (seq, i),
+                                    average);
+        if (item == NULL)
+        {
+            Py_DECREF (list);
+            Py_DECREF (seq);
+            return NULL;
+        }
+        PyList_SET_ITEM (list, i, item);
+    }
+    Py_DECREF (seq);
+    return list;
+}
+
+static PyObject*
+integralimage_new (PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyIntegralImageObject *self;
+    PyObject *surfobj;
+    SDL_Surface *surf;
+    size_t entries, itemsize;
+    static char *keywords[] = {"surface", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords (args, kwds, "O!:IntegralImage",
+                                      keywords, &PySurface_Type, &surfobj))
+        return NULL;
+    surf = PySurface_AsSurface (surfobj);
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4)
+        return RAISE (PyExc_ValueError,
+                      "unsupport Surface bit depth for transform");
+
+    self = (PyIntegralImageObject *) type->tp_alloc (type, 0);
+    if (self == NULL)
+        return NULL;
+    self->w = surf->w;
+    self->h = surf->h;
+    self->wide = (Uint64) surf->w * surf->h * 255 > 0xffffffffU;
+    itemsize = self->wide ? sizeof (Uint64) : sizeof (Uint32);
+    entries = (size_t) (surf->w + 1) * (surf->h + 1) * 4;
+    if (entries > ((size_t) -1) / itemsize)
+    {
+        Py_DECREF (self);
+        return PyErr_NoMemory ();
+    }
+    self->sums = PyMem_Malloc (entries * itemsize);
+    if (self->sums == NULL)
+    {
+        Py_DECREF (self);
+        return PyErr_NoMemory ();
+    }
+
+    PySurface_Lock (surfobj);
+    Py_BEGIN_ALLOW_THREADS;
+    integralimage_build (self, surf);
+    Py_END_ALLOW_THREADS;
+    PySurface_Unlock (surfobj);
+    return (PyObject *) self;
+}
+
+static void
+integralimage_dealloc (PyIntegralImageObject *self)
+{
+    PyMem_Free (self->sums);
+    Py_TYPE (self)->tp_free ((PyObject *) self);
+}
+
+static PyObject*
+integralimage_sum_method (PyIntegralImageObject *self, PyObject *args)
+{
+    PyObject *rectobj = NULL;
+
+    if (!PyArg_ParseTuple (args, "|O", &rectobj))
+        return NULL;
+    return integralimage_query (self, rectobj, 0);
+}
+
+static PyObject*
+integralimage_average (PyIntegralImageObject *self, PyObject *args)
+{
+    PyObject *rectobj = NULL;
+
+    if (!PyArg_ParseTuple (args, "|O", &rectobj))
+        return NULL;
+    return integralimage_query (self, rectobj, 1);
+}
+
+static PyObject*
+integralimage_sum_many (PyIntegralImageObject *self, PyObject *rects)
+{
+    return integralimage_query_many (self, rects, 0);
+}
+
+static PyObject*
+integralimage_average_many (PyIntegralImageObject *self, PyObject *rects)
+{
+    return integralimage_query_many (self, rects, 1);
+}
+
+static PyObject*
+integralimage_get_size (PyIntegralImageObject *self)
+{
+    return Py_BuildValue ("(ii)", self->w, self->h);
+}
+
+static PyMethodDef integralimage_methods[] =
+{
+    { "sum", (PyCFunction) integralimage_sum_method, METH_VARARGS,
+          DOC_INTEGRALIMAGESUM },
+    { "average", (PyCFunction) integralimage_average, METH_VARARGS,
+          DOC_INTEGRALIMAGEAVERAGE },
+    { "sum_many", (PyCFunction) integralimage_sum_many, METH_O,
+          DOC_INTEGRALIMAGESUMMANY },
+    { "average_many", (PyCFunction) integralimage_average_many, METH_O,
+          DOC_INTEGRALIMAGEAVERAGEMANY },
+    { "get_size", (PyCFunction) integralimage_get_size, METH_NOARGS,
+          DOC_INTEGRALIMAGEGETSIZE },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject PyIntegralImage_Type =
+{
+    TYPE_HEAD (NULL, 0)
+    "pygame.transform.IntegralImage",   /* tp_name */
+    sizeof (PyIntegralImageObject),     /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor) integralimage_dealloc, /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_compare */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    DOC_PYGAMETRANSFORMINTEGRALIMAGE,   /* Documentation string */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    integralimage_methods,              /* tp_methods */
+    0,                                  /* tp_members */
+    0,                                  /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    0,                                  /* tp_init */
+    0,                                  /* tp_alloc */
+    integralimage_new,                  /* tp_new */
+};
+
+/* Accumulator: running sums of surfaces, for average_surfaces over a
+ * stream of frames. Surfaces are read a row at a time into RGBA bytes,
+ * which the accumulate functions of scale.h add to Uint32 sums. With a
+ * window the last frames are kept, in RGBA, to take them out again; with
+ * alpha the sums are instead a float exponential moving average.
+ *
+ * The sums, frames, row, count and next are only touched with the GIL
+ * released and the object's lock held, so threads sharing an Accumulator
+ * take turns. The lock is never held while waiting for the GIL.
+ */
+typedef struct {
+    void (*add) (Uint32 *, Uint8 *, int);
+    void (*sub) (Uint32 *, Uint8 *, int);
+    void (*ema) (float *, Uint8 *, int, float);
+} AccumulateOps;
+
+static void
+accumulate_add_ONLYC (Uint32 *acc, Uint8 *src, int count)
+{
+    int i = 0;
+
+    ACCUMULATE_TAIL (i, ACCUMULATE_ADD)
+}
+
+static void
+accumulate_sub_ONLYC (Uint32 *acc, Uint8 *src, int count)
+{
+    int i = 0;
+
+    ACCUMULATE_TAIL (i, ACCUMULATE_SUB)
+}
+
+static void
+accumulate_ema_ONLYC (float *acc, Uint8 *src, int count, float alpha)
+{
+    int i = 0;
+
+    ACCUMULATE_TAIL (i, ACCUMULATE_EMA)
+}
+
+static const AccumulateOps accumulate_ops_ONLYC = {
+    accumulate_add_ONLYC, accumulate_sub_ONLYC, accumulate_ema_ONLYC
+};
+#if defined(PG_SIMD_X86)
+static const AccumulateOps accumulate_ops_SSE2 = {
+    accumulate_add_SSE2, accumulate_sub_SSE2, accumulate_ema_SSE2
+};
+#endif
+#if defined(PG_SIMD_NEON)
+static const AccumulateOps accumulate_ops_NEON = {
+    accumulate_add_NEON, accumulate_sub_NEON, accumulate_ema_NEON
+};
+#endif
+
+/* Most frames the Uint32 sums can hold, with room to round the mean */
+#define ACCUMULATOR_MAX_COUNT (0xffffffffU / 256)
+
+typedef struct {
+    PyObject_HEAD
+    int w;
+    int h;
+    int window;                 /* frames kept, or 0 */
+    float alpha;                /* weight of a new frame, or 0 */
+    Uint32 *sums;               /* w * h * 4, without alpha */
+    float *ema;                 /* w * h * 4, with alpha */
+    Uint8 *frames;              /* window frames of w * h * 4 */
+    Uint8 *row;                 /* one row of RGBA */
+    int next;                   /* the frame the next add replaces */
+    Py_ssize_t count;
+    const AccumulateOps *ops;
+    SDL_mutex *lock;
+} PyAccumulatorObject;
+
+static int
+accumulator_fast_format (SDL_PixelFormat *format)
+{
+    return (threshold_fast_format (format) &&
+            (format->Amask == 0 ||
+             (format->Ashift % 8 == 0 &&
+              format->Amask == 0xffU << format->Ashift)));
+}
+
+/* Row y of surf as RGBA bytes */
+static void
+accumulator_read_row (SDL_Surface *surf, int y, Uint8 *rgba)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint8 *pixels = (Uint8 *) surf->pixels;
+    Uint8 *pix;
+    Uint32 color;
+    int x;
+
+    if (accumulator_fast_format (format))
+    {
+        Uint32 *row = (Uint32 *) (pixels + y * surf->pitch);
+
+        for (x = 0; x < surf->w; x++)
+        {
+            color = row[x];
+            rgba[x * 4] = (Uint8) (color >> format->Rshift);
+            rgba[x * 4 + 1] = (Uint8) (color >> format->Gshift);
+            rgba[x * 4 + 2] = (Uint8) (color >> format->Bshift);
+            rgba[x * 4 + 3] = format->Amask ?
+                (Uint8) (color >> format->Ashift) : 255;
+        }
+        return;
+    }
+    for (x = 0; x < surf->w; x++)
+    {
+        SURF_GET_AT (color, surf, x, y, pixels, format, pix);
+        SDL_GetRGBA (color, format, rgba + x * 4, rgba + x * 4 + 1,
+                     rgba + x * 4 + 2, rgba + x * 4 + 3);
+    }
+}
+
+static void
+accumulator_write_row (SDL_Surface *surf, int y, Uint8 *rgba)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint8 *pixels = (Uint8 *) surf->pixels;
+    Uint8 *byte_buf;
+    Uint32 color;
+    int x;
+
+    if (accumulator_fast_format (format))
+    {
+        Uint32 *row = (Uint32 *) (pixels + y * surf->pitch);
+
+        for (x = 0; x < surf->w; x++)
+            row[x] = (((Uint32) rgba[x * 4] << format->Rshift) |
+                      ((Uint32) rgba[x * 4 + 1] << format->Gshift) |
+                      ((Uint32) rgba[x * 4 + 2] << format->Bshift) |
+                      (((Uint32) rgba[x * 4 + 3] << format->Ashift) &
+                       format->Amask));
+        return;
+    }
+    for (x = 0; x < surf->w; x++)
+    {
+        color = SDL_MapRGBA (format, rgba[x * 4], rgba[x * 4 + 1],
+                             rgba[x * 4 + 2], rgba[x * 4 + 3]);
+        SURF_SET_AT (color, surf, x, y, pixels, format, byte_buf);
+    }
+}
+
+/* Add surf, or take it out with sub, called with the GIL released and
+   self->lock held */
+static void
+accumulator_update (PyAccumulatorObject *self, SDL_Surface *surf, int sub)
+{
+    size_t rowlen = (size_t) self->w * 4;
+    size_t framelen = rowlen * self->h;
+    Uint8 *frame = NULL;
+    int y;
+
+    if (self->window)
+        frame = self->frames + self->next * framelen;
+    for (y = 0; y < self->h; y++)
+    {
+        Uint32 *sums = self->sums ? self->sums + y * rowlen : NULL;
+
+        if (frame)
+        {
+            /* replace the oldest frame */
+            Uint8 *row = frame + y * rowlen;
+
+            if (self->count == self->window)
+                self->ops->sub (sums, row, (int) rowlen);
+            accumulator_read_row (surf, y, row);
+            self->ops->add (sums, row, (int) rowlen);
+            continue;
+        }
+        accumulator_read_row (surf, y, self->row);
+        if (sums == NULL)
+        {
+            float *ema = self->ema + y * rowlen;
+            size_t i;
+
+            if (self->count)
+                self->ops->ema (ema, self->row, (int) rowlen, self->alpha);
+            else
+                for (i = 0; i < rowlen; i++)
+                    ema[i] = self->row[i];
+        }
+        else if (sub)
+            self->ops->sub (sums, self->row, (int) rowlen);
+        else
+            self->ops->add (sums, self->row, (int) rowlen);
+    }
+}
+
+static void
+accumulator_result (PyAccumulatorObject *self, SDL_Surface *surf)
+{
+    size_t rowlen = (size_t) self->w * 4;
+    Uint32 count = (Uint32) self->count;
+    size_t i;
+    int y;
+
+    for (y = 0; y < self->h; y++)
+    {
+        if (self->sums)
+        {
+            Uint32 *sums = self->sums + y * rowlen;
+
+            for (i = 0; i < rowlen; i++)
+                self->row[i] = (Uint8) ((sums[i] + count / 2) / count);
+        }
+        else
+        {
+            float *ema = self->ema + y * rowlen;
+
+            for (i = 0; i < rowlen; i++)
+                self->row[i] = (Uint8) (ema[i] + 0.5f);
+        }
+        accumulator_write_row (surf, y, self->row);
+    }
+}
+
+static PyObject*
+accumulator_new (PyTypeObject *type, PyObject *args, PyObject *kwds)
+{
+    PyAccumulatorObject *self;
+    int w, h, window = 0;
+    float alpha = 0.0f;
+    size_t framelen;
+    static char *keywords[] = {"size", "window", "alpha", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords (args, kwds, "(ii)|if:Accumulator",
+                                      keywords, &w, &h, &window, &alpha))
+        return NULL;
+    if (w < 0 || h < 0)
+        return RAISE (PyExc_ValueError, "Cannot use negative size");
+    if (window < 0)
+        return RAISE (PyExc_ValueError, "window must not be negative");
+    if (!(alpha >= 0.0f && alpha <= 1.0f))
+        return RAISE (PyExc_ValueError, "alpha must be from 0 to 1");
+    if (window && alpha)
+        return RAISE (PyExc_ValueError,
+                      "Cannot use both a window and alpha");
+    if ((size_t) w * 4 > INT_MAX ||
+        (h && (size_t) w * 4 > ((size_t) -1) / sizeof (float) / h))
+        return PyErr_NoMemory ();
+    framelen = (size_t) w * h * 4;
+    if (window && framelen && (size_t) window > ((size_t) -1) / framelen)
+        return PyErr_NoMemory ();
+
+    self = (PyAccumulatorObject *) type->tp_alloc (type, 0);
+    if (self == NULL)
+        return NULL;
+    self->w = w;
+    self->h = h;
+    self->window = window;
+    self->alpha = alpha;
+    self->ops = &accumulate_ops_ONLYC;
+#if defined(PG_SIMD_X86)
+    if (SDL_HasSSE2 ())
+        self->ops = &accumulate_ops_SSE2;
+#endif
+#if defined(PG_SIMD_NEON)
+    if (SDL_HasNEON ())
+        self->ops = &accumulate_ops_NEON;
+#endif
+    /* at least a byte each, so a 0 size is not an allocation failure */
+    self->row = (Uint8 *) PyMem_Malloc ((size_t) w * 4 + 1);
+    if (alpha)
+        self->ema = (float *) PyMem_Malloc (framelen * sizeof (float) + 1);
+    else
+        self->sums = (Uint32 *) PyMem_Malloc (framelen * sizeof (Uint32) + 1);
+    if (window)
+        self->frames = (Uint8 *) PyMem_Malloc (framelen * window + 1);
+    if (self->row == NULL || (alpha ? !self->ema : !self->sums) ||
+        (window && self->frames == NULL))
+    {
+        Py_DECREF (self);
+        return PyErr_NoMemory ();
+    }
+    if (self->sums)
+        memset (self->sums, 0, framelen * sizeof (Uint32));
+    self->lock = SDL_CreateMutex ();
+    if (self->lock == NULL)
+    {
+        Py_DECREF (self);
+        return RAISE (PyExc_SDLError, SDL_GetError ());
+    }
+    return (PyObject *) self;
+}
+
+static void
+accumulator_dealloc (PyAccumulatorObject *self)
+{
+    PyMem_Free (self->sums);
+    PyMem_Free (self->ema);
+    PyMem_Free (self->frames);
+    PyMem_Free (self->row);
+    if (self->lock)
+        SDL_DestroyMutex (self->lock);
+    Py_TYPE (self)->tp_free ((PyObject *) self);
+}
+
+static SDL_Surface*
+accumulator_check (PyAccumulatorObject *self, PyObject *surfobj)
+{
+    SDL_Surface *surf = PySurface_AsSurface (surfobj);
+
+    if (surf->w != self->w || surf->h != self->h)
+    {
+        RAISE (PyExc_ValueError, "Surface not the size of the Accumulator");
+        return NULL;
+    }
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4)
+    {
+        RAISE (PyExc_ValueError, "unsupport Surface bit depth for transform");
+        return NULL;
+    }
+    return surf;
+}
+
+static PyObject*
+accumulator_add (PyAccumulatorObject *self, PyObject *args)
+{
+    PyObject *surfobj;
+    SDL_Surface *surf;
+    int full;
+
+    if (!PyArg_ParseTuple (args, "O!", &PySurface_Type, &surfobj))
+        return NULL;
+    if (!(surf = accumulator_check (self, surfobj)))
+        return NULL;
+
+    PySurface_Lock (surfobj);
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex (self->lock);
+    full = (self->sums && !self->window &&
+            self->count >= (Py_ssize_t) ACCUMULATOR_MAX_COUNT);
+    if (!full)
+    {
+        accumulator_update (self, surf, 0);
+        if (self->window)
+        {
+            self->next = (self->next + 1) % self->window;
+            if (self->count < self->window)
+                self->count++;
+        }
+        else
+            self->count++;
+    }
+    SDL_UnlockMutex (self->lock);
+    Py_END_ALLOW_THREADS;
+    PySurface_Unlock (surfobj);
+
+    if (full)
+        return RAISE (PyExc_OverflowError, "too many surfaces added");
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+accumulator_remove (PyAccumulatorObject *self, PyObject *args)
+{
+    PyObject *surfobj;
+    SDL_Surface *surf;
+    int empty;
+
+    if (!PyArg_ParseTuple (args, "O!", &PySurface_Type, &surfobj))
+        return NULL;
+    if (self->window || self->alpha)
+        return RAISE (PyExc_ValueError,
+                      "remove() needs an Accumulator without window or alpha");
+    if (!(surf = accumulator_check (self, surfobj)))
+        return NULL;
+
+    PySurface_Lock (surfobj);
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex (self->lock);
+    empty = self->count == 0;
+    if (!empty)
+    {
+        accumulator_update (self, surf, 1);
+        self->count--;
+    }
+    SDL_UnlockMutex (self->lock);
+    Py_END_ALLOW_THREADS;
+    PySurface_Unlock (surfobj);
+
+    if (empty)
+        return RAISE (PyExc_ValueError, "No surfaces to remove");
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+accumulator_to_surface (PyAccumulatorObject *self, PyObject *args)
+{
+    PyObject *surfobj = NULL;
+    SDL_Surface *surf;
+    int empty;
+
+    if (!PyArg_ParseTuple (args, "|O!", &PySurface_Type, &surfobj))
+        return NULL;
+
+    if (surfobj)
+    {
+        if (!(surf = accumulator_check (self, surfobj)))
+            return NULL;
+        PySurface_Lock (surfobj);
+    }
+    else
+    {
+        surf = SDL_CreateRGBSurface (SDL_SRCALPHA, self->w, self->h, 32,
+                                     0xff << 16, 0xff << 8, 0xff,
+                                     0xffU << 24);
+        if (!surf)
+            return RAISE (PyExc_SDLError, SDL_GetError ());
+        SDL_LockSurface (surf);
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex (self->lock);
+    empty = self->count == 0;
+    if (!empty)
+        accumulator_result (self, surf);
+    SDL_UnlockMutex (self->lock);
+    Py_END_ALLOW_THREADS;
+
+    if (surfobj)
+    {
+        PySurface_Unlock (surfobj);
+        if (empty)
+            return RAISE (PyExc_ValueError, "No surfaces added");
+        Py_INCREF (surfobj);
+        return surfobj;
+    }
+    SDL_UnlockSurface (surf);
+    if (empty)
+    {
+        SDL_FreeSurface (surf);
+        return RAISE (PyExc_ValueError, "No surfaces added");
+    }
+    return PySurface_New (surf);
+}
+
+static PyObject*
+accumulator_clear (PyAccumulatorObject *self)
+{
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex (self->lock);
+    if (self->sums)
+        memset (self->sums, 0, (size_t) self->w * self->h * 4 *
+                sizeof (Uint32));
+    self->count = 0;
+    self->next = 0;
+    SDL_UnlockMutex (self->lock);
+    Py_END_ALLOW_THREADS;
+    Py_RETURN_NONE;
+}
+
+static PyObject*
+accumulator_get_count (PyAccumulatorObject *self)
+{
+    Py_ssize_t count;
+
+    Py_BEGIN_ALLOW_THREADS;
+    SDL_LockMutex (self->lock);
+    count = self->count;
+    SDL_UnlockMutex (self->lock);
+    Py_END_ALLOW_THREADS;
+    return PyInt_FromSsize_t (count);
+}
+
+static PyMethodDef accumulator_methods[] =
+{
+    { "add", (PyCFunction) accumulator_add, METH_VARARGS,
+          DOC_ACCUMULATORADD },
+    { "remove", (PyCFunction) accumulator_remove, METH_VARARGS,
+          DOC_ACCUMULATORREMOVE },
+    { "to_surface", (PyCFunction) accumulator_to_surface, METH_VARARGS,
+          DOC_ACCUMULATORTOSURFACE },
+    { "clear", (PyCFunction) accumulator_clear, METH_NOARGS,
+          DOC_ACCUMULATORCLEAR },
+    { "get_count", (PyCFunction) accumulator_get_count, METH_NOARGS,
+          DOC_ACCUMULATORGETCOUNT },
+    { NULL, NULL, 0, NULL }
+};
+
+static PyTypeObject PyAccumulator_Type =
+{
+    TYPE_HEAD (NULL, 0)
+    "pygame.transform.Accumulator",     /* tp_name */
+    sizeof (PyAccumulatorObject),       /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor) accumulator_dealloc,   /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_compare */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    DOC_PYGAMETRANSFORMACCUMULATOR,     /* Documentation string */
+    0,                                  /* tp_traverse */
+    0,                                  /* tp_clear */
+    0,                                  /* tp_richcompare */
+    0,                                  /* tp_weaklistoffset */
+    0,                                  /* tp_iter */
+    0,                                  /* tp_iternext */
+    accumulator_methods,                /* tp_methods */
+    0,                                  /* tp_members */
+    0,                                  /* tp_getset */
+    0,                                  /* tp_base */
+    0,                                  /* tp_dict */
+    0,                                  /* tp_descr_get */
+    0,                                  /* tp_descr_set */
+    0,                                  /* tp_dictoffset */
+    0,                                  /* tp_init */
+    0,                                  /* tp_alloc */
+    accumulator_new,                    /* tp_new */
+};
+
 static PyMethodDef _transform_methods[] =
 {
     { "scale", surf_scale, METH_VARARGS, DOC_PYGAMETRANSFORMSCALE },
-    { "rotate", surf_rotate, METH_VARARGS, DOC_PYGAMETRANSFORMROTATE },
+    { "rotate", (PyCFunction) surf_rotate, METH_VARARGS | METH_KEYWORDS,
+          DOC_PYGAMETRANSFORMROTATE },
     { "flip", surf_flip, METH_VARARGS, DOC_PYGAMETRANSFORMFLIP },
     { "rotozoom", surf_rotozoom, METH_VARARGS, DOC_PYGAMETRANSFORMROTOZOOM},
-    { "chop", surf_chop, METH_VARARGS, DOC_PYGAMETRANSFORMCHOP },
+    { "flip_ip", surf_flip_ip, METH_VARARGS, DOC_PYGAMETRANSFORMFLIPIP },
+    { "chop", (PyCFunction) surf_chop, METH_VARARGS | METH_KEYWORDS,
+          DOC_PYGAMETRANSFORMCHOP },
     { "scale2x", surf_scale2x, METH_VARARGS, DOC_PYGAMETRANSFORMSCALE2X },
     { "smoothscale", surf_scalesmooth, METH_VARARGS, DOC_PYGAMETRANSFORMSMOOTHSCALE },
+    { "build_pyramid", surf_build_pyramid, METH_VARARGS,
+          DOC_PYGAMETRANSFORMBUILDPYRAMID },
+    { "pyramid_scale", surf_pyramid_scale, METH_VARARGS,
+          DOC_PYGAMETRANSFORMPYRAMIDSCALE },
+    { "box_blur", surf_box_blur, METH_VARARGS, DOC_PYGAMETRANSFORMBOXBLUR },
+    { "gaussian_blur", surf_gaussian_blur, METH_VARARGS,
+          DOC_PYGAMETRANSFORMGAUSSIANBLUR },
     { "get_smoothscale_backend", (PyCFunction) surf_get_smoothscale_backend, METH_NOARGS,
           DOC_PYGAMETRANSFORMGETSMOOTHSCALEBACKEND },
     { "set_smoothscale_backend", (PyCFunction) surf_set_smoothscale_backend,
@@ -2878,6 +5041,16 @@ MODINIT_DEFINE (transform)
         MODINIT_ERROR;
     }
 
+    if (PyType_Ready (&PyRotationCache_Type) < 0) {
+        MODINIT_ERROR;
+    }
+    if (PyType_Ready (&PyIntegralImage_Type) < 0) {
+        MODINIT_ERROR;
+    }
+    if (PyType_Ready (&PyAccumulator_Type) < 0) {
+        MODINIT_ERROR;
+    }
+
     /* create the module */
 #if PY3
     module = PyModule_Create (&_module);
@@ -2891,6 +5064,28 @@ MODINIT_DEFINE (transform)
         MODINIT_ERROR;
     }
 
+    Py_INCREF (&PyRotationCache_Type);
+    if (PyModule_AddObject (module, "RotationCache",
+                            (PyObject *) &PyRotationCache_Type)) {
+        Py_DECREF (&PyRotationCache_Type);
+        DECREF_MOD (module);
+        MODINIT_ERROR;
+    }
+    Py_INCREF (&PyIntegralImage_Type);
+    if (PyModule_AddObject (module, "IntegralImage",
+                            (PyObject *) &PyIntegralImage_Type)) {
+        Py_DECREF (&PyIntegralImage_Type);
+        DECREF_MOD (module);
+        MODINIT_ERROR;
+    }
+    Py_INCREF (&PyAccumulator_Type);
+    if (PyModule_AddObject (module, "Accumulator",
+                            (PyObject *) &PyAccumulator_Type)) {
+        Py_DECREF (&PyAccumulator_Type);
+        DECREF_MOD (module);
+        MODINIT_ERROR;
+    }
+
     st = GETSTATE (module);
     if (st->filter_type == 0) {
         smoothscale_init (st);
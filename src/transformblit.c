@@ -0,0 +1,352 @@
+/*
+  pygame - Python Game Library
+  Copyright (C) 2000-2001  Pete Shinners
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+  Pete Shinners
+  pete@shinners.org
+*/
+
+/* A rotated and scaled alpha blit done in one pass. Each destination pixel
+ * in the bounding box of the transformed source is mapped back into the
+ * source, sampled, and blended as pygame_AlphaBlit would, so no
+ * intermediate surface is needed.
+ */
+
+#define NO_PYGAME_C_API
+#include "_surface.h"
+#include "pgworkers.h"
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Source coordinates are stepped in 16.16 fixed point, held in 64 bits
+   so large sources cannot overflow. The smallest scale keeps a step below
+   2^32 source pixels.
+ */
+#define TB_SHIFT 16
+#define TB_ONE (1 << TB_SHIFT)
+
+typedef struct
+{
+    Uint8           *s_pixels;
+    int              s_pitch;
+    int              s_bpp;
+    int              s_w, s_h;
+    SDL_PixelFormat *src;
+    int              src_ppa;       /* Source has per pixel alpha        */
+    int              alphamod;      /* Surface alpha, 255 if none        */
+    int              has_colorkey;
+    Uint32           colorkey;
+    Uint8           *d_pixels;
+    int              d_pitch;
+    int              d_bpp;
+    SDL_PixelFormat *dst;
+    int              dst_ppa;
+    int              x, y, w, h;    /* Destination area to visit         */
+    double           u0, v0;        /* Source position of the first pixel */
+    double           dudx, dvdx;    /* Source step for one pixel right   */
+    double           dudy, dvdy;    /* Source step for one pixel down    */
+    int              smooth;
+} TransformBlitInfo;
+
+static void
+transformblit_band (void *job, int first, int count);
+
+/* Read source pixel (x, y) as straight RGBA; alpha 0 when off the surface
+ * or matching the colorkey.
+ */
+static void
+transformblit_sample (TransformBlitInfo *info, int x, int y, int *r,
+                      int *g, int *b, int *a)
+{
+    SDL_PixelFormat *fmt = info->src;
+    Uint8 *sp;
+    Uint32 pixel;
+
+    if (x < 0 || y < 0 || x >= info->s_w || y >= info->s_h) {
+        *r = *g = *b = *a = 0;
+        return;
+    }
+    sp = info->s_pixels + y * info->s_pitch + x * info->s_bpp;
+    if (info->s_bpp == 1) {
+        pixel = *sp;
+        GET_PIXELVALS_1 (*r, *g, *b, *a, sp, fmt);
+        if (!info->src_ppa)
+            *a = 255;
+    }
+    else {
+        GET_PIXEL (pixel, info->s_bpp, sp);
+        GET_PIXELVALS (*r, *g, *b, *a, pixel, fmt, info->src_ppa);
+    }
+    if (info->has_colorkey && pixel == info->colorkey)
+        *a = 0;
+}
+
+static void
+transformblit_band (void *job, int first, int count)
+{
+    TransformBlitInfo *info = (TransformBlitInfo *) job;
+    SDL_PixelFormat *dstfmt = info->dst;
+    int d_bpp = info->d_bpp;
+    int dppa = info->dst_ppa;
+    Sint64 du = (Sint64) floor (info->dudx * TB_ONE + 0.5);
+    Sint64 dv = (Sint64) floor (info->dvdx * TB_ONE + 0.5);
+    Sint64 su, sv;
+    int row, col, fx, fy;
+    int iu, iv;
+    Uint8 *dp;
+    Uint32 pixel;
+    int dR, dG, dB, dA, sR, sG, sB, sA;
+    int r[4], g[4], b[4], a[4];
+    Uint32 w[4], wa, tot, accR, accG, accB;
+    int i;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    int dstoffR = dstfmt->Rshift >> 3;
+    int dstoffG = dstfmt->Gshift >> 3;
+    int dstoffB = dstfmt->Bshift >> 3;
+#else
+    int dstoffR = 2 - (dstfmt->Rshift >> 3);
+    int dstoffG = 2 - (dstfmt->Gshift >> 3);
+    int dstoffB = 2 - (dstfmt->Bshift >> 3);
+#endif
+
+    for (row = first; row < first + count; ++row) {
+        /* Start each row from the exact position so errors do not build up
+           down the destination.
+         */
+        su = (Sint64) floor ((info->u0 + row * info->dudy) * TB_ONE + 0.5);
+        sv = (Sint64) floor ((info->v0 + row * info->dvdy) * TB_ONE + 0.5);
+        if (info->smooth) {
+            /* Interpolate between the centers of the four nearest pixels */
+            su -= TB_ONE / 2;
+            sv -= TB_ONE / 2;
+        }
+        dp = info->d_pixels + (info->y + row) * info->d_pitch +
+             info->x * d_bpp;
+
+        for (col = 0; col < info->w; ++col, su += du, sv += dv, dp += d_bpp) {
+            if (!info->smooth) {
+                if (su < 0 || sv < 0)
+                    continue;
+                if ((su >> TB_SHIFT) >= info->s_w ||
+                    (sv >> TB_SHIFT) >= info->s_h)
+                    continue;
+                iu = (int) (su >> TB_SHIFT);
+                iv = (int) (sv >> TB_SHIFT);
+                transformblit_sample (info, iu, iv, &sR, &sG, &sB, &sA);
+            }
+            else {
+                /* Shift by a pixel so the left and top neighbours of the
+                   first row and column never need a negative shift.
+                 */
+                if (su < -TB_ONE || sv < -TB_ONE)
+                    continue;
+                if ((su >> TB_SHIFT) >= info->s_w ||
+                    (sv >> TB_SHIFT) >= info->s_h)
+                    continue;
+                iu = (int) ((su + TB_ONE) >> TB_SHIFT) - 1;
+                iv = (int) ((sv + TB_ONE) >> TB_SHIFT) - 1;
+                fx = (int) ((su + TB_ONE) >> (TB_SHIFT - 8)) & 0xff;
+                fy = (int) ((sv + TB_ONE) >> (TB_SHIFT - 8)) & 0xff;
+                w[0] = (256 - fx) * (256 - fy);
+                w[1] = fx * (256 - fy);
+                w[2] = (256 - fx) * fy;
+                w[3] = fx * fy;
+                transformblit_sample (info, iu, iv, r, g, b, a);
+                transformblit_sample (info, iu + 1, iv, r + 1, g + 1, b + 1,
+                                      a + 1);
+                transformblit_sample (info, iu, iv + 1, r + 2, g + 2, b + 2,
+                                      a + 2);
+                transformblit_sample (info, iu + 1, iv + 1, r + 3, g + 3,
+                                      b + 3, a + 3);
+
+                /* Weight the colors by alpha so transparent pixels do not
+                   bleed into the edges.
+                 */
+                tot = accR = accG = accB = 0;
+                for (i = 0; i < 4; ++i) {
+                    wa = (w[i] >> 8) * a[i];
+                    tot += wa;
+                    accR += wa * r[i];
+                    accG += wa * g[i];
+                    accB += wa * b[i];
+                }
+                if (!tot)
+                    continue;
+                sR = (accR + tot / 2) / tot;
+                sG = (accG + tot / 2) / tot;
+                sB = (accB + tot / 2) / tot;
+                sA = (tot + 128) >> 8;
+            }
+            if (info->alphamod != 255)
+                sA = sA * info->alphamod / 255;
+
+            GET_PIXEL (pixel, d_bpp, dp);
+            GET_PIXELVALS (dR, dG, dB, dA, pixel, dstfmt, dppa);
+            ALPHA_BLEND (sR, sG, sB, sA, dR, dG, dB, dA);
+            if (d_bpp == 3) {
+                dp[dstoffR] = dR;
+                dp[dstoffG] = dG;
+                dp[dstoffB] = dB;
+            }
+            else {
+                CREATE_PIXEL (dp, dR, dG, dB, dA, d_bpp, dstfmt);
+            }
+        }
+    }
+}
+
+int
+pygame_TransformBlit (SDL_Surface *src, SDL_Surface *dst, double cx,
+                      double cy, double angle, double scale, int smooth,
+                      SDL_Rect *dstrect)
+{
+    TransformBlitInfo info;
+    SDL_Rect *clip = &dst->clip_rect;
+    double radians, c, s, ex, ey, sw, sh, fx1, fy1, fx2, fy2;
+    int x1, y1, x2, y2;
+    int overlap, nbands;
+#ifdef SDL2
+    Uint8 alphamod;
+#endif /* SDL2 */
+
+    dstrect->x = clip->x;
+    dstrect->y = clip->y;
+    dstrect->w = dstrect->h = 0;
+
+    if (dst->format->BytesPerPixel < 2) {
+        SDL_SetError ("unsupported destination bit depth for "
+                      "transformed blit");
+        return -1;
+    }
+    if (!Py_IS_FINITE (cx) || !Py_IS_FINITE (cy) || !Py_IS_FINITE (angle) ||
+        !Py_IS_FINITE (scale) ||
+        (scale != 0.0 && fabs (scale) < PYGAME_TRANSFORMBLIT_MIN_SCALE)) {
+        SDL_SetError ("invalid position, angle or scale for "
+                      "transformed blit");
+        return -1;
+    }
+    /* An empty result sits at the center, kept inside the clip area */
+    dstrect->x = (int) MAX (MIN (cx, clip->x + clip->w), clip->x);
+    dstrect->y = (int) MAX (MIN (cy, clip->y + clip->h), clip->y);
+    if (scale == 0.0 || src->w == 0 || src->h == 0)
+        return 0;
+
+    radians = angle * M_PI / 180.0;
+    c = cos (radians);
+    s = sin (radians);
+    sw = src->w;
+    sh = src->h;
+
+    /* Half size of the destination box; smooth sampling reaches half a
+       source pixel past each edge.
+     */
+    if (smooth) {
+        sw += 1;
+        sh += 1;
+    }
+    ex = (fabs (c) * sw + fabs (s) * sh) * fabs (scale) / 2.0;
+    ey = (fabs (s) * sw + fabs (c) * sh) * fabs (scale) / 2.0;
+    /* Allow for rounding in cos and sin, so 90 degree turns stay exact.
+       Clip before converting to int, as the box may be far off screen.
+     */
+    fx1 = MAX (floor (cx - ex + 1e-6), clip->x);
+    fy1 = MAX (floor (cy - ey + 1e-6), clip->y);
+    fx2 = MIN (ceil (cx + ex - 1e-6), clip->x + clip->w);
+    fy2 = MIN (ceil (cy + ey - 1e-6), clip->y + clip->h);
+    if (fx1 >= fx2 || fy1 >= fy2)
+        return 0;
+    x1 = (int) fx1;
+    y1 = (int) fy1;
+    x2 = (int) fx2;
+    y2 = (int) fy2;
+
+    info.s_pixels = (Uint8 *) src->pixels;
+    info.s_pitch = src->pitch;
+    info.s_bpp = src->format->BytesPerPixel;
+    info.s_w = src->w;
+    info.s_h = src->h;
+    info.src = src->format;
+#ifndef SDL2
+    info.src_ppa = (src->flags & SDL_SRCALPHA) && src->format->Amask;
+    info.alphamod = ((src->flags & SDL_SRCALPHA) && !src->format->Amask) ?
+                    src->format->alpha : 255;
+    info.has_colorkey = (src->flags & SDL_SRCCOLORKEY) != 0;
+    info.colorkey = src->format->colorkey;
+#else /* SDL2 */
+    info.src_ppa = SDL_ISPIXELFORMAT_ALPHA (src->format->format) &&
+                   src->format->Amask;
+    if (SDL_GetSurfaceAlphaMod (src, &alphamod) != 0)
+        alphamod = 255;
+    info.alphamod = alphamod;
+    info.has_colorkey = SDL_GetColorKey (src, &info.colorkey) == 0;
+#endif /* SDL2 */
+    info.d_pixels = (Uint8 *) dst->pixels;
+    info.d_pitch = dst->pitch;
+    info.d_bpp = dst->format->BytesPerPixel;
+    info.dst = dst->format;
+#ifndef SDL2
+    info.dst_ppa = (dst->flags & SDL_SRCALPHA) && dst->format->Amask;
+#else /* SDL2 */
+    info.dst_ppa = SDL_ISPIXELFORMAT_ALPHA (dst->format->format) &&
+                   dst->format->Amask;
+#endif /* SDL2 */
+    info.x = x1;
+    info.y = y1;
+    info.w = x2 - x1;
+    info.h = y2 - y1;
+    info.smooth = smooth;
+
+    /* Inverse map the center of destination pixel (x1, y1). A positive
+       angle turns the image counterclockwise on screen, as
+       pygame.transform.rotate does.
+     */
+    info.dudx = c / scale;
+    info.dvdx = s / scale;
+    info.dudy = -s / scale;
+    info.dvdy = c / scale;
+    info.u0 = (x1 + 0.5 - cx) * info.dudx + (y1 + 0.5 - cy) * info.dudy +
+              src->w / 2.0;
+    info.v0 = (x1 + 0.5 - cx) * info.dvdx + (y1 + 0.5 - cy) * info.dvdy +
+              src->h / 2.0;
+
+    /* A subsurface shares pixels with its parent. Bands would then read
+       pixels that other bands are writing, so run in one, as
+       SoftBlitPyGame does for an overlapping blit.
+     */
+    overlap = (info.d_pixels + y1 * info.d_pitch + x1 * info.d_bpp <
+               info.s_pixels + (info.s_h - 1) * info.s_pitch +
+               info.s_w * info.s_bpp &&
+               info.s_pixels <
+               info.d_pixels + (y2 - 1) * info.d_pitch + x2 * info.d_bpp);
+    nbands = overlap ? 1 : pg_workers_bands (info.w, info.h);
+    if (nbands > 1) {
+        Py_BEGIN_ALLOW_THREADS;
+        pg_workers_run (transformblit_band, &info, info.h, nbands);
+        Py_END_ALLOW_THREADS;
+    }
+    else
+        transformblit_band (&info, 0, info.h);
+
+    dstrect->x = x1;
+    dstrect->y = y1;
+    dstrect->w = x2 - x1;
+    dstrect->h = y2 - y1;
+    return 0;
+}
@@ -99,6 +99,9 @@ def createPygameMods():
             "scale2x.c",
             "surface_fill.c",
             "alphablit.c",            
+            "simd_blitters.c",
+            "pgworkers.c",
+            "transformblit.c",
         ),
         "gfxdraw" : ( 
             "gfxdraw.c", 
@@ -111,7 +114,8 @@ def createPygameMods():
         "transform" : (
             "transform.c",
             "rotozoom.c",
-            "scale2x.c"
+            "scale2x.c",
+            "scale_simd.c"
         )
     }
 
@@ -88,6 +88,246 @@ class BlitTest( unittest.TestCase ):
         self.assertEqual(s.get_at((0,0))[0], 0 )
 
 
+    def test_SRCALPHA_32_layouts(self):
+        """ 32 bit per pixel alpha blits match the ALPHA_BLEND macro.
+
+        Same layout and red/blue swapped 32 bit blits go through packed
+        pixel (SIMD) kernels. Widths around the 4 and 8 pixel kernel
+        strides check the vector bodies and the scalar row tails.
+        """
+        import random
+
+        def alpha_blend(s, d):
+            sR, sG, sB, sA = s
+            dR, dG, dB, dA = d
+            if not dA:
+                return (sR, sG, sB, sA)
+            def comp(sC, dC):
+                return (((sC - dC) * sA + sC) >> 8) + dC
+            return (comp(sR, dR), comp(sG, dG), comp(sB, dB),
+                    sA + dA - ((sA * dA) // 255))
+
+        rand = random.Random(23)
+        argb = (0xff0000, 0xff00, 0xff, 0xff000000)
+        abgr = (0xff, 0xff00, 0xff0000, 0xff000000)
+        rgba = (0xff000000, 0xff0000, 0xff00, 0xff)
+        bgra = (0xff00, 0xff0000, 0xff000000, 0xff)
+        layouts = [(argb, argb), (argb, abgr), (abgr, argb),
+                   (rgba, rgba), (rgba, bgra), (bgra, rgba)]
+        alphas = [0, 1, 127, 128, 254, 255]
+
+        for src_masks, dst_masks in layouts:
+            for w in [1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33]:
+                h = 2
+                s = pygame.Surface((w, h), SRCALPHA, 32, src_masks)
+                d = pygame.Surface((w, h), SRCALPHA, 32, dst_masks)
+                for y in range(h):
+                    for x in range(w):
+                        s.set_at((x, y), (rand.randint(0, 255),
+                                          rand.randint(0, 255),
+                                          rand.randint(0, 255),
+                                          rand.choice(alphas)))
+                        d.set_at((x, y), (rand.randint(0, 255),
+                                          rand.randint(0, 255),
+                                          rand.randint(0, 255),
+                                          rand.choice(alphas)))
+                expected = [alpha_blend(tuple(s.get_at((x, y))),
+                                        tuple(d.get_at((x, y))))
+                            for y in range(h) for x in range(w)]
+                d.blit(s, (0, 0))
+                result = [tuple(d.get_at((x, y)))
+                          for y in range(h) for x in range(w)]
+                self.assertEqual(result, expected,
+                                 "masks %s -> %s, width %i" %
+                                 ([hex(m) for m in src_masks],
+                                  [hex(m) for m in dst_masks], w))
+
+    def test_simd_backends(self):
+        """ Each SIMD backend gives the same pixels as the C kernels.
+
+        Alpha blits, the packed BLEND_* blits and get_bounding_rect are run
+        once per backend this machine has, on the same random surfaces, with
+        every tail width from 1 to 15 pixels and a few longer rows.
+        """
+        import random
+
+        self.assertRaises(ValueError, pygame.surface.set_simd_backend, 'NONE')
+        backend = pygame.surface.get_simd_backend()
+        backends = []
+        try:
+            for name in ['GENERIC', 'SSE2', 'AVX2', 'NEON']:
+                try:
+                    pygame.surface.set_simd_backend(name)
+                except ValueError:
+                    continue
+                self.assertEqual(pygame.surface.get_simd_backend(), name)
+                backends.append(name)
+            self.assertEqual(backends[0], 'GENERIC')
+
+            results = {}
+            for name in backends:
+                pygame.surface.set_simd_backend(name)
+                results[name] = self._simd_backend_run(random.Random(37))
+            for name in backends[1:]:
+                for expected, result in zip(results['GENERIC'],
+                                            results[name]):
+                    self.assertEqual(result, expected,
+                                     "%s differs from GENERIC for %s" %
+                                     (name, expected[0]))
+        finally:
+            pygame.surface.set_simd_backend(backend)
+
+    def _simd_backend_run(self, rand):
+        argb = (0xff0000, 0xff00, 0xff, 0xff000000)
+        abgr = (0xff, 0xff00, 0xff0000, 0xff000000)
+        bgra = (0xff00, 0xff0000, 0xff000000, 0xff)
+        rgba = (0xff000000, 0xff0000, 0xff00, 0xff)
+        layouts = [(argb, argb), (argb, abgr), (rgba, bgra)]
+        blends = [0, BLEND_ADD, BLEND_SUB, BLEND_MULT, BLEND_MIN, BLEND_MAX,
+                  BLEND_RGBA_ADD, BLEND_RGBA_SUB, BLEND_RGBA_MULT,
+                  BLEND_RGBA_MIN, BLEND_RGBA_MAX]
+        widths = list(range(1, 16)) + [16, 17, 31, 32, 33, 71]
+        h = 3
+
+        def fill(surf, alphas):
+            w = surf.get_width()
+            for y in range(h):
+                for x in range(w):
+                    surf.set_at((x, y), (rand.randint(0, 255),
+                                         rand.randint(0, 255),
+                                         rand.randint(0, 255),
+                                         rand.choice(alphas)))
+
+        out = []
+        for w in widths:
+            for src_masks, dst_masks in layouts:
+                s = pygame.Surface((w, h), SRCALPHA, 32, src_masks)
+                fill(s, [0, 1, 127, 128, 254, 255])
+                for flags in blends:
+                    d = pygame.Surface((w, h), SRCALPHA, 32, dst_masks)
+                    fill(d, [0, 64, 255])
+                    d.blit(s, (0, 0), None, flags)
+                    out.append(((w, src_masks, dst_masks, flags),
+                                d.get_buffer().raw))
+
+            for flags in [BLEND_ADD, BLEND_SUB, BLEND_MIN, BLEND_MAX]:
+                s = pygame.Surface((w, h), 0, 16)
+                d = pygame.Surface((w, h), 0, 16)
+                fill(s, [255])
+                fill(d, [255])
+                d.blit(s, (0, 0), None, flags)
+                out.append(((w, 16, flags), d.get_buffer().raw))
+
+            # A few counted pixels anywhere in the rows
+            s = pygame.Surface((w, h), SRCALPHA, 32)
+            for i in range(3):
+                s.set_at((rand.randrange(w), rand.randrange(h)),
+                         (0, 0, 0, rand.randint(1, 255)))
+            out.append(((w, 'bounds'),
+                        [tuple(s.get_bounding_rect(a)) for a in (1, 128)]))
+        return out
+
+
+    def test_BLEND_same_layout(self):
+        """ Blend blits between surfaces of one layout match the BLEND_*
+        macros channel by channel.
+
+        These take the packed pixel kernels. RGB blends leave the
+        destination alpha alone, RGBA blends change all four channels.
+        """
+        import random
+
+        ops = {
+            BLEND_ADD: lambda s, d: min(s + d, 255),
+            BLEND_SUB: lambda s, d: max(d - s, 0),
+            BLEND_MULT: lambda s, d: (s * d) >> 8,
+            BLEND_MIN: min,
+            BLEND_MAX: max,
+            }
+        rgba_flags = {
+            BLEND_RGBA_ADD: BLEND_ADD,
+            BLEND_RGBA_SUB: BLEND_SUB,
+            BLEND_RGBA_MULT: BLEND_MULT,
+            BLEND_RGBA_MIN: BLEND_MIN,
+            BLEND_RGBA_MAX: BLEND_MAX,
+            }
+        rand = random.Random(29)
+        layouts = [(0xff0000, 0xff00, 0xff, 0xff000000),
+                   (0xff000000, 0xff0000, 0xff00, 0xff),
+                   (0xff00, 0xff0000, 0xff000000, 0xff),
+                   (0xff0000, 0xff00, 0xff, 0)]
+
+        def fill(surf, w, h):
+            for y in range(h):
+                for x in range(w):
+                    surf.set_at((x, y), [rand.randint(0, 255)
+                                         for i in range(4)])
+
+        for masks in layouts:
+            flags = SRCALPHA if masks[3] else 0
+            for special_flags in list(ops) + list(rgba_flags):
+                op = ops[rgba_flags.get(special_flags, special_flags)]
+                all_channels = special_flags in rgba_flags and masks[3]
+                for w in [1, 3, 4, 5, 8, 9, 17, 33]:
+                    h = 2
+                    s = pygame.Surface((w, h), flags, 32, masks)
+                    d = pygame.Surface((w, h), flags, 32, masks)
+                    fill(s, w, h)
+                    fill(d, w, h)
+                    expected = []
+                    for y in range(h):
+                        for x in range(w):
+                            sc = s.get_at((x, y))
+                            dc = d.get_at((x, y))
+                            c = [op(sc[i], dc[i]) for i in range(3)]
+                            c.append(op(sc[3], dc[3])
+                                     if all_channels else dc[3])
+                            expected.append(tuple(c))
+                    d.blit(s, (0, 0), None, special_flags)
+                    result = [tuple(d.get_at((x, y)))
+                              for y in range(h) for x in range(w)]
+                    self.assertEqual(result, expected,
+                                     "masks %s, flags %i, width %i" %
+                                     ([hex(m) for m in masks],
+                                      special_flags, w))
+
+    def test_BLEND_565(self):
+        """ 16 bit RGB565 blend blits work on the 5 and 6 bit fields """
+        import random
+
+        ops = {
+            BLEND_ADD: lambda s, d, m: min(s + d, m),
+            BLEND_SUB: lambda s, d, m: max(d - s, 0),
+            BLEND_MIN: lambda s, d, m: min(s, d),
+            BLEND_MAX: lambda s, d, m: max(s, d),
+            BLEND_RGBA_ADD: lambda s, d, m: min(s + d, m),
+            BLEND_RGBA_MAX: lambda s, d, m: max(s, d),
+            }
+        rand = random.Random(31)
+        masks = (0xf800, 0x07e0, 0x001f, 0)
+
+        for special_flags, op in ops.items():
+            for w in [1, 7, 8, 9, 17]:
+                s = pygame.Surface((w, 1), 0, 16, masks)
+                d = pygame.Surface((w, 1), 0, 16, masks)
+                spx = [rand.randint(0, 0xffff) for x in range(w)]
+                dpx = [rand.randint(0, 0xffff) for x in range(w)]
+                for x in range(w):
+                    s.set_at((x, 0), s.unmap_rgb(spx[x]))
+                    d.set_at((x, 0), d.unmap_rgb(dpx[x]))
+                spx = [s.get_at_mapped((x, 0)) for x in range(w)]
+                dpx = [d.get_at_mapped((x, 0)) for x in range(w)]
+                expected = []
+                for sp, dp in zip(spx, dpx):
+                    r = op(sp >> 11, dp >> 11, 31)
+                    g = op((sp >> 5) & 63, (dp >> 5) & 63, 63)
+                    b = op(sp & 31, dp & 31, 31)
+                    expected.append((r << 11) | (g << 5) | b)
+                d.blit(s, (0, 0), None, special_flags)
+                result = [d.get_at_mapped((x, 0)) for x in range(w)]
+                self.assertEqual(result, expected,
+                                 "flags %i, width %i" % (special_flags, w))
+
 
 if __name__ == '__main__':
     unittest.main()
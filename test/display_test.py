@@ -58,6 +58,44 @@ class DisplayModuleTest( unittest.TestCase ):
 
             """
 
+    def test_update_dirty(self):
+        pygame.init()
+        try:
+            self.assertRaises(pygame.error, pygame.display.set_dirty_tracking)
+            screen = pygame.display.set_mode((100, 100))
+            self.assertRaises(pygame.error, pygame.display.update_dirty)
+
+            pygame.display.set_dirty_tracking(True)
+            self.assertEqual(pygame.display.update_dirty(), [])
+
+            screen.fill((55, 55, 55), (90, 90, 20, 20))
+            self.assertEqual(pygame.display.update_dirty(),
+                             [pygame.Rect(90, 90, 10, 10)])
+
+            # overlapping changes are merged, separate ones are kept
+            sprite = pygame.Surface((10, 10))
+            screen.blit(sprite, (0, 0))
+            screen.blit(sprite, (5, 0))
+            pygame.draw.rect(screen, (255, 0, 0), (50, 50, 10, 10))
+            dirty = sorted(pygame.display.update_dirty())
+            self.assertEqual(dirty, [pygame.Rect(0, 0, 15, 10),
+                                     pygame.Rect(50, 50, 10, 10)])
+
+            # subsurface changes land on the display
+            sub = screen.subsurface((20, 30, 40, 40))
+            sub.blit(sprite, (1, 2))
+            self.assertEqual(pygame.display.update_dirty(),
+                             [pygame.Rect(21, 32, 10, 10)])
+
+            screen.fill((0, 0, 0))
+            pygame.display.flip()
+            self.assertEqual(pygame.display.update_dirty(), [])
+
+            pygame.display.set_dirty_tracking(False)
+            self.assertRaises(pygame.error, pygame.display.update_dirty)
+        finally:
+            pygame.quit()
+
     def todo_test_Info(self):
 
         # __doc__ (as of 2008-08-02) for pygame.display.Info:
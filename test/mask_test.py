@@ -131,7 +131,51 @@ class MaskTypeTest( unittest.TestCase ):
         self.assertRaises(IndexError, lambda : m.set_at((-1,0), 1) )
         self.assertRaises(IndexError, lambda : m.set_at((10,0), 1) )
         self.assertRaises(IndexError, lambda : m.set_at((0,10), 1) )
-        
+
+    def test_overlap_area__wide(self):
+        """ overlap, overlap_area and count agree on masks many words wide
+        """
+        random.seed(21)
+        m1 = random_mask((300, 70))
+        m2 = random_mask((150, 45))
+        empty = pygame.Mask((150, 45))
+        for offset in [(0, 0), (64, 3), (33, 25), (-17, -9),
+                       (290, 60), (-149, 5), (7, -44)]:
+            area = m1.overlap_mask(m2, offset).count()
+            self.assertEqual(m1.overlap_area(m2, offset), area)
+            self.assertEqual(m1.overlap(m2, offset) is not None, area > 0)
+            self.assertEqual(m1.overlap_area(empty, offset), 0)
+            self.assertEqual(m1.overlap(empty, offset), None)
+        self.assertEqual(m1.overlap_area(m1, (0, 0)), m1.count())
+
+    def test_overlap_many(self):
+        random.seed(23)
+        m = random_mask((70, 40))
+        pairs = []
+        for i in range(60):
+            size = (random.randint(1, 90), random.randint(1, 30))
+            other = pygame.Mask(size)
+            for k in range(random.randint(0, 5)):
+                other.set_at((random.randrange(size[0]),
+                              random.randrange(size[1])))
+            pairs.append((other, (random.randint(-100, 80),
+                                  random.randint(-40, 50))))
+        pairs.append((pygame.Mask((0, 0)), (3, 3)))
+
+        self.assertEqual(m.overlap_many(pairs),
+                         [i for i, (other, offset) in enumerate(pairs)
+                          if m.overlap(other, offset) is not None])
+        self.assertEqual(m.overlap_area_many(pairs),
+                         [m.overlap_area(other, offset)
+                          for other, offset in pairs])
+        self.assertEqual(m.overlap_many([]), [])
+        self.assertEqual(m.overlap_area_many(iter(pairs[:3])),
+                         m.overlap_area_many(pairs[:3]))
+        self.assertRaises(TypeError, m.overlap_many, [m])
+        self.assertRaises(TypeError, m.overlap_many, [(m, (0, 0), 1)])
+        self.assertRaises(TypeError, m.overlap_area_many, [(None, (0, 0))])
+        self.assertRaises(TypeError, m.overlap_area_many, 5)
+
     def test_drawing(self):
         """ Test fill, clear, invert, draw, erase
         """
@@ -272,7 +316,42 @@ class MaskTypeTest( unittest.TestCase ):
         self.assertEquals(len(comps1), 2)
         self.assertEquals(len(comps2), 1)
         self.assertEquals(len(comps3), 0)
-        
+
+        self.assertRaises(IndexError, m.connected_component, (10, 0))
+
+    def test_connected_components__crop(self):
+        """Cropped components match the full size ones, across word
+        boundaries and over many rows."""
+
+        # a diagonal across a word boundary, and a column spanning all rows
+        m = pygame.Mask((200, 150))
+        for i in range(100):
+            m.set_at((10 + i, 20 + i), 1)
+        for y in range(150):
+            m.set_at((150, y), 1)
+        comps = m.connected_components(crop=True)
+        self.assertEquals(len(comps), 2)
+        self.assertEquals(comps[0][1], pygame.Rect(150, 0, 1, 150))
+        self.assertEquals(comps[0][0].count(), 150)
+        self.assertEquals(comps[1][1], pygame.Rect(10, 20, 100, 100))
+        self.assertEquals(comps[1][0].get_size(), (100, 100))
+        self.assertEquals(comps[1][0].count(), 100)
+
+        m = random_mask((300, 100))
+        full = m.connected_components()
+        cropped = m.connected_components(crop=True)
+        rects = m.get_bounding_rects()
+        self.assertEquals(len(full), len(rects))
+        self.assertEquals(len(cropped), len(rects))
+        for comp, (part, rect), r in zip(full, cropped, rects):
+            self.assertEquals(rect, r)
+            self.assertEquals(part.get_size(), rect.size)
+            self.assertEquals(part.count(), comp.count())
+            self.assertEquals(comp.overlap_area(part, rect.topleft),
+                              part.count())
+
+        cropped = m.connected_components(3, crop=True)
+        self.assertEquals(len(cropped), len([c for c in full if c.count() >= 3]))
 
     def test_get_bounding_rects(self):
         """
@@ -453,6 +532,113 @@ class MaskModuleTest(unittest.TestCase):
             self.assertEqual(mask.get_bounding_rects(), [pygame.Rect((40,40,10,10))])
 
 
+    def test_from_surface__32bit_rows(self):
+        """ 32 bit surfaces of odd widths give the same masks per pixel
+        """
+        random.seed(24)
+        w, h = 83, 7
+        surf = pygame.Surface((w, h), SRCALPHA, 32)
+        keyed = pygame.Surface((w, h), 0, 32)
+        other = pygame.Surface((w, h), 0, 32)
+        colors = [(10, 20, 30), (200, 100, 50), (15, 25, 28), (0, 0, 0)]
+        for y in range(h):
+            for x in range(w):
+                surf.set_at((x, y), (random.randint(0, 255),
+                                     random.randint(0, 255),
+                                     random.randint(0, 255),
+                                     random.randint(0, 255)))
+                keyed.set_at((x, y), random.choice(colors))
+                other.set_at((x, y), random.choice(colors))
+
+        def check(mask, expected):
+            for y in range(h):
+                for x in range(w):
+                    self.assertEqual(bool(mask.get_at((x, y))),
+                                     bool(expected(x, y)), (x, y))
+
+        for threshold in (-1, 0, 127, 254, 255):
+            check(pygame.mask.from_surface(surf, threshold),
+                  lambda x, y: surf.get_at((x, y))[3] > threshold)
+
+        keyed.set_colorkey((10, 20, 30))
+        check(pygame.mask.from_surface(keyed),
+              lambda x, y: keyed.get_at((x, y))[:3] != (10, 20, 30))
+
+        def near(c1, c2, t):
+            return all(abs(c1[i] - c2[i]) < t[i] for i in range(3))
+        t = (6, 6, 3, 255)
+        check(pygame.mask.from_threshold(keyed, (12, 22, 30), t),
+              lambda x, y: near(keyed.get_at((x, y)), (12, 22, 30), t))
+        check(pygame.mask.from_threshold(keyed, (0, 0, 0), t, other),
+              lambda x, y: near(keyed.get_at((x, y)), other.get_at((x, y)),
+                                t))
+
+
+class MaskWorldTest(unittest.TestCase):
+    def brute_pairs(self, masks, positions):
+        pairs = set()
+        for i in range(len(masks)):
+            for j in range(i + 1, len(masks)):
+                offset = (positions[j][0] - positions[i][0],
+                          positions[j][1] - positions[i][1])
+                if masks[i].overlap(masks[j], offset) is not None:
+                    pairs.add((i, j))
+        return pairs
+
+    def check_pairs(self, world, masks, positions):
+        found = set()
+        for a, b, (x, y) in world.query_pairs():
+            self.assertTrue(a < b)
+            self.assertTrue(masks[a].get_at((x - positions[a][0],
+                                             y - positions[a][1])))
+            self.assertTrue(masks[b].get_at((x - positions[b][0],
+                                             y - positions[b][1])))
+            found.add((a, b))
+        self.assertEqual(found, self.brute_pairs(masks, positions))
+
+    def test_query_pairs(self):
+        random.seed(22)
+        world = pygame.mask.MaskWorld()
+        masks, positions = [], []
+        for i in range(40):
+            m = pygame.Mask((random.randint(1, 80), random.randint(1, 40)))
+            for k in range(random.randint(0, 30)):
+                m.set_at((random.randrange(m.get_size()[0]),
+                          random.randrange(m.get_size()[1])))
+            pos = (random.randint(-50, 200), random.randint(-50, 200))
+            self.assertEqual(world.add(m, pos), i)
+            masks.append(m)
+            positions.append(pos)
+        self.assertEqual(len(world), 40)
+        self.check_pairs(world, masks, positions)
+
+        for step in range(5):
+            for i in range(len(masks)):
+                positions[i] = (positions[i][0] + random.randint(-10, 10),
+                                positions[i][1] + random.randint(-10, 10))
+                world.move(i, positions[i])
+            self.check_pairs(world, masks, positions)
+
+    def test_remove(self):
+        full = pygame.Mask((10, 10))
+        full.fill()
+        world = pygame.mask.MaskWorld()
+        a = world.add(full, (0, 0))
+        b = world.add(full, (5, 5))
+        c = world.add(full, (9, 0))
+        self.assertEqual(sorted(p[:2] for p in world.query_pairs()),
+                         [(a, b), (a, c), (b, c)])
+        world.remove(b)
+        self.assertEqual(len(world), 2)
+        self.assertEqual([p[:2] for p in world.query_pairs()], [(a, c)])
+        self.assertRaises(KeyError, world.remove, b)
+        self.assertRaises(KeyError, world.move, b, (0, 0))
+        self.assertRaises(KeyError, world.move, 7, (0, 0))
+        self.assertEqual(world.add(pygame.Mask((0, 0)), (0, 0)), b)
+        self.assertEqual([p[:2] for p in world.query_pairs()], [(a, c)])
+        world.move(c, (10, 0))
+        self.assertEqual(world.query_pairs(), [])
+
 
 if __name__ == '__main__':
 
@@ -166,12 +166,62 @@ class SurfaceTypeTest(unittest.TestCase):
         self.assertEqual(bound_rect.width, 31)
         self.assertEqual(bound_rect.height, 31)
 
+        # Wide 32 bit surfaces take the vectorized path, check each edge
+        surf = pygame.Surface((77, 9), SRCALPHA, 32)
+        for pos, rect in [((40, 4), (40, 4, 1, 1)),
+                          ((3, 6), (3, 4, 38, 3)),
+                          ((76, 2), (3, 2, 74, 5)),
+                          ((50, 0), (3, 0, 74, 7)),
+                          ((10, 8), (3, 0, 74, 9))]:
+            surf.set_at(pos, (0, 0, 0, 200))
+            self.assertEqual(surf.get_bounding_rect(), pygame.Rect(rect))
+        self.assertEqual(surf.get_bounding_rect(min_alpha=201).size, (0, 0))
+        self.assertEqual(surf.get_bounding_rect(min_alpha=0),
+                         surf.get_rect())
+
+        # A cached result lasts until the surface is drawn on
+        surf.fill((0, 0, 0, 0))
+        surf.set_at((20, 3), (0, 0, 0, 255))
+        self.assertEqual(surf.get_bounding_rect(cache=True),
+                         pygame.Rect(20, 3, 1, 1))
+        self.assertEqual(surf.get_bounding_rect(cache=True),
+                         pygame.Rect(20, 3, 1, 1))
+        surf.fill((0, 0, 0, 255), (30, 5, 2, 2))
+        self.assertEqual(surf.get_bounding_rect(cache=True),
+                         pygame.Rect(20, 3, 12, 4))
+        surf.blit(pygame.Surface((1, 1)), (5, 1))
+        self.assertEqual(surf.get_bounding_rect(cache=True),
+                         pygame.Rect(5, 1, 27, 6))
+        surf.set_at((70, 8), (0, 0, 0, 255))
+        self.assertEqual(surf.get_bounding_rect(cache=True),
+                         pygame.Rect(5, 1, 66, 8))
+        surf.subsurface((0, 0, 4, 4)).fill((0, 0, 0, 255))
+        self.assertEqual(surf.get_bounding_rect(cache=True),
+                         pygame.Rect(0, 0, 71, 9))
+
         # Issue #180
         pygame.display.init()
         try:
             surf = pygame.Surface((4, 1), 0, 8)
             surf.fill((255, 255, 255))
             surf.get_bounding_rect()  # Segfault.
+
+            # Palette changes decide which pixels match the colorkey
+            surf = pygame.Surface((8, 8), 0, 8)
+            surf.set_palette_at(0, (0, 0, 0))
+            surf.set_palette_at(1, (255, 0, 0))
+            surf.fill((0, 0, 0))
+            surf.set_colorkey((0, 0, 0))
+            surf.set_at((5, 5), (255, 0, 0))
+            self.assertEqual(surf.get_bounding_rect(cache=True),
+                             pygame.Rect(5, 5, 1, 1))
+            surf.set_palette_at(1, (0, 0, 0))
+            self.assertEqual(surf.get_bounding_rect(cache=True),
+                             surf.get_bounding_rect())
+            self.assertEqual(surf.get_bounding_rect(cache=True).size, (0, 0))
+            surf.set_palette([(0, 0, 0), (0, 255, 0)])
+            self.assertEqual(surf.get_bounding_rect(cache=True),
+                             pygame.Rect(5, 5, 1, 1))
         finally:
             pygame.quit()
 
@@ -589,6 +639,126 @@ class SurfaceTypeTest(unittest.TestCase):
         self.assertEqual(s1.get_at((0, 0)), (0, 0, 0, 255))
         self.assertEqual(s1.get_at((1, 1)), color)
 
+    def test_blits(self):
+        dst1 = pygame.Surface((20, 20), 0, 32)
+        dst2 = pygame.Surface((20, 20), 0, 32)
+        src = pygame.Surface((4, 4), SRCALPHA, 32)
+        src.fill((10, 20, 30, 128))
+        solid = pygame.Surface((3, 3), 0, 32)
+        solid.fill((5, 6, 7))
+        sequence = [(src, (1, 1)),
+                    (solid, pygame.Rect(5, 5, 10, 10)),
+                    (src, (18, 18), (0, 0, 2, 2)),
+                    (solid, (2, 3), None, BLEND_ADD),
+                    (src, (-2, 10))]
+
+        expected = [dst1.blit(*args) for args in sequence]
+        rects = dst2.blits(sequence)
+        self.assertEqual(rects, expected)
+        for x in range(20):
+            for y in range(20):
+                self.assertEqual(dst1.get_at((x, y)), dst2.get_at((x, y)))
+
+        # Any iterable works, and doreturn=False gives None.
+        self.assertEqual(dst2.blits(iter(sequence), doreturn=False), None)
+        self.assertEqual(dst2.blits([]), [])
+
+        # A subsurface destination is offset like Surface.blit.
+        sub = dst2.subsurface((4, 4, 8, 8))
+        dst2.fill((0, 0, 0))
+        self.assertEqual(sub.blits([(solid, (1, 1))]),
+                         [pygame.Rect(1, 1, 3, 3)])
+        self.assertEqual(dst2.get_at((5, 5)), (5, 6, 7, 255))
+        self.assertEqual(dst2.get_at((4, 4)), (0, 0, 0, 255))
+
+        # Code run by the iterator sees the owner as it was, and may blit
+        # to the same destination.
+        clips = []
+        def items():
+            for i in range(100):
+                clips.append(tuple(dst2.get_clip()))
+                sub.blit(solid, (5, 5))
+                yield (solid, (i % 6, 0))
+        self.assertEqual(len(sub.blits(items())), 100)
+        self.assertEqual(set(clips), set([(0, 0, 20, 20)]))
+        self.assertEqual(dst2.get_clip(), pygame.Rect(0, 0, 20, 20))
+        self.assertEqual(dst2.get_at((11, 11)), (5, 6, 7, 255))
+        self.assertEqual(dst2.get_at((11, 4)), (5, 6, 7, 255))
+        self.assertEqual(dst2.get_at((12, 4)), (0, 0, 0, 255))
+
+        self.assertRaises(TypeError, dst2.blits, None)
+        self.assertRaises(TypeError, dst2.blits, [(None, (0, 0))])
+        self.assertRaises(TypeError, dst2.blits, [(src, 'bad')])
+        self.assertRaises(ValueError, dst2.blits, [(src,)])
+        self.assertRaises(ValueError, dst2.blits, [(src, (0, 0), None, 0, 0)])
+        self.assertRaises(TypeError, dst2.blits, [1])
+
+    def test_blit_transformed(self):
+        src = pygame.Surface((7, 4), 0, 32)
+        for x in range(7):
+            for y in range(4):
+                src.set_at((x, y), (x * 30, y * 60, 100))
+
+        # No rotation or zoom is a plain blit.
+        expected = pygame.Surface((30, 20), 0, 32)
+        expected.blit(src, (10, 5))
+        for smooth in (False, True):
+            dst = pygame.Surface((30, 20), 0, 32)
+            rect = dst.blit_transformed(src, (13.5, 7), smooth=smooth)
+            self.assertTrue(rect.contains((10, 5, 7, 4)))
+            for x in range(30):
+                for y in range(20):
+                    self.assertEqual(dst.get_at((x, y)),
+                                     expected.get_at((x, y)))
+
+        # Rotation and zoom match pygame.transform for whole steps.
+        for angle, scale in ((90, 1.0), (180, 1.0), (270, 2.0), (0, 3.0)):
+            expected = pygame.transform.rotate(src, angle)
+            expected = pygame.transform.scale(
+                expected, (expected.get_width() * int(scale),
+                           expected.get_height() * int(scale)))
+            w, h = expected.get_size()
+            dst = pygame.Surface((40, 40), 0, 32)
+            rect = dst.blit_transformed(src, (10 + w / 2.0, 10 + h / 2.0),
+                                        angle, scale)
+            self.assertEqual(rect, (10, 10, w, h))
+            for x in range(w):
+                for y in range(h):
+                    self.assertEqual(dst.get_at((10 + x, 10 + y)),
+                                     expected.get_at((x, y)))
+
+        # Source alpha is blended, and smooth edges fade out.
+        alpha = pygame.Surface((8, 8), SRCALPHA, 32)
+        alpha.fill((255, 255, 255, 128))
+        dst = pygame.Surface((30, 30), 0, 32)
+        dst.blit_transformed(alpha, (15, 15), 45)
+        self.assertEqual(dst.get_at((15, 15)), (128, 128, 128, 255))
+        self.assertEqual(dst.get_at((0, 0)), (0, 0, 0, 255))
+        alpha.fill((255, 255, 255))
+        dst.fill((0, 0, 0))
+        dst.blit_transformed(alpha, (15, 15), 30, 2.0, True)
+        self.assertEqual(dst.get_at((15, 15)), (255, 255, 255, 255))
+        edge = [dst.get_at((x, 15))[0] for x in range(30)]
+        self.assertTrue([v for v in edge if 0 < v < 255])
+
+        self.assertEqual(dst.blit_transformed(alpha, (5, 5), 0, 0.0).size,
+                         (0, 0))
+        self.assertRaises(ValueError, dst.blit_transformed, dst, (0, 0))
+        self.assertRaises(ValueError, dst.blit_transformed, alpha, (0, 0),
+                          0, -1.0)
+        self.assertRaises(ValueError, dst.blit_transformed, alpha, (0, 0),
+                          0, 1e-6)
+        self.assertRaises(ValueError, dst.blit_transformed, alpha, (0, 0),
+                          float('nan'))
+        self.assertRaises(ValueError, dst.blit_transformed, alpha,
+                          (float('inf'), 0))
+        self.assertEqual(dst.blit_transformed(alpha, (1e9, 5), 0, 1e6).size,
+                         (0, 0))
+        self.assertRaises(TypeError, dst.blit_transformed, alpha, 'bad')
+        self.assertRaises(ValueError,
+                          pygame.Surface((4, 4), 0, 8).blit_transformed,
+                          alpha, (0, 0))
+
     def todo_test_blit(self):
         # __doc__ (as of 2008-08-02) for pygame.surface.Surface.blit:
 
@@ -867,7 +1037,7 @@ class SurfaceTypeTest(unittest.TestCase):
 
         self.fail()
 
-    def todo_test_get_locks(self):
+    def test_get_locks(self):
 
         # __doc__ (as of 2008-08-02) for pygame.surface.Surface.get_locks:
 
@@ -876,7 +1046,34 @@ class SurfaceTypeTest(unittest.TestCase):
           #
           # Returns the currently existing locks for the Surface.
 
-        self.fail()
+        surf = pygame.Surface((10, 10), 0, 32)
+        self.assertEqual(surf.get_locks(), ())
+        surf.lock()
+        surf.lock()
+        self.assertEqual(surf.get_locks(), (surf, surf))
+
+        # More lock holders than are kept in the surface itself
+        arrays = [pygame.PixelArray(surf) for i in range(6)]
+        locks = surf.get_locks()
+        self.assertEqual(len(locks), 8)
+        self.assertEqual(len([l for l in locks if l is surf]), 2)
+        for a in arrays:
+            self.assertEqual(len([l for l in locks if l is a]), 1)
+        surf.unlock()
+        surf.unlock()
+        self.assertTrue(surf.get_locked())
+        del locks
+        del arrays[2]
+        self.assertEqual(len(surf.get_locks()), 5)
+        del arrays
+        self.assertEqual(surf.get_locks(), ())
+        self.assertFalse(surf.get_locked())
+
+        sub = surf.subsurface((1, 1, 4, 4))
+        sub.lock()
+        self.assertEqual(surf.get_locks(), (sub,))
+        sub.unlock()
+        self.assertEqual(surf.get_locks(), ())
 
     def todo_test_get_losses(self):
 
@@ -2213,6 +2410,188 @@ class SurfaceBlendTest (unittest.TestCase):
                 dst.fill(fill_color, special_flags=getattr(pygame, blend_name))
                 self._assert_surface(dst, p, ", %s" % blend_name)
 
+class SurfaceParallelTest(unittest.TestCase):
+    """Software blits and fills split across worker threads"""
+
+    def setUp(self):
+        self.config = pygame.surface.get_parallelism()
+
+    def tearDown(self):
+        pygame.surface.set_parallelism(*self.config)
+
+    def _make_pair(self, size, flags, depth):
+        src = pygame.Surface(size, flags, depth)
+        w, h = size
+        for y in range(h):
+            for x in range(0, w, 7):
+                src.set_at((x, y), ((x * 3) & 255, (y * 5) & 255,
+                                    (x + y) & 255, (x * y) & 255))
+        dst = pygame.Surface(size, flags, depth)
+        dst.fill((40, 90, 160, 200))
+        return src, dst
+
+    def _blit_and_fill(self, size, flags, depth, special_flags):
+        src, dst = self._make_pair(size, flags, depth)
+        dst.blit(src, (1, 2), None, special_flags)
+        if special_flags:
+            dst.fill((20, 30, 40, 50), None, special_flags)
+        return pygame.image.tostring(dst, 'RGBA')
+
+    def test_get_set_parallelism(self):
+        pygame.surface.set_parallelism(3, 100)
+        self.assertEqual(pygame.surface.get_parallelism(), (3, 100))
+        pygame.surface.set_parallelism(n=1, min_pixels=0)
+        self.assertEqual(pygame.surface.get_parallelism(), (1, 0))
+        pygame.surface.set_parallelism()
+        n, min_pixels = pygame.surface.get_parallelism()
+        self.assertTrue(n >= 1)
+        self.assertEqual(min_pixels, 65536)
+        self.assertRaises(ValueError, pygame.surface.set_parallelism, -1)
+        self.assertRaises(ValueError, pygame.surface.set_parallelism, 2, -1)
+
+    def test_parallel_matches_serial(self):
+        cases = [((97, 61), SRCALPHA, 32, 0),
+                 ((97, 61), 0, 32, 0),
+                 ((97, 61), 0, 24, BLEND_ADD),
+                 ((97, 61), SRCALPHA, 32, BLEND_RGBA_MULT),
+                 ((97, 61), 0, 16, BLEND_SUB),
+                 ((97, 61), SRCALPHA, 32, BLEND_PREMULTIPLIED)]
+        for size, flags, depth, special_flags in cases:
+            pygame.surface.set_parallelism(1)
+            expected = self._blit_and_fill(size, flags, depth, special_flags)
+            pygame.surface.set_parallelism(4, 1)
+            result = self._blit_and_fill(size, flags, depth, special_flags)
+            self.assertEqual(result, expected,
+                             "flags %x, depth %i, special_flags %i" %
+                             (flags, depth, special_flags))
+
+    def test_parallel_self_blit(self):
+        pygame.surface.set_parallelism(1)
+        surf, _ = self._make_pair((64, 64), 0, 32)
+        surf.blit(surf, (3, 5), None, BLEND_ADD)
+        expected = pygame.image.tostring(surf, 'RGBA')
+        pygame.surface.set_parallelism(4, 1)
+        surf, _ = self._make_pair((64, 64), 0, 32)
+        surf.blit(surf, (3, 5), None, BLEND_ADD)
+        self.assertEqual(pygame.image.tostring(surf, 'RGBA'), expected)
+
+    def test_parallel_subsurface_blit_transformed(self):
+        # The parent is the source of a transformed blit into its own lower
+        # half, moved down 32 rows. Rows are then copied in order, each
+        # from one already written, as a single band does.
+        pygame.surface.set_parallelism(4, 1)
+        parent, _ = self._make_pair((64, 256), 0, 32)
+        expected = [[parent.get_at((x, y)) for x in range(64)]
+                    for y in range(256)]
+        for y in range(128, 256):
+            expected[y] = expected[y - 32]
+        sub = parent.subsurface((0, 128, 64, 128))
+        rect = sub.blit_transformed(parent, (32, 32))
+        self.assertEqual(rect, (0, 0, 64, 128))
+        for y in range(256):
+            for x in range(64):
+                self.assertEqual(parent.get_at((x, y)), expected[y][x])
+        self.assertRaises(ValueError, parent.blit_transformed, parent,
+                          (0, 0))
+
+
+class SurfaceBlitStatsTest(unittest.TestCase):
+
+    def tearDown(self):
+        pygame.surface.set_blit_stats(False)
+        pygame.surface.reset_blit_stats()
+
+    def test_blit_stats(self):
+        dst = pygame.Surface((20, 10), 0, 32)
+        alpha_dst = pygame.Surface((20, 10), SRCALPHA, 32)
+        src = pygame.Surface((4, 5), 0, 16)
+        alpha_src = pygame.Surface((4, 5), SRCALPHA, 32)
+
+        pygame.surface.reset_blit_stats()
+        dst.blit(src, (0, 0))
+        self.assertEqual(pygame.surface.get_blit_stats(), {})
+
+        pygame.surface.set_blit_stats(True)
+        dst.blit(src, (0, 0))
+        dst.blit(src, (18, 0))
+        dst.blit(src, (0, 0), None, BLEND_ADD)
+        alpha_dst.blits([(alpha_src, (0, 0)), (alpha_src, (5, 0))])
+        stats = pygame.surface.get_blit_stats()
+        self.assertEqual(len(stats), 3)
+
+        calls, pixels, ns = stats[('sdl', 2, 4, 0)]
+        self.assertEqual(calls, 2)
+        self.assertEqual(pixels, 4 * 5 + 2 * 5)
+        self.assertTrue(ns >= 0)
+        self.assertEqual(stats[('softblit', 2, 4, BLEND_ADD)][:2], (1, 20))
+        self.assertEqual(stats[('alphablit', 4, 4, 0)][:2], (2, 40))
+
+        pygame.surface.set_blit_stats(False)
+        dst.blit(src, (0, 0))
+        self.assertEqual(pygame.surface.get_blit_stats()[('sdl', 2, 4, 0)][0],
+                         2)
+        pygame.surface.reset_blit_stats()
+        self.assertEqual(pygame.surface.get_blit_stats(), {})
+
+
+class SurfacePoolTest(unittest.TestCase):
+
+    def tearDown(self):
+        pygame.surface.set_pool_limit(16 * 1024 * 1024)
+
+    def test_pool(self):
+        pygame.surface.set_pool_limit(0)
+        pygame.surface.set_pool_limit(1024 * 1024)
+        stats = pygame.surface.get_pool_stats()
+        self.assertEqual(stats['retained_bytes'], 0)
+        self.assertEqual(stats['limit'], 1024 * 1024)
+
+        s = pygame.Surface((64, 32), 0, 32)
+        self.assertFalse(s.get_flags() & PREALLOC)
+        self.assertEqual(s.get_at((63, 31)), (0, 0, 0, 255))
+        s.fill((10, 20, 30))
+        del s
+        gc.collect()
+        stats = pygame.surface.get_pool_stats()
+        self.assertTrue(stats['retained_bytes'] >= 64 * 32 * 4)
+        hits = stats['hits']
+
+        # A reused buffer comes back cleared
+        s = pygame.Surface((60, 32), 0, 32)
+        self.assertEqual(pygame.surface.get_pool_stats()['hits'], hits + 1)
+        self.assertEqual(s.get_at((0, 0)), (0, 0, 0, 255))
+        t = pygame.transform.flip(s, True, False)
+        self.assertEqual(t.get_size(), (60, 32))
+        del s, t
+        gc.collect()
+
+        pygame.surface.set_pool_limit(0)
+        stats = pygame.surface.get_pool_stats()
+        self.assertEqual(stats['retained_bytes'], 0)
+        self.assertEqual(stats['retained_buffers'], 0)
+        self.assertRaises(ValueError, pygame.surface.set_pool_limit, -1)
+
+    def test_pool__flags(self):
+        # Pooled surfaces blit like unpooled ones
+        pygame.surface.set_pool_limit(0)
+        plain = [pygame.Surface((64, 32), flags, 32).get_flags()
+                 for flags in (0, SRCALPHA)]
+        pygame.surface.set_pool_limit(1024 * 1024)
+        for i in range(2):
+            pooled = [pygame.Surface((64, 32), flags, 32).get_flags()
+                      for flags in (0, SRCALPHA)]
+            self.assertEqual(pooled, plain)
+            gc.collect()
+        self.assertTrue(pooled[1] & SRCALPHA)
+
+        src = pygame.Surface((64, 32), SRCALPHA, 32)
+        src.fill((255, 0, 0, 128))
+        dst = pygame.Surface((64, 32), 0, 32)
+        dst.blit(src, (0, 0))
+        self.assertEqual(dst.get_at((0, 0))[1:3], (0, 0))
+        self.assertTrue(120 <= dst.get_at((0, 0))[0] <= 136)
+
+
 class SurfaceSelfBlitTest(unittest.TestCase):
     """Blit to self tests.
 
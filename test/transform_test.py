@@ -354,6 +354,44 @@ class TransformModuleTest( unittest.TestCase ):
 
         ################################################################
 
+    def test_threshold__32bit_matches_24bit(self):
+        # 32 bit surfaces take a faster path than other depths. Check it
+        # against 24 bit copies of the same pixels, for widths on either
+        # side of the vector sizes.
+        import random
+        random.seed(7)
+        threshold = pygame.transform.threshold
+
+        for w, h in ((1, 1), (7, 5), (33, 17), (64, 40)):
+            pixels = [((x, y), (random.choice((50, 60, 200)),
+                                random.choice((50, 58, 100)),
+                                random.randint(0, 255)))
+                      for y in range(h) for x in range(w)]
+            surfs = {}
+            for depth in (24, 32):
+                s = pygame.Surface((w, h), 0, depth)
+                s2 = pygame.Surface((w, h), 0, depth)
+                for pos, color in pixels:
+                    s.set_at(pos, color)
+                    s2.set_at(pos, (color[1], color[0], color[2]))
+                surfs[depth] = s, s2
+
+            for change_return in (0, 1, 2):
+                for compare in (None, 0, 1):
+                    results = []
+                    for depth in (24, 32):
+                        s, s2 = surfs[depth]
+                        dest = pygame.Surface((w, h), 0, depth)
+                        args = [dest, s, (55, 55, 128), (6, 9, 128),
+                                (1, 2, 3), change_return]
+                        if compare is not None:
+                            # against the second surface, inverse or not
+                            args += [s2, compare]
+                        n = threshold(*args)
+                        results.append((n, [tuple(dest.get_at(pos))
+                                            for pos, c in pixels]))
+                    self.assertEqual(results[0], results[1])
+
     def test_threshold__surface(self):
         """
         """
@@ -609,6 +647,39 @@ class TransformModuleTest( unittest.TestCase ):
         for pt, color in gradient:
             self.assert_(s.get_at(pt) == color)
 
+    def test_rotate__smooth(self):
+        color = (10, 200, 30, 255)
+        for depth in (24, 32):
+            s = pygame.Surface((40, 30), 0, depth)
+            s.fill(color)
+            for angle in (10, 45, -100, 333.5):
+                plain = pygame.transform.rotate(s, angle)
+                smooth = pygame.transform.rotate(s, angle, smooth=True)
+                self.assertEqual(smooth.get_size(), plain.get_size())
+                # the padding and the filled inside blend to themselves
+                w, h = smooth.get_size()
+                self.assertEqual(smooth.get_at((0, 0)), color)
+                self.assertEqual(smooth.get_at((w // 2, h // 2)), color)
+
+    def test_rotate__smooth_at_90_degrees(self):
+        w, h = 32, 16
+        s = pygame.Surface((w, h), 0, 32)
+        for pt, color in test_utils.gradient(w, h):
+            s.set_at(pt, color)
+
+        for angle in (90, 180, -90):
+            plain = pygame.transform.rotate(s, angle)
+            smooth = pygame.transform.rotate(s, angle, True)
+            self.assertEqual(smooth.get_size(), plain.get_size())
+            for y in range(plain.get_height()):
+                for x in range(plain.get_width()):
+                    self.assertEqual(smooth.get_at((x, y)),
+                                     plain.get_at((x, y)))
+
+    def test_rotate__smooth_depth(self):
+        s = pygame.Surface((8, 8), 0, 8)
+        self.assertRaises(ValueError, pygame.transform.rotate, s, 30, True)
+
     def test_scale2x(self):
 
         # __doc__ (as of 2008-06-25) for pygame.transform.scale2x:
@@ -626,7 +697,8 @@ class TransformModuleTest( unittest.TestCase ):
 
     def test_get_smoothscale_backend(self):
         filter_type = pygame.transform.get_smoothscale_backend()
-        self.failUnless(filter_type in ['GENERIC', 'MMX', 'SSE'])
+        self.failUnless(filter_type in ['GENERIC', 'MMX', 'SSE',
+                                        'SSE2', 'AVX2', 'NEON'])
         # It would be nice to test if a non-generic type corresponds to an x86
         # processor. But there is no simple test for this. platform.machine()
         # returns process version specific information, like 'i686'.
@@ -653,7 +725,7 @@ class TransformModuleTest( unittest.TestCase ):
             pygame.transform.set_smoothscale_backend(1)
         self.failUnlessRaises(TypeError, change)
         # Unsupported type, if possible.
-        if original_type != 'SSE':
+        if original_type in ('GENERIC', 'NEON'):
             def change():
                 pygame.transform.set_smoothscale_backend('SSE')
             self.failUnlessRaises(ValueError, change)
@@ -661,6 +733,304 @@ class TransformModuleTest( unittest.TestCase ):
         filter_type = pygame.transform.get_smoothscale_backend()
         self.failUnlessEqual(filter_type, original_type)
 
+    def test_smoothscale_backends_match(self):
+        # The intrinsic backends give the same pixels as 'GENERIC'.
+        original_type = pygame.transform.get_smoothscale_backend()
+        sizes = [(29, 17), (11, 41), (64, 5), (3, 3), (57, 33)]
+        targets = [(13, 7), (40, 50), (7, 30), (100, 6), (57, 34), (1, 1)]
+        sources = []
+        for depth, fmt in ((32, 'RGBA'), (24, 'RGB')):
+            for w, h in sizes:
+                flags = SRCALPHA if depth == 32 else 0
+                s = pygame.Surface((w, h), flags, depth)
+                for y in range(h):
+                    for x in range(w):
+                        s.set_at((x, y), ((x * 37 + y * 11) % 256,
+                                          (x * y * 7) % 256,
+                                          (x * 5 + y * 91) % 256,
+                                          (x * 13 + y * 3) % 256))
+                sources.append((s, fmt))
+
+        def scaled_all():
+            return [pygame.image.tostring(
+                        pygame.transform.smoothscale(s, size), fmt)
+                    for s, fmt in sources for size in targets]
+
+        try:
+            pygame.transform.set_smoothscale_backend('GENERIC')
+            expected = scaled_all()
+            for backend in ('SSE2', 'AVX2', 'NEON'):
+                try:
+                    pygame.transform.set_smoothscale_backend(backend)
+                except ValueError:
+                    continue
+                self.assertTrue(scaled_all() == expected,
+                                "%s differs from GENERIC" % backend)
+        finally:
+            pygame.transform.set_smoothscale_backend(original_type)
+
+    def test_smoothscale_parallel(self):
+        # Splitting the passes across threads does not change the result.
+        config = pygame.surface.get_parallelism()
+        sources = []
+        for depth, flags in ((32, SRCALPHA), (24, 0)):
+            s = pygame.Surface((83, 47), flags, depth)
+            for y in range(47):
+                for x in range(83):
+                    s.set_at((x, y), ((x * 7) % 256, (y * 13) % 256,
+                                      (x * y) % 256, (x + y * 3) % 256))
+            sources.append(s)
+        targets = [(31, 19), (160, 90), (83, 20), (40, 47), (200, 30)]
+
+        def scaled_all():
+            return [pygame.image.tostring(
+                        pygame.transform.smoothscale(s, size), 'RGB')
+                    for s in sources for size in targets]
+
+        try:
+            pygame.surface.set_parallelism(1)
+            expected = scaled_all()
+            pygame.surface.set_parallelism(4, 1)
+            self.assertTrue(scaled_all() == expected)
+        finally:
+            pygame.surface.set_parallelism(*config)
+
+    def test_build_pyramid(self):
+        s = pygame.Surface((13, 6), SRCALPHA, 32)
+        for y in range(6):
+            for x in range(13):
+                s.set_at((x, y), (x * 19, y * 40, (x * y) % 256, 255 - x))
+        pyramid = pygame.transform.build_pyramid(s, 10)
+        self.assertTrue(pyramid[0] is s)
+        self.assertEqual([level.get_size() for level in pyramid],
+                         [(13, 6), (6, 3), (3, 1), (1, 1)])
+        for level in pyramid:
+            self.assertEqual(level.get_bitsize(), 32)
+        # Each pixel is the rounded average of the 2x2 it covers.
+        for y in range(3):
+            for x in range(6):
+                quad = [s.get_at((2 * x + i, 2 * y + j))
+                        for i in (0, 1) for j in (0, 1)]
+                expected = tuple((sum(c[k] for c in quad) + 2) // 4
+                                 for k in range(4))
+                self.assertEqual(tuple(pyramid[1].get_at((x, y))), expected)
+        # A one pixel side stays one pixel.
+        a, b = pyramid[2].get_at((0, 0)), pyramid[2].get_at((1, 0))
+        self.assertEqual(tuple(pyramid[3].get_at((0, 0))),
+                         tuple((a[k] + b[k] + 1) // 2 for k in range(4)))
+
+        self.assertEqual(len(pygame.transform.build_pyramid(s, 0)), 1)
+        self.assertEqual(len(pygame.transform.build_pyramid(s, 2)), 3)
+        s24 = pygame.Surface((9, 9), 0, 24)
+        s24.fill((10, 20, 30))
+        for level in pygame.transform.build_pyramid(s24, 3)[1:]:
+            self.assertEqual(level.get_bitsize(), 24)
+            self.assertEqual(level.get_at((0, 0)), (10, 20, 30, 255))
+        self.assertRaises(ValueError, pygame.transform.build_pyramid, s, -1)
+        self.assertRaises(ValueError, pygame.transform.build_pyramid,
+                          pygame.Surface((8, 8), 0, 8), 2)
+
+    def test_build_pyramid_backends_match(self):
+        original_type = pygame.transform.get_smoothscale_backend()
+        s = pygame.Surface((71, 37), SRCALPHA, 32)
+        for y in range(37):
+            for x in range(71):
+                s.set_at((x, y), ((x * 37) % 256, (y * 11) % 256,
+                                  (x * y) % 256, (x + y) % 256))
+
+        def levels():
+            return [pygame.image.tostring(level, 'RGBA')
+                    for level in pygame.transform.build_pyramid(s, 6)]
+
+        try:
+            pygame.transform.set_smoothscale_backend('GENERIC')
+            expected = levels()
+            for backend in ('SSE2', 'AVX2', 'NEON'):
+                try:
+                    pygame.transform.set_smoothscale_backend(backend)
+                except ValueError:
+                    continue
+                self.assertTrue(levels() == expected,
+                                "%s differs from GENERIC" % backend)
+        finally:
+            pygame.transform.set_smoothscale_backend(original_type)
+
+    def test_pyramid_scale(self):
+        s = pygame.Surface((64, 32), SRCALPHA, 32)
+        for x in range(64):
+            s.fill(((x * 4) % 256, 100, 255 - x, 200), (x, 0, 1, 32))
+        pyramid = pygame.transform.build_pyramid(s, 5)
+        tostring = pygame.image.tostring
+
+        # The smallest level at least as big is scaled.
+        for size, level in (((20, 10), 1), ((16, 8), 2), ((15, 9), 1),
+                            ((3, 1), 4), ((100, 40), 0), ((64, 5), 0)):
+            expected = pygame.transform.smoothscale(pyramid[level], size)
+            result = pygame.transform.pyramid_scale(pyramid, size)
+            self.assertEqual(result.get_size(), size)
+            self.assertEqual(tostring(result, 'RGBA'),
+                             tostring(expected, 'RGBA'))
+
+        # The order of the levels does not matter.
+        result = pygame.transform.pyramid_scale(tuple(reversed(pyramid)),
+                                                (20, 10))
+        expected = pygame.transform.smoothscale(pyramid[1], (20, 10))
+        self.assertEqual(tostring(result, 'RGBA'), tostring(expected, 'RGBA'))
+
+        dest = pygame.Surface((20, 10), SRCALPHA, 32)
+        self.assertTrue(
+            pygame.transform.pyramid_scale(pyramid, (20, 10), dest) is dest)
+        self.assertEqual(tostring(dest, 'RGBA'), tostring(expected, 'RGBA'))
+
+        self.assertRaises(ValueError, pygame.transform.pyramid_scale,
+                          [], (4, 4))
+        self.assertRaises(TypeError, pygame.transform.pyramid_scale,
+                          [s, 1], (4, 4))
+
+    def test_box_blur(self):
+        w, h = 11, 7
+        s = pygame.Surface((w, h), SRCALPHA, 32)
+        for y in range(h):
+            for x in range(w):
+                s.set_at((x, y), ((x * 23) % 256, (y * 37) % 256,
+                                  (x * y * 5) % 256, 255 - x * y))
+
+        def box(get, n, radius):
+            # The rounded averages of the line with its ends repeated.
+            return [tuple((sum(get(min(max(i + k, 0), n - 1))[c]
+                               for k in range(-radius, radius + 1)) +
+                           radius) // (2 * radius + 1) for c in range(4))
+                    for i in range(n)]
+
+        for radius in (0, 1, 2, 9):
+            rows = [box(lambda x: s.get_at((x, y)), w, radius)
+                    for y in range(h)]
+            expected = [box(lambda y: rows[y][x], h, radius)
+                        for x in range(w)]
+            result = pygame.transform.box_blur(s, radius)
+            self.assertEqual(result.get_size(), (w, h))
+            for y in range(h):
+                for x in range(w):
+                    self.assertEqual(tuple(result.get_at((x, y))),
+                                     expected[x][y])
+
+        # A 24-bit surface blurs like its 32-bit copy.
+        s24 = pygame.Surface((w, h), 0, 24)
+        s24.blit(s, (0, 0))
+        s32 = pygame.Surface((w, h), 0, 32)
+        s32.blit(s24, (0, 0))
+        self.assertEqual(
+            pygame.image.tostring(pygame.transform.box_blur(s24, 2), 'RGB'),
+            pygame.image.tostring(pygame.transform.box_blur(s32, 2), 'RGB'))
+
+        # The destination may be the surface itself.
+        expected = pygame.image.tostring(pygame.transform.box_blur(s, 3),
+                                         'RGBA')
+        self.assertTrue(pygame.transform.box_blur(s, 3, s) is s)
+        self.assertEqual(pygame.image.tostring(s, 'RGBA'), expected)
+
+        self.assertRaises(ValueError, pygame.transform.box_blur, s, -1)
+        self.assertRaises(ValueError, pygame.transform.box_blur,
+                          pygame.Surface((4, 4), 0, 8), 1)
+        self.assertRaises(ValueError, pygame.transform.box_blur, s, 1,
+                          pygame.Surface((4, 4), SRCALPHA, 32))
+
+    def test_gaussian_blur(self):
+        s = pygame.Surface((41, 41), 0, 32)
+        s.set_at((20, 20), (255, 255, 255))
+        result = pygame.transform.gaussian_blur(s, 3.0)
+        # The spot spreads out evenly, falling away from the middle.
+        centre = result.get_at((20, 20))[0]
+        self.assertTrue(0 < centre < 255)
+        for d in range(1, 20):
+            around = [result.get_at(p)[0] for p in
+                      ((20 + d, 20), (20 - d, 20), (20, 20 + d), (20, 20 - d))]
+            self.assertEqual(len(set(around)), 1)
+            self.assertTrue(around[0] <= centre)
+        self.assertEqual(result.get_at((0, 0)), (0, 0, 0, 255))
+
+        s.fill((10, 200, 30))
+        result = pygame.transform.gaussian_blur(s, 5.5)
+        self.assertEqual(pygame.image.tostring(result, 'RGB'),
+                         pygame.image.tostring(s, 'RGB'))
+        self.assertEqual(
+            pygame.image.tostring(pygame.transform.gaussian_blur(s, 0), 'RGB'),
+            pygame.image.tostring(s, 'RGB'))
+        self.assertRaises(ValueError, pygame.transform.gaussian_blur, s, -1.0)
+
+    def test_blur_backends_match(self):
+        original_type = pygame.transform.get_smoothscale_backend()
+        s = pygame.Surface((53, 29), SRCALPHA, 32)
+        for y in range(29):
+            for x in range(53):
+                s.set_at((x, y), ((x * 37) % 256, (y * 11) % 256,
+                                  (x * y) % 256, (x + y) % 256))
+
+        def blurred():
+            return [pygame.image.tostring(pygame.transform.box_blur(s, 4),
+                                          'RGBA'),
+                    pygame.image.tostring(pygame.transform.gaussian_blur(s, 2.5),
+                                          'RGBA')]
+
+        try:
+            pygame.transform.set_smoothscale_backend('GENERIC')
+            expected = blurred()
+            for backend in ('SSE2', 'AVX2', 'NEON'):
+                try:
+                    pygame.transform.set_smoothscale_backend(backend)
+                except ValueError:
+                    continue
+                self.assertTrue(blurred() == expected,
+                                "%s differs from GENERIC" % backend)
+        finally:
+            pygame.transform.set_smoothscale_backend(original_type)
+
+    def test_flip_ip(self):
+        for depth in (8, 16, 24, 32):
+            for w, h in ((37, 5), (64, 2), (1, 3), (8, 1)):
+                s = pygame.Surface((w, h), 0, depth)
+                for y in range(h):
+                    for x in range(w):
+                        s.set_at((x, y), ((x * 29 + y) % 256,
+                                          (y * 53) % 256, (x * y) % 256))
+                for xbool, ybool in ((1, 0), (0, 1), (1, 1), (0, 0)):
+                    expected = pygame.transform.flip(s, xbool, ybool)
+                    flipped = s.copy()
+                    self.assertTrue(
+                        pygame.transform.flip_ip(flipped, xbool, ybool)
+                        is None)
+                    for y in range(h):
+                        for x in range(w):
+                            self.assertEqual(flipped.get_at((x, y)),
+                                             expected.get_at((x, y)))
+
+    def test_chop__view(self):
+        s = pygame.Surface((20, 10), 0, 32)
+        for y in range(10):
+            for x in range(20):
+                s.set_at((x, y), (x * 10, y * 20, 0))
+        tostring = pygame.image.tostring
+
+        # Cuts at the edges give a subsurface of what is left.
+        for rect in ((0, 0, 5, 3), (15, 7, 10, 10), (0, 8, 0, 2),
+                     (30, 30, 2, 2), (-5, 0, 20, 4)):
+            expected = pygame.transform.chop(s, rect)
+            view = pygame.transform.chop(s, rect, view=True)
+            self.assertTrue(view.get_parent() is s)
+            self.assertEqual(view.get_size(), expected.get_size())
+            self.assertEqual(tostring(view, 'RGB'), tostring(expected, 'RGB'))
+
+        # An interior cut still copies.
+        expected = pygame.transform.chop(s, (5, 2, 3, 3))
+        copy = pygame.transform.chop(s, (5, 2, 3, 3), True)
+        self.assertTrue(copy.get_parent() is None)
+        self.assertEqual(copy.get_size(), (17, 7))
+        self.assertEqual(tostring(copy, 'RGB'), tostring(expected, 'RGB'))
+
+        view = pygame.transform.chop(s, (0, 0, 5, 0), True)
+        view.fill((1, 2, 3))
+        self.assertEqual(s.get_at((5, 0)), (1, 2, 3, 255))
+
     def todo_test_chop(self):
 
         # __doc__ (as of 2008-08-02) for pygame.transform.chop:
@@ -729,6 +1099,269 @@ class TransformModuleTest( unittest.TestCase ):
 
         self.fail()
 
+class RotationCacheTest(unittest.TestCase):
+
+    def _surface(self, size=(16, 16)):
+        s = pygame.Surface(size, SRCALPHA, 32)
+        w, h = size
+        for y in range(h):
+            for x in range(w):
+                s.set_at((x, y), (x * 15, y * 15, (x * y) % 256, 255))
+        return s
+
+    def test_get(self):
+        s = self._surface((20, 10))
+        cache = pygame.transform.RotationCache(s, 30)
+        for angle in (0, 90, 30, 180):
+            r = cache.get(angle)
+            expected = pygame.transform.rotate(s, angle)
+            self.assertEqual(r.get_size(), expected.get_size())
+            self.assertEqual(pygame.image.tostring(r, 'RGBA'),
+                             pygame.image.tostring(expected, 'RGBA'))
+        # Angles go to the nearest step, modulo 360.
+        self.assertTrue(cache.get(44) is cache.get(30))
+        self.assertTrue(cache.get(46) is cache.get(60))
+        self.assertTrue(cache.get(-30) is cache.get(330))
+        self.assertTrue(cache.get(356) is cache.get(0))
+        self.assertTrue(cache.get(450) is cache.get(90))
+        self.assertEqual(cache.get(7.5).get_size(), (20, 10))
+        self.assertRaises(ValueError, cache.get, float('nan'))
+        self.assertRaises(ValueError, cache.get, float('inf'))
+        self.assertRaises(ValueError, cache.get, float('-inf'))
+
+    def test_get__uneven_step(self):
+        s = self._surface()
+        # Steps at 0, 100, 200 and 300; past 300 the next is 360, that is 0.
+        cache = pygame.transform.RotationCache(s, 100)
+        self.assertTrue(cache.get(340) is cache.get(0))
+        self.assertTrue(cache.get(320) is cache.get(300))
+        cache = pygame.transform.RotationCache(s, 7)
+        self.assertTrue(cache.get(356) is cache.get(357))
+        self.assertTrue(cache.get(358) is cache.get(357))
+        self.assertTrue(cache.get(359) is cache.get(0))
+
+    def test_stats_and_lru(self):
+        s = self._surface()
+        nbytes = s.get_pitch() * s.get_height()
+        cache = pygame.transform.RotationCache(s, 90, budget=2 * nbytes)
+        stats = cache.get_stats()
+        self.assertEqual(stats, {'hits': 0, 'misses': 0, 'evictions': 0,
+                                 'entries': 0, 'bytes': 0,
+                                 'budget': 2 * nbytes})
+        a = cache.get(0)
+        b = cache.get(90)
+        self.assertTrue(cache.get(0) is a)
+        cache.get(180)              # drops 90, the least recently used
+        stats = cache.get_stats()
+        self.assertEqual((stats['hits'], stats['misses'],
+                          stats['evictions'], stats['entries'],
+                          stats['bytes']), (1, 3, 1, 2, 2 * nbytes))
+        self.assertTrue(cache.get(0) is a)
+        self.assertFalse(cache.get(90) is b)
+        self.assertEqual(cache.get_stats()['misses'], 4)
+
+        cache.set_budget(nbytes)
+        stats = cache.get_stats()
+        self.assertEqual((stats['entries'], stats['bytes']), (1, nbytes))
+        cache.clear()
+        self.assertEqual(cache.get_stats()['entries'], 0)
+        self.assertEqual(cache.get_stats()['bytes'], 0)
+
+        # Too big to keep at all.
+        cache.set_budget(0)
+        r = cache.get(0)
+        self.assertEqual(r.get_size(), (16, 16))
+        self.assertFalse(cache.get(0) is r)
+        self.assertEqual(cache.get_stats()['entries'], 0)
+
+    def test_arguments(self):
+        s = self._surface()
+        RotationCache = pygame.transform.RotationCache
+        self.assertRaises(ValueError, RotationCache, s, 0)
+        self.assertRaises(ValueError, RotationCache, s, -5)
+        self.assertRaises(ValueError, RotationCache, s, 1e-12)
+        self.assertRaises(ValueError, RotationCache, s, 0.09)
+        self.assertRaises(ValueError, RotationCache, s, float('nan'))
+        RotationCache(s, 0.1)
+        self.assertRaises(ValueError, RotationCache, s, 361)
+        self.assertRaises(ValueError, RotationCache, s, 10, -1)
+        self.assertRaises(TypeError, RotationCache, None, 10)
+        cache = RotationCache(surface=s, step=360)
+        self.assertTrue(cache.get(180) is cache.get(0))
+        self.assertRaises(ValueError, cache.set_budget, -1)
+
+class IntegralImageTest(unittest.TestCase):
+
+    def _surface(self, size, depth=32):
+        flags = SRCALPHA if depth == 32 else 0
+        s = pygame.Surface(size, flags, depth)
+        w, h = size
+        for y in range(h):
+            for x in range(w):
+                s.set_at((x, y), (x * 13 % 256, y * 7 % 256,
+                                  (x * y) % 256, 128 + x % 128))
+        return s
+
+    def test_average_matches_average_color(self):
+        for depth in (8, 16, 24, 32):
+            s = self._surface((23, 17), depth)
+            image = pygame.transform.IntegralImage(s)
+            self.assertEqual(image.get_size(), (23, 17))
+            for rect in ((0, 0, 23, 17), (3, 4, 5, 6), (10, 0, 1, 17),
+                         (-4, -2, 9, 8), (20, 15, 10, 10)):
+                self.assertEqual(image.average(rect),
+                                 pygame.transform.average_color(s, rect))
+            self.assertEqual(image.average(),
+                             pygame.transform.average_color(s))
+
+    def test_sum(self):
+        s = self._surface((9, 6))
+        image = pygame.transform.IntegralImage(s)
+        rect = pygame.Rect(2, 1, 4, 3)
+        expected = [0, 0, 0, 0]
+        for y in range(rect.top, rect.bottom):
+            for x in range(rect.left, rect.right):
+                for i, c in enumerate(s.get_at((x, y))):
+                    expected[i] += c
+        self.assertEqual(image.sum(rect), tuple(expected))
+        self.assertEqual(image.sum((50, 50, 2, 2)), (0, 0, 0, 0))
+        self.assertEqual(image.average((0, 0, 0, 0)), (0, 0, 0, 0))
+
+    def test_many(self):
+        s = self._surface((12, 12))
+        image = pygame.transform.IntegralImage(s)
+        rects = [(0, 0, 4, 4), pygame.Rect(3, 3, 6, 2), ((1, 1), (11, 11))]
+        self.assertEqual(image.sum_many(rects),
+                         [image.sum(r) for r in rects])
+        self.assertEqual(image.average_many(rects),
+                         [image.average(r) for r in rects])
+        self.assertEqual(image.sum_many([]), [])
+        self.assertRaises(TypeError, image.sum_many, [(1, 2)])
+        self.assertRaises(TypeError, image.average_many, 3)
+
+    def test_snapshot(self):
+        s = self._surface((4, 4))
+        image = pygame.transform.IntegralImage(s)
+        before = image.sum()
+        s.fill((0, 0, 0, 0))
+        self.assertEqual(image.sum(), before)
+
+class AccumulatorTest(unittest.TestCase):
+
+    def _frames(self, n, size=(7, 5)):
+        frames = []
+        w, h = size
+        for k in range(n):
+            s = pygame.Surface(size, SRCALPHA, 32)
+            for y in range(h):
+                for x in range(w):
+                    s.set_at((x, y), ((x * 31 + k * 50) % 256,
+                                      (y * 17 + k * 20) % 256,
+                                      (x * y + k * 90) % 256,
+                                      (k * 60) % 256))
+            frames.append(s)
+        return frames
+
+    def _mean(self, frames, pos):
+        n = len(frames)
+        sums = [0, 0, 0, 0]
+        for s in frames:
+            for i, c in enumerate(s.get_at(pos)):
+                sums[i] += c
+        return tuple((c + n // 2) // n for c in sums)
+
+    def test_mean(self):
+        frames = self._frames(5)
+        acc = pygame.transform.Accumulator((7, 5))
+        self.assertRaises(ValueError, acc.to_surface)
+        for s in frames:
+            acc.add(s)
+        self.assertEqual(acc.get_count(), 5)
+        result = acc.to_surface()
+        self.assertEqual(result.get_size(), (7, 5))
+        for pos in ((0, 0), (6, 4), (3, 2)):
+            self.assertEqual(tuple(result.get_at(pos)),
+                             self._mean(frames, pos))
+
+        acc.remove(frames[0])
+        acc.remove(frames[3])
+        result = acc.to_surface()
+        rest = [frames[1], frames[2], frames[4]]
+        for pos in ((0, 0), (6, 4), (3, 2)):
+            self.assertEqual(tuple(result.get_at(pos)),
+                             self._mean(rest, pos))
+
+        acc.clear()
+        self.assertEqual(acc.get_count(), 0)
+        self.assertRaises(ValueError, acc.remove, frames[0])
+
+    def test_window(self):
+        frames = self._frames(7)
+        acc = pygame.transform.Accumulator((7, 5), window=3)
+        for n, s in enumerate(frames):
+            acc.add(s)
+            last = frames[max(0, n - 2):n + 1]
+            self.assertEqual(acc.get_count(), len(last))
+            result = acc.to_surface()
+            for pos in ((0, 0), (5, 3)):
+                self.assertEqual(tuple(result.get_at(pos)),
+                                 self._mean(last, pos))
+        self.assertRaises(ValueError, acc.remove, frames[0])
+
+    def test_alpha(self):
+        a = pygame.Surface((2, 2), SRCALPHA, 32)
+        b = pygame.Surface((2, 2), SRCALPHA, 32)
+        a.fill((0, 100, 200, 255))
+        b.fill((200, 100, 0, 55))
+        acc = pygame.transform.Accumulator((2, 2), alpha=0.25)
+        acc.add(a)
+        self.assertEqual(acc.to_surface().get_at((0, 0)), (0, 100, 200, 255))
+        acc.add(b)
+        self.assertEqual(acc.to_surface().get_at((1, 1)), (50, 100, 150, 205))
+        self.assertRaises(ValueError, acc.remove, a)
+
+    def test_depths_and_dest(self):
+        acc = pygame.transform.Accumulator((4, 4))
+        for depth in (24, 32):
+            s = pygame.Surface((4, 4), 0, depth)
+            s.fill((128, 64, 32))
+            acc.add(s)
+        dest = pygame.Surface((4, 4), 0, 24)
+        self.assertTrue(acc.to_surface(dest) is dest)
+        self.assertEqual(dest.get_at((2, 2)), (128, 64, 32, 255))
+
+    def test_errors(self):
+        Accumulator = pygame.transform.Accumulator
+        self.assertRaises(ValueError, Accumulator, (-1, 4))
+        self.assertRaises(ValueError, Accumulator, (4, 4), window=-1)
+        self.assertRaises(ValueError, Accumulator, (4, 4), alpha=1.5)
+        self.assertRaises(ValueError, Accumulator, (4, 4), window=2,
+                          alpha=0.5)
+        acc = Accumulator((4, 4))
+        self.assertRaises(ValueError, acc.add, pygame.Surface((4, 5)))
+
+    def test_threads(self):
+        # Threads sharing an Accumulator take turns with its sums
+        import threading
+        a, b = self._frames(2, (64, 64))
+        acc = pygame.transform.Accumulator((64, 64), window=4)
+        def adder(s):
+            for i in range(50):
+                acc.add(s)
+        threads = [threading.Thread(target=adder, args=(s,))
+                   for s in (a, b, a, b)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        self.assertEqual(acc.get_count(), 4)
+        result = acc.to_surface()
+        for pos in ((0, 0), (63, 63), (20, 40)):
+            self.assertTrue(tuple(result.get_at(pos)) in
+                            [self._mean(f, pos) for f in
+                             ([a] * 4, [a] * 3 + [b], [a, a, b, b],
+                              [a] + [b] * 3, [b] * 4)])
+
 if __name__ == '__main__':
     #tt = TransformModuleTest()
     #tt.test_threshold_non_src_alpha()